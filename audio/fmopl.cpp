@@ -306,7 +306,13 @@ EmulatedOPL::EmulatedOPL() :
 	_nextTick(0),
 	_samplesPerTick(0),
 	_baseFreq(0),
-	_handle(new Audio::SoundHandle()) {
+	_handle(new Audio::SoundHandle()),
+	_batchRendering(true),
+	_queueMutex(g_system ? g_system->createMutex() : nullptr),
+	_inBatch(false),
+	_batchBuffer(0),
+	_batchRendered(0),
+	_batchPos(0) {
 }
 
 EmulatedOPL::~EmulatedOPL() {
@@ -317,6 +323,90 @@ EmulatedOPL::~EmulatedOPL() {
 	stop();
 
 	delete _handle;
+
+	if (_queueMutex)
+		g_system->deleteMutex(_queueMutex);
+}
+
+void EmulatedOPL::lockQueue() {
+	if (_queueMutex)
+		g_system->lockMutex(_queueMutex);
+}
+
+void EmulatedOPL::unlockQueue() {
+	if (_queueMutex)
+		g_system->unlockMutex(_queueMutex);
+}
+
+void EmulatedOPL::write(int a, int v) {
+	if (_batchRendering) {
+		lockQueue();
+		const bool queued = queueWrite(false, a, v);
+		unlockQueue();
+		if (queued)
+			return;
+	}
+	writeImmediate(a, v);
+}
+
+byte EmulatedOPL::read(int a) {
+	if (_batchRendering) {
+		// Timer polling has to see the writes made so far
+		lockQueue();
+		if (_inBatch) {
+			applyPendingWrites();
+			renderBatch(_batchPos);
+		}
+		unlockQueue();
+	}
+	return readImmediate(a);
+}
+
+void EmulatedOPL::writeReg(int r, int v) {
+	if (_batchRendering) {
+		lockQueue();
+		const bool queued = queueWrite(true, r, v);
+		unlockQueue();
+		if (queued)
+			return;
+	}
+	writeRegImmediate(r, v);
+}
+
+bool EmulatedOPL::queueWrite(bool isReg, int address, int value) {
+	if (!_inBatch)
+		return false;
+
+	PendingWrite write;
+	write.frame = _batchPos;
+	write.isReg = isReg;
+	write.address = address;
+	write.value = value;
+	_pendingWrites.push_back(write);
+	return true;
+}
+
+void EmulatedOPL::renderBatch(int frame) {
+	if (frame <= _batchRendered)
+		return;
+
+	const int stereoFactor = isStereo() ? 2 : 1;
+	generateSamples(_batchBuffer + _batchRendered * stereoFactor, (frame - _batchRendered) * stereoFactor);
+	_batchRendered = frame;
+}
+
+void EmulatedOPL::applyPendingWrites() {
+	for (uint i = 0; i < _pendingWrites.size(); ++i) {
+		const PendingWrite &write = _pendingWrites[i];
+		renderBatch(write.frame);
+		if (write.isReg)
+			writeRegImmediate(write.address, write.value);
+		else
+			writeImmediate(write.address, write.value);
+	}
+
+	// Keep the storage around for the next buffer
+	_pendingWrites.resize(0);
 }
 
 int EmulatedOPL::readBuffer(int16 *buffer, const int numSamples) {
@@ -324,6 +414,47 @@ int EmulatedOPL::readBuffer(int16 *buffer, const int numSamples) {
 	int len = numSamples / stereoFactor;
 	int step;
 
+	if (_batchRendering) {
+		// Run the callbacks for the whole buffer first, remembering at
+		// which sample each of them happened, then render everything.
+		lockQueue();
+		_batchBuffer = buffer;
+		_batchRendered = 0;
+		_batchPos = 0;
+		_inBatch = true;
+		unlockQueue();
+
+		do {
+			step = len - _batchPos;
+			if (step > (_nextTick >> FIXP_SHIFT))
+				step = (_nextTick >> FIXP_SHIFT);
+
+			lockQueue();
+			_batchPos += step;
+			unlockQueue();
+
+			_nextTick -= step << FIXP_SHIFT;
+			if (!(_nextTick >> FIXP_SHIFT)) {
+				if (_callback && _callback->isValid())
+					(*_callback)();
+
+				_nextTick += _samplesPerTick;
+			}
+		} while (_batchPos < len);
+
+		// Writes from now on go to the chip directly again, so the ones
+		// queued so far are applied first
+		lockQueue();
+		applyPendingWrites();
+		_inBatch = false;
+		unlockQueue();
+
+		renderBatch(len);
+		_batchBuffer = 0;
+
+		return numSamples;
+	}
+
 	do {
 		step = len;
 		if (step > (_nextTick >> FIXP_SHIFT))
@@ -25,9 +25,11 @@
 
 #include "audio/audiostream.h"
 
+#include "common/array.h"
 #include "common/func.h"
 #include "common/ptr.h"
 #include "common/scummsys.h"
+#include "common/system.h"
 
 namespace Audio {
 class SoundHandle;
@@ -236,6 +238,12 @@ private:
  *
  * This will send callbacks based on the number of samples
  * decoded in readBuffer().
+ *
+ * By default, readBuffer() first runs all callbacks which fall into the
+ * requested buffer. Register writes made by them are queued together with
+ * the sample position of the callback, and the buffer is then rendered in
+ * as few generateSamples() calls as the writes allow. Reads flush the
+ * queue first, so drivers always see the current chip state.
  */
 class EmulatedOPL : public OPL, protected Audio::AudioStream {
 public:
@@ -243,8 +251,18 @@ public:
 	virtual ~EmulatedOPL();
 
 	// OPL API
+	void write(int a, int v);
+	byte read(int a);
+	void writeReg(int r, int v);
 	void setCallbackFrequency(int timerFrequency);
 
+	/**
+	 * Enable or disable batch rendering. When disabled, samples are
+	 * rendered tick by tick with register writes applied immediately,
+	 * which is how all emulators worked before.
+	 */
+	void setBatchRendering(bool enable) { _batchRendering = enable; }
+
 	// AudioStream API
 	int readBuffer(int16 *buffer, const int numSamples);
 	int getRate() const;
@@ -267,6 +285,14 @@ protected:
 	 */
 	virtual void generateSamples(int16 *buffer, int numSamples) = 0;
 
+	/**
+	 * Implementations of write(), read() and writeReg() which act on the
+	 * emulated chip right away.
+	 */
+	virtual void writeImmediate(int a, int v) = 0;
+	virtual byte readImmediate(int a) = 0;
+	virtual void writeRegImmediate(int r, int v) = 0;
+
 private:
 	int _baseFreq;
 
@@ -278,6 +304,41 @@ private:
 	int _samplesPerTick;
 
 	Audio::SoundHandle *_handle;
+
+	/** A register write made by a callback during batch rendering. */
+	struct PendingWrite {
+		int frame;
+		bool isReg;
+		int address;
+		int value;
+	};
+
+	bool _batchRendering;
+
+	/**
+	 * Register writes may come from other threads than the mixer's while
+	 * a batch is being rendered. They are queued as well, and the queue,
+	 * _inBatch and _batchPos are protected by this mutex. The batch itself
+	 * is only rendered while holding it, up to the end of the callbacks.
+	 */
+	OSystem::MutexRef _queueMutex;
+	bool _inBatch;
+	Common::Array<PendingWrite> _pendingWrites;
+
+	/** The buffer being filled by readBuffer(). */
+	int16 *_batchBuffer;
+	/** Frames rendered into _batchBuffer so far. */
+	int _batchRendered;
+	/** Frame position of the callback currently running. */
+	int _batchPos;
+
+	void lockQueue();
+	void unlockQueue();
+	/** Queue a write if a batch is being rendered, the queue must be locked. */
+	bool queueWrite(bool isReg, int address, int value);
+	void renderBatch(int frame);
+	/** Render up to each queued write and apply it, the queue must be locked. */
+	void applyPendingWrites();
 };
 
 } // End of namespace OPL
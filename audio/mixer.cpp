@@ -22,6 +22,8 @@
 
 #include "gui/EventRecorder.h"
 
+#include "common/atomic.h"
+#include "common/framestats.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 
@@ -43,7 +45,7 @@ namespace Audio {
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, RateConverterQuality quality);
 	~Channel();
 
 	/**
@@ -147,22 +149,35 @@ private:
 	const Mixer::SoundType _type;
 	SoundHandle _handle;
 	bool _permanent;
-	int _pauseLevel;
+	volatile int _pauseLevel;
 	int _id;
 
 	byte _volume;
 	int8 _balance;
 
 	void updateChannelVolumes();
-	st_volume_t _volL, _volR;
+
+	/**
+	 * The effective left (high half) and right (low half) volume. Set by
+	 * the control side and read by mix(), so both travel in one word.
+	 */
+	volatile uint32 _mixVolume;
 
 	Mixer *_mixer;
 
-	uint32 _samplesConsumed;
+	/**
+	 * _samplesConsumed and _mixerTimeStamp are written by mix() on the
+	 * audio thread. _timeSeq is odd while they are being updated, which
+	 * lets getElapsedTime() retry instead of reading a torn pair.
+	 */
+	volatile uint32 _timeSeq;
+	volatile uint32 _samplesConsumed;
 	uint32 _samplesDecoded;
-	uint32 _mixerTimeStamp;
+	volatile uint32 _mixerTimeStamp;
 	uint32 _pauseStartTime;
 	uint32 _pauseTime;
+	/** Value of _mixerTimeStamp when _pauseTime was measured. */
+	uint32 _pauseTimeBase;
 
 	RateConverter *_converter;
 	Common::DisposablePtr<AudioStream> _stream;
@@ -173,15 +188,20 @@ private:
 #pragma mark -
 
 MixerImpl::MixerImpl(uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _rateConverterQuality(kRateConverterLinear), _soundTypeSettings(),
+	  _callbackCount(0), _controlDraining(false) {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	for (int i = 0; i != NUM_CHANNELS; i++) {
 		_channels[i] = 0;
+		_mixChannels[i] = 0;
+	}
 }
 
 MixerImpl::~MixerImpl() {
+	// The control side owns every channel, including those the audio
+	// thread has reported as finished but which were not deleted yet.
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
 }
@@ -192,10 +212,91 @@ void MixerImpl::setReady(bool ready) {
 	_mixerReady = ready;
 }
 
+void MixerImpl::setRateConverterQuality(RateConverterQuality quality) {
+	Common::StackLock lock(_mutex);
+
+	_rateConverterQuality = quality;
+}
+
 uint MixerImpl::getOutputRate() const {
 	return _sampleRate;
 }
 
+void MixerImpl::queueChannelCommand(int index, Channel *chan) {
+	ChannelCommand cmd;
+	cmd.index = index;
+	cmd.channel = chan;
+
+	while (!_commands.push(cmd)) {
+		// The queue is full. The backend may have stopped calling
+		// mixCallback(), e.g. while audio is suspended or before it is
+		// ready, so apply the queued commands here unless a callback is
+		// mixing right now. Announcing that first and then checking for a
+		// callback, while the callback does the opposite, ensures that at
+		// most one of both goes on (see mixCallback()).
+		Common::atomicStore(_controlDraining, true);
+		Common::memoryBarrier();
+		if (!(Common::atomicLoad(_callbackCount) & 1)) {
+			ChannelCommand pending;
+			while (_commands.pop(pending))
+				_mixChannels[pending.index] = pending.channel;
+		}
+		Common::atomicStore(_controlDraining, false);
+
+		if (_commands.push(cmd))
+			break;
+		g_system->delayMillis(1);
+	}
+}
+
+void MixerImpl::waitForMixCallback() {
+	// Make sure that our latest commands are visible to a callback which
+	// starts from now on, and see whether one is running right now.
+	Common::memoryBarrier();
+	const uint32 count = Common::atomicLoad(_callbackCount);
+
+	// A running callback may still use the old channel list; the next one
+	// will pick up the new list before it mixes anything.
+	if (count & 1) {
+		while (Common::atomicLoad(_callbackCount) == count)
+			g_system->delayMillis(0);
+	}
+}
+
+void MixerImpl::processFinishedChannels() {
+	FinishedChannel finished;
+	while (_finished.pop(finished)) {
+		// The channel may have been stopped, and its slot reused, since
+		// the audio thread reported it.
+		Channel *chan = _channels[finished.index];
+		if (chan && chan->getHandle()._val == finished.handle) {
+			delete chan;
+			_channels[finished.index] = 0;
+		}
+	}
+}
+
+void MixerImpl::removeChannel(int index) {
+	Channel *chan = _channels[index];
+	removeChannels(&chan, 1);
+}
+
+void MixerImpl::removeChannels(Channel **chans, int count) {
+	if (!count)
+		return;
+
+	for (int i = 0; i != count; i++) {
+		const int index = chans[i]->getHandle()._val % NUM_CHANNELS;
+		_channels[index] = 0;
+		queueChannelCommand(index, 0);
+	}
+
+	waitForMixCallback();
+
+	for (int i = 0; i != count; i++)
+		delete chans[i];
+}
+
 void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	int index = -1;
 	for (int i = 0; i != NUM_CHANNELS; i++) {
@@ -219,6 +320,8 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
+
+	queueChannelCommand(index, chan);
 }
 
 void MixerImpl::playStream(
@@ -239,6 +342,8 @@ void MixerImpl::playStream(
 
 	assert(_mixerReady);
 
+	processFinishedChannels();
+
 	// Prevent duplicate sounds
 	if (id != -1) {
 		for (int i = 0; i != NUM_CHANNELS; i++)
@@ -260,21 +365,38 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, _rateConverterQuality);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
 	insertChannel(handle, chan);
 }
 
 int MixerImpl::mixCallback(byte *samples, uint len) {
+	FRAME_STATS_SCOPE(kFrameStageAudio);
 	assert(samples);
 
-	Common::StackLock lock(_mutex);
+	// Announce that we are mixing, then pick up the channel changes made
+	// since the last callback. See waitForMixCallback().
+	Common::atomicStore(_callbackCount, _callbackCount + 1);
+	Common::memoryBarrier();
+
+	// The control side is applying the queued commands itself, see
+	// queueChannelCommand(). This is rare, so just play silence this time.
+	if (Common::atomicLoad(_controlDraining)) {
+		memset(samples, 0, len);
+		Common::atomicStore(_callbackCount, _callbackCount + 1);
+		return 0;
+	}
+
+	ChannelCommand cmd;
+	while (_commands.pop(cmd))
+		_mixChannels[cmd.index] = cmd.channel;
 
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
 	assert(len % 4 == 0);
 	len >>= 2;
+	FRAME_STATS_PIXELS(kFrameStageAudio, len);
 
 	// Since the mixer callback has been called, the mixer must be ready...
 	_mixerReady = true;
@@ -285,51 +407,64 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	// mix all channels
 	int res = 0, tmp;
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i]) {
-			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
-			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
+		if (_mixChannels[i]) {
+			if (_mixChannels[i]->isFinished()) {
+				// Let the control side delete the channel. Should the
+				// queue ever be full, we simply try again next time.
+				FinishedChannel finished;
+				finished.index = i;
+				finished.handle = _mixChannels[i]->getHandle()._val;
+				if (_finished.push(finished))
+					_mixChannels[i] = 0;
+			} else if (!_mixChannels[i]->isPaused()) {
+				tmp = _mixChannels[i]->mix(buf, len);
 
 				if (tmp > res)
 					res = tmp;
 			}
 		}
 
+	Common::atomicStore(_callbackCount, _callbackCount + 1);
+
 	return res;
 }
 
 void MixerImpl::stopAll() {
 	Common::StackLock lock(_mutex);
+	processFinishedChannels();
+
+	Channel *chans[NUM_CHANNELS];
+	int count = 0;
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+		if (_channels[i] != 0 && !_channels[i]->isPermanent())
+			chans[count++] = _channels[i];
 	}
+	removeChannels(chans, count);
 }
 
 void MixerImpl::stopID(int id) {
 	Common::StackLock lock(_mutex);
+	processFinishedChannels();
+
+	Channel *chans[NUM_CHANNELS];
+	int count = 0;
 	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
-		}
+		if (_channels[i] != 0 && _channels[i]->getId() == id)
+			chans[count++] = _channels[i];
 	}
+	removeChannels(chans, count);
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	processFinishedChannels();
 
 	// Simply ignore stop requests for handles of sounds that already terminated
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return;
 
-	delete _channels[index];
-	_channels[index] = 0;
+	removeChannel(index);
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
@@ -349,6 +484,7 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
 	Common::StackLock lock(_mutex);
+	processFinishedChannels();
 
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
@@ -367,6 +503,7 @@ byte MixerImpl::getChannelVolume(SoundHandle handle) {
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
 	Common::StackLock lock(_mutex);
+	processFinishedChannels();
 
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
@@ -389,6 +526,7 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	processFinishedChannels();
 
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
@@ -399,6 +537,7 @@ Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 
 void MixerImpl::pauseAll(bool paused) {
 	Common::StackLock lock(_mutex);
+	processFinishedChannels();
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0) {
 			_channels[i]->pause(paused);
@@ -408,6 +547,7 @@ void MixerImpl::pauseAll(bool paused) {
 
 void MixerImpl::pauseID(int id, bool paused) {
 	Common::StackLock lock(_mutex);
+	processFinishedChannels();
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != 0 && _channels[i]->getId() == id) {
 			_channels[i]->pause(paused);
@@ -418,6 +558,7 @@ void MixerImpl::pauseID(int id, bool paused) {
 
 void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 	Common::StackLock lock(_mutex);
+	processFinishedChannels();
 
 	// Simply ignore (un)pause requests for sounds that already terminated
 	const int index = handle._val % NUM_CHANNELS;
@@ -429,6 +570,7 @@ void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 
 bool MixerImpl::isSoundIDActive(int id) {
 	Common::StackLock lock(_mutex);
+	processFinishedChannels();
 
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
@@ -442,6 +584,7 @@ bool MixerImpl::isSoundIDActive(int id) {
 
 int MixerImpl::getSoundID(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	processFinishedChannels();
 	const int index = handle._val % NUM_CHANNELS;
 	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
 		return _channels[index]->getId();
@@ -450,6 +593,7 @@ int MixerImpl::getSoundID(SoundHandle handle) {
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	processFinishedChannels();
 
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
@@ -461,6 +605,7 @@ bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
 	Common::StackLock lock(_mutex);
+	processFinishedChannels();
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i] && _channels[i]->getType() == type)
 			return true;
@@ -497,16 +642,17 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
+                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent,
+                 RateConverterQuality quality)
     : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
-      _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
-      _pauseStartTime(0), _pauseTime(0), _converter(0), _volL(0), _volR(0),
+      _balance(0), _pauseLevel(0), _timeSeq(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
+      _pauseStartTime(0), _pauseTime(0), _pauseTimeBase(0), _converter(0), _mixVolume(0),
       _stream(stream, autofreeStream) {
 	assert(mixer);
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo, quality);
 }
 
 Channel::~Channel() {
@@ -540,22 +686,26 @@ void Channel::updateChannelVolumes() {
 	// volume is in the range 0 - kMaxMixerVolume.
 	// Hence, the vol_l/vol_r values will be in that range, too
 
+	st_volume_t volL, volR;
+
 	if (!_mixer->isSoundTypeMuted(_type)) {
 		int vol = _mixer->getVolumeForSoundType(_type) * _volume;
 
 		if (_balance == 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = vol / Mixer::kMaxChannelVolume;
+			volL = vol / Mixer::kMaxChannelVolume;
+			volR = vol / Mixer::kMaxChannelVolume;
 		} else if (_balance < 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
+			volL = vol / Mixer::kMaxChannelVolume;
+			volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
 		} else {
-			_volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
-			_volR = vol / Mixer::kMaxChannelVolume;
+			volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
+			volR = vol / Mixer::kMaxChannelVolume;
 		}
 	} else {
-		_volL = _volR = 0;
+		volL = volR = 0;
 	}
+
+	_mixVolume = ((uint32)volL << 16) | volR;
 }
 
 void Channel::pause(bool paused) {
@@ -571,6 +721,7 @@ void Channel::pause(bool paused) {
 
 		if (!_pauseLevel) {
 			_pauseTime = (g_system->getMillis(true) - _pauseStartTime);
+			_pauseTimeBase = _mixerTimeStamp;
 			_pauseStartTime = 0;
 		}
 	}
@@ -582,17 +733,27 @@ Timestamp Channel::getElapsedTime() {
 
 	Audio::Timestamp ts(0, rate);
 
-	if (_mixerTimeStamp == 0)
+	uint32 seq, samplesConsumed, mixerTimeStamp;
+	do {
+		seq = Common::atomicLoad(_timeSeq);
+		samplesConsumed = _samplesConsumed;
+		mixerTimeStamp = _mixerTimeStamp;
+	} while ((seq & 1) || Common::atomicLoad(_timeSeq) != seq);
+
+	if (mixerTimeStamp == 0)
 		return ts;
 
+	// The last pause only counts if no buffer was mixed since it ended.
+	const uint32 pauseTime = (_pauseTimeBase == mixerTimeStamp) ? _pauseTime : 0;
+
 	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
+		delta = _pauseStartTime - mixerTimeStamp;
 	else
-		delta = g_system->getMillis(true) - _mixerTimeStamp - _pauseTime;
+		delta = g_system->getMillis(true) - mixerTimeStamp - pauseTime;
 
 	// Convert the number of samples into a time duration.
 
-	ts = ts.addFrames(_samplesConsumed);
+	ts = ts.addFrames(samplesConsumed);
 	ts = ts.addMsecs(delta);
 
 	// In theory it would seem like a good idea to limit the approximation
@@ -612,10 +773,13 @@ int Channel::mix(int16 *data, uint len) {
 		// TODO: call drain method
 	} else {
 		assert(_converter);
+		Common::atomicStore(_timeSeq, _timeSeq + 1);
 		_samplesConsumed = _samplesDecoded;
 		_mixerTimeStamp = g_system->getMillis(true);
-		_pauseTime = 0;
-		res = _converter->flow(*_stream, data, len, _volL, _volR);
+		Common::atomicStore(_timeSeq, _timeSeq + 1);
+
+		const uint32 volume = _mixVolume;
+		res = _converter->flow(*_stream, data, len, volume >> 16, volume & 0xFFFF);
 		_samplesDecoded += res;
 	}
 
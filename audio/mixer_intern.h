@@ -25,7 +25,9 @@
 
 #include "common/scummsys.h"
 #include "common/mutex.h"
+#include "common/spsc-queue.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
 
 namespace Audio {
 
@@ -46,19 +48,43 @@ namespace Audio {
  * (partial) alternative implementations of the mixer, e.g. to make
  * better use of native sound mixing support on low-end devices.
  *
+ * The public methods may be called from any thread; they are serialized
+ * by a mutex. mixCallback() never takes that mutex. Instead, channels are
+ * handed to the audio thread through a lock-free command queue which it
+ * drains at the start of every buffer, and channels which finished playing
+ * are handed back through a second queue.
+ *
  * @see OSystem::getMixer()
  */
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 16
+		NUM_CHANNELS = 16,
+		NUM_COMMANDS = 256
+	};
+
+	/**
+	 * Tells the audio thread which channel now occupies a slot. A null
+	 * channel empties the slot.
+	 */
+	struct ChannelCommand {
+		int index;
+		Channel *channel;
+	};
+
+	/** Reports a channel whose stream ended back to the control side. */
+	struct FinishedChannel {
+		int index;
+		uint32 handle;
 	};
 
+	/** Serializes the control side; never locked by mixCallback(). */
 	Common::Mutex _mutex;
 
 	const uint _sampleRate;
-	bool _mixerReady;
+	volatile bool _mixerReady;
 	uint32 _handleSeed;
+	RateConverterQuality _rateConverterQuality;
 
 	struct SoundTypeSettings {
 		SoundTypeSettings() : mute(false), volume(kMaxMixerVolume) {}
@@ -68,8 +94,24 @@ private:
 	};
 
 	SoundTypeSettings _soundTypeSettings[4];
+
+	/** The channels as seen by the control side, which owns them. */
 	Channel *_channels[NUM_CHANNELS];
 
+	/** The channels as seen by mixCallback(). */
+	Channel *_mixChannels[NUM_CHANNELS];
+
+	Common::SPSCQueue<ChannelCommand, NUM_COMMANDS> _commands;
+	Common::SPSCQueue<FinishedChannel, 2 * NUM_CHANNELS> _finished;
+
+	/** Incremented when mixCallback() starts and ends, so odd while mixing. */
+	volatile uint32 _callbackCount;
+
+	/**
+	 * Set while the control side empties a full command queue itself,
+	 * which keeps mixCallback() from using the queue and the mix channels.
+	 */
+	volatile bool _controlDraining;
 
 public:
 
@@ -121,6 +163,24 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+	/**
+	 * Remove a channel from the given slot and delete it once the audio
+	 * thread can no longer be using it.
+	 */
+	void removeChannel(int index);
+
+	/** Remove several channels, waiting for the audio thread only once. */
+	void removeChannels(Channel **chans, int count);
+
+	/** Hand a slot change to the audio thread. */
+	void queueChannelCommand(int index, Channel *chan);
+
+	/** Wait until mixCallback() no longer runs on an outdated channel list. */
+	void waitForMixCallback();
+
+	/** Delete the channels mixCallback() reported as finished. */
+	void processFinishedChannels();
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
@@ -139,6 +199,13 @@ public:
 	 * their audio system has been completed.
 	 */
 	void setReady(bool ready);
+
+	/**
+	 * Select the rate conversion algorithm used for channels whose sample
+	 * rate differs from the output rate. Only affects channels started
+	 * after the call.
+	 */
+	void setRateConverterQuality(RateConverterQuality quality);
 };
 
 
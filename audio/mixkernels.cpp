@@ -0,0 +1,261 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/mixkernels.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIO_MIXKERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AUDIO_MIXKERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace Audio {
+
+#pragma mark --- Scalar kernels ---
+
+static void mixMonoScalar(int16 *dst, const int16 *src, uint len, uint16 volL, uint16 volR) {
+	for (; len > 0; --len) {
+		const int sample = *src++;
+		clampedAdd(dst[0], (sample * (int)volL) / Mixer::kMaxMixerVolume);
+		clampedAdd(dst[1], (sample * (int)volR) / Mixer::kMaxMixerVolume);
+		dst += 2;
+	}
+}
+
+static void mixStereoScalar(int16 *dst, const int16 *src, uint len, uint16 volL, uint16 volR) {
+	for (; len > 0; --len) {
+		clampedAdd(dst[0], (src[0] * (int)volL) / Mixer::kMaxMixerVolume);
+		clampedAdd(dst[1], (src[1] * (int)volR) / Mixer::kMaxMixerVolume);
+		src += 2;
+		dst += 2;
+	}
+}
+
+static int32 convolveScalar(const int16 *samples, const int16 *coeffs, uint len) {
+	int32 sum = 0;
+	for (; len > 0; --len)
+		sum += *samples++ * *coeffs++;
+	return sum;
+}
+
+static const MixKernels s_scalarKernels = { &mixMonoScalar, &mixStereoScalar, &convolveScalar, "scalar" };
+
+#ifdef AUDIO_MIXKERNELS_SSE2
+#pragma mark --- SSE2 kernels ---
+
+/**
+ * Scale eight samples by the matching volumes and add them, saturating,
+ * to eight output samples. The division by kMaxMixerVolume rounds toward
+ * zero like the C division in the scalar path: negative products get a
+ * bias of kMaxMixerVolume - 1 before the arithmetic shift.
+ */
+static inline __m128i mixBlockSSE2(__m128i out, __m128i in, __m128i vol) {
+	const __m128i lo = _mm_mullo_epi16(in, vol);
+	const __m128i hi = _mm_mulhi_epi16(in, vol);
+	__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+	__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+
+	const __m128i bias = _mm_set1_epi32(Mixer::kMaxMixerVolume - 1);
+	p0 = _mm_srai_epi32(_mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), bias)), 8);
+	p1 = _mm_srai_epi32(_mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), bias)), 8);
+
+#ifdef OUTPUT_UNSIGNED_AUDIO
+	const __m128i sign = _mm_set1_epi16((short)0x8000);
+	return _mm_xor_si128(_mm_adds_epi16(_mm_xor_si128(out, sign), _mm_packs_epi32(p0, p1)), sign);
+#else
+	return _mm_adds_epi16(out, _mm_packs_epi32(p0, p1));
+#endif
+}
+
+static void mixMonoSSE2(int16 *dst, const int16 *src, uint len, uint16 volL, uint16 volR) {
+	const __m128i vol = _mm_set_epi16(volR, volL, volR, volL, volR, volL, volR, volL);
+
+	for (; len >= 8; len -= 8) {
+		const __m128i in = _mm_loadu_si128((const __m128i *)src);
+		__m128i *out = (__m128i *)dst;
+
+		_mm_storeu_si128(out, mixBlockSSE2(_mm_loadu_si128(out), _mm_unpacklo_epi16(in, in), vol));
+		_mm_storeu_si128(out + 1, mixBlockSSE2(_mm_loadu_si128(out + 1), _mm_unpackhi_epi16(in, in), vol));
+
+		src += 8;
+		dst += 16;
+	}
+
+	mixMonoScalar(dst, src, len, volL, volR);
+}
+
+static void mixStereoSSE2(int16 *dst, const int16 *src, uint len, uint16 volL, uint16 volR) {
+	const __m128i vol = _mm_set_epi16(volR, volL, volR, volL, volR, volL, volR, volL);
+
+	for (; len >= 4; len -= 4) {
+		__m128i *out = (__m128i *)dst;
+		_mm_storeu_si128(out, mixBlockSSE2(_mm_loadu_si128(out), _mm_loadu_si128((const __m128i *)src), vol));
+
+		src += 8;
+		dst += 8;
+	}
+
+	mixStereoScalar(dst, src, len, volL, volR);
+}
+
+static int32 convolveSSE2(const int16 *samples, const int16 *coeffs, uint len) {
+	__m128i acc = _mm_setzero_si128();
+
+	for (; len >= 8; len -= 8) {
+		acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)samples), _mm_loadu_si128((const __m128i *)coeffs)));
+		samples += 8;
+		coeffs += 8;
+	}
+
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+
+	return _mm_cvtsi128_si32(acc) + convolveScalar(samples, coeffs, len);
+}
+
+static const MixKernels s_sse2Kernels = { &mixMonoSSE2, &mixStereoSSE2, &convolveSSE2, "SSE2" };
+
+static bool hasSSE2() {
+#if defined(__GNUC__) && defined(__i386__)
+	// 32-bit builds may be told to target SSE2 while running on a
+	// CPU without it; everything 64-bit has it.
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2");
+#else
+	return true;
+#endif
+}
+#endif // AUDIO_MIXKERNELS_SSE2
+
+#ifdef AUDIO_MIXKERNELS_NEON
+#pragma mark --- NEON kernels ---
+
+/** NEON counterpart of mixBlockSSE2. */
+static inline int16x8_t mixBlockNEON(int16x8_t out, int16x8_t in, int16x8_t vol) {
+	int32x4_t p0 = vmull_s16(vget_low_s16(in), vget_low_s16(vol));
+	int32x4_t p1 = vmull_s16(vget_high_s16(in), vget_high_s16(vol));
+
+	const int32x4_t bias = vdupq_n_s32(Mixer::kMaxMixerVolume - 1);
+	p0 = vshrq_n_s32(vaddq_s32(p0, vandq_s32(vshrq_n_s32(p0, 31), bias)), 8);
+	p1 = vshrq_n_s32(vaddq_s32(p1, vandq_s32(vshrq_n_s32(p1, 31), bias)), 8);
+
+	const int16x8_t scaled = vcombine_s16(vmovn_s32(p0), vmovn_s32(p1));
+#ifdef OUTPUT_UNSIGNED_AUDIO
+	const int16x8_t sign = vdupq_n_s16((int16)0x8000);
+	return veorq_s16(vqaddq_s16(veorq_s16(out, sign), scaled), sign);
+#else
+	return vqaddq_s16(out, scaled);
+#endif
+}
+
+static void mixMonoNEON(int16 *dst, const int16 *src, uint len, uint16 volL, uint16 volR) {
+	const int16 volPair[8] = { (int16)volL, (int16)volR, (int16)volL, (int16)volR, (int16)volL, (int16)volR, (int16)volL, (int16)volR };
+	const int16x8_t vol = vld1q_s16(volPair);
+
+	for (; len >= 4; len -= 4) {
+		const int16x4_t in = vld1_s16(src);
+		const int16x4x2_t dup = vzip_s16(in, in);
+
+		vst1q_s16(dst, mixBlockNEON(vld1q_s16(dst), vcombine_s16(dup.val[0], dup.val[1]), vol));
+
+		src += 4;
+		dst += 8;
+	}
+
+	mixMonoScalar(dst, src, len, volL, volR);
+}
+
+static void mixStereoNEON(int16 *dst, const int16 *src, uint len, uint16 volL, uint16 volR) {
+	const int16 volPair[8] = { (int16)volL, (int16)volR, (int16)volL, (int16)volR, (int16)volL, (int16)volR, (int16)volL, (int16)volR };
+	const int16x8_t vol = vld1q_s16(volPair);
+
+	for (; len >= 4; len -= 4) {
+		vst1q_s16(dst, mixBlockNEON(vld1q_s16(dst), vld1q_s16(src), vol));
+
+		src += 8;
+		dst += 8;
+	}
+
+	mixStereoScalar(dst, src, len, volL, volR);
+}
+
+static int32 convolveNEON(const int16 *samples, const int16 *coeffs, uint len) {
+	int32x4_t acc = vdupq_n_s32(0);
+
+	for (; len >= 4; len -= 4) {
+		acc = vmlal_s16(acc, vld1_s16(samples), vld1_s16(coeffs));
+		samples += 4;
+		coeffs += 4;
+	}
+
+	const int32 sum = vgetq_lane_s32(acc, 0) + vgetq_lane_s32(acc, 1) + vgetq_lane_s32(acc, 2) + vgetq_lane_s32(acc, 3);
+	return sum + convolveScalar(samples, coeffs, len);
+}
+
+static const MixKernels s_neonKernels = { &mixMonoNEON, &mixStereoNEON, &convolveNEON, "NEON" };
+#endif // AUDIO_MIXKERNELS_NEON
+
+#pragma mark -
+
+const MixKernels *getMixKernels(MixKernelType type) {
+	switch (type) {
+	case kMixKernelScalar:
+		return &s_scalarKernels;
+#ifdef AUDIO_MIXKERNELS_SSE2
+	case kMixKernelSSE2:
+		return hasSSE2() ? &s_sse2Kernels : 0;
+#endif
+#ifdef AUDIO_MIXKERNELS_NEON
+	case kMixKernelNEON:
+		return &s_neonKernels;
+#endif
+	default:
+		return 0;
+	}
+}
+
+const MixKernels &getDefaultMixKernels() {
+	static const MixKernels *s_default = 0;
+
+	// Racing here is harmless: every caller computes the same answer.
+	if (!s_default) {
+		const MixKernels *kernels = &s_scalarKernels;
+		for (int i = kMixKernelCount - 1; i > kMixKernelScalar; --i) {
+			const MixKernels *candidate = getMixKernels((MixKernelType)i);
+			if (candidate) {
+				kernels = candidate;
+				break;
+			}
+		}
+		s_default = kernels;
+	}
+
+	return *s_default;
+}
+
+} // End of namespace Audio
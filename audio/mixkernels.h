@@ -0,0 +1,101 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_MIXKERNELS_H
+#define AUDIO_MIXKERNELS_H
+
+#include "common/scummsys.h"
+
+namespace Audio {
+
+/**
+ * The inner loops of the mixer: scale a block of samples by a per-channel
+ * volume (0 - Mixer::kMaxMixerVolume) and add the result, with saturation,
+ * to an interleaved stereo output buffer.
+ *
+ * Every implementation must produce output which is bit-identical to the
+ * scalar one, i.e. to clampedAdd(dst, (src * vol) / Mixer::kMaxMixerVolume).
+ */
+struct MixKernels {
+	/**
+	 * Mix a mono source into a stereo output buffer.
+	 *
+	 * @param dst    interleaved stereo output, 2 * len samples
+	 * @param src    mono input, len samples
+	 * @param len    number of sample pairs to produce
+	 * @param volL   volume applied to the samples stored at dst[2 * n]
+	 * @param volR   volume applied to the samples stored at dst[2 * n + 1]
+	 */
+	void (*mixMono)(int16 *dst, const int16 *src, uint len, uint16 volL, uint16 volR);
+
+	/**
+	 * Mix an interleaved stereo source into a stereo output buffer.
+	 * The source must already be in output channel order.
+	 *
+	 * @param dst    interleaved stereo output, 2 * len samples
+	 * @param src    interleaved stereo input, 2 * len samples
+	 * @param len    number of sample pairs to produce
+	 * @param volL   volume applied to src[2 * n]
+	 * @param volR   volume applied to src[2 * n + 1]
+	 */
+	void (*mixStereo)(int16 *dst, const int16 *src, uint len, uint16 volL, uint16 volR);
+
+	/**
+	 * Compute the dot product of a block of samples with a set of filter
+	 * coefficients, as used by FIR based rate converters. The caller must
+	 * ensure that the sum cannot overflow 32 bits.
+	 *
+	 * @param samples  input samples, len values
+	 * @param coeffs   filter coefficients, len values
+	 * @param len      number of values, preferably a multiple of 8
+	 * @return the sum of samples[n] * coeffs[n]
+	 */
+	int32 (*convolve)(const int16 *samples, const int16 *coeffs, uint len);
+
+	/** Human readable name of the implementation, for debug output. */
+	const char *name;
+};
+
+enum MixKernelType {
+	kMixKernelScalar = 0,
+	kMixKernelSSE2,
+	kMixKernelNEON,
+
+	kMixKernelCount
+};
+
+/**
+ * Return the kernels of the given type, or 0 if that implementation was
+ * either not compiled in or is not supported by the CPU we are running on.
+ * The scalar kernels are always available.
+ */
+const MixKernels *getMixKernels(MixKernelType type);
+
+/**
+ * Return the fastest kernels usable on this machine. The choice is made
+ * once, on the first call.
+ */
+const MixKernels &getDefaultMixKernels();
+
+} // End of namespace Audio
+
+#endif
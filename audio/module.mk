@@ -13,6 +13,7 @@ MODULE_OBJS := \
 	miles_adlib.o \
 	miles_midi.o \
 	mixer.o \
+	mixkernels.o \
 	mpu401.o \
 	musicplugin.o \
 	null.o \
@@ -43,6 +44,7 @@ MODULE_OBJS := \
 	mods/soundfx.o \
 	mods/tfmx.o \
 	softsynth/cms.o \
+	softsynth/emumidi.o \
 	softsynth/opl/dbopl.o \
 	softsynth/opl/dosbox.o \
 	softsynth/opl/mame.o \
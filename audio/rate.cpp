@@ -31,10 +31,13 @@
 #include "audio/audiostream.h"
 #include "audio/rate.h"
 #include "audio/mixer.h"
+#include "audio/mixkernels.h"
 #include "common/frac.h"
 #include "common/textconsole.h"
 #include "common/util.h"
 
+#include <math.h>
+
 namespace Audio {
 
 
@@ -67,6 +70,8 @@ template<bool stereo, bool reverseStereo>
 class SimpleRateConverter : public RateConverter {
 protected:
 	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
+	/** resampled stereo output, waiting to be mixed */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
 	const st_sample_t *inPtr;
 	int inLen;
 
@@ -119,37 +124,53 @@ int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 	oend = obuf + osamp * 2;
 
 	while (obuf < oend) {
+		// Resample a block into outBuf, then let the mix kernels do the
+		// volume scaling and the clamping for the whole block at once.
+		st_sample_t *tmp = outBuf;
+		st_sample_t *tmpEnd = outBuf + MIN<long>(oend - obuf, ARRAYSIZE(outBuf));
+		bool eos = false;
+
+		while (tmp < tmpEnd) {
+
+			// read enough input samples so that opos >= 0
+			do {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						eos = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				opos--;
+				if (opos >= 0) {
+					inPtr += (stereo ? 2 : 1);
+				}
+			} while (opos >= 0);
+
+			if (eos)
+				break;
 
-		// read enough input samples so that opos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			opos--;
-			if (opos >= 0) {
-				inPtr += (stereo ? 2 : 1);
-			}
-		} while (opos >= 0);
-
-		st_sample_t out0, out1;
-		out0 = *inPtr++;
-		out1 = (stereo ? *inPtr++ : out0);
+			st_sample_t out0, out1;
+			out0 = *inPtr++;
+			out1 = (stereo ? *inPtr++ : out0);
 
-		// Increment output position
-		opos += opos_inc;
+			// Increment output position
+			opos += opos_inc;
 
-		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+			tmp[reverseStereo    ] = out0;
+			tmp[reverseStereo ^ 1] = out1;
+			tmp += 2;
+		}
 
-		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		const uint frames = (tmp - outBuf) / 2;
+		_kernels.mixStereo(obuf, outBuf, frames, reverseStereo ? vol_r : vol_l, reverseStereo ? vol_l : vol_r);
+		obuf += frames * 2;
 
-		obuf += 2;
+		if (eos)
+			break;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -169,6 +190,8 @@ template<bool stereo, bool reverseStereo>
 class LinearRateConverter : public RateConverter {
 protected:
 	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
+	/** interpolated stereo output, waiting to be mixed */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
 	const st_sample_t *inPtr;
 	int inLen;
 
@@ -228,47 +251,267 @@ int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 	oend = obuf + osamp * 2;
 
 	while (obuf < oend) {
-
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE_LOW <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
+		// Interpolate a block into outBuf, then let the mix kernels do the
+		// volume scaling and the clamping for the whole block at once.
+		st_sample_t *tmp = outBuf;
+		st_sample_t *tmpEnd = outBuf + MIN<long>(oend - obuf, ARRAYSIZE(outBuf));
+		bool eos = false;
+
+		while (tmp < tmpEnd) {
+
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE_LOW <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						eos = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				ilast0 = icur0;
+				icur0 = *inPtr++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *inPtr++;
+				}
+				opos -= FRAC_ONE_LOW;
 			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
+
+			if (eos)
+				break;
+
+			// Loop as long as the outpos trails behind, and as long as there is
+			// still space in the output buffer.
+			while (opos < (frac_t)FRAC_ONE_LOW && tmp < tmpEnd) {
+				// interpolate
+				st_sample_t out0, out1;
+				out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+				out1 = (stereo ?
+							  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
+							  out0);
+
+				tmp[reverseStereo    ] = out0;
+				tmp[reverseStereo ^ 1] = out1;
+				tmp += 2;
+
+				// Increment output position
+				opos += opos_inc;
 			}
-			opos -= FRAC_ONE_LOW;
 		}
 
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE_LOW && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						  out0);
+		const uint frames = (tmp - outBuf) / 2;
+		_kernels.mixStereo(obuf, outBuf, frames, reverseStereo ? vol_r : vol_l, reverseStereo ? vol_l : vol_r);
+		obuf += frames * 2;
+
+		if (eos)
+			break;
+	}
+	return (obuf - ostart) / 2;
+}
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+#pragma mark -
 
-			obuf += 2;
 
-			// Increment output position
-			opos += opos_inc;
+/**
+ * Parameters of the polyphase filter bank. Each of the POLYPHASE_PHASES
+ * phases holds POLYPHASE_TAPS coefficients in 1.14 fixed point format. With
+ * 14 fractional bits the sum of a convolution over 16 taps always fits into
+ * 32 bits.
+ */
+enum {
+	POLYPHASE_TAPS = 16,
+	POLYPHASE_PHASE_BITS = 8,
+	POLYPHASE_PHASES = (1 << POLYPHASE_PHASE_BITS),
+	POLYPHASE_COEF_BITS = 14,
+	POLYPHASE_CUTOFF_STEPS = 32
+};
+
+/**
+ * Return the coefficient table for converting from inrate to outrate. The
+ * tables only depend on the cutoff frequency, so they are computed once and
+ * shared by all converters; every upsampling converter uses the same one.
+ * Converters are only created with the mixer mutex held, so no extra
+ * locking is done here.
+ */
+static const int16 *getPolyphaseFilterBank(st_rate_t inrate, st_rate_t outrate) {
+	static int16 *s_filterBanks[POLYPHASE_CUTOFF_STEPS + 1];
+
+	// Upsampling keeps everything up to the input Nyquist frequency,
+	// downsampling has to cut at the output Nyquist frequency instead.
+	uint step = POLYPHASE_CUTOFF_STEPS;
+	if (outrate < inrate)
+		step = MAX<uint>(1, (outrate * POLYPHASE_CUTOFF_STEPS) / inrate);
+
+	if (s_filterBanks[step])
+		return s_filterBanks[step];
+
+	int16 *bank = new int16[POLYPHASE_PHASES * POLYPHASE_TAPS];
+
+	// Leave some room for the transition band below the cutoff.
+	const double cutoff = 0.9 * step / POLYPHASE_CUTOFF_STEPS;
+	const double halfTaps = POLYPHASE_TAPS / 2;
+
+	for (int phase = 0; phase < POLYPHASE_PHASES; ++phase) {
+		const double frac = (double)phase / POLYPHASE_PHASES;
+		double h[POLYPHASE_TAPS];
+		double sum = 0;
+
+		// Tap k is applied to the input sample which is (k - halfTaps + 1)
+		// samples away from the integer part of the output position.
+		for (int k = 0; k < POLYPHASE_TAPS; ++k) {
+			const double d = k - halfTaps + 1 - frac;
+			const double x = M_PI * cutoff * d;
+			const double sinc = (d == 0) ? 1.0 : sin(x) / x;
+			const double window = 0.42 + 0.5 * cos(M_PI * d / halfTaps) + 0.08 * cos(2 * M_PI * d / halfTaps);
+
+			h[k] = sinc * window;
+			sum += h[k];
+		}
+
+		// Normalize to unity gain, and put the rounding error into the
+		// center tap so that DC passes unchanged.
+		int16 *coeffs = bank + phase * POLYPHASE_TAPS;
+		int total = 0;
+		for (int k = 0; k < POLYPHASE_TAPS; ++k) {
+			coeffs[k] = (int16)floor(h[k] / sum * (1 << POLYPHASE_COEF_BITS) + 0.5);
+			total += coeffs[k];
 		}
+		coeffs[POLYPHASE_TAPS / 2 - (frac < 0.5 ? 1 : 0)] += (1 << POLYPHASE_COEF_BITS) - total;
+	}
+
+	s_filterBanks[step] = bank;
+	return bank;
+}
+
+/**
+ * Audio rate converter based on a windowed-sinc polyphase FIR filter.
+ *
+ * The fractional output position selects one of POLYPHASE_PHASES
+ * precomputed filters, which is then applied to the last POLYPHASE_TAPS
+ * input samples. Compared to the LinearRateConverter this removes most of
+ * the aliasing when upsampling low rate game audio, at the cost of a short
+ * convolution per output sample, which is done by the mix kernels.
+ *
+ * Limited to sampling frequency <= 131071 Hz.
+ */
+template<bool stereo, bool reverseStereo>
+class PolyphaseRateConverter : public RateConverter {
+protected:
+	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
+	/** filtered stereo output, waiting to be mixed */
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+	const st_sample_t *inPtr;
+	int inLen;
+
+	/** fractional position of the output stream in input stream unit */
+	frac_t opos;
+
+	/** fractional position increment in the output stream */
+	frac_t opos_inc;
+
+	/**
+	 * The last POLYPHASE_TAPS input samples (left/right channel). Every
+	 * sample is stored twice, so that the filter window starting at
+	 * histPos is always contiguous.
+	 */
+	st_sample_t hist0[2 * POLYPHASE_TAPS], hist1[2 * POLYPHASE_TAPS];
+	uint histPos;
+
+	const int16 *filterBank;
+
+public:
+	PolyphaseRateConverter(st_rate_t inrate, st_rate_t outrate);
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+};
+
+template<bool stereo, bool reverseStereo>
+PolyphaseRateConverter<stereo, reverseStereo>::PolyphaseRateConverter(st_rate_t inrate, st_rate_t outrate) {
+	if (inrate >= 131072 || outrate >= 131072) {
+		error("rate effect can only handle rates < 131072");
+	}
+
+	opos = FRAC_ONE_LOW;
+	opos_inc = (inrate << FRAC_BITS_LOW) / outrate;
+
+	memset(hist0, 0, sizeof(hist0));
+	memset(hist1, 0, sizeof(hist1));
+	histPos = 0;
+
+	filterBank = getPolyphaseFilterBank(inrate, outrate);
+
+	inLen = 0;
+}
+
+template<bool stereo, bool reverseStereo>
+int PolyphaseRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	st_sample_t *ostart, *oend;
+
+	ostart = obuf;
+	oend = obuf + osamp * 2;
+
+	while (obuf < oend) {
+		st_sample_t *tmp = outBuf;
+		st_sample_t *tmpEnd = outBuf + MIN<long>(oend - obuf, ARRAYSIZE(outBuf));
+		bool eos = false;
+
+		while (tmp < tmpEnd) {
+
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE_LOW <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						eos = true;
+						break;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				hist0[histPos] = hist0[histPos + POLYPHASE_TAPS] = *inPtr++;
+				if (stereo)
+					hist1[histPos] = hist1[histPos + POLYPHASE_TAPS] = *inPtr++;
+				histPos = (histPos + 1) % POLYPHASE_TAPS;
+				opos -= FRAC_ONE_LOW;
+			}
+
+			if (eos)
+				break;
+
+			// Loop as long as the outpos trails behind, and as long as there is
+			// still space in the output buffer.
+			while (opos < (frac_t)FRAC_ONE_LOW && tmp < tmpEnd) {
+				const int16 *coeffs = filterBank + (opos >> (FRAC_BITS_LOW - POLYPHASE_PHASE_BITS)) * POLYPHASE_TAPS;
+				const int32 round = 1 << (POLYPHASE_COEF_BITS - 1);
+
+				st_sample_t out0, out1;
+				out0 = CLIP<int32>((_kernels.convolve(hist0 + histPos, coeffs, POLYPHASE_TAPS) + round) >> POLYPHASE_COEF_BITS, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+				out1 = (stereo ?
+						CLIP<int32>((_kernels.convolve(hist1 + histPos, coeffs, POLYPHASE_TAPS) + round) >> POLYPHASE_COEF_BITS, ST_SAMPLE_MIN, ST_SAMPLE_MAX) :
+						out0);
+
+				tmp[reverseStereo    ] = out0;
+				tmp[reverseStereo ^ 1] = out1;
+				tmp += 2;
+
+				// Increment output position
+				opos += opos_inc;
+			}
+		}
+
+		const uint frames = (tmp - outBuf) / 2;
+		_kernels.mixStereo(obuf, outBuf, frames, reverseStereo ? vol_r : vol_l, reverseStereo ? vol_l : vol_r);
+		obuf += frames * 2;
+
+		if (eos)
+			break;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -315,20 +558,19 @@ public:
 		len = input.readBuffer(_buffer, osamp);
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
+		if (stereo) {
+			len /= 2;
+			if (reverseStereo) {
+				ptr = _buffer;
+				for (st_size_t i = 0; i < len; ++i, ptr += 2)
+					SWAP(ptr[0], ptr[1]);
+			}
+			_kernels.mixStereo(obuf, _buffer, len, reverseStereo ? vol_r : vol_l, reverseStereo ? vol_l : vol_r);
+		} else {
+			_kernels.mixMono(obuf, _buffer, len, vol_l, vol_r);
 		}
+		obuf += len * 2;
+
 		return (obuf - ostart) / 2;
 	}
 
@@ -341,9 +583,11 @@ public:
 #pragma mark -
 
 template<bool stereo, bool reverseStereo>
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, RateConverterQuality quality) {
 	if (inrate != outrate) {
-		if ((inrate % outrate) == 0 && (inrate < 65536)) {
+		if (quality == kRateConverterPolyphase) {
+			return new PolyphaseRateConverter<stereo, reverseStereo>(inrate, outrate);
+		} else if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			return new SimpleRateConverter<stereo, reverseStereo>(inrate, outrate);
 		} else {
 			return new LinearRateConverter<stereo, reverseStereo>(inrate, outrate);
@@ -356,14 +600,14 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateConverterQuality quality) {
 	if (stereo) {
 		if (reverseStereo)
-			return makeRateConverter<true, true>(inrate, outrate);
+			return makeRateConverter<true, true>(inrate, outrate, quality);
 		else
-			return makeRateConverter<true, false>(inrate, outrate);
+			return makeRateConverter<true, false>(inrate, outrate, quality);
 	} else
-		return makeRateConverter<false, false>(inrate, outrate);
+		return makeRateConverter<false, false>(inrate, outrate, quality);
 }
 
 } // End of namespace Audio
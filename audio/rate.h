@@ -24,6 +24,7 @@
 #define AUDIO_RATE_H
 
 #include "common/scummsys.h"
+#include "audio/mixkernels.h"
 
 namespace Audio {
 
@@ -66,8 +67,12 @@ static inline void clampedAdd(int16& a, int b) {
 }
 
 class RateConverter {
+protected:
+	/** Kernels used to scale and mix the converted samples into the output. */
+	const MixKernels &_kernels;
+
 public:
-	RateConverter() {}
+	RateConverter() : _kernels(getDefaultMixKernels()) {}
 	virtual ~RateConverter() {}
 
 	/**
@@ -78,7 +83,17 @@ public:
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
 };
 
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+/**
+ * The algorithm used by a RateConverter when input and output rates differ.
+ */
+enum RateConverterQuality {
+	/** Sample dropping or linear interpolation. Cheap, but aliases. */
+	kRateConverterLinear = 0,
+	/** Windowed-sinc polyphase FIR filter. Slower, but much cleaner. */
+	kRateConverterPolyphase
+};
+
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false, RateConverterQuality quality = kRateConverterLinear);
 
 } // End of namespace Audio
 
@@ -0,0 +1,267 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/softsynth/emumidi.h"
+
+#include "common/atomic.h"
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+int MidiDriver_Emulated::readBuffer(int16 *data, const int numSamples) {
+	if (_ring)
+		return readPreRendered(data, numSamples);
+
+	const int stereoFactor = isStereo() ? 2 : 1;
+	int len = numSamples / stereoFactor;
+	int step;
+
+	do {
+		step = len;
+		if (step > (_nextTick >> FIXP_SHIFT))
+			step = (_nextTick >> FIXP_SHIFT);
+
+		generateSamples(data, step);
+
+		_nextTick -= step << FIXP_SHIFT;
+		if (!(_nextTick >> FIXP_SHIFT)) {
+			if (_timerProc)
+				(*_timerProc)(_timerParam);
+
+			onTimer();
+
+			_nextTick += _samplesPerTick;
+		}
+
+		data += step * stereoFactor;
+		len -= step;
+	} while (len);
+
+	return numSamples;
+}
+
+void MidiDriver_Emulated::dispatchMessage(uint32 b) {
+	if (_ring)
+		queueEvent(b, 0, 0);
+	else
+		playMessage(b);
+}
+
+void MidiDriver_Emulated::dispatchSysEx(const byte *msg, uint16 length) {
+	if (_ring)
+		queueEvent(0, msg, length);
+	else
+		playSysEx(msg, length);
+}
+
+#pragma mark -
+
+void MidiDriver_Emulated::startPreRender() {
+	if (_ring || !ConfMan.getBool("midi_prerender"))
+		return;
+
+	Common::ThreadManager *threads = g_system->getThreadManager();
+	if (!threads) {
+		warning("MidiDriver_Emulated: Rendering ahead needs threads, which this backend does not provide");
+		return;
+	}
+
+	const int latency = CLIP(ConfMan.getInt("midi_prerender_latency"), 10, 1000);
+	const int stereoFactor = isStereo() ? 2 : 1;
+
+	_lookAhead = getRate() * latency / 1000;
+	for (_ringSize = 1; _ringSize < _lookAhead; _ringSize <<= 1)
+		;
+
+	_ring = new int16[_ringSize * stereoFactor];
+	_ringWrite = _ringRead = _eventBase = 0;
+	_underruns = _lateEvents = 0;
+
+	// Fill up the buffer before the mixer starts pulling from it
+	renderAhead(_lookAhead);
+
+	_threads = threads;
+	_renderQuit = false;
+	_renderWake = _threads->createSemaphore(0);
+	if (_renderWake)
+		_renderThread = _threads->createThread(&renderThreadProc, this);
+	if (!_renderThread) {
+		warning("MidiDriver_Emulated: Could not start the render thread");
+		if (_renderWake)
+			_threads->deleteSemaphore(_renderWake);
+		_renderWake = 0;
+		_threads = 0;
+		delete[] _ring;
+		_ring = 0;
+		return;
+	}
+
+	debug(1, "MidiDriver_Emulated: Rendering %d ms ahead", latency);
+}
+
+void MidiDriver_Emulated::stopPreRender() {
+	if (!_ring)
+		return;
+
+	Common::atomicStore(_renderQuit, true);
+	_threads->postSemaphore(_renderWake);
+	_threads->joinThread(_renderThread);
+	_threads->deleteSemaphore(_renderWake);
+	_renderThread = 0;
+	_renderWake = 0;
+	_threads = 0;
+
+	Common::StackLock lock(_renderMutex);
+	delete[] _ring;
+	_ring = 0;
+
+	Common::StackLock eventLock(_eventMutex);
+	_events.clear();
+
+	debug(1, "MidiDriver_Emulated: Stopped rendering ahead, %u underruns, %u late events", _underruns, _lateEvents);
+}
+
+void MidiDriver_Emulated::renderThreadProc(void *param) {
+	MidiDriver_Emulated *driver = (MidiDriver_Emulated *)param;
+
+	// Woken up whenever the mixer took a chunk out of the ring
+	for (;;) {
+		driver->_threads->waitSemaphore(driver->_renderWake);
+		if (Common::atomicLoad(driver->_renderQuit))
+			break;
+
+		Common::StackLock lock(driver->_renderMutex);
+		driver->renderAhead(Common::atomicLoad(driver->_ringRead) + driver->_lookAhead);
+	}
+}
+
+void MidiDriver_Emulated::renderAhead(uint32 target) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+	uint32 write = _ringWrite;
+
+	while ((int32)(target - write) > 0) {
+		uint32 end = target;
+
+		// Play everything which is due, and render no further than the
+		// next event.
+		for (;;) {
+			PendingEvent event;
+			{
+				Common::StackLock lock(_eventMutex);
+				if (_events.empty())
+					break;
+
+				const uint32 time = _events.front().time;
+				if ((int32)(time - write) > 0) {
+					if ((int32)(time - end) < 0)
+						end = time;
+					break;
+				}
+
+				event = _events.pop();
+			}
+
+			if ((int32)(event.time - write) < 0)
+				++_lateEvents;
+
+			if (event.sysEx.empty())
+				playMessage(event.message);
+			else
+				playSysEx(event.sysEx.begin(), event.sysEx.size());
+		}
+
+		const uint32 offset = write & (_ringSize - 1);
+		const uint32 count = MIN<uint32>(end - write, _ringSize - offset);
+		generateSamples(_ring + offset * stereoFactor, count);
+
+		write += count;
+		Common::atomicStore(_ringWrite, write);
+	}
+}
+
+void MidiDriver_Emulated::queueEvent(uint32 message, const byte *sysEx, uint16 length) {
+	PendingEvent event;
+	event.time = _eventBase + _lookAhead;
+	event.message = message;
+	if (sysEx)
+		event.sysEx = Common::Array<byte>(sysEx, length);
+
+	Common::StackLock lock(_eventMutex);
+	_events.push(event);
+}
+
+int MidiDriver_Emulated::readPreRendered(int16 *data, const int numSamples) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+	int len = numSamples / stereoFactor;
+
+	while (len > 0) {
+		// Never consume more than the look-ahead at once: the events sent
+		// by the timer callbacks below are then timed beyond anything the
+		// render thread may have rendered already.
+		const uint32 read = _ringRead;
+		const uint32 chunk = MIN<uint32>(len, _lookAhead);
+		uint32 pos = 0;
+
+		do {
+			uint32 step = chunk - pos;
+			if (step > (uint32)(_nextTick >> FIXP_SHIFT))
+				step = (_nextTick >> FIXP_SHIFT);
+
+			pos += step;
+
+			_nextTick -= step << FIXP_SHIFT;
+			if (!(_nextTick >> FIXP_SHIFT)) {
+				_eventBase = read + pos;
+
+				if (_timerProc)
+					(*_timerProc)(_timerParam);
+
+				onTimer();
+
+				_nextTick += _samplesPerTick;
+			}
+		} while (pos < chunk);
+
+		if (Common::atomicLoad(_ringWrite) - read < chunk) {
+			// The render thread fell behind, render the rest here
+			++_underruns;
+
+			Common::StackLock lock(_renderMutex);
+			renderAhead(read + chunk);
+		}
+
+		const uint32 offset = read & (_ringSize - 1);
+		const uint32 first = MIN<uint32>(chunk, _ringSize - offset);
+		memcpy(data, _ring + offset * stereoFactor, first * stereoFactor * sizeof(int16));
+		memcpy(data + first * stereoFactor, _ring, (chunk - first) * stereoFactor * sizeof(int16));
+
+		Common::atomicStore(_ringRead, read + chunk);
+		_eventBase = read + chunk;
+		_threads->postSemaphore(_renderWake);
+
+		data += chunk * stereoFactor;
+		len -= chunk;
+	}
+
+	return numSamples;
+}
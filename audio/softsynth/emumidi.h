@@ -27,6 +27,11 @@
 #include "audio/mididrv.h"
 #include "audio/mixer.h"
 
+#include "common/array.h"
+#include "common/mutex.h"
+#include "common/queue.h"
+#include "common/thread.h"
+
 class MidiDriver_Emulated : public Audio::AudioStream, public MidiDriver {
 protected:
 	bool _isOpen;
@@ -44,12 +49,83 @@ private:
 	int _nextTick;
 	int _samplesPerTick;
 
+	/** A MIDI event waiting for the pre-render position to reach it. */
+	struct PendingEvent {
+		uint32 time;
+		uint32 message;
+		Common::Array<byte> sysEx;
+	};
+
+	/** Rendered sample frames, see startPreRender(); 0 when rendering synchronously. */
+	int16 *_ring;
+	/** Size of _ring in frames, a power of two. */
+	uint32 _ringSize;
+	/** Number of frames kept rendered ahead of the mixer. */
+	uint32 _lookAhead;
+	/** Frames ever rendered into and read from the ring. */
+	volatile uint32 _ringWrite;
+	volatile uint32 _ringRead;
+	/** Playback position which newly dispatched events are timed from. */
+	volatile uint32 _eventBase;
+
+	Common::Mutex _renderMutex;
+	Common::Mutex _eventMutex;
+	Common::Queue<PendingEvent> _events;
+
+	volatile uint32 _underruns;
+	volatile uint32 _lateEvents;
+
+	/** The thread of this driver which renders ahead, while _ring is set. */
+	Common::ThreadManager *_threads;
+	Common::ThreadManager::ThreadRef _renderThread;
+	Common::ThreadManager::SemaphoreRef _renderWake;
+	volatile bool _renderQuit;
+
+	static void renderThreadProc(void *param);
+	void renderAhead(uint32 target);
+	void queueEvent(uint32 message, const byte *sysEx, uint16 length);
+	int readPreRendered(int16 *data, const int numSamples);
+
 protected:
 	int _baseFreq;
 
 	virtual void generateSamples(int16 *buf, int len) = 0;
 	virtual void onTimer() {}
 
+	/**
+	 * Play a MIDI message or SysEx on the synthesizer right away. Drivers
+	 * which support pre-rendering implement these and pass everything
+	 * they receive through dispatchMessage() and dispatchSysEx().
+	 */
+	virtual void playMessage(uint32 b) {}
+	virtual void playSysEx(const byte *msg, uint16 length) {}
+
+	/**
+	 * Hand a MIDI message or SysEx to the synthesizer. When pre-rendering,
+	 * it is played once the rendering reaches the current playback
+	 * position plus the look-ahead, so that all events are delayed by the
+	 * same amount. Otherwise it is played at once.
+	 */
+	void dispatchMessage(uint32 b);
+	void dispatchSysEx(const byte *msg, uint16 length);
+
+	/**
+	 * Render ahead of the mixer on a thread of this driver if the
+	 * "midi_prerender" option is set, keeping "midi_prerender_latency"
+	 * milliseconds of output buffered. Call from open() before the stream
+	 * is played. Nothing happens on backends without a thread manager.
+	 *
+	 * The timer callback then still runs in the mixer thread, in sync with
+	 * the output, and the messages it sends reach the synthesizer after
+	 * the look-ahead.
+	 */
+	void startPreRender();
+
+	/**
+	 * Stop rendering ahead. Call from close() after the stream was stopped.
+	 */
+	void stopPreRender();
+
 public:
 	MidiDriver_Emulated(Audio::Mixer *mixer) :
 		_mixer(mixer),
@@ -58,9 +134,25 @@ public:
 		_timerParam(0),
 		_nextTick(0),
 		_samplesPerTick(0),
+		_ring(0),
+		_ringSize(0),
+		_lookAhead(0),
+		_ringWrite(0),
+		_ringRead(0),
+		_eventBase(0),
+		_underruns(0),
+		_lateEvents(0),
+		_threads(0),
+		_renderThread(0),
+		_renderWake(0),
+		_renderQuit(false),
 		_baseFreq(250) {
 	}
 
+	virtual ~MidiDriver_Emulated() {
+		stopPreRender();
+	}
+
 	// MidiDriver API
 	virtual int open() {
 		_isOpen = true;
@@ -87,35 +179,23 @@ public:
 		return 1000000 / _baseFreq;
 	}
 
-	// AudioStream API
-	virtual int readBuffer(int16 *data, const int numSamples) {
-		const int stereoFactor = isStereo() ? 2 : 1;
-		int len = numSamples / stereoFactor;
-		int step;
-
-		do {
-			step = len;
-			if (step > (_nextTick >> FIXP_SHIFT))
-				step = (_nextTick >> FIXP_SHIFT);
-
-			generateSamples(data, step);
-
-			_nextTick -= step << FIXP_SHIFT;
-			if (!(_nextTick >> FIXP_SHIFT)) {
-				if (_timerProc)
-					(*_timerProc)(_timerParam);
+	/** Whether output is currently rendered ahead on the render thread. */
+	bool isPreRendering() const { return _ring != 0; }
 
-				onTimer();
+	/**
+	 * Number of times the mixer found less pre-rendered output than it
+	 * needed and had to render the rest itself.
+	 */
+	uint32 getUnderrunCount() const { return _underruns; }
 
-				_nextTick += _samplesPerTick;
-			}
+	/**
+	 * Number of events which arrived after the rendering had passed their
+	 * time and were played late.
+	 */
+	uint32 getLateEventCount() const { return _lateEvents; }
 
-			data += step * stereoFactor;
-			len -= step;
-		} while (len);
-
-		return numSamples;
-	}
+	// AudioStream API
+	virtual int readBuffer(int16 *data, const int numSamples);
 
 	virtual bool endOfData() const {
 		return false;
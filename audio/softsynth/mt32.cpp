@@ -115,6 +115,8 @@ private:
 
 protected:
 	void generateSamples(int16 *buf, int len) override;
+	void playMessage(uint32 b) override;
+	void playSysEx(const byte *msg, uint16 length) override;
 
 public:
 	MidiDriver_MT32(Audio::Mixer *mixer);
@@ -221,6 +223,8 @@ int MidiDriver_MT32::open() {
 
 	MidiDriver_Emulated::open();
 
+	startPreRender();
+
 	_mixer->playStream(Audio::Mixer::kPlainSoundType, &_mixerSoundHandle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
 
 	return 0;
@@ -228,7 +232,10 @@ int MidiDriver_MT32::open() {
 
 void MidiDriver_MT32::send(uint32 b) {
 	midiDriverCommonSend(b);
+	dispatchMessage(b);
+}
 
+void MidiDriver_MT32::playMessage(uint32 b) {
 	Common::StackLock lock(_mutex);
 	_service.playMsg(b);
 }
@@ -239,13 +246,18 @@ void MidiDriver_MT32::setPitchBendRange(byte channel, uint range) {
 	if (range > 24) {
 		warning("setPitchBendRange() called with range > 24: %d", range);
 	}
-	byte benderRangeSysex[4] = { 0, 0, 4, (uint8)range };
-	Common::StackLock lock(_mutex);
-	_service.writeSysex(channel, benderRangeSysex, 4);
+	// Send it as a DT1 message, so that it stays in order with the notes
+	// when rendering ahead. The checksum is not looked at.
+	byte benderRangeSysex[9] = { 0x41, channel, 0x16, 0x12, 0, 0, 4, (uint8)range, 0 };
+	dispatchSysEx(benderRangeSysex, sizeof(benderRangeSysex));
 }
 
 void MidiDriver_MT32::sysEx(const byte *msg, uint16 length) {
 	midiDriverCommonSysEx(msg, length);
+	dispatchSysEx(msg, length);
+}
+
+void MidiDriver_MT32::playSysEx(const byte *msg, uint16 length) {
 	if (msg[0] == 0xf0) {
 		Common::StackLock lock(_mutex);
 		_service.playSysex(msg, length);
@@ -273,6 +285,7 @@ void MidiDriver_MT32::close() {
 	setTimerCallback(NULL, NULL);
 	// Detach the mixer callback handler
 	_mixer->stopHandle(_mixerSoundHandle);
+	stopPreRender();
 
 	Common::StackLock lock(_mutex);
 	_service.closeSynth();
@@ -63,6 +63,17 @@ protected:
 	 */
 	virtual AbstractFSNode *getChild(const Common::String &name) const = 0;
 
+	/**
+	 * Returns a node for the child with the given name, like getChild(), but
+	 * trusts the caller that it exists and whether it is a directory. This
+	 * saves backends from having to check the child, e.g. when the contents
+	 * of the directory are already known from a cache.
+	 *
+	 * @param name String containing the name of the child to create a new node.
+	 * @param isDirectory whether the child is a directory
+	 */
+	virtual AbstractFSNode *getChildWithKnownType(const Common::String &name, bool isDirectory) const { return getChild(name); }
+
 	/**
 	 * The parent node of this directory.
 	 * The parent of the root is the root itself.
@@ -173,6 +184,17 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Retrieves the size and the time of the last modification of the file
+	 * or directory referred by this path, without opening it. Backends which
+	 * can't do this cheaply keep the default implementation.
+	 *
+	 * @param size				set to the file size in bytes; for directories, the value is backend specific
+	 * @param modificationTime	set to the modification time, in seconds since an arbitrary epoch
+	 * @return bool true if both values were retrieved, false otherwise.
+	 */
+	virtual bool getFileInfo(uint32 &size, uint32 &modificationTime) const { return false; }
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
@@ -183,6 +205,16 @@ public:
 	 */
 	virtual Common::SeekableReadStream *createReadStream() = 0;
 
+	/**
+	 * Like createReadStream(), but the backend may map the file into memory,
+	 * which makes small reads and seeks cheap. Only meant for game data which
+	 * nobody writes to while it is open. Backends without file mapping just
+	 * return createReadStream().
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	virtual Common::SeekableReadStream *createMappedReadStream() { return createReadStream(); }
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -64,6 +64,7 @@ public:
 	Common::SeekableReadStream *createReadStream() override;
 	Common::WriteStream *createWriteStream() override;
 	AbstractFSNode *getChild(const Common::String &n) const override;
+	DrivePOSIXFilesystemNode *getChildWithKnownType(const Common::String &n, bool isDirectoryFlag) const override;
 	bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const override;
 	AbstractFSNode *getParent() const override;
 
@@ -71,7 +72,6 @@ private:
 	bool _isPseudoRoot;
 	const Config &_config;
 
-	DrivePOSIXFilesystemNode *getChildWithKnownType(const Common::String &n, bool isDirectoryFlag) const;
 	bool isDrive(const Common::String &path) const;
 	void configureStream(StdioStream *stream);
 };
@@ -73,6 +73,16 @@ bool POSIXFilesystemNode::isWritable() const {
 	return access(_path.c_str(), W_OK) == 0;
 }
 
+bool POSIXFilesystemNode::getFileInfo(uint32 &size, uint32 &modificationTime) const {
+	struct stat st;
+	if (stat(_path.c_str(), &st) != 0 || !(S_ISREG(st.st_mode) || S_ISDIR(st.st_mode)))
+		return false;
+
+	size = (uint32)st.st_size;
+	modificationTime = (uint32)st.st_mtime;
+	return true;
+}
+
 void POSIXFilesystemNode::setFlags() {
 	struct stat st;
 
@@ -153,6 +163,24 @@ AbstractFSNode *POSIXFilesystemNode::getChild(const Common::String &n) const {
 	return makeNode(newPath);
 }
 
+AbstractFSNode *POSIXFilesystemNode::getChildWithKnownType(const Common::String &n, bool isDirectoryFlag) const {
+	assert(_isDirectory);
+
+	// Make sure the string contains no slashes
+	assert(!n.contains('/'));
+
+	// Start with a clone of this node, as getChildren() does
+	POSIXFilesystemNode *child = new POSIXFilesystemNode(*this);
+	if (_path.lastChar() != '/')
+		child->_path += '/';
+	child->_path += n;
+	child->_displayName = n;
+	child->_isDirectory = isDirectoryFlag;
+	child->_isValid = true;
+
+	return child;
+}
+
 bool POSIXFilesystemNode::getChildren(AbstractFSList &myList, ListMode mode, bool hidden) const {
 	assert(_isDirectory);
 
@@ -315,6 +343,17 @@ Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
 	return PosixIoStream::makeFromPath(getPath(), false);
 }
 
+Common::SeekableReadStream *POSIXFilesystemNode::createMappedReadStream() {
+#ifdef HAS_MMAP
+	// Large files are mapped, which makes small reads and seeks cheap
+	Common::SeekableReadStream *mapped = PosixMappedReadStream::makeFromPath(getPath());
+	if (mapped)
+		return mapped;
+#endif
+
+	return createReadStream();
+}
+
 Common::WriteStream *POSIXFilesystemNode::createWriteStream() {
 	return PosixIoStream::makeFromPath(getPath(), true);
 }
@@ -61,12 +61,15 @@ public:
 	virtual bool isDirectory() const { return _isDirectory; }
 	virtual bool isReadable() const;
 	virtual bool isWritable() const;
+	virtual bool getFileInfo(uint32 &size, uint32 &modificationTime) const;
 
 	virtual AbstractFSNode *getChild(const Common::String &n) const;
+	virtual AbstractFSNode *getChildWithKnownType(const Common::String &n, bool isDirectoryFlag) const;
 	virtual bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const;
 	virtual AbstractFSNode *getParent() const;
 
 	virtual Common::SeekableReadStream *createReadStream();
+	virtual Common::SeekableReadStream *createMappedReadStream();
 	virtual Common::WriteStream *createWriteStream();
 	virtual bool createDirectory();
 
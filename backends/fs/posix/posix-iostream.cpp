@@ -26,6 +26,12 @@
 
 #include <sys/stat.h>
 
+#ifdef HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 PosixIoStream *PosixIoStream::makeFromPath(const Common::String &path, bool writeMode) {
 	FILE *handle = fopen(path.c_str(), writeMode ? "wb" : "rb");
 
@@ -54,3 +60,42 @@ int32 PosixIoStream::size() const {
 
 	return st.st_size;
 }
+
+#ifdef HAS_MMAP
+
+// Below this size, stdio reads are as fast and need no address space
+static const off_t kMinMappedSize = 1024 * 1024;
+// Stream sizes are 32 bit; on 32 bit systems, do not exhaust the address space
+static const off_t kMaxMappedSize = sizeof(void *) > 4 ? 0x7FFFFFFF : 256 * 1024 * 1024;
+
+PosixMappedReadStream *PosixMappedReadStream::makeFromPath(const Common::String &path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1)
+		return nullptr;
+
+	struct stat st;
+	if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode) ||
+	    st.st_size < kMinMappedSize || st.st_size > kMaxMappedSize) {
+		close(fd);
+		return nullptr;
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+		return nullptr;
+
+	return new PosixMappedReadStream(mapping, st.st_size);
+}
+
+PosixMappedReadStream::PosixMappedReadStream(void *mapping, uint32 size) :
+		Common::MemoryReadStream((const byte *)mapping, size),
+		_mapping(mapping), _mappingSize(size) {
+}
+
+PosixMappedReadStream::~PosixMappedReadStream() {
+	munmap(_mapping, _mappingSize);
+}
+
+#endif
@@ -36,4 +36,33 @@ public:
 	int32 size() const override;
 };
 
+#ifdef HAS_MMAP
+
+#include "common/memstream.h"
+
+/**
+ * A read-only stream over a file mapped into memory. Reads and seeks are
+ * plain memory accesses, so many small reads, or SeekableSubReadStreams
+ * slicing the file up, cost no system calls.
+ *
+ * The file must not be truncated while it is mapped.
+ */
+class PosixMappedReadStream : public Common::MemoryReadStream {
+public:
+	/**
+	 * Map the file at the given path. Returns nullptr if the file is too
+	 * small for mapping to pay off, too large, or cannot be mapped.
+	 */
+	static PosixMappedReadStream *makeFromPath(const Common::String &path);
+	~PosixMappedReadStream() override;
+
+private:
+	PosixMappedReadStream(void *mapping, uint32 size);
+
+	void *_mapping;
+	uint32 _mappingSize;
+};
+
+#endif
+
 #endif
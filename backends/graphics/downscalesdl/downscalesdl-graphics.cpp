@@ -277,28 +277,22 @@ void DownscaleSdlGraphicsManager::internUpdateScreen() {
 	updateOSD();
 #endif
 
-	// Force a full redraw if requested
-	if (_forceRedraw) {
-		_numDirtyRects = 1;
-		_dirtyRectList[0].x = 0;
-		_dirtyRectList[0].y = 0;
-		_dirtyRectList[0].w = width;
-		_dirtyRectList[0].h = height;
-
 #ifdef GPH_DEVICE
-		// HACK: Make sure the full hardware screen is wiped clean.
+	// HACK: Make sure the full hardware screen is wiped clean.
+	if (_forceRedraw)
 		SDL_FillRect(_hwScreen, NULL, 0);
 #endif
-	}
+
+	prepareDirtyRects(width, height);
 
 	// Only draw anything if necessary
-	if (_numDirtyRects > 0 || _cursorNeedsRedraw) {
+	if (!_dirtyRectList.empty() || _cursorNeedsRedraw) {
 		SDL_Rect *r;
 		SDL_Rect dst;
 		uint32 srcPitch, dstPitch;
-		SDL_Rect *lastRect = _dirtyRectList + _numDirtyRects;
+		SDL_Rect *lastRect = _dirtyRectList.begin() + _dirtyRectList.size();
 
-		for (r = _dirtyRectList; r != lastRect; ++r) {
+		for (r = _dirtyRectList.begin(); r != lastRect; ++r) {
 			dst = *r;
 			dst.x++;    // Shift rect by one since 2xSai needs to access the data around
 			dst.y++;    // any pixel to scale it, and we want to avoid mem access crashes.
@@ -313,7 +307,7 @@ void DownscaleSdlGraphicsManager::internUpdateScreen() {
 		srcPitch = srcSurf->pitch;
 		dstPitch = _hwScreen->pitch;
 
-		for (r = _dirtyRectList; r != lastRect; ++r) {
+		for (r = _dirtyRectList.begin(); r != lastRect; ++r) {
 			int dst_y = r->y + _currentShakeYOffset;
 			int dst_h = 0;
 			int dst_w = 0;
@@ -397,10 +391,10 @@ void DownscaleSdlGraphicsManager::internUpdateScreen() {
 #endif
 
 		// Finally, blit all our changes to the screen
-		SDL_UpdateRects(_hwScreen, _numDirtyRects, _dirtyRectList);
+		SDL_UpdateRects(_hwScreen, _dirtyRectList.size(), _dirtyRectList.begin());
 	}
 
-	_numDirtyRects = 0;
+	_dirtyRectList.clear();
 	_forceRedraw = false;
 	_cursorNeedsRedraw = false;
 }
@@ -89,6 +89,13 @@ public:
 	virtual void setFocusRectangle(const Common::Rect& rect) = 0;
 	virtual void clearFocusRectangle() = 0;
 
+	virtual Graphics::PixelFormat getSpriteFormat() const { return Graphics::PixelFormat(); }
+	virtual uint32 createSprite(uint width, uint height) { return 0; }
+	virtual void destroySprite(uint32 sprite) {}
+	virtual void copyRectToSprite(uint32 sprite, const void *buf, int pitch, int x, int y, int w, int h) {}
+	virtual void drawSprite(uint32 sprite, int x, int y, int w, int h, uint32 color) {}
+	virtual void clearSprites() {}
+
 	virtual void showOverlay() = 0;
 	virtual void hideOverlay() = 0;
 	virtual Graphics::PixelFormat getOverlayFormat() const = 0;
@@ -38,6 +38,7 @@ void Context::reset() {
 	shadersSupported = false;
 	multitextureSupported = false;
 	framebufferObjectSupported = false;
+	unpackSubImageSupported = false;
 
 #define GL_FUNC_DEF(ret, name, param) name = nullptr;
 #include "backends/graphics/opengl/opengl-func.h"
@@ -138,6 +139,8 @@ void OpenGLGraphicsManager::initializeGLContext() {
 			g_context.multitextureSupported = true;
 		} else if (token == "GL_EXT_framebuffer_object") {
 			g_context.framebufferObjectSupported = true;
+		} else if (token == "GL_EXT_unpack_subimage") {
+			g_context.unpackSubImageSupported = true;
 		}
 	}
 
@@ -153,10 +156,22 @@ void OpenGLGraphicsManager::initializeGLContext() {
 
 		// GLES2 always has FBO support.
 		g_context.framebufferObjectSupported = true;
+
+		// GLES3 contexts, which we also treat as GLES2, have
+		// GL_UNPACK_ROW_LENGTH without the extension.
+		const char *verString = (const char *)g_context.glGetString(GL_VERSION);
+		if (verString && !strncmp(verString, "OpenGL ES 3", 11)) {
+			g_context.unpackSubImageSupported = true;
+		}
 	} else {
 		g_context.shadersSupported = ARBShaderObjects & ARBShadingLanguage100 & ARBVertexShader & ARBFragmentShader;
 	}
 
+	// GL_UNPACK_ROW_LENGTH is part of desktop OpenGL since 1.0.
+	if (g_context.type == kContextGL) {
+		g_context.unpackSubImageSupported = true;
+	}
+
 	// Log context type.
 	switch (g_context.type) {
 	case kContextGL:
@@ -181,6 +196,7 @@ void OpenGLGraphicsManager::initializeGLContext() {
 	debug(5, "OpenGL: Shader support: %d", g_context.shadersSupported);
 	debug(5, "OpenGL: Multitexture support: %d", g_context.multitextureSupported);
 	debug(5, "OpenGL: FBO support: %d", g_context.framebufferObjectSupported);
+	debug(5, "OpenGL: Unpack subimage support: %d", g_context.unpackSubImageSupported);
 }
 
 } // End of namespace OpenGL
@@ -187,6 +187,7 @@ typedef GLhandleARB GLshader;
 #define GL_R8                             0x8229
 
 /* PixelStoreParameter */
+#define GL_UNPACK_ROW_LENGTH              0x0CF2
 #define GL_UNPACK_ALIGNMENT               0x0CF5
 #define GL_PACK_ALIGNMENT                 0x0D05
 
@@ -23,6 +23,7 @@
 
 #include "backends/graphics/opengl/opengl-graphics.h"
 #include "backends/graphics/opengl/texture.h"
+#include "backends/graphics/opengl/sprite-atlas.h"
 #include "backends/graphics/opengl/pipelines/pipeline.h"
 #include "backends/graphics/opengl/pipelines/fixed.h"
 #include "backends/graphics/opengl/pipelines/shader.h"
@@ -33,6 +34,7 @@
 #include "common/translation.h"
 #include "common/algorithm.h"
 #include "common/file.h"
+#include "common/framestats.h"
 #include "gui/debugger.h"
 #include "engines/engine.h"
 #ifdef USE_OSD
@@ -58,6 +60,17 @@
 
 namespace OpenGL {
 
+#ifdef ENABLE_FRAME_STATS
+namespace {
+
+uint32 dirtyPixels(const Surface &surface) {
+	const Common::Rect area = surface.getDirtyArea();
+	return area.width() * area.height();
+}
+
+} // End of anonymous namespace
+#endif
+
 OpenGLGraphicsManager::OpenGLGraphicsManager()
     : _currentState(), _oldState(), _transactionMode(kTransactionNone), _screenChangeID(1 << (sizeof(int) * 8 - 2)),
       _pipeline(nullptr), _stretchMode(STRETCH_FIT),
@@ -66,7 +79,8 @@ OpenGLGraphicsManager::OpenGLGraphicsManager()
       _cursor(nullptr),
       _cursorHotspotX(0), _cursorHotspotY(0),
       _cursorHotspotXScaled(0), _cursorHotspotYScaled(0), _cursorWidthScaled(0), _cursorHeightScaled(0),
-      _cursorKeyColor(0), _cursorDontScale(false), _cursorPaletteEnabled(false)
+      _cursorKeyColor(0), _cursorDontScale(false), _cursorPaletteEnabled(false),
+      _spriteAtlas(nullptr)
 #ifdef USE_OSD
       , _osdMessageChangeRequest(false), _osdMessageAlpha(0), _osdMessageFadeStartTime(0), _osdMessageSurface(nullptr),
       _osdIconSurface(nullptr)
@@ -80,6 +94,7 @@ OpenGLGraphicsManager::~OpenGLGraphicsManager() {
 	delete _gameScreen;
 	delete _overlay;
 	delete _cursor;
+	delete _spriteAtlas;
 #ifdef USE_OSD
 	delete _osdMessageSurface;
 	delete _osdIconSurface;
@@ -95,6 +110,7 @@ bool OpenGLGraphicsManager::hasFeature(OSystem::Feature f) const {
 	case OSystem::kFeatureCursorPalette:
 	case OSystem::kFeatureFilteringMode:
 	case OSystem::kFeatureStretchMode:
+	case OSystem::kFeatureSpriteBatching:
 		return true;
 
 	case OSystem::kFeatureOverlaySupportsAlpha:
@@ -124,6 +140,10 @@ void OpenGLGraphicsManager::setFeatureState(OSystem::Feature f, bool enable) {
 			_cursor->enableLinearFiltering(enable);
 		}
 
+		if (_spriteAtlas) {
+			_spriteAtlas->enableLinearFiltering(enable);
+		}
+
 		break;
 
 	case OSystem::kFeatureCursorPalette:
@@ -485,6 +505,7 @@ void OpenGLGraphicsManager::updateScreen() {
 	    && !_gameScreen->isDirty()
 	    && !(_overlayVisible && _overlay->isDirty())
 	    && !(_cursorVisible && _cursor && _cursor->isDirty())
+	    && !(_spriteAtlas && _spriteAtlas->isDirty())
 #ifdef USE_OSD
 	    && !_osdMessageSurface && !_osdIconSurface
 #endif
@@ -493,11 +514,17 @@ void OpenGLGraphicsManager::updateScreen() {
 	}
 
 	// Update changes to textures.
-	_gameScreen->updateGLTexture();
+	{
+		FRAME_STATS_SCOPE(kFrameStageScale);
+		FRAME_STATS_PIXELS(kFrameStageScale, dirtyPixels(*_gameScreen) + dirtyPixels(*_overlay));
+		_gameScreen->updateGLTexture();
+		_overlay->updateGLTexture();
+	}
 	if (_cursorVisible && _cursor) {
+		FRAME_STATS_SCOPE(kFrameStageCursor);
+		FRAME_STATS_PIXELS(kFrameStageCursor, dirtyPixels(*_cursor));
 		_cursor->updateGLTexture();
 	}
-	_overlay->updateGLTexture();
 
 	// Clear the screen buffer.
 	GL_CALL(glClear(GL_COLOR_BUFFER_BIT));
@@ -515,6 +542,12 @@ void OpenGLGraphicsManager::updateScreen() {
 	// First step: Draw the (virtual) game screen.
 	g_context.getActivePipeline()->drawTexture(_gameScreen->getGLTexture(), _gameDrawRect.left, _gameDrawRect.top, _gameDrawRect.width(), _gameDrawRect.height());
 
+	// Draw the engine sprites on top of it, batched per atlas page.
+	if (_spriteAtlas && _spriteAtlas->hasQueuedSprites()) {
+		_backBuffer.enableBlend(Framebuffer::kBlendModeTraditionalTransparency);
+		_spriteAtlas->render(*g_context.getActivePipeline(), _gameDrawRect, _gameScreen->getWidth(), _gameScreen->getHeight());
+	}
+
 	// Second step: Draw the overlay if visible.
 	if (_overlayVisible) {
 		int dstX = (_windowWidth - _overlayDrawRect.width()) / 2;
@@ -587,6 +620,8 @@ void OpenGLGraphicsManager::updateScreen() {
 
 	_cursorNeedsRedraw = false;
 	_forceRedraw = false;
+
+	FRAME_STATS_SCOPE(kFrameStagePresent);
 	refreshScreen();
 }
 
@@ -785,6 +820,38 @@ void OpenGLGraphicsManager::setCursorPalette(const byte *colors, uint start, uin
 	updateCursorPalette();
 }
 
+Graphics::PixelFormat OpenGLGraphicsManager::getSpriteFormat() const {
+	return _spriteAtlas ? _spriteAtlas->getFormat() : _defaultFormatAlpha;
+}
+
+uint32 OpenGLGraphicsManager::createSprite(uint width, uint height) {
+	return _spriteAtlas ? _spriteAtlas->createSprite(width, height) : 0;
+}
+
+void OpenGLGraphicsManager::destroySprite(uint32 sprite) {
+	if (_spriteAtlas) {
+		_spriteAtlas->destroySprite(sprite);
+	}
+}
+
+void OpenGLGraphicsManager::copyRectToSprite(uint32 sprite, const void *buf, int pitch, int x, int y, int w, int h) {
+	if (_spriteAtlas) {
+		_spriteAtlas->copyRectToSprite(sprite, buf, pitch, x, y, w, h);
+	}
+}
+
+void OpenGLGraphicsManager::drawSprite(uint32 sprite, int x, int y, int w, int h, uint32 color) {
+	if (_spriteAtlas) {
+		_spriteAtlas->drawSprite(sprite, x, y, w, h, color);
+	}
+}
+
+void OpenGLGraphicsManager::clearSprites() {
+	if (_spriteAtlas) {
+		_spriteAtlas->clearSprites();
+	}
+}
+
 void OpenGLGraphicsManager::displayMessageOnOSD(const Common::U32String &msg) {
 #ifdef USE_OSD
 	_osdMessageChangeRequest = true;
@@ -1039,6 +1106,16 @@ void OpenGLGraphicsManager::notifyContextCreate(const Graphics::PixelFormat &def
 		_cursor->recreate();
 	}
 
+	if (_spriteAtlas) {
+		_spriteAtlas->recreate();
+	} else {
+		GLenum glIntFormat, glFormat, glType;
+		if (getGLPixelFormat(_defaultFormatAlpha, glIntFormat, glFormat, glType)) {
+			_spriteAtlas = new SpriteAtlas(glIntFormat, glFormat, glType, _defaultFormatAlpha);
+			_spriteAtlas->enableLinearFiltering(_currentState.filtering);
+		}
+	}
+
 #ifdef USE_OSD
 	if (_osdMessageSurface) {
 		_osdMessageSurface->recreate();
@@ -1063,6 +1140,10 @@ void OpenGLGraphicsManager::notifyContextDestroy() {
 		_cursor->destroy();
 	}
 
+	if (_spriteAtlas) {
+		_spriteAtlas->destroy();
+	}
+
 #ifdef USE_OSD
 	if (_osdMessageSurface) {
 		_osdMessageSurface->destroy();
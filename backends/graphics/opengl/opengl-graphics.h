@@ -46,6 +46,7 @@ namespace OpenGL {
 
 class Surface;
 class Pipeline;
+class SpriteAtlas;
 #if !USE_FORCED_GLES
 class Shader;
 #endif
@@ -112,6 +113,13 @@ public:
 	virtual void setMouseCursor(const void *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, bool dontScale, const Graphics::PixelFormat *format) override;
 	virtual void setCursorPalette(const byte *colors, uint start, uint num) override;
 
+	virtual Graphics::PixelFormat getSpriteFormat() const override;
+	virtual uint32 createSprite(uint width, uint height) override;
+	virtual void destroySprite(uint32 sprite) override;
+	virtual void copyRectToSprite(uint32 sprite, const void *buf, int pitch, int x, int y, int w, int h) override;
+	virtual void drawSprite(uint32 sprite, int x, int y, int w, int h, uint32 color) override;
+	virtual void clearSprites() override;
+
 	virtual void displayMessageOnOSD(const Common::U32String &msg) override;
 	virtual void displayActivityIconOnOSD(const Graphics::Surface *icon) override;
 
@@ -411,6 +419,15 @@ protected:
 	 */
 	byte _cursorPalette[3 * 256];
 
+	//
+	// Sprites
+	//
+
+	/**
+	 * Storage for engine sprites, created with the first context.
+	 */
+	SpriteAtlas *_spriteAtlas;
+
 #ifdef USE_OSD
 	//
 	// OSD
@@ -25,6 +25,10 @@
 namespace OpenGL {
 
 #if !USE_FORCED_GLES2
+FixedPipeline::FixedPipeline() {
+	_color[0] = _color[1] = _color[2] = _color[3] = 1.0f;
+}
+
 void FixedPipeline::activateInternal() {
 	GL_CALL(glDisable(GL_LIGHTING));
 	GL_CALL(glDisable(GL_FOG));
@@ -43,6 +47,11 @@ void FixedPipeline::activateInternal() {
 }
 
 void FixedPipeline::setColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+	_color[0] = r;
+	_color[1] = g;
+	_color[2] = b;
+	_color[3] = a;
+
 	GL_CALL(glColor4f(r, g, b, a));
 }
 
@@ -54,6 +63,20 @@ void FixedPipeline::drawTexture(const GLTexture &texture, const GLfloat *coordin
 	GL_CALL(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
 }
 
+void FixedPipeline::drawTriangles(const GLTexture &texture, const GLfloat *coordinates, const GLfloat *texCoords, const GLfloat *colors, GLsizei vertexCount) {
+	texture.bind();
+
+	GL_CALL(glEnableClientState(GL_COLOR_ARRAY));
+	GL_CALL(glColorPointer(4, GL_FLOAT, 0, colors));
+	GL_CALL(glTexCoordPointer(2, GL_FLOAT, 0, texCoords));
+	GL_CALL(glVertexPointer(2, GL_FLOAT, 0, coordinates));
+	GL_CALL(glDrawArrays(GL_TRIANGLES, 0, vertexCount));
+	GL_CALL(glDisableClientState(GL_COLOR_ARRAY));
+
+	// The current color is undefined after drawing with a color array.
+	GL_CALL(glColor4f(_color[0], _color[1], _color[2], _color[3]));
+}
+
 void FixedPipeline::setProjectionMatrix(const GLfloat *projectionMatrix) {
 	if (!isActive()) {
 		return;
@@ -30,14 +30,20 @@ namespace OpenGL {
 #if !USE_FORCED_GLES2
 class FixedPipeline : public Pipeline {
 public:
+	FixedPipeline();
+
 	virtual void setColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
 
 	virtual void drawTexture(const GLTexture &texture, const GLfloat *coordinates);
+	virtual void drawTriangles(const GLTexture &texture, const GLfloat *coordinates, const GLfloat *texCoords, const GLfloat *colors, GLsizei vertexCount);
 
 	virtual void setProjectionMatrix(const GLfloat *projectionMatrix);
 
 protected:
 	virtual void activateInternal();
+
+private:
+	GLfloat _color[4];
 };
 #endif // !USE_FORCED_GLES2
 
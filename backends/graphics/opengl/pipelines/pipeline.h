@@ -92,6 +92,22 @@ public:
 		drawTexture(texture, coordinates);
 	}
 
+	/**
+	 * Draw a batch of textured, colored triangles to the currently active
+	 * framebuffer with a single draw call.
+	 *
+	 * The modulation color set by setColor is not used for the batch, but
+	 * stays in effect for later drawTexture calls.
+	 *
+	 * @param texture     Texture to use for drawing.
+	 * @param coordinates x, y pairs, one per vertex.
+	 * @param texCoords   Texture coordinates, one pair per vertex.
+	 * @param colors      r, g, b, a modulation colors in [0,1], one set per
+	 *                    vertex.
+	 * @param vertexCount Number of vertices, three per triangle.
+	 */
+	virtual void drawTriangles(const GLTexture &texture, const GLfloat *coordinates, const GLfloat *texCoords, const GLfloat *colors, GLsizei vertexCount) = 0;
+
 	/**
 	 * Set the projection matrix.
 	 *
@@ -86,6 +86,18 @@ void ShaderPipeline::drawTexture(const GLTexture &texture, const GLfloat *coordi
 	GL_CALL(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
 }
 
+void ShaderPipeline::drawTriangles(const GLTexture &texture, const GLfloat *coordinates, const GLfloat *texCoords, const GLfloat *colors, GLsizei vertexCount) {
+	texture.bind();
+
+	GL_CALL(glVertexAttribPointer(_colorAttribLocation, 4, GL_FLOAT, GL_FALSE, 0, colors));
+	GL_CALL(glVertexAttribPointer(_texCoordAttribLocation, 2, GL_FLOAT, GL_FALSE, 0, texCoords));
+	GL_CALL(glVertexAttribPointer(_vertexAttribLocation, 2, GL_FLOAT, GL_FALSE, 0, coordinates));
+	GL_CALL(glDrawArrays(GL_TRIANGLES, 0, vertexCount));
+
+	// drawTexture relies on the colors set up by activateInternal.
+	GL_CALL(glVertexAttribPointer(_colorAttribLocation, 4, GL_FLOAT, GL_FALSE, 0, _colorAttributes));
+}
+
 void ShaderPipeline::setProjectionMatrix(const GLfloat *projectionMatrix) {
 	_activeShader->setUniform("projection", new ShaderUniformMatrix44(projectionMatrix));
 }
@@ -37,6 +37,7 @@ public:
 	virtual void setColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
 
 	virtual void drawTexture(const GLTexture &texture, const GLfloat *coordinates);
+	virtual void drawTriangles(const GLTexture &texture, const GLfloat *coordinates, const GLfloat *texCoords, const GLfloat *colors, GLsizei vertexCount);
 
 	virtual void setProjectionMatrix(const GLfloat *projectionMatrix);
 
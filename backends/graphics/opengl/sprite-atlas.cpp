@@ -0,0 +1,290 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "backends/graphics/opengl/sprite-atlas.h"
+#include "backends/graphics/opengl/texture.h"
+#include "backends/graphics/opengl/pipelines/pipeline.h"
+
+namespace OpenGL {
+
+SpriteAtlas::SpriteAtlas(GLenum glIntFormat, GLenum glFormat, GLenum glType, const Graphics::PixelFormat &format)
+    : _glIntFormat(glIntFormat), _glFormat(glFormat), _glType(glType), _format(format),
+      _linearFiltering(false), _nextSprite(1), _queueChanged(false) {
+}
+
+SpriteAtlas::~SpriteAtlas() {
+	for (uint i = 0; i < _pages.size(); ++i) {
+		if (_pages[i]) {
+			delete _pages[i]->texture;
+			delete _pages[i];
+		}
+	}
+}
+
+uint SpriteAtlas::addPage(uint width, uint height, bool shared) {
+	Texture *texture = new Texture(_glIntFormat, _glFormat, _glType, _format);
+	texture->enableLinearFiltering(_linearFiltering);
+	texture->allocate(width, height);
+
+	Page *page = new Page(texture, width, height, shared);
+	for (uint i = 0; i < _pages.size(); ++i) {
+		if (!_pages[i]) {
+			_pages[i] = page;
+			return i;
+		}
+	}
+
+	_pages.push_back(page);
+	return _pages.size() - 1;
+}
+
+uint32 SpriteAtlas::createSprite(uint width, uint height) {
+	const uint maxSize = g_context.maxTextureSize;
+	if (width == 0 || height == 0 || width > maxSize || height > maxSize) {
+		return 0;
+	}
+
+	const uint pageSize = MIN<uint>(kPageSize, maxSize);
+
+	Sprite sprite;
+	int page = -1;
+
+	// Sprites too large for the shared pages get a page of their own.
+	if (width <= pageSize && height <= pageSize) {
+		for (uint i = 0; i < _pages.size() && page == -1; ++i) {
+			if (_pages[i] && _pages[i]->shared && _pages[i]->packer.allocate(width, height, sprite.rect)) {
+				page = i;
+			}
+		}
+
+		if (page == -1) {
+			page = addPage(pageSize, pageSize, true);
+			_pages[page]->packer.allocate(width, height, sprite.rect);
+		} else {
+			// The space may have belonged to a destroyed sprite. Clear it,
+			// along with the padding which linear filtering samples.
+			Texture *texture = _pages[page]->texture;
+			Graphics::Surface *pixels = texture->getSurface();
+			const Common::Rect area(sprite.rect.left, sprite.rect.top,
+			                        MIN<int>(sprite.rect.right + 1, pixels->w),
+			                        MIN<int>(sprite.rect.bottom + 1, pixels->h));
+			pixels->fillRect(area, 0);
+			texture->addDirtyArea(area);
+		}
+	} else {
+		page = addPage(width, height, false);
+		_pages[page]->packer.allocate(width, height, sprite.rect);
+	}
+
+	sprite.page = page;
+
+	const uint32 handle = _nextSprite;
+	_nextSprite = (_nextSprite == 0xFFFFFFFF) ? 1 : _nextSprite + 1;
+	_sprites[handle] = sprite;
+	return handle;
+}
+
+void SpriteAtlas::destroySprite(uint32 handle) {
+	SpriteMap::iterator i = _sprites.find(handle);
+	if (i == _sprites.end()) {
+		return;
+	}
+
+	const Sprite sprite = i->_value;
+	_sprites.erase(i);
+
+	// Queued draws of the sprite are skipped from now on.
+	for (uint j = 0; j < _queue.size(); ++j) {
+		if (_queue[j].sprite == handle) {
+			_queueChanged = true;
+			break;
+		}
+	}
+
+	Page *page = _pages[sprite.page];
+	page->packer.release(sprite.rect);
+
+	// Pages of large sprites only ever hold one sprite. Shared pages are
+	// kept, sprites are usually replaced by others soon.
+	if (!page->shared) {
+		delete page->texture;
+		delete page;
+		_pages[sprite.page] = nullptr;
+	}
+}
+
+void SpriteAtlas::copyRectToSprite(uint32 handle, const void *buf, int pitch, int x, int y, int w, int h) {
+	SpriteMap::const_iterator i = _sprites.find(handle);
+	if (i == _sprites.end()) {
+		return;
+	}
+
+	const Sprite &sprite = i->_value;
+	assert(x >= 0 && y >= 0 && x + w <= sprite.rect.width() && y + h <= sprite.rect.height());
+
+	_pages[sprite.page]->texture->copyRectToTexture(sprite.rect.left + x, sprite.rect.top + y, w, h, buf, pitch);
+}
+
+void SpriteAtlas::drawSprite(uint32 sprite, int x, int y, int w, int h, uint32 color) {
+	if (w <= 0 || h <= 0 || !_sprites.contains(sprite)) {
+		return;
+	}
+
+	Draw draw;
+	draw.sprite = sprite;
+	draw.x = x;
+	draw.y = y;
+	draw.w = w;
+	draw.h = h;
+	draw.color = color;
+	_queue.push_back(draw);
+	_queueChanged = true;
+}
+
+void SpriteAtlas::clearSprites() {
+	if (_queue.empty()) {
+		return;
+	}
+
+	// Keep the storage, the queue is usually refilled right away.
+	_queue.resize(0);
+	_queueChanged = true;
+}
+
+bool SpriteAtlas::isDirty() const {
+	if (_queueChanged) {
+		return true;
+	}
+
+	if (_queue.empty()) {
+		return false;
+	}
+
+	for (uint i = 0; i < _pages.size(); ++i) {
+		if (_pages[i] && _pages[i]->texture->isDirty()) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void SpriteAtlas::flush(Pipeline &pipeline, const Page &page) {
+	pipeline.drawTriangles(page.texture->getGLTexture(), &_coordinates[0], &_texCoords[0], &_colors[0], _coordinates.size() / 2);
+
+	_coordinates.resize(0);
+	_texCoords.resize(0);
+	_colors.resize(0);
+}
+
+void SpriteAtlas::render(Pipeline &pipeline, const Common::Rect &drawRect, uint gameWidth, uint gameHeight) {
+	for (uint i = 0; i < _pages.size(); ++i) {
+		if (_pages[i]) {
+			_pages[i]->texture->updateGLTexture();
+		}
+	}
+
+	const GLfloat scaleX = (GLfloat)drawRect.width() / gameWidth;
+	const GLfloat scaleY = (GLfloat)drawRect.height() / gameHeight;
+
+	int currentPage = -1;
+	for (uint i = 0; i < _queue.size(); ++i) {
+		const Draw &draw = _queue[i];
+		SpriteMap::const_iterator s = _sprites.find(draw.sprite);
+		if (s == _sprites.end()) {
+			continue;
+		}
+
+		const Sprite &sprite = s->_value;
+		if ((int)sprite.page != currentPage) {
+			if (currentPage != -1) {
+				flush(pipeline, *_pages[currentPage]);
+			}
+			currentPage = sprite.page;
+		}
+
+		// Two triangles per sprite: top left, top right, bottom left and
+		// top right, bottom right, bottom left.
+		const GLfloat x1 = drawRect.left + draw.x * scaleX;
+		const GLfloat y1 = drawRect.top + draw.y * scaleY;
+		const GLfloat x2 = x1 + draw.w * scaleX;
+		const GLfloat y2 = y1 + draw.h * scaleY;
+		const GLfloat coordinates[6*2] = { x1, y1, x2, y1, x1, y2, x2, y1, x2, y2, x1, y2 };
+
+		const GLTexture &texture = _pages[currentPage]->texture->getGLTexture();
+		const GLfloat u1 = (GLfloat)sprite.rect.left / texture.getWidth();
+		const GLfloat v1 = (GLfloat)sprite.rect.top / texture.getHeight();
+		const GLfloat u2 = (GLfloat)sprite.rect.right / texture.getWidth();
+		const GLfloat v2 = (GLfloat)sprite.rect.bottom / texture.getHeight();
+		const GLfloat texCoords[6*2] = { u1, v1, u2, v1, u1, v2, u2, v1, u2, v2, u1, v2 };
+
+		const GLfloat a = ((draw.color >> 24) & 0xFF) / 255.0f;
+		const GLfloat r = ((draw.color >> 16) & 0xFF) / 255.0f;
+		const GLfloat g = ((draw.color >>  8) & 0xFF) / 255.0f;
+		const GLfloat b = ((draw.color >>  0) & 0xFF) / 255.0f;
+
+		for (uint v = 0; v < 6; ++v) {
+			_coordinates.push_back(coordinates[2 * v + 0]);
+			_coordinates.push_back(coordinates[2 * v + 1]);
+			_texCoords.push_back(texCoords[2 * v + 0]);
+			_texCoords.push_back(texCoords[2 * v + 1]);
+			_colors.push_back(r);
+			_colors.push_back(g);
+			_colors.push_back(b);
+			_colors.push_back(a);
+		}
+	}
+
+	if (currentPage != -1) {
+		flush(pipeline, *_pages[currentPage]);
+	}
+
+	_queueChanged = false;
+}
+
+void SpriteAtlas::destroy() {
+	for (uint i = 0; i < _pages.size(); ++i) {
+		if (_pages[i]) {
+			_pages[i]->texture->destroy();
+		}
+	}
+}
+
+void SpriteAtlas::recreate() {
+	for (uint i = 0; i < _pages.size(); ++i) {
+		if (_pages[i]) {
+			_pages[i]->texture->recreate();
+		}
+	}
+}
+
+void SpriteAtlas::enableLinearFiltering(bool enable) {
+	_linearFiltering = enable;
+
+	for (uint i = 0; i < _pages.size(); ++i) {
+		if (_pages[i]) {
+			_pages[i]->texture->enableLinearFiltering(enable);
+		}
+	}
+}
+
+} // End of namespace OpenGL
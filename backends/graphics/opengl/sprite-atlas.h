@@ -0,0 +1,194 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_GRAPHICS_OPENGL_SPRITE_ATLAS_H
+#define BACKENDS_GRAPHICS_OPENGL_SPRITE_ATLAS_H
+
+#include "backends/graphics/opengl/opengl-sys.h"
+
+#include "graphics/atlas_packer.h"
+#include "graphics/pixelformat.h"
+
+#include "common/array.h"
+#include "common/hashmap.h"
+#include "common/rect.h"
+
+namespace OpenGL {
+
+class Pipeline;
+class Texture;
+
+/**
+ * Storage and batched drawing for engine sprites.
+ *
+ * Sprites are packed into a few large textures ("pages"), so the sprites
+ * queued for a frame can be drawn with one draw call per run of sprites
+ * sharing a page instead of one per sprite, and nothing needs to be
+ * composited on the CPU. Each page keeps a copy of its pixels, which is
+ * used to restore the textures when the context is recreated.
+ */
+class SpriteAtlas {
+public:
+	/**
+	 * Create a new, empty atlas.
+	 *
+	 * @param glIntFormat The internal format to use.
+	 * @param glFormat    The input format.
+	 * @param glType      The input type.
+	 * @param format      The format of the sprite pixel data.
+	 */
+	SpriteAtlas(GLenum glIntFormat, GLenum glFormat, GLenum glType, const Graphics::PixelFormat &format);
+	~SpriteAtlas();
+
+	const Graphics::PixelFormat &getFormat() const { return _format; }
+
+	/**
+	 * Reserve space for a sprite. Its pixels are transparent until set
+	 * with copyRectToSprite.
+	 *
+	 * @return The handle of the sprite, or 0 if it does not fit.
+	 */
+	uint32 createSprite(uint width, uint height);
+
+	/**
+	 * Free a sprite. Queued draws of it are dropped.
+	 */
+	void destroySprite(uint32 sprite);
+
+	/**
+	 * Copy image data in the format returned by getFormat to a sprite.
+	 */
+	void copyRectToSprite(uint32 sprite, const void *buf, int pitch, int x, int y, int w, int h);
+
+	/**
+	 * Queue a sprite for drawing. Sprites are drawn in the order they are
+	 * queued.
+	 *
+	 * @param x, y, w, h The area to draw the sprite to, in game screen
+	 *                   coordinates. The sprite is stretched to fill it.
+	 * @param color      ARGB (0xAARRGGBB) color to modulate the sprite
+	 *                   with.
+	 */
+	void drawSprite(uint32 sprite, int x, int y, int w, int h, uint32 color);
+
+	/**
+	 * Empty the draw queue.
+	 */
+	void clearSprites();
+
+	/**
+	 * Whether the output of render changed since the last call.
+	 */
+	bool isDirty() const;
+
+	/**
+	 * Whether there is anything to render.
+	 */
+	bool hasQueuedSprites() const { return !_queue.empty(); }
+
+	/**
+	 * Upload pending changes and draw all queued sprites.
+	 *
+	 * @param pipeline   Pipeline to draw with.
+	 * @param drawRect   Area the game screen is drawn to.
+	 * @param gameWidth  Width of the game screen.
+	 * @param gameHeight Height of the game screen.
+	 */
+	void render(Pipeline &pipeline, const Common::Rect &drawRect, uint gameWidth, uint gameHeight);
+
+	/**
+	 * Destroy OpenGL description of the pages.
+	 */
+	void destroy();
+
+	/**
+	 * Recreate OpenGL description of the pages.
+	 */
+	void recreate();
+
+	/**
+	 * Enable or disable linear texture filtering.
+	 *
+	 * @param enable true to enable and false to disable.
+	 */
+	void enableLinearFiltering(bool enable);
+
+private:
+	enum {
+		/** Size of the shared pages, if the context allows. */
+		kPageSize = 1024
+	};
+
+	struct Page {
+		Page(Texture *t, uint width, uint height, bool s) : texture(t), packer(width, height, 1), shared(s) {}
+
+		Texture *texture;
+		Graphics::AtlasPacker packer;
+
+		/** False for pages holding a single, large sprite. */
+		bool shared;
+	};
+
+	struct Sprite {
+		uint page;
+		Common::Rect rect;
+	};
+
+	struct Draw {
+		uint32 sprite;
+		GLfloat x, y, w, h;
+		uint32 color;
+	};
+
+	typedef Common::HashMap<uint32, Sprite> SpriteMap;
+
+	/** Add a page and return its index. */
+	uint addPage(uint width, uint height, bool shared);
+
+	/** Draw the vertices collected so far and start a new batch. */
+	void flush(Pipeline &pipeline, const Page &page);
+
+	const GLenum _glIntFormat;
+	const GLenum _glFormat;
+	const GLenum _glType;
+	const Graphics::PixelFormat _format;
+
+	bool _linearFiltering;
+
+	/** Pages; pages which became empty are freed and leave a hole. */
+	Common::Array<Page *> _pages;
+
+	SpriteMap _sprites;
+	uint32 _nextSprite;
+
+	Common::Array<Draw> _queue;
+	bool _queueChanged;
+
+	// Vertex data of the current batch, kept to avoid reallocations.
+	Common::Array<GLfloat> _coordinates;
+	Common::Array<GLfloat> _texCoords;
+	Common::Array<GLfloat> _colors;
+};
+
+} // End of namespace OpenGL
+
+#endif
@@ -136,23 +136,25 @@ void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &sr
 	bind();
 
 	// Update the actual texture.
-	// Although we have the area of the texture buffer we want to update we
-	// cannot take advantage of the left/right boundries here because it is
-	// not possible to specify a pitch to glTexSubImage2D. To be precise, with
-	// plain OpenGL we could set GL_UNPACK_ROW_LENGTH to achieve this. However,
-	// OpenGL ES 1.0 does not support GL_UNPACK_ROW_LENGTH. Thus, we are left
-	// with the following options:
-	//
-	// 1) (As we do right now) Simply always update the whole texture lines of
-	//    rect changed. This is simplest to implement. In case performance is
-	//    really an issue we can think of switching to another method.
-	//
-	// 2) Copy the dirty rect to a temporary buffer and upload that by using
-	//    glTexSubImage2D. This is what the Android backend does. It is more
-	//    complicated though.
-	//
-	// 3) Use glTexSubImage2D per line changed. This is what the old OpenGL
-	//    graphics manager did but it is much slower! Thus, we do not use it.
+	// glTexSubImage2D has no pitch parameter, but GL_UNPACK_ROW_LENGTH
+	// provides one where it is available: on desktop OpenGL, OpenGL ES 3
+	// and with GL_EXT_unpack_subimage. Then only the dirty rect itself is
+	// uploaded. OpenGL ES 1.0 and plain OpenGL ES 2.0 lack it; there we
+	// simply update the whole texture lines of the rect changed. Copying
+	// the rect to a temporary buffer first (what the Android backend does)
+	// or uploading it line by line (what the old OpenGL graphics manager
+	// did) would avoid that too, but the latter is much slower and the
+	// former not worth the extra copy on the contexts in question.
+#ifdef GL_UNPACK_ROW_LENGTH
+	if (g_context.unpackSubImageSupported && area.width() != src.w) {
+		GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, src.pitch / src.format.bytesPerPixel));
+		GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, area.left, area.top, area.width(), area.height(),
+		                        _glFormat, _glType, src.getBasePtr(area.left, area.top)));
+		GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+		return;
+	}
+#endif
+
 	GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, area.top, src.w, area.height(),
 	                       _glFormat, _glType, src.getBasePtr(0, area.top)));
 }
@@ -170,15 +172,7 @@ void Surface::copyRectToTexture(uint x, uint y, uint w, uint h, const void *srcP
 	assert(x + w <= dstSurf->w);
 	assert(y + h <= dstSurf->h);
 
-	// *sigh* Common::Rect::extend behaves unexpected whenever one of the two
-	// parameters is an empty rect. Thus, we check whether the current dirty
-	// area is valid. In case it is not we simply use the parameters as new
-	// dirty area. Otherwise, we simply call extend.
-	if (_dirtyArea.isEmpty()) {
-		_dirtyArea = Common::Rect(x, y, x + w, y + h);
-	} else {
-		_dirtyArea.extend(Common::Rect(x, y, x + w, y + h));
-	}
+	addDirtyArea(Common::Rect(x, y, x + w, y + h));
 
 	const byte *src = (const byte *)srcPtr;
 	byte *dst = (byte *)dstSurf->getBasePtr(x, y);
@@ -196,6 +190,18 @@ void Surface::copyRectToTexture(uint x, uint y, uint w, uint h, const void *srcP
 	}
 }
 
+void Surface::addDirtyArea(const Common::Rect &area) {
+	// *sigh* Common::Rect::extend behaves unexpected whenever one of the two
+	// parameters is an empty rect. Thus, we check whether the current dirty
+	// area is valid. In case it is not we simply use the parameters as new
+	// dirty area. Otherwise, we simply call extend.
+	if (_dirtyArea.isEmpty()) {
+		_dirtyArea = area;
+	} else {
+		_dirtyArea.extend(area);
+	}
+}
+
 void Surface::fill(uint32 color) {
 	Graphics::Surface *dst = getSurface();
 	dst->fillRect(Common::Rect(dst->w, dst->h), color);
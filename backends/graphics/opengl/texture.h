@@ -201,8 +201,20 @@ public:
 	void fill(uint32 color);
 
 	void flagDirty() { _allDirty = true; }
+
+	/**
+	 * Mark an area as changed, after modifying the data returned by
+	 * getSurface directly.
+	 */
+	void addDirtyArea(const Common::Rect &area);
+
 	virtual bool isDirty() const { return _allDirty || !_dirtyArea.isEmpty(); }
 
+	/**
+	 * @return The area changed since the last updateGLTexture call.
+	 */
+	Common::Rect getDirtyArea() const;
+
 	virtual uint getWidth() const = 0;
 	virtual uint getHeight() const = 0;
 
@@ -240,8 +252,6 @@ public:
 	virtual const GLTexture &getGLTexture() const = 0;
 protected:
 	void clearDirty() { _allDirty = false; _dirtyArea = Common::Rect(); }
-
-	Common::Rect getDirtyArea() const;
 private:
 	bool _allDirty;
 	Common::Rect _dirtyArea;
@@ -26,17 +26,20 @@
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
 #include "backends/events/sdl/sdl-events.h"
 #include "common/config-manager.h"
+#include "common/debug.h"
 #include "common/mutex.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
 #include "common/util.h"
 #include "common/file.h"
 #include "common/frac.h"
+#include "common/framestats.h"
 #ifdef USE_RGB_COLOR
 #include "common/list.h"
 #endif
 #include "graphics/font.h"
 #include "graphics/fontman.h"
+#include "graphics/palette_usage.h"
 #include "graphics/scaler.h"
 #include "graphics/scaler/aspect.h"
 #include "graphics/surface.h"
@@ -160,8 +163,8 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_mouseData(nullptr), _mouseSurface(nullptr),
 	_mouseOrigSurface(nullptr), _cursorDontScale(false), _cursorPaletteDisabled(true),
 	_currentShakeXOffset(0), _currentShakeYOffset(0),
-	_paletteDirtyStart(0), _paletteDirtyEnd(0),
-	_screenIsLocked(false),
+	_paletteDirtyStart(0), _paletteDirtyEnd(0), _paletteChangedAny(false),
+	_scalerJobs(nullptr), _screenIsLocked(false),
 	_displayDisabled(false),
 #ifdef USE_SDL_DEBUG_FOCUSRECT
 	_enableFocusRectDebugCode(false), _enableFocusRect(false), _focusRect(),
@@ -171,6 +174,7 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	// allocate palette storage
 	_currentPalette = (SDL_Color *)calloc(sizeof(SDL_Color), 256);
 	_cursorPalette = (SDL_Color *)calloc(sizeof(SDL_Color), 256);
+	memset(_paletteChanged, 0, sizeof(_paletteChanged));
 
 	_mouseBackup.x = _mouseBackup.y = _mouseBackup.w = _mouseBackup.h = 0;
 
@@ -201,6 +205,11 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 }
 
 SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
+	const Graphics::DirtyRegion::Stats &stats = _dirtyRegion.getStats();
+	if (stats.frames)
+		debug(1, "Screen updates: %u frames, %u full, %u rects, %u pixels scaled per frame on average, %u at most",
+			stats.frames, stats.fullFrames, stats.rects, (uint32)(stats.pixels / stats.frames), stats.maxPixels);
+
 	unloadGFXMode();
 	if (_mouseOrigSurface) {
 		SDL_FreeSurface(_mouseOrigSurface);
@@ -214,6 +223,7 @@ SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
 	free(_currentPalette);
 	free(_cursorPalette);
 	delete[] _mouseData;
+	delete _scalerJobs;
 }
 
 bool SurfaceSdlGraphicsManager::hasFeature(OSystem::Feature f) const {
@@ -1189,9 +1199,11 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 			_paletteDirtyStart,
 			_paletteDirtyEnd - _paletteDirtyStart);
 
+		_paletteDirtyStart = 256;
 		_paletteDirtyEnd = 0;
 
-		_forceRedraw = true;
+		if (_paletteChangedAny)
+			addPaletteDirtyRects();
 	}
 
 	if (!_overlayVisible) {
@@ -1222,23 +1234,16 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 	updateOSD();
 #endif
 
-	// Force a full redraw if requested
-	if (_forceRedraw) {
-		_numDirtyRects = 1;
-		_dirtyRectList[0].x = 0;
-		_dirtyRectList[0].y = 0;
-		_dirtyRectList[0].w = width;
-		_dirtyRectList[0].h = height;
-	}
+	prepareDirtyRects(width, height);
 
 	// Only draw anything if necessary
-	if (_numDirtyRects > 0 || _cursorNeedsRedraw) {
+	if (!_dirtyRectList.empty() || _cursorNeedsRedraw) {
 		SDL_Rect *r;
 		SDL_Rect dst;
 		uint32 srcPitch, dstPitch;
-		SDL_Rect *lastRect = _dirtyRectList + _numDirtyRects;
+		SDL_Rect *lastRect = _dirtyRectList.begin() + _dirtyRectList.size();
 
-		for (r = _dirtyRectList; r != lastRect; ++r) {
+		for (r = _dirtyRectList.begin(); r != lastRect; ++r) {
 			dst = *r;
 			dst.x++;	// Shift rect by one since 2xSai needs to access the data around
 			dst.y++;	// any pixel to scale it, and we want to avoid mem access crashes.
@@ -1253,7 +1258,8 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		srcPitch = srcSurf->pitch;
 		dstPitch = _hwScreen->pitch;
 
-		for (r = _dirtyRectList; r != lastRect; ++r) {
+		for (r = _dirtyRectList.begin(); r != lastRect; ++r) {
+			FRAME_STATS_SCOPE(kFrameStageScale);
 			int dst_x = r->x + _currentShakeXOffset;
 			int dst_y = r->y + _currentShakeYOffset;
 			int dst_w = 0;
@@ -1281,8 +1287,16 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 					dst_y = real2Aspect(dst_y);
 
 				assert(scalerProc != NULL);
-				scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
-					(byte *)_hwScreen->pixels + dst_x * 2 + dst_y * dstPitch, dstPitch, dst_w, dst_h);
+				const byte *srcPtr = (byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch;
+				byte *dstPtr = (byte *)_hwScreen->pixels + dst_x * 2 + dst_y * dstPitch;
+				FRAME_STATS_PIXELS(kFrameStageScale, dst_w * dst_h);
+				if (scale1 > 1 && dst_w * dst_h >= MIN_PARALLEL_SCALE_AREA) {
+					if (!_scalerJobs)
+						_scalerJobs = new Common::JobQueue();
+					ScaleInBands(*_scalerJobs, scalerProc, scale1, srcPtr, srcPitch, dstPtr, dstPitch, dst_w, dst_h);
+				} else {
+					scalerProc(srcPtr, srcPitch, dstPtr, dstPitch, dst_w, dst_h);
+				}
 			}
 
 			r->x = dst_x;
@@ -1392,11 +1406,12 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 
 		// Finally, blit all our changes to the screen
 		if (!_displayDisabled) {
-			SDL_UpdateRects(_hwScreen, _numDirtyRects, _dirtyRectList);
+			FRAME_STATS_SCOPE(kFrameStagePresent);
+			SDL_UpdateRects(_hwScreen, _dirtyRectList.size(), _dirtyRectList.begin());
 		}
 	}
 
-	_numDirtyRects = 0;
+	_dirtyRectList.clear();
 	_forceRedraw = false;
 	_cursorNeedsRedraw = false;
 }
@@ -1557,11 +1572,6 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 	if (_forceRedraw)
 		return;
 
-	if (_numDirtyRects == NUM_DIRTY_RECT) {
-		_forceRedraw = true;
-		return;
-	}
-
 	int height, width;
 
 	if (!_overlayVisible && !realCoordinates) {
@@ -1610,14 +1620,67 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 		return;
 	}
 
-	if (w > 0 && h > 0) {
-		SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
+	if (w <= 0 || h <= 0)
+		return;
+
+	if (realCoordinates) {
+		// Added while updating, after the scaled rects have been computed
+		SDL_Rect r;
+		r.x = x;
+		r.y = y;
+		r.w = w;
+		r.h = h;
+		_dirtyRectList.push_back(r);
+		return;
+	}
+
+	// The region merges nearby rects, so small changes never force a
+	// redraw of the whole screen
+	_dirtyRegion.setBounds(Common::Rect(width, height));
+	_dirtyRegion.addRect(Common::Rect(x, y, x + w, y + h));
+	if (_dirtyRegion.isFull())
+		_forceRedraw = true;
+}
+
+void SurfaceSdlGraphicsManager::prepareDirtyRects(int width, int height) {
+	// Force a full redraw if requested
+	if (_forceRedraw) {
+		_dirtyRegion.setBounds(Common::Rect(width, height));
+		_dirtyRegion.addAll();
+	}
+
+	const Common::Array<Common::Rect> &rects = _dirtyRegion.getRects();
+	_dirtyRectList.resize(rects.size());
+	for (uint i = 0; i < rects.size(); ++i) {
+		_dirtyRectList[i].x = rects[i].left;
+		_dirtyRectList[i].y = rects[i].top;
+		_dirtyRectList[i].w = rects[i].width();
+		_dirtyRectList[i].h = rects[i].height();
+	}
 
-		r->x = x;
-		r->y = y;
-		r->w = w;
-		r->h = h;
+	_dirtyRegion.clear();
+}
+
+void SurfaceSdlGraphicsManager::addPaletteDirtyRects() {
+	// Palette cycling usually touches a small part of the screen. Finding
+	// it is much cheaper than running the scaler over the whole screen.
+	if (_overlayVisible || _screen->format->BytesPerPixel != 1) {
+		_forceRedraw = true;
+	} else if (!_forceRedraw) {
+		SDL_LockSurface(_screen);
+		Graphics::findPaletteUsage((const byte *)_screen->pixels, _screen->pitch,
+			_videoMode.screenWidth, _videoMode.screenHeight, _paletteChanged,
+			MAX(8, _videoMode.screenHeight / 32), _paletteUsage);
+		SDL_UnlockSurface(_screen);
+
+		for (uint i = 0; i < _paletteUsage.size(); ++i) {
+			const Common::Rect &r = _paletteUsage[i];
+			addDirtyRect(r.left, r.top, r.width(), r.height());
+		}
 	}
+
+	memset(_paletteChanged, 0, sizeof(_paletteChanged));
+	_paletteChangedAny = false;
 }
 
 int16 SurfaceSdlGraphicsManager::getHeight() const {
@@ -1643,6 +1706,11 @@ void SurfaceSdlGraphicsManager::setPalette(const byte *colors, uint start, uint
 	uint i;
 	SDL_Color *base = _currentPalette + start;
 	for (i = 0; i < num; i++, b += 3) {
+		if (base[i].r != b[0] || base[i].g != b[1] || base[i].b != b[2]) {
+			_paletteChanged[start + i] = true;
+			_paletteChangedAny = true;
+		}
+
 		base[i].r = b[0];
 		base[i].g = b[1];
 		base[i].b = b[2];
@@ -2154,6 +2222,8 @@ void SurfaceSdlGraphicsManager::undrawMouse() {
 }
 
 void SurfaceSdlGraphicsManager::drawMouse() {
+	FRAME_STATS_SCOPE(kFrameStageCursor);
+
 	if (!_cursorVisible || !_mouseSurface || !_mouseCurState.w || !_mouseCurState.h) {
 		_mouseBackup.x = _mouseBackup.y = _mouseBackup.w = _mouseBackup.h = 0;
 		return;
@@ -2209,6 +2279,7 @@ void SurfaceSdlGraphicsManager::drawMouse() {
 
 	if (SDL_BlitSurface(_mouseSurface, nullptr, _hwScreen, &dst) != 0)
 		error("SDL_BlitSurface failed: %s", SDL_GetError());
+	FRAME_STATS_PIXELS(kFrameStageCursor, dst.w * dst.h);
 
 	// The screen will be updated using real surface coordinates, i.e.
 	// they will not be scaled or aspect-ratio corrected.
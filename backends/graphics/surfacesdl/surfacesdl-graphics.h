@@ -25,9 +25,12 @@
 
 #include "backends/graphics/graphics.h"
 #include "backends/graphics/sdl/sdl-graphics.h"
+#include "graphics/dirty_region.h"
 #include "graphics/pixelformat.h"
 #include "graphics/scaler.h"
+#include "common/array.h"
 #include "common/events.h"
+#include "common/jobqueue.h"
 #include "common/mutex.h"
 
 #include "backends/events/sdl/sdl-events.h"
@@ -336,13 +339,19 @@ protected:
 	int _screenChangeCount;
 
 	enum {
-		NUM_DIRTY_RECT = 100,
-		MAX_SCALING = 3
+		MAX_SCALING = 3,
+		// Smallest dirty rect, in pixels, scaled on several threads
+		MIN_PARALLEL_SCALE_AREA = 64 * 64
 	};
 
-	// Dirty rect management
-	SDL_Rect _dirtyRectList[NUM_DIRTY_RECT];
-	int _numDirtyRects;
+	// Dirty rect management. Changes to the game screen or the overlay are
+	// collected in _dirtyRegion, in their own coordinates. An update turns
+	// them into _dirtyRectList, which ends up in hardware coordinates.
+	Graphics::DirtyRegion _dirtyRegion;
+	Common::Array<SDL_Rect> _dirtyRectList;
+
+	// Worker threads scaling large dirty rects in bands, created on first use
+	Common::JobQueue *_scalerJobs;
 
 	struct MousePos {
 		// The size and hotspot of the original cursor image.
@@ -390,6 +399,12 @@ protected:
 	SDL_Color *_currentPalette;
 	uint _paletteDirtyStart, _paletteDirtyEnd;
 
+	// Palette entries whose color changed since the last screen update.
+	// Only the parts of the screen showing them need to be redrawn.
+	bool _paletteChanged[256];
+	bool _paletteChangedAny;
+	Common::Array<Common::Rect> _paletteUsage;
+
 	// Cursor palette data
 	SDL_Color *_cursorPalette;
 
@@ -406,6 +421,8 @@ protected:
 #endif
 
 	virtual void addDirtyRect(int x, int y, int w, int h, bool realCoordinates = false);
+	void addPaletteDirtyRects();
+	void prepareDirtyRects(int width, int height);
 
 	virtual void drawMouse();
 	virtual void undrawMouse();
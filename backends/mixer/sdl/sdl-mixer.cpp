@@ -113,6 +113,14 @@ void SdlMixerManager::init() {
 
 	_mixer = new Audio::MixerImpl(_obtained.freq);
 	assert(_mixer);
+
+	// Advanced users may trade CPU time for less aliasing on low rate game
+	// audio by setting "audio_resampler=polyphase" in their config file.
+	if (ConfMan.hasKey("audio_resampler") && ConfMan.get("audio_resampler") == "polyphase") {
+		debug(1, "Using polyphase rate converter");
+		_mixer->setRateConverterQuality(Audio::kRateConverterPolyphase);
+	}
+
 	_mixer->setReady(true);
 
 	startAudio();
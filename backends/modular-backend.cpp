@@ -28,6 +28,7 @@
 #include "backends/mutex/mutex.h"
 #include "gui/EventRecorder.h"
 
+#include "common/framestats.h"
 #include "common/timer.h"
 #include "graphics/pixelformat.h"
 
@@ -156,6 +157,8 @@ PaletteManager *ModularGraphicsBackend::getPaletteManager() {
 }
 
 void ModularGraphicsBackend::copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {
+	FRAME_STATS_SCOPE(kFrameStageCopyRect);
+	FRAME_STATS_PIXELS(kFrameStageCopyRect, w * h);
 	_graphicsManager->copyRectToScreen(buf, pitch, x, y, w, h);
 }
 
@@ -176,7 +179,11 @@ void ModularGraphicsBackend::updateScreen() {
 	g_eventRec.preDrawOverlayGui();
 #endif
 
-	_graphicsManager->updateScreen();
+	{
+		FRAME_STATS_SCOPE(kFrameStageUpdate);
+		_graphicsManager->updateScreen();
+	}
+	FRAME_STATS_END_FRAME();
 
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.postDrawOverlayGui();
@@ -194,6 +201,30 @@ void ModularGraphicsBackend::clearFocusRectangle() {
 	_graphicsManager->clearFocusRectangle();
 }
 
+Graphics::PixelFormat ModularGraphicsBackend::getSpriteFormat() const {
+	return _graphicsManager->getSpriteFormat();
+}
+
+uint32 ModularGraphicsBackend::createSprite(uint width, uint height) {
+	return _graphicsManager->createSprite(width, height);
+}
+
+void ModularGraphicsBackend::destroySprite(uint32 sprite) {
+	_graphicsManager->destroySprite(sprite);
+}
+
+void ModularGraphicsBackend::copyRectToSprite(uint32 sprite, const void *buf, int pitch, int x, int y, int w, int h) {
+	_graphicsManager->copyRectToSprite(sprite, buf, pitch, x, y, w, h);
+}
+
+void ModularGraphicsBackend::drawSprite(uint32 sprite, int x, int y, int w, int h, uint32 color) {
+	_graphicsManager->drawSprite(sprite, x, y, w, h, color);
+}
+
+void ModularGraphicsBackend::clearSprites() {
+	_graphicsManager->clearSprites();
+}
+
 void ModularGraphicsBackend::showOverlay() {
 	_graphicsManager->showOverlay();
 }
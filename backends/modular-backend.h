@@ -100,6 +100,13 @@ public:
 	virtual void setFocusRectangle(const Common::Rect& rect) override final;
 	virtual void clearFocusRectangle() override final;
 
+	virtual Graphics::PixelFormat getSpriteFormat() const override final;
+	virtual uint32 createSprite(uint width, uint height) override final;
+	virtual void destroySprite(uint32 sprite) override final;
+	virtual void copyRectToSprite(uint32 sprite, const void *buf, int pitch, int x, int y, int w, int h) override final;
+	virtual void drawSprite(uint32 sprite, int x, int y, int w, int h, uint32 color = 0xFFFFFFFF) override final;
+	virtual void clearSprites() override final;
+
 	virtual void showOverlay() override final;
 	virtual void hideOverlay() override final;
 	virtual Graphics::PixelFormat getOverlayFormat() const override final;
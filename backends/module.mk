@@ -126,6 +126,7 @@ MODULE_OBJS += \
 	graphics/opengl/framebuffer.o \
 	graphics/opengl/opengl-graphics.o \
 	graphics/opengl/shader.o \
+	graphics/opengl/sprite-atlas.o \
 	graphics/opengl/texture.o \
 	graphics/opengl/pipelines/clut8.o \
 	graphics/opengl/pipelines/fixed.o \
@@ -145,6 +146,7 @@ MODULE_OBJS += \
 	mixer/sdl/sdl-mixer.o \
 	mutex/sdl/sdl-mutex.o \
 	plugins/sdl/sdl-provider.o \
+	threads/sdl/sdl-threads.o \
 	timer/sdl/sdl-timer.o
 
 # SDL 2 removed audio CD support
@@ -176,6 +178,7 @@ MODULE_OBJS += \
 	plugins/posix/posix-provider.o \
 	saves/posix/posix-saves.o \
 	taskbar/unity/unity-taskbar.o \
+	threads/pthread/pthread-threads.o \
 	dialogs/gtk/gtk-dialogs.o
 
 ifdef USE_SPEECH_DISPATCHER
@@ -46,6 +46,7 @@
 #include "backends/events/default/default-events.h"
 #include "backends/mixer/null/null-mixer.h"
 #include "backends/mutex/null/null-mutex.h"
+#include "backends/threads/pthread/pthread-threads.h"
 #include "backends/graphics/null/null-graphics.h"
 #include "audio/mixer_intern.h"
 #include "common/scummsys.h"
@@ -76,6 +77,7 @@ public:
 	virtual bool pollEvent(Common::Event &event);
 
 	virtual uint32 getMillis(bool skipRecord = false);
+	virtual uint64 getMicros();
 	virtual void delayMillis(uint msecs);
 	virtual void getTimeAndDate(TimeDate &t) const;
 
@@ -127,6 +129,9 @@ void OSystem_NULL::initBackend() {
 #endif
 
 	_mutexManager = new NullMutexManager();
+#ifdef POSIX
+	_threadManager = new PthreadThreadManager();
+#endif
 	_timerManager = new DefaultTimerManager();
 	_eventManager = new DefaultEventManager(this);
 	_savefileManager = new DefaultSaveFileManager();
@@ -176,6 +181,18 @@ uint32 OSystem_NULL::getMillis(bool skipRecord) {
 #endif
 }
 
+uint64 OSystem_NULL::getMicros() {
+#ifdef POSIX
+	timeval curTime;
+
+	gettimeofday(&curTime, 0);
+
+	return (uint64)(curTime.tv_sec - _startTime.tv_sec) * 1000000 + (curTime.tv_usec - _startTime.tv_usec);
+#else
+	return OSystem::getMicros();
+#endif
+}
+
 void OSystem_NULL::delayMillis(uint msecs) {
 #ifdef POSIX
 	usleep(msecs * 1000);
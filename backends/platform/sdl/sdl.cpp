@@ -47,6 +47,7 @@
 #include "backends/events/sdl/legacy-sdl-events.h"
 #include "backends/keymapper/hardware-input.h"
 #include "backends/mutex/sdl/sdl-mutex.h"
+#include "backends/threads/sdl/sdl-threads.h"
 #include "backends/timer/sdl/sdl-timer.h"
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
 #ifdef USE_OPENGL
@@ -126,6 +127,8 @@ OSystem_SDL::~OSystem_SDL() {
 #endif
 
 	_timerManager = 0;
+	delete _threadManager;
+	_threadManager = 0;
 	delete _mutexManager;
 	_mutexManager = 0;
 
@@ -161,6 +164,9 @@ void OSystem_SDL::init() {
 	if (_mutexManager == 0)
 		_mutexManager = new SdlMutexManager();
 
+	if (_threadManager == 0)
+		_threadManager = new SdlThreadManager();
+
 	if (_window == 0)
 		_window = new SdlWindow();
 
@@ -524,6 +530,16 @@ uint32 OSystem_SDL::getMillis(bool skipRecord) {
 	return millis;
 }
 
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+uint64 OSystem_SDL::getMicros() {
+	static const Uint64 frequency = SDL_GetPerformanceFrequency();
+	const Uint64 counter = SDL_GetPerformanceCounter();
+
+	// Split the conversion so that it does not overflow
+	return (counter / frequency) * 1000000 + (counter % frequency) * 1000000 / frequency;
+}
+#endif
+
 void OSystem_SDL::delayMillis(uint msecs) {
 #ifdef ENABLE_EVENTRECORDER
 	if (!g_eventRec.processDelayMillis())
@@ -0,0 +1,169 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
+
+#include "common/scummsys.h"
+
+#if defined(POSIX)
+
+#include "backends/threads/pthread/pthread-threads.h"
+#include "common/textconsole.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+namespace {
+
+struct PthreadThread {
+	pthread_t thread;
+	Common::ThreadManager::ThreadProc proc;
+	void *param;
+};
+
+// Unnamed POSIX semaphores are not available everywhere (most notably
+// not on macOS), so build them from a mutex and a condition variable.
+struct PthreadSemaphore {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	uint value;
+};
+
+void *threadEntry(void *arg) {
+	PthreadThread *thread = (PthreadThread *)arg;
+	thread->proc(thread->param);
+	return nullptr;
+}
+
+} // End of anonymous namespace
+
+uint PthreadThreadManager::getCPUCount() {
+#ifdef _SC_NPROCESSORS_ONLN
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	if (count > 1)
+		return (uint)count;
+#endif
+	return 1;
+}
+
+Common::ThreadManager::ThreadRef PthreadThreadManager::createThread(ThreadProc proc, void *param) {
+	PthreadThread *thread = new PthreadThread;
+	thread->proc = proc;
+	thread->param = param;
+
+	if (pthread_create(&thread->thread, nullptr, threadEntry, thread) != 0) {
+		warning("pthread_create() failed");
+		delete thread;
+		return nullptr;
+	}
+
+	return (ThreadRef)thread;
+}
+
+void PthreadThreadManager::joinThread(ThreadRef thread) {
+	PthreadThread *t = (PthreadThread *)thread;
+
+	if (pthread_join(t->thread, nullptr) != 0)
+		warning("pthread_join() failed");
+	delete t;
+}
+
+Common::ThreadManager::MutexRef PthreadThreadManager::createMutex() {
+	pthread_mutex_t *mutex = new pthread_mutex_t;
+
+	if (pthread_mutex_init(mutex, nullptr) != 0) {
+		warning("pthread_mutex_init() failed");
+		delete mutex;
+		return nullptr;
+	}
+
+	return (MutexRef)mutex;
+}
+
+void PthreadThreadManager::lockMutex(MutexRef mutex) {
+	if (pthread_mutex_lock((pthread_mutex_t *)mutex) != 0)
+		warning("pthread_mutex_lock() failed");
+}
+
+void PthreadThreadManager::unlockMutex(MutexRef mutex) {
+	if (pthread_mutex_unlock((pthread_mutex_t *)mutex) != 0)
+		warning("pthread_mutex_unlock() failed");
+}
+
+void PthreadThreadManager::deleteMutex(MutexRef mutex) {
+	pthread_mutex_t *m = (pthread_mutex_t *)mutex;
+
+	if (pthread_mutex_destroy(m) != 0)
+		warning("pthread_mutex_destroy() failed");
+	else
+		delete m;
+}
+
+Common::ThreadManager::SemaphoreRef PthreadThreadManager::createSemaphore(uint initialValue) {
+	PthreadSemaphore *sem = new PthreadSemaphore;
+	sem->value = initialValue;
+
+	if (pthread_mutex_init(&sem->mutex, nullptr) != 0) {
+		warning("pthread_mutex_init() failed");
+		delete sem;
+		return nullptr;
+	}
+
+	if (pthread_cond_init(&sem->cond, nullptr) != 0) {
+		warning("pthread_cond_init() failed");
+		pthread_mutex_destroy(&sem->mutex);
+		delete sem;
+		return nullptr;
+	}
+
+	return (SemaphoreRef)sem;
+}
+
+void PthreadThreadManager::waitSemaphore(SemaphoreRef sem) {
+	PthreadSemaphore *s = (PthreadSemaphore *)sem;
+
+	pthread_mutex_lock(&s->mutex);
+	while (s->value == 0)
+		pthread_cond_wait(&s->cond, &s->mutex);
+	s->value--;
+	pthread_mutex_unlock(&s->mutex);
+}
+
+void PthreadThreadManager::postSemaphore(SemaphoreRef sem) {
+	PthreadSemaphore *s = (PthreadSemaphore *)sem;
+
+	pthread_mutex_lock(&s->mutex);
+	s->value++;
+	pthread_cond_signal(&s->cond);
+	pthread_mutex_unlock(&s->mutex);
+}
+
+void PthreadThreadManager::deleteSemaphore(SemaphoreRef sem) {
+	PthreadSemaphore *s = (PthreadSemaphore *)sem;
+
+	pthread_cond_destroy(&s->cond);
+	pthread_mutex_destroy(&s->mutex);
+	delete s;
+}
+
+#endif
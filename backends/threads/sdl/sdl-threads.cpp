@@ -0,0 +1,113 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/threads/sdl/sdl-threads.h"
+#include "backends/platform/sdl/sdl-sys.h"
+#include "common/textconsole.h"
+
+namespace {
+
+struct SdlThread {
+	SDL_Thread *thread;
+	Common::ThreadManager::ThreadProc proc;
+	void *param;
+};
+
+int SDLCALL threadEntry(void *arg) {
+	SdlThread *thread = (SdlThread *)arg;
+	thread->proc(thread->param);
+	return 0;
+}
+
+} // End of anonymous namespace
+
+uint SdlThreadManager::getCPUCount() {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	const int count = SDL_GetCPUCount();
+	if (count > 1)
+		return (uint)count;
+#endif
+	return 1;
+}
+
+Common::ThreadManager::ThreadRef SdlThreadManager::createThread(ThreadProc proc, void *param) {
+	SdlThread *thread = new SdlThread;
+	thread->proc = proc;
+	thread->param = param;
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	thread->thread = SDL_CreateThread(threadEntry, "ScummVM worker", thread);
+#else
+	thread->thread = SDL_CreateThread(threadEntry, thread);
+#endif
+	if (!thread->thread) {
+		warning("SDL_CreateThread() failed: %s", SDL_GetError());
+		delete thread;
+		return nullptr;
+	}
+
+	return (ThreadRef)thread;
+}
+
+void SdlThreadManager::joinThread(ThreadRef thread) {
+	SdlThread *t = (SdlThread *)thread;
+	SDL_WaitThread(t->thread, nullptr);
+	delete t;
+}
+
+Common::ThreadManager::MutexRef SdlThreadManager::createMutex() {
+	return (MutexRef)SDL_CreateMutex();
+}
+
+void SdlThreadManager::lockMutex(MutexRef mutex) {
+	SDL_mutexP((SDL_mutex *)mutex);
+}
+
+void SdlThreadManager::unlockMutex(MutexRef mutex) {
+	SDL_mutexV((SDL_mutex *)mutex);
+}
+
+void SdlThreadManager::deleteMutex(MutexRef mutex) {
+	SDL_DestroyMutex((SDL_mutex *)mutex);
+}
+
+Common::ThreadManager::SemaphoreRef SdlThreadManager::createSemaphore(uint initialValue) {
+	return (SemaphoreRef)SDL_CreateSemaphore(initialValue);
+}
+
+void SdlThreadManager::waitSemaphore(SemaphoreRef sem) {
+	SDL_SemWait((SDL_sem *)sem);
+}
+
+void SdlThreadManager::postSemaphore(SemaphoreRef sem) {
+	SDL_SemPost((SDL_sem *)sem);
+}
+
+void SdlThreadManager::deleteSemaphore(SemaphoreRef sem) {
+	SDL_DestroySemaphore((SDL_sem *)sem);
+}
+
+#endif
@@ -0,0 +1,49 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_THREADS_SDL_H
+#define BACKENDS_THREADS_SDL_H
+
+#include "common/thread.h"
+
+/**
+ * SDL based thread manager.
+ */
+class SdlThreadManager : public Common::ThreadManager {
+public:
+	virtual uint getCPUCount();
+
+	virtual ThreadRef createThread(ThreadProc proc, void *param);
+	virtual void joinThread(ThreadRef thread);
+
+	virtual MutexRef createMutex();
+	virtual void lockMutex(MutexRef mutex);
+	virtual void unlockMutex(MutexRef mutex);
+	virtual void deleteMutex(MutexRef mutex);
+
+	virtual SemaphoreRef createSemaphore(uint initialValue);
+	virtual void waitSemaphore(SemaphoreRef sem);
+	virtual void postSemaphore(SemaphoreRef sem);
+	virtual void deleteSemaphore(SemaphoreRef sem);
+};
+
+#endif
@@ -27,6 +27,7 @@
 
 #include <limits.h>
 
+#include "engines/detectioncache.h"
 #include "engines/metaengine.h"
 #include "base/commandLine.h"
 #include "base/plugins.h"
@@ -82,6 +83,10 @@ static const char HELP_STRING[] =
 	"  --auto-detect            Display a list of games from current or specified directory\n"
 	"                           and start the first one. Use --path=PATH to specify a directory.\n"
 	"  --recursive              In combination with --add or --detect recurse down all subdirectories\n"
+	"  --bench-detector         Run detection on the current or specified directory three\n"
+	"                           times: without the detection cache, with an empty one and\n"
+	"                           with the filled one. Report how long each run took, how many\n"
+	"                           files were hashed and how many were served from the cache\n"
 #if defined(WIN32) && !defined(__SYMBIAN32__)
 	"  --console                Enable the console window (default:enabled)\n"
 #endif
@@ -243,6 +248,8 @@ void registerDefaults() {
 	ConfMan.registerDefault("dump_midi", false);
 	ConfMan.registerDefault("enable_gs", false);
 	ConfMan.registerDefault("midi_gain", 100);
+	ConfMan.registerDefault("midi_prerender", false);
+	ConfMan.registerDefault("midi_prerender_latency", 100);
 
 	ConfMan.registerDefault("music_driver", "auto");
 	ConfMan.registerDefault("mt32_device", "null");
@@ -285,6 +292,8 @@ void registerDefaults() {
 #endif
 
 	// Miscellaneous
+	ConfMan.registerDefault("detection_cache", true);
+	ConfMan.registerDefault("directory_cache", false);
 	ConfMan.registerDefault("joystick_num", 0);
 	ConfMan.registerDefault("confirm_exit", false);
 	ConfMan.registerDefault("disable_sdl_parachute", false);
@@ -530,6 +539,9 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_COMMAND("auto-detect")
 			END_COMMAND
 
+			DO_LONG_COMMAND("bench-detector")
+			END_COMMAND
+
 #ifdef DETECTOR_TESTING_HACK
 			// HACK FIXME TODO: This command is intentionally *not* documented!
 			DO_LONG_COMMAND("test-detector")
@@ -1012,6 +1024,7 @@ static Common::String detectGames(const Common::String &path, const Common::Stri
 	//Current directory
 	Common::FSNode dir(path);
 	DetectedGames candidates = recListGames(dir, engineId, gameId, recursive);
+	DetectionCacheMan.flush(true);
 
 	if (candidates.empty()) {
 		printf("WARNING: ScummVM could not find any game in %s\n", dir.getPath().c_str());
@@ -1080,6 +1093,7 @@ static bool addGames(const Common::String &path, const Common::String &engineId,
 	//Current directory
 	Common::FSNode dir(path);
 	int added = recAddGames(dir, engineId, gameId, recursive);
+	DetectionCacheMan.flush(true);
 	printf("Added %d games\n", added);
 	if (added == 0 && !recursive) {
 		printf("Consider using --recursive to search inside subdirectories\n");
@@ -1087,6 +1101,32 @@ static bool addGames(const Common::String &path, const Common::String &engineId,
 	ConfMan.flushToDisk();
 	return true;
 }
+/** Time detection of the given directory without the detection cache, then with a cold and a warm one */
+static void benchDetector(const Common::String &path, bool recursive) {
+	static const char *const runNames[] = { "Uncached:  ", "Cold cache:", "Warm cache:" };
+	Common::FSNode dir(path);
+	uint games = 0;
+
+	// The cold run starts from an empty cache, also dropping the entries of
+	// earlier scans, and fills it, so that the warm one measures a repeated
+	// scan of unchanged files
+	for (int run = 0; run < ARRAYSIZE(runNames); run++) {
+		DetectionCacheMan.setEnabled(run != 0);
+		DetectionCacheMan.resetStats();
+		if (run == 1)
+			DetectionCacheMan.clear();
+
+		const uint32 start = g_system->getMillis();
+		games = recListGames(dir, "", "", recursive).size();
+		DetectionCacheMan.flush(true);
+		const uint32 time = g_system->getMillis() - start;
+
+		printf("%s %u ms, %u files hashed, %u files served from cache\n", runNames[run], time,
+		       DetectionCacheMan.getHashedCount(), DetectionCacheMan.getCachedCount());
+	}
+
+	printf("Detected %u games in %s\n", games, dir.getPath().c_str());
+}
 
 #ifdef DETECTOR_TESTING_HACK
 static void runDetectorTest() {
@@ -1355,6 +1395,9 @@ bool processSettings(Common::String &command, Common::StringMap &settings, Commo
 	} else if (command == "add") {
 		addGames(settings["path"], gameOption.engineId, gameOption.gameId, settings["recursive"] == "true");
 		return true;
+	} else if (command == "bench-detector") {
+		benchDetector(settings["path"], settings["recursive"] == "true");
+		return true;
 	}
 #ifdef DETECTOR_TESTING_HACK
 	else if (command == "test-detector") {
@@ -43,6 +43,7 @@
 #include "common/debug-channels.h" /* for debug manager */
 #include "common/events.h"
 #include "gui/EventRecorder.h"
+#include "common/framestats.h"
 #include "common/fs.h"
 #ifdef ENABLE_EVENTRECORDER
 #include "common/recorderfile.h"
@@ -659,6 +660,9 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	Common::ConfigManager::destroy();
 	Common::DebugManager::destroy();
 	Common::OSDMessageQueue::destroy();
+#ifdef ENABLE_FRAME_STATS
+	Common::FrameStats::destroy();
+#endif
 #ifdef ENABLE_EVENTRECORDER
 	GUI::EventRecorder::destroy();
 #endif
@@ -25,6 +25,7 @@
 #include "common/func.h"
 #include "common/debug.h"
 #include "common/config-manager.h"
+#include "common/jobqueue.h"
 
 #ifdef DYNAMIC_MODULES
 #include "common/fs.h"
@@ -476,6 +477,7 @@ void PluginManager::addToPluginsInMemList(Plugin *plugin) {
 
 // Engine plugins
 
+#include "engines/detectioncache.h"
 #include "engines/metaengine.h"
 
 namespace Common {
@@ -537,28 +539,71 @@ QualifiedGameList EngineManager::findGameInLoadedPlugins(const Common::String &g
 }
 
 DetectionResults EngineManager::detectGames(const Common::FSList &fslist) const {
-	DetectedGames candidates;
-	PluginList plugins;
-	PluginList::const_iterator iter;
-	PluginMan.loadFirstPlugin();
-	do {
-		plugins = getPlugins();
-		// Iterate over all known games and for each check if it might be
-		// the game in the presented directory.
-		for (iter = plugins.begin(); iter != plugins.end(); ++iter) {
+	Common::Array<Common::FSList> fslists;
+	fslists.push_back(fslist);
+	return detectGames(fslists).front();
+}
+
+namespace {
+
+/** The directories detectDirectories() works on, with the plugins loaded at the moment */
+struct DetectionJob {
+	const PluginList *plugins;
+	const Common::Array<Common::FSList> *fslists;
+	Common::Array<DetectedGames> *candidates;
+};
+
+void detectDirectories(uint begin, uint end, void *param) {
+	const DetectionJob *job = (const DetectionJob *)param;
+
+	// Iterate over all known games and for each check if it might be
+	// the game in one of the presented directories.
+	for (uint i = begin; i < end; i++) {
+		const Common::FSList &fslist = (*job->fslists)[i];
+
+		for (PluginList::const_iterator iter = job->plugins->begin(); iter != job->plugins->end(); ++iter) {
 			const MetaEngine &metaEngine = (*iter)->get<MetaEngine>();
 			DetectedGames engineCandidates = metaEngine.detectGames(fslist);
 
-			for (uint i = 0; i < engineCandidates.size(); i++) {
-				engineCandidates[i].path = fslist.begin()->getParent().getPath();
-				engineCandidates[i].shortPath = fslist.begin()->getParent().getDisplayName();
-				candidates.push_back(engineCandidates[i]);
+			for (uint j = 0; j < engineCandidates.size(); j++) {
+				engineCandidates[j].path = fslist.begin()->getParent().getPath();
+				engineCandidates[j].shortPath = fslist.begin()->getParent().getDisplayName();
+				(*job->candidates)[i].push_back(engineCandidates[j]);
 			}
-
 		}
+	}
+}
+
+} // End of anonymous namespace
+
+Common::Array<DetectionResults> EngineManager::detectGames(const Common::Array<Common::FSList> &fslists, Common::JobQueue *jobs) const {
+	Common::Array<DetectedGames> candidates;
+	candidates.resize(fslists.size());
+	PluginList plugins;
+
+	DetectionJob job;
+	job.plugins = &plugins;
+	job.fslists = &fslists;
+	job.candidates = &candidates;
+
+	PluginMan.loadFirstPlugin();
+	do {
+		plugins = getPlugins();
+
+		// Directories take very different times, so each is a job of its own
+		if (jobs)
+			jobs->parallelFor(0, fslists.size(), 1, detectDirectories, &job);
+		else
+			detectDirectories(0, fslists.size(), &job);
 	} while (PluginMan.loadNextPlugin());
 
-	return DetectionResults(candidates);
+	DetectionCacheMan.flush();
+
+	Common::Array<DetectionResults> results;
+	for (uint i = 0; i < candidates.size(); i++)
+		results.push_back(DetectionResults(candidates[i]));
+
+	return results;
 }
 
 const PluginList &EngineManager::getPlugins() const {
@@ -21,6 +21,7 @@
  */
 
 #include "common/archive.h"
+#include "common/atomic.h"
 #include "common/fs.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -40,6 +41,18 @@ SeekableReadStream *GenericArchiveMember::createReadStream() const {
 }
 
 
+volatile uint32 Archive::_indexGeneration = 0;
+
+uint32 Archive::getIndexGeneration() {
+	return atomicLoad(_indexGeneration);
+}
+
+void Archive::bumpIndexGeneration() {
+	// Archives may finish on different threads; a lost increment still
+	// changes the value, which is all that readers look at.
+	atomicStore(_indexGeneration, _indexGeneration + 1);
+}
+
 int Archive::listMatchingMembers(ArchiveMemberList &list, const String &pattern) const {
 	// Get all "names" (TODO: "files" ?)
 	ArchiveMemberList allNames;
@@ -92,6 +105,7 @@ void SearchSet::insert(const Node &node) {
 			break;
 	}
 	_list.insert(it, node);
+	invalidateIndex();
 }
 
 void SearchSet::add(const String &name, Archive *archive, int priority, bool autoFree) {
@@ -170,6 +184,7 @@ void SearchSet::addSubDirectoriesMatching(const FSNode &directory, String origPa
 void SearchSet::remove(const String &name) {
 	ArchiveNodeList::iterator it = find(name);
 	if (it != _list.end()) {
+		invalidateIndex();
 		if (it->_autoFree)
 			delete it->_arc;
 		_list.erase(it);
@@ -181,6 +196,7 @@ bool SearchSet::hasArchive(const String &name) const {
 }
 
 void SearchSet::clear() {
+	invalidateIndex();
 	for (ArchiveNodeList::iterator i = _list.begin(); i != _list.end(); ++i) {
 		if (i->_autoFree)
 			delete i->_arc;
@@ -205,17 +221,118 @@ void SearchSet::setPriority(const String &name, int priority) {
 	insert(node);
 }
 
-bool SearchSet::hasFile(const String &name) const {
-	if (name.empty())
-		return false;
+void SearchSet::invalidateIndex() {
+	_indexValid = false;
+	_indexPending = false;
+	_lookupsSinceChange = 0;
+	_index.clear();
+	_indexOrder.clear();
+	_unindexed.clear();
+}
 
-	ArchiveNodeList::const_iterator it = _list.begin();
-	for (; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(name))
+bool SearchSet::prepareIndex() const {
+	if (_indexValid) {
+		if (!_indexPending || Archive::getIndexGeneration() == _indexGeneration)
 			return true;
+
+		// An archive may have its names now; the set itself did not change,
+		// so rebuild right away.
+		_index.clear();
+		_indexOrder.clear();
+		_unindexed.clear();
+	} else {
+		// Building the index costs about as much as a lookup of a missing
+		// file, so don't bother for sets which are only queried a few times
+		// between changes.
+		const uint kLookupsBeforeIndexing = 8;
+		if (++_lookupsSinceChange < kLookupsBeforeIndexing)
+			return false;
 	}
 
-	return false;
+	// Read the generation first, so that an archive finishing while we
+	// list the names causes another rebuild.
+	_indexGeneration = Archive::getIndexGeneration();
+	_indexPending = false;
+
+	StringArray names;
+	for (ArchiveNodeList::const_iterator it = _list.begin(); it != _list.end(); ++it) {
+		const uint pos = _indexOrder.size();
+		_indexOrder.push_back(&*it);
+
+		names.clear();
+		const IndexableNames listed = it->_arc->listIndexableNames(names);
+		if (listed != kIndexableNamesListed) {
+			if (listed == kIndexableNamesPending)
+				_indexPending = true;
+			_unindexed.push_back(pos);
+			continue;
+		}
+
+		// Archives come in search order, so the first one to claim a name wins
+		for (StringArray::const_iterator n = names.begin(); n != names.end(); ++n) {
+			if (!_index.contains(*n))
+				_index[*n] = pos;
+		}
+	}
+
+	_indexValid = true;
+	++_stats.rebuilds;
+	return true;
+}
+
+static bool probeArchive(const Archive *archive, const String &name, SeekableReadStream **stream) {
+	if (!stream)
+		return archive->hasFile(name);
+
+	*stream = archive->createReadStreamForMember(name);
+	return *stream != nullptr;
+}
+
+const SearchSet::Node *SearchSet::findArchive(const String &name, SeekableReadStream **stream) const {
+	++_stats.lookups;
+
+	if (!prepareIndex()) {
+		for (ArchiveNodeList::const_iterator it = _list.begin(); it != _list.end(); ++it) {
+			if (probeArchive(it->_arc, name, stream))
+				return &*it;
+		}
+		return nullptr;
+	}
+
+	++_stats.indexedLookups;
+
+	NameIndex::const_iterator hit = _index.find(name);
+	const uint candidate = (hit != _index.end()) ? hit->_value : _indexOrder.size();
+
+	// Archives without an index entry which come first are still asked
+	for (uint i = 0; i < _unindexed.size() && _unindexed[i] < candidate; ++i) {
+		const Node *node = _indexOrder[_unindexed[i]];
+		if (probeArchive(node->_arc, name, stream))
+			return node;
+	}
+
+	if (candidate == _indexOrder.size())
+		return nullptr;
+
+	if (probeArchive(_indexOrder[candidate]->_arc, name, stream))
+		return _indexOrder[candidate];
+
+	// The member went away after it was indexed, e.g. a file was deleted
+	// from disk. Ask everything further down the list.
+	++_stats.staleEntries;
+	for (uint i = candidate + 1; i < _indexOrder.size(); ++i) {
+		if (probeArchive(_indexOrder[i]->_arc, name, stream))
+			return _indexOrder[i];
+	}
+
+	return nullptr;
+}
+
+bool SearchSet::hasFile(const String &name) const {
+	if (name.empty())
+		return false;
+
+	return findArchive(name, nullptr) != nullptr;
 }
 
 int SearchSet::listMatchingMembers(ArchiveMemberList &list, const String &pattern) const {
@@ -242,27 +359,17 @@ const ArchiveMemberPtr SearchSet::getMember(const String &name) const {
 	if (name.empty())
 		return ArchiveMemberPtr();
 
-	ArchiveNodeList::const_iterator it = _list.begin();
-	for (; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(name))
-			return it->_arc->getMember(name);
-	}
-
-	return ArchiveMemberPtr();
+	const Node *node = findArchive(name, nullptr);
+	return node ? node->_arc->getMember(name) : ArchiveMemberPtr();
 }
 
 SeekableReadStream *SearchSet::createReadStreamForMember(const String &name) const {
 	if (name.empty())
 		return nullptr;
 
-	ArchiveNodeList::const_iterator it = _list.begin();
-	for (; it != _list.end(); ++it) {
-		SeekableReadStream *stream = it->_arc->createReadStreamForMember(name);
-		if (stream)
-			return stream;
-	}
-
-	return nullptr;
+	SeekableReadStream *stream = nullptr;
+	findArchive(name, &stream);
+	return stream;
 }
 
 
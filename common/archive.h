@@ -24,6 +24,9 @@
 #define COMMON_ARCHIVE_H
 
 #include "common/str.h"
+#include "common/str-array.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
 #include "common/list.h"
 #include "common/ptr.h"
 #include "common/singleton.h"
@@ -89,6 +92,13 @@ class Archive {
 public:
 	virtual ~Archive() { }
 
+	/** Results of listIndexableNames(). */
+	enum IndexableNames {
+		kIndexableNamesUnsupported, ///< The archive has to be queried directly
+		kIndexableNamesListed,      ///< All names were appended
+		kIndexableNamesPending      ///< Not known yet; ask again once getIndexGeneration() changes
+	};
+
 	/**
 	 * Check if a member with the given name is present in the Archive.
 	 * Patterns are not allowed, as this is meant to be a quick File::exists()
@@ -123,6 +133,31 @@ public:
 	 * @return the newly created input stream
 	 */
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const = 0;
+
+	/**
+	 * Append the names of all members to names, so that a SearchSet can find
+	 * them through a single index instead of asking each of its archives in
+	 * turn. Only archives whose list of members does not change once they
+	 * have been created may implement this, and the names must be exactly
+	 * the ones (compared case-insensitively) accepted by hasFile() and
+	 * createReadStreamForMember().
+	 *
+	 * @return whether the names were listed
+	 */
+	virtual IndexableNames listIndexableNames(StringArray &names) const { return kIndexableNamesUnsupported; }
+
+	/**
+	 * A counter shared by all archives, which changes whenever an archive
+	 * that answered kIndexableNamesPending becomes able to list its names.
+	 */
+	static uint32 getIndexGeneration();
+
+protected:
+	/** Announce that the names of this archive can now be listed. */
+	static void bumpIndexGeneration();
+
+private:
+	static volatile uint32 _indexGeneration;
 };
 
 
@@ -155,7 +190,54 @@ class SearchSet : public Archive {
 	bool _ignoreClashes;
 
 public:
-	SearchSet() : _ignoreClashes(false) { }
+	/**
+	 * Counters describing how lookups by name were served.
+	 */
+	struct IndexStats {
+		uint32 lookups;        ///< Calls to hasFile(), getMember() and createReadStreamForMember()
+		uint32 indexedLookups; ///< Lookups answered with the help of the name index
+		uint32 rebuilds;       ///< Number of times the name index was built
+		uint32 staleEntries;   ///< Index hits which the archive did not confirm
+
+		IndexStats() : lookups(0), indexedLookups(0), rebuilds(0), staleEntries(0) { }
+	};
+
+private:
+	/**
+	 * Lookups by name go through an index of the member names of all
+	 * archives which support listIndexableNames(). It maps each name to the
+	 * position, in search order, of the first such archive having it; the
+	 * remaining archives are still asked directly, in priority order.
+	 *
+	 * The index is dropped whenever the list of archives changes, and only
+	 * rebuilt once that list has been left alone for a few lookups. It is
+	 * also rebuilt when an archive which could not list its names yet
+	 * becomes able to, see Archive::getIndexGeneration().
+	 */
+	typedef HashMap<String, uint, IgnoreCase_Hash, IgnoreCase_EqualTo> NameIndex;
+	mutable NameIndex _index;
+	mutable Array<const Node *> _indexOrder; // all archives, in search order
+	mutable Array<uint> _unindexed;          // positions of archives missing from _index
+	mutable bool _indexValid;
+	mutable bool _indexPending;              // some archive answered kIndexableNamesPending
+	mutable uint32 _indexGeneration;         // Archive::getIndexGeneration() when the index was built
+	mutable uint _lookupsSinceChange;
+	mutable IndexStats _stats;
+
+	void invalidateIndex();
+
+	// Build the index if that is worthwhile, return whether it is usable.
+	bool prepareIndex() const;
+
+	/**
+	 * Find the first archive which has the given file. If stream is not
+	 * null, archives are probed with createReadStreamForMember() and the
+	 * stream of the archive found is returned in it, otherwise with hasFile().
+	 */
+	const Node *findArchive(const String &name, SeekableReadStream **stream) const;
+
+public:
+	SearchSet() : _ignoreClashes(false), _indexValid(false), _indexPending(false), _indexGeneration(0), _lookupsSinceChange(0) { }
 	virtual ~SearchSet() { clear(); }
 
 	/**
@@ -256,6 +338,14 @@ public:
 	 * in FSDirectory documentation
 	 */
 	void setIgnoreClashes(bool ignoreClashes) { _ignoreClashes = ignoreClashes; }
+
+	/** Whether clashes are ignored when adding directories. */
+	bool getIgnoreClashes() const { return _ignoreClashes; }
+
+	/**
+	 * Return the lookup counters, for profiling.
+	 */
+	const IndexStats &getIndexStats() const { return _stats; }
 };
 
 
@@ -0,0 +1,80 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Common {
+
+/*
+ * Minimal helpers for sharing plain words between threads without a mutex.
+ * Only aligned variables of at most pointer size may be used with them.
+ */
+
+/**
+ * Full memory barrier: no load or store is moved across it, neither by the
+ * compiler nor by the CPU.
+ */
+inline void memoryBarrier() {
+#if defined(_MSC_VER)
+	long dummy = 0;
+	_InterlockedExchange(&dummy, 0);
+#elif defined(__GNUC__) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+	__sync_synchronize();
+#elif defined(__GNUC__)
+	// Targets without atomic instructions are single core, so it is
+	// enough to stop the compiler from reordering.
+	__asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+/**
+ * Read a variable written by another thread. Everything the other thread
+ * stored before publishing the value with atomicStore() is visible after
+ * this returns.
+ */
+template<typename T>
+inline T atomicLoad(const volatile T &var) {
+	T value = var;
+	memoryBarrier();
+	return value;
+}
+
+/**
+ * Publish a value to other threads. All stores issued before this one are
+ * visible to a thread which reads the new value with atomicLoad().
+ */
+template<typename T>
+inline void atomicStore(volatile T &var, T value) {
+	memoryBarrier();
+	var = value;
+}
+
+} // End of namespace Common
+
+#endif
@@ -0,0 +1,236 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/dircache.h"
+#include "common/debug.h"
+#include "common/fs.h"
+#include "common/savefile.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+namespace Common {
+
+DECLARE_SINGLETON(DirectoryCache);
+
+static const char *const kCacheFileName = "scummvm-directories.cache";
+static const char *const kCacheHeader = "ScummVM directory cache 1";
+
+/**
+ * The reference counts of String are not thread safe, so names shared with
+ * nodes handed to other threads are always copied into new storage.
+ */
+static String unshare(const String &str) {
+	return String(str.c_str(), str.size());
+}
+
+DirectoryCache::DirectoryCache(ThreadManager *threads)
+	: _threads(threads), _mutex(nullptr), _loaded(false), _dirty(false), _stored(0), _cached(0) {
+	if (!_threads && g_system)
+		_threads = g_system->getThreadManager();
+	if (_threads)
+		_mutex = _threads->createMutex();
+}
+
+DirectoryCache::~DirectoryCache() {
+	if (_mutex)
+		_threads->deleteMutex(_mutex);
+}
+
+void DirectoryCache::lock() {
+	if (_mutex)
+		_threads->lockMutex(_mutex);
+}
+
+void DirectoryCache::unlock() {
+	if (_mutex)
+		_threads->unlockMutex(_mutex);
+}
+
+bool DirectoryCache::lookup(const FSNode &dir, FSList &children) {
+	uint32 size, modificationTime;
+	if (!dir.getFileInfo(size, modificationTime))
+		return false;
+
+	const String path = dir.getPath();
+	Array<Entry> entries;
+
+	lock();
+	ListingMap::const_iterator it = _listings.find(path);
+	const bool found = it != _listings.end() && it->_value.size == size && it->_value.modificationTime == modificationTime;
+	if (found) {
+		entries.reserve(it->_value.entries.size());
+		for (uint i = 0; i < it->_value.entries.size(); ++i) {
+			Entry entry;
+			entry.name = unshare(it->_value.entries[i].name);
+			entry.isDirectory = it->_value.entries[i].isDirectory;
+			entries.push_back(entry);
+		}
+		_cached++;
+	}
+	unlock();
+
+	if (!found)
+		return false;
+
+	children.clear();
+	for (uint i = 0; i < entries.size(); ++i)
+		children.push_back(dir.getChildWithKnownType(entries[i].name, entries[i].isDirectory));
+	return true;
+}
+
+void DirectoryCache::store(const FSNode &dir, const FSList &children) {
+	uint32 size, modificationTime;
+	if (!dir.getFileInfo(size, modificationTime))
+		return;
+
+	// Build the listing in place, so that all copies of its strings are
+	// made and dropped while holding the lock
+	lock();
+	Listing &listing = _listings[unshare(dir.getPath())];
+	listing.size = size;
+	listing.modificationTime = modificationTime;
+	listing.entries.clear();
+	listing.entries.reserve(children.size());
+	for (FSList::const_iterator it = children.begin(); it != children.end(); ++it) {
+		Entry entry;
+		entry.name = unshare(it->getName());
+		entry.isDirectory = it->isDirectory();
+		listing.entries.push_back(entry);
+	}
+	_dirty = true;
+	_stored++;
+	unlock();
+}
+
+void DirectoryCache::load() {
+	SaveFileManager *saveFileMan = g_system ? g_system->getSavefileManager() : nullptr;
+	if (_loaded || !saveFileMan)
+		return;
+	_loaded = true;
+
+	InSaveFile *in = saveFileMan->openForLoading(kCacheFileName);
+	if (!in)
+		return;
+
+	if (!loadFrom(*in))
+		warning("Ignoring directory cache with unknown format");
+	delete in;
+}
+
+bool DirectoryCache::loadFrom(SeekableReadStream &in) {
+	if (in.readLine() != kCacheHeader)
+		return false;
+
+	lock();
+
+	// Each directory starts with a line holding the size and modification
+	// time its listing is valid for, the number of entries and the path,
+	// separated by tabs. Then follows one line per entry, holding 'd' for
+	// directories or 'f' for files and the name.
+	while (!in.eos() && !in.err()) {
+		const String line = in.readLine();
+		const char *fields[4];
+		const char *pos = line.c_str();
+		int count = 0;
+
+		for (; count < 3; count++) {
+			fields[count] = pos;
+			pos = strchr(pos, '\t');
+			if (!pos)
+				break;
+			pos++;
+		}
+
+		// The path is last, so it may contain tabs itself
+		if (count != 3)
+			continue;
+		fields[3] = pos;
+
+		Listing listing;
+		listing.size = strtoul(fields[0], nullptr, 10);
+		listing.modificationTime = strtoul(fields[1], nullptr, 10);
+		const uint entries = strtoul(fields[2], nullptr, 10);
+
+		listing.entries.reserve(entries);
+		for (uint i = 0; i < entries && !in.eos(); i++) {
+			const String name = in.readLine();
+			if (name.size() < 2 || (name[0] != 'd' && name[0] != 'f'))
+				break;
+
+			Entry entry;
+			entry.name = String(name.c_str() + 1);
+			entry.isDirectory = name[0] == 'd';
+			listing.entries.push_back(entry);
+		}
+
+		// Listings stored before the data was loaded are newer
+		if (listing.entries.size() == entries && !_listings.contains(fields[3]))
+			_listings[fields[3]] = listing;
+	}
+
+	debug(2, "Loaded %u directory cache entries", _listings.size());
+	unlock();
+
+	return true;
+}
+
+void DirectoryCache::flush() {
+	SaveFileManager *saveFileMan = g_system ? g_system->getSavefileManager() : nullptr;
+	if (!_dirty || !saveFileMan)
+		return;
+
+	// Don't lose the listings of earlier sessions which were not needed yet
+	load();
+
+	OutSaveFile *out = saveFileMan->openForSaving(kCacheFileName, false);
+	if (!out) {
+		warning("Could not write directory cache");
+		return;
+	}
+
+	saveTo(*out);
+	out->finalize();
+	if (out->err())
+		warning("Could not write directory cache");
+	delete out;
+}
+
+void DirectoryCache::saveTo(WriteStream &out) {
+	lock();
+
+	out.writeString(kCacheHeader);
+	out.writeByte('\n');
+	for (ListingMap::const_iterator it = _listings.begin(); it != _listings.end(); ++it) {
+		const Listing &listing = it->_value;
+		out.writeString(String::format("%u\t%u\t%u\t%s\n", listing.size, listing.modificationTime, listing.entries.size(), it->_key.c_str()));
+		for (uint i = 0; i < listing.entries.size(); ++i) {
+			out.writeByte(listing.entries[i].isDirectory ? 'd' : 'f');
+			out.writeString(listing.entries[i].name);
+			out.writeByte('\n');
+		}
+	}
+	_dirty = false;
+
+	unlock();
+}
+
+} // End of namespace Common
@@ -0,0 +1,131 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_DIRCACHE_H
+#define COMMON_DIRCACHE_H
+
+#include "common/array.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/singleton.h"
+#include "common/str.h"
+#include "common/thread.h"
+
+namespace Common {
+
+class FSList;
+class FSNode;
+class SeekableReadStream;
+class WriteStream;
+
+/**
+ * Remembers the contents of directories on disk, so that an FSDirectory
+ * does not have to list all directories of a game again whenever the game
+ * is started. A listing is only used while the size and modification time
+ * of its directory stay the same; the latter changes whenever entries are
+ * added, removed or renamed.
+ *
+ * Directories whose modification time the backend cannot report (see
+ * FSNode::getFileInfo) are always listed.
+ *
+ * lookup() and store() may be called from any thread, while load() and
+ * flush() access the save directory and must be called on the main thread.
+ */
+class DirectoryCache : public Singleton<DirectoryCache> {
+public:
+	/**
+	 * @param threads  the thread manager used for locking; nullptr selects
+	 *                 the one of g_system, if any
+	 */
+	explicit DirectoryCache(ThreadManager *threads = nullptr);
+	~DirectoryCache();
+
+	/**
+	 * Looks up the remembered contents of a directory.
+	 *
+	 * @param dir		the directory
+	 * @param children	set to nodes for the entries of the directory
+	 * @return true if a valid listing was found
+	 */
+	bool lookup(const FSNode &dir, FSList &children);
+
+	/**
+	 * Remembers the contents of a directory, as returned by FSNode::getChildren().
+	 */
+	void store(const FSNode &dir, const FSList &children);
+
+	/** Reads the listings stored in the save directory, if not done yet. */
+	void load();
+
+	/** Writes the listings to the save directory if they changed. */
+	void flush();
+
+	/**
+	 * Adds the listings written by saveTo() to the cache, keeping the
+	 * ones already present.
+	 *
+	 * @return false if the data is not in the expected format
+	 */
+	bool loadFrom(SeekableReadStream &in);
+
+	/** Writes all listings to the given stream. */
+	void saveTo(WriteStream &out);
+
+	/** Number of directories listed and stored since the statistics were last reset. */
+	uint32 getStoredCount() const { return _stored; }
+	/** Number of directories served from the cache since the statistics were last reset. */
+	uint32 getCachedCount() const { return _cached; }
+	void resetStats() { _stored = _cached = 0; }
+
+private:
+	struct Entry {
+		String name;
+		bool isDirectory;
+	};
+
+	struct Listing {
+		uint32 size;
+		uint32 modificationTime;
+		Array<Entry> entries;
+	};
+
+	typedef HashMap<String, Listing> ListingMap;
+
+	void lock();
+	void unlock();
+
+	ThreadManager *_threads;
+	ThreadManager::MutexRef _mutex;
+
+	ListingMap _listings;
+	bool _loaded;
+	bool _dirty;
+	uint32 _stored;
+	uint32 _cached;
+};
+
+} // End of namespace Common
+
+/** Shortcut for accessing the directory cache. */
+#define DirectoryCacheMan Common::DirectoryCache::instance()
+
+#endif
@@ -0,0 +1,172 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#include "common/framestats.h"
+#include "common/atomic.h"
+#include "common/config-manager.h"
+#include "common/file.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+#include "common/ustr.h"
+
+namespace Common {
+
+DECLARE_SINGLETON(FrameStats);
+
+namespace {
+
+/**
+ * Running totals of every stage. Each is written by a single thread and
+ * only read by FrameStats, so plain stores are enough; the totals may wrap
+ * as only their differences are used.
+ */
+struct StageTotals {
+	volatile uint32 micros;
+	volatile uint32 pixels;
+};
+
+StageTotals s_stageTotals[kFrameStageCount];
+
+} // End of anonymous namespace
+
+void addFrameStageTime(FrameStage stage, uint32 micros) {
+	s_stageTotals[stage].micros += micros;
+}
+
+void addFrameStagePixels(FrameStage stage, uint32 pixels) {
+	s_stageTotals[stage].pixels += pixels;
+}
+
+FrameStageTimer::FrameStageTimer(FrameStage stage) : _stage(stage), _start(g_system->getMicros()) {
+}
+
+FrameStageTimer::~FrameStageTimer() {
+	addFrameStageTime(_stage, (uint32)(g_system->getMicros() - _start));
+}
+
+FrameStats::FrameStats() : _frameCount(0), _periodFrames(0), _periodFrameMicros(0), _csv(nullptr) {
+	_lastFrameEnd = _periodStart = g_system->getMicros();
+
+	for (int i = 0; i < kFrameStageCount; ++i) {
+		_lastMicros[i] = atomicLoad(s_stageTotals[i].micros);
+		_lastPixels[i] = atomicLoad(s_stageTotals[i].pixels);
+		_periodMicros[i] = 0;
+	}
+
+	_showOnOSD = ConfMan.hasKey("frame_stats_osd") && ConfMan.getBool("frame_stats_osd");
+
+	if (ConfMan.hasKey("frame_stats_csv")) {
+		const String filename = ConfMan.get("frame_stats_csv");
+		_csv = new DumpFile();
+		if (_csv->open(filename)) {
+			_csv->writeString("frame,frame_us,engine_us,copyrect_us,copyrect_px,update_us,scale_us,scale_px,"
+			                  "cursor_us,cursor_px,present_us,audio_us,audio_samples\n");
+		} else {
+			warning("FrameStats: Could not open '%s' for writing", filename.c_str());
+			delete _csv;
+			_csv = nullptr;
+		}
+	}
+}
+
+FrameStats::~FrameStats() {
+	if (_csv) {
+		_csv->finalize();
+		delete _csv;
+	}
+}
+
+void FrameStats::endFrame() {
+	const uint64 now = g_system->getMicros();
+
+	Frame frame;
+	for (int i = 0; i < kFrameStageCount; ++i) {
+		const uint32 micros = atomicLoad(s_stageTotals[i].micros);
+		const uint32 pixels = atomicLoad(s_stageTotals[i].pixels);
+		frame.micros[i] = micros - _lastMicros[i];
+		frame.pixels[i] = pixels - _lastPixels[i];
+		_lastMicros[i] = micros;
+		_lastPixels[i] = pixels;
+		_periodMicros[i] += frame.micros[i];
+	}
+
+	frame.frameMicros = (uint32)(now - _lastFrameEnd);
+	_lastFrameEnd = now;
+	++_frameCount;
+
+	_periodFrameMicros += frame.frameMicros;
+	++_periodFrames;
+
+	if (_csv)
+		writeCSV(frame);
+
+	if (now - _periodStart >= 1000000)
+		updateSummary(now);
+}
+
+namespace {
+
+/** The part of a frame which was not spent in the backend. */
+uint32 engineMicros(uint32 frameMicros, uint32 copyRectMicros, uint32 updateMicros) {
+	const uint32 backendMicros = copyRectMicros + updateMicros;
+	return frameMicros > backendMicros ? frameMicros - backendMicros : 0;
+}
+
+} // End of anonymous namespace
+
+void FrameStats::writeCSV(const Frame &frame) {
+	_csv->writeString(String::format("%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n",
+		_frameCount, frame.frameMicros,
+		engineMicros(frame.frameMicros, frame.micros[kFrameStageCopyRect], frame.micros[kFrameStageUpdate]),
+		frame.micros[kFrameStageCopyRect], frame.pixels[kFrameStageCopyRect],
+		frame.micros[kFrameStageUpdate],
+		frame.micros[kFrameStageScale], frame.pixels[kFrameStageScale],
+		frame.micros[kFrameStageCursor], frame.pixels[kFrameStageCursor],
+		frame.micros[kFrameStagePresent],
+		frame.micros[kFrameStageAudio], frame.pixels[kFrameStageAudio]));
+}
+
+void FrameStats::updateSummary(uint64 now) {
+	// Average milliseconds per frame
+	double ms[kFrameStageCount];
+	for (int i = 0; i < kFrameStageCount; ++i)
+		ms[i] = _periodMicros[i] / (1000.0 * _periodFrames);
+	const double frameMs = _periodFrameMicros / (1000.0 * _periodFrames);
+	const double engineMs = MAX(frameMs - ms[kFrameStageCopyRect] - ms[kFrameStageUpdate], 0.0);
+
+	_summary = String::format("%.1f fps, %.2f ms/frame\n"
+	                          "engine %.2f  copy %.2f  update %.2f\n"
+	                          "scale %.2f  cursor %.2f  present %.2f  audio %.2f",
+	                          _periodFrames * 1000000.0 / (now - _periodStart), frameMs,
+	                          engineMs, ms[kFrameStageCopyRect], ms[kFrameStageUpdate],
+	                          ms[kFrameStageScale], ms[kFrameStageCursor], ms[kFrameStagePresent], ms[kFrameStageAudio]);
+
+	if (_showOnOSD)
+		g_system->displayMessageOnOSD(U32String(_summary));
+
+	_periodStart = now;
+	_periodFrames = 0;
+	_periodFrameMicros = 0;
+	for (int i = 0; i < kFrameStageCount; ++i)
+		_periodMicros[i] = 0;
+}
+
+} // End of namespace Common
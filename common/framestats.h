@@ -0,0 +1,147 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+#ifndef COMMON_FRAMESTATS_H
+#define COMMON_FRAMESTATS_H
+
+#include "common/scummsys.h"
+
+/**
+ * @file
+ * Per-frame timings of the graphics and audio output, for finding out where
+ * frame time goes without an external profiler.
+ *
+ * Backends mark the interesting parts of their code with the FRAME_STATS_*
+ * macros below. They expand to nothing unless ScummVM was configured with
+ * --enable-frame-stats. The collected timings are shown on the OSD when
+ * frame_stats_osd is set, and written to the CSV file named by
+ * frame_stats_csv, one line per frame.
+ */
+
+#ifdef ENABLE_FRAME_STATS
+
+#include "common/singleton.h"
+#include "common/str.h"
+
+namespace Common {
+
+class DumpFile;
+
+/**
+ * The stages frame time is split into. Each stage counts the time spent in
+ * it and the number of pixels it processed. Time spent by the engine is not
+ * measured directly: it is what remains of the frame once the stages run by
+ * the engine thread are subtracted.
+ */
+enum FrameStage {
+	kFrameStageCopyRect,   ///< OSystem::copyRectToScreen
+	kFrameStageUpdate,     ///< OSystem::updateScreen, includes the next three
+	kFrameStageScale,      ///< Scaling the screen or uploading it to the GPU
+	kFrameStageCursor,     ///< Drawing the mouse cursor
+	kFrameStagePresent,    ///< Handing the finished frame to the display
+	kFrameStageAudio,      ///< Mixer callbacks; they run on the audio thread,
+	                       ///< the pixel count holds the samples produced
+
+	kFrameStageCount
+};
+
+/**
+ * Add time to a stage. A stage must only ever be recorded from one thread,
+ * which is what allows this to work without locking.
+ */
+void addFrameStageTime(FrameStage stage, uint32 micros);
+
+/** Add processed pixels to a stage, with the same rules as addFrameStageTime. */
+void addFrameStagePixels(FrameStage stage, uint32 pixels);
+
+/**
+ * Adds the time between its construction and its destruction to a stage.
+ */
+class FrameStageTimer {
+public:
+	FrameStageTimer(FrameStage stage);
+	~FrameStageTimer();
+
+private:
+	FrameStage _stage;
+	uint64 _start;
+};
+
+/**
+ * Splits the stage totals into frames, and reports them.
+ */
+class FrameStats : public Singleton<FrameStats> {
+public:
+	FrameStats();
+	~FrameStats();
+
+	/**
+	 * Close the current frame. The backend calls this once per
+	 * OSystem::updateScreen, after the frame was presented.
+	 */
+	void endFrame();
+
+	/**
+	 * Return a summary of the frames of the last second: the frame rate
+	 * and the average time spent per stage.
+	 */
+	const String &getSummary() const { return _summary; }
+
+private:
+	struct Frame {
+		uint32 micros[kFrameStageCount];
+		uint32 pixels[kFrameStageCount];
+		uint32 frameMicros;
+	};
+
+	void writeCSV(const Frame &frame);
+	void updateSummary(uint64 now);
+
+	uint64 _lastFrameEnd;
+	uint32 _lastMicros[kFrameStageCount];
+	uint32 _lastPixels[kFrameStageCount];
+	uint32 _frameCount;
+
+	uint64 _periodStart;
+	uint32 _periodFrames;
+	uint64 _periodMicros[kFrameStageCount];
+	uint64 _periodFrameMicros;
+
+	bool _showOnOSD;
+	DumpFile *_csv;
+	String _summary;
+};
+
+} // End of namespace Common
+
+#define FRAME_STATS_SCOPE(stage) Common::FrameStageTimer frameStageTimer_##stage(Common::stage)
+#define FRAME_STATS_PIXELS(stage, pixels) Common::addFrameStagePixels(Common::stage, pixels)
+#define FRAME_STATS_END_FRAME() Common::FrameStats::instance().endFrame()
+
+#else
+
+#define FRAME_STATS_SCOPE(stage) do {} while (0)
+#define FRAME_STATS_PIXELS(stage, pixels) do {} while (0)
+#define FRAME_STATS_END_FRAME() do {} while (0)
+
+#endif
+
+#endif
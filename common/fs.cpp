@@ -20,6 +20,8 @@
  *
  */
 
+#include "common/atomic.h"
+#include "common/dircache.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 #include "backends/fs/abstract-fs.h"
@@ -69,6 +71,15 @@ FSNode FSNode::getChild(const String &n) const {
 	return FSNode(node);
 }
 
+FSNode FSNode::getChildWithKnownType(const String &n, bool isDirectory) const {
+	// If this node is invalid or not a directory, return an invalid node
+	if (_realNode == nullptr || !_realNode->isDirectory())
+		return FSNode();
+
+	AbstractFSNode *node = _realNode->getChildWithKnownType(n, isDirectory);
+	return FSNode(node);
+}
+
 bool FSNode::getChildren(FSList &fslist, ListMode mode, bool hidden) const {
 	if (!_realNode || !_realNode->isDirectory())
 		return false;
@@ -125,6 +136,10 @@ bool FSNode::isWritable() const {
 	return _realNode && _realNode->isWritable();
 }
 
+bool FSNode::getFileInfo(uint32 &size, uint32 &modificationTime) const {
+	return _realNode && _realNode->getFileInfo(size, modificationTime);
+}
+
 SeekableReadStream *FSNode::createReadStream() const {
 	if (_realNode == nullptr)
 		return nullptr;
@@ -140,6 +155,21 @@ SeekableReadStream *FSNode::createReadStream() const {
 	return _realNode->createReadStream();
 }
 
+SeekableReadStream *FSNode::createMappedReadStream() const {
+	if (_realNode == nullptr)
+		return nullptr;
+
+	if (!_realNode->exists()) {
+		warning("FSNode::createMappedReadStream: '%s' does not exist", getName().c_str());
+		return nullptr;
+	} else if (_realNode->isDirectory()) {
+		warning("FSNode::createMappedReadStream: '%s' is a directory", getName().c_str());
+		return nullptr;
+	}
+
+	return _realNode->createMappedReadStream();
+}
+
 WriteStream *FSNode::createWriteStream() const {
 	if (_realNode == nullptr)
 		return nullptr;
@@ -169,28 +199,44 @@ bool FSNode::createDirectory() const {
 }
 
 FSDirectory::FSDirectory(const FSNode &node, int depth, bool flat, bool ignoreClashes)
-  : _node(node), _cached(false), _depth(depth), _flat(flat), _ignoreClashes(ignoreClashes) {
+  : _node(node), _cached(false), _depth(depth), _flat(flat), _ignoreClashes(ignoreClashes),
+    _seeded(false), _listing(0), _dirCache(nullptr), _mapFiles(false), _threads(nullptr), _scanThread(nullptr),
+    _mutex(nullptr), _progress(nullptr), _waiters(0), _quit(false) {
 }
 
 FSDirectory::FSDirectory(const String &prefix, const FSNode &node, int depth, bool flat,
                          bool ignoreClashes)
-  : _node(node), _cached(false), _depth(depth), _flat(flat), _ignoreClashes(ignoreClashes) {
+  : _node(node), _cached(false), _depth(depth), _flat(flat), _ignoreClashes(ignoreClashes),
+    _seeded(false), _listing(0), _dirCache(nullptr), _mapFiles(false), _threads(nullptr), _scanThread(nullptr),
+    _mutex(nullptr), _progress(nullptr), _waiters(0), _quit(false) {
 
 	setPrefix(prefix);
 }
 
 FSDirectory::FSDirectory(const String &name, int depth, bool flat, bool ignoreClashes)
-  : _node(name), _cached(false), _depth(depth), _flat(flat), _ignoreClashes(ignoreClashes) {
+  : _node(name), _cached(false), _depth(depth), _flat(flat), _ignoreClashes(ignoreClashes),
+    _seeded(false), _listing(0), _dirCache(nullptr), _mapFiles(false), _threads(nullptr), _scanThread(nullptr),
+    _mutex(nullptr), _progress(nullptr), _waiters(0), _quit(false) {
 }
 
 FSDirectory::FSDirectory(const String &prefix, const String &name, int depth, bool flat,
                          bool ignoreClashes)
-  : _node(name), _cached(false), _depth(depth), _flat(flat), _ignoreClashes(ignoreClashes) {
+  : _node(name), _cached(false), _depth(depth), _flat(flat), _ignoreClashes(ignoreClashes),
+    _seeded(false), _listing(0), _dirCache(nullptr), _mapFiles(false), _threads(nullptr), _scanThread(nullptr),
+    _mutex(nullptr), _progress(nullptr), _waiters(0), _quit(false) {
 
 	setPrefix(prefix);
 }
 
 FSDirectory::~FSDirectory() {
+	if (_scanThread) {
+		atomicStore(_quit, true);
+		_threads->joinThread(_scanThread);
+	}
+	if (_progress)
+		_threads->deleteSemaphore(_progress);
+	if (_mutex)
+		_threads->deleteMutex(_mutex);
 }
 
 void FSDirectory::setPrefix(const String &prefix) {
@@ -204,51 +250,155 @@ FSNode FSDirectory::getFSNode() const {
 	return _node;
 }
 
-FSNode *FSDirectory::lookupCache(NodeCache &cache, const String &name) const {
-	// make caching as lazy as possible
-	if (!name.empty()) {
-		ensureCached();
+/*
+    The background scan shares the caches with the thread doing lookups.
+    The reference counts of SharedPtr and String are not thread safe, so
+    all nodes and strings either belong to a single thread or are only
+    copied and released while holding the lock. In particular, a directory
+    is listed through a node of its own rather than the one stored in
+    _subDirCache, which other threads may be using. The root is listed
+    through _node, which the scan only uses by reference, so that only the
+    thread owning the FSDirectory touches its reference count.
+*/
 
-		if (cache.contains(name))
-			return &cache[name];
+void FSDirectory::lock() const {
+	if (_mutex)
+		_threads->lockMutex(_mutex);
+}
+
+void FSDirectory::unlock() const {
+	if (_mutex)
+		_threads->unlockMutex(_mutex);
+}
+
+void FSDirectory::waitForProgress() const {
+	assert(_progress);
+	_waiters++;
+	unlock();
+	_threads->waitSemaphore(_progress);
+	lock();
+}
+
+void FSDirectory::wakeWaiters() const {
+	for (; _waiters > 0; _waiters--)
+		_threads->postSemaphore(_progress);
+}
+
+void FSDirectory::scanInBackground(ThreadManager *threads) {
+	if (!threads && g_system)
+		threads = g_system->getThreadManager();
+	if (!threads || _threads || _seeded || _cached || _depth <= 0 || !_node.isDirectory())
+		return;
+
+	_mutex = threads->createMutex();
+	_progress = threads->createSemaphore(0);
+	if (!_mutex || !_progress) {
+		if (_mutex)
+			threads->deleteMutex(_mutex);
+		if (_progress)
+			threads->deleteSemaphore(_progress);
+		_mutex = nullptr;
+		_progress = nullptr;
+		return;
 	}
+	_threads = threads;
+
+	// The scan gets strings of its own. The root is listed through _node,
+	// which is only ever used by reference.
+	PendingDir root;
+	root.prefix = String(_prefix.c_str());
+	root.depth = _depth;
+	_pending.push_back(root);
+	_dirStates[root.prefix] = kDirPending;
+	_seeded = true;
+
+	_scanThread = _threads->createThread(scanProc, this);
+	if (!_scanThread)
+		warning("FSDirectory: Could not start scan thread for '%s'", _node.getPath().c_str());
+}
+
+void FSDirectory::scanProc(void *param) {
+	const FSDirectory *dir = (const FSDirectory *)param;
+
+	dir->lock();
+	if (dir->_flat) {
+		// Clashes are resolved in the order of a depth first walk, so flat
+		// trees are cached as a whole, and nobody looks at the caches before
+		// that is finished.
+		PendingDir root = dir->_pending.front();
+		dir->_pending.clear();
+		dir->unlock();
+
+		dir->cacheDirectoryRecursive(dir->_node, root.depth, root.prefix);
+
+		dir->lock();
+		root = PendingDir();
+		dir->_cached = true;
+		dir->wakeWaiters();
+	} else {
+		while (!atomicLoad(dir->_quit)) {
+			if (!dir->_pending.empty())
+				dir->listPending(dir->_pending.begin());
+			else if (dir->_listing)
+				dir->waitForProgress(); // the subdirectories of that one are still to come
+			else
+				break;
+		}
+	}
+	if (dir->_cached)
+		bumpIndexGeneration();
+	dir->unlock();
+}
 
-	return nullptr;
+bool FSDirectory::lookupCache(const NodeCache &cache, const String &name, FSNode &node) const {
+	// make caching as lazy as possible
+	if (name.empty())
+		return false;
+
+	lock();
+	ensureListed(name);
+
+	NodeCache::const_iterator it = cache.find(name);
+	const bool found = (it != cache.end());
+	if (found)
+		node = it->_value;
+	unlock();
+
+	return found;
 }
 
 bool FSDirectory::hasFile(const String &name) const {
 	if (name.empty() || !_node.isDirectory())
 		return false;
 
-	FSNode *node = lookupCache(_fileCache, name);
-	return node && node->exists();
+	FSNode node;
+	return lookupCache(_fileCache, name, node) && node.exists();
 }
 
 const ArchiveMemberPtr FSDirectory::getMember(const String &name) const {
 	if (name.empty() || !_node.isDirectory())
 		return ArchiveMemberPtr();
 
-	FSNode *node = lookupCache(_fileCache, name);
-
-	if (!node || !node->exists()) {
+	FSNode node;
+	if (!lookupCache(_fileCache, name, node) || !node.exists()) {
 		warning("FSDirectory::getMember: '%s' does not exist", name.c_str());
 		return ArchiveMemberPtr();
-	} else if (node->isDirectory()) {
+	} else if (node.isDirectory()) {
 		warning("FSDirectory::getMember: '%s' is a directory", name.c_str());
 		return ArchiveMemberPtr();
 	}
 
-	return ArchiveMemberPtr(new FSNode(*node));
+	return ArchiveMemberPtr(new FSNode(node));
 }
 
 SeekableReadStream *FSDirectory::createReadStreamForMember(const String &name) const {
 	if (name.empty() || !_node.isDirectory())
 		return nullptr;
 
-	FSNode *node = lookupCache(_fileCache, name);
-	if (!node)
+	FSNode node;
+	if (!lookupCache(_fileCache, name, node))
 		return nullptr;
-	SeekableReadStream *stream = node->createReadStream();
+	SeekableReadStream *stream = _mapFiles ? node.createMappedReadStream() : node.createReadStream();
 	if (!stream)
 		warning("FSDirectory::createReadStreamForMember: Can't create stream for file '%s'", name.c_str());
 
@@ -264,19 +414,27 @@ FSDirectory *FSDirectory::getSubDirectory(const String &prefix, const String &na
 	if (name.empty() || !_node.isDirectory())
 		return nullptr;
 
-	FSNode *node = lookupCache(_subDirCache, name);
-	if (!node)
+	FSNode node;
+	if (!lookupCache(_subDirCache, name, node))
 		return nullptr;
 
-	return new FSDirectory(prefix, *node, depth, flat, ignoreClashes);
+	return new FSDirectory(prefix, node, depth, flat, ignoreClashes);
 }
 
-void FSDirectory::cacheDirectoryRecursive(FSNode node, int depth, const String& prefix) const {
-	if (depth <= 0)
+void FSDirectory::listDirectory(const FSNode &node, FSList &list) const {
+	if (_dirCache && _dirCache->lookup(node, list))
+		return;
+
+	if (node.getChildren(list, FSNode::kListAll) && _dirCache)
+		_dirCache->store(node, list);
+}
+
+void FSDirectory::cacheDirectoryRecursive(const FSNode &node, int depth, const String& prefix) const {
+	if (depth <= 0 || atomicLoad(_quit))
 		return;
 
 	FSList list;
-	node.getChildren(list, FSNode::kListAll);
+	listDirectory(node, list);
 
 	FSList::iterator it = list.begin();
 	for ( ; it != list.end(); ++it) {
@@ -317,11 +475,176 @@ void FSDirectory::cacheDirectoryRecursive(FSNode node, int depth, const String&
 
 }
 
+void FSDirectory::seedPending() const {
+	if (_seeded)
+		return;
+	_seeded = true;
+
+	if (_depth <= 0 || !_node.isDirectory()) {
+		_cached = true;
+		return;
+	}
+
+	PendingDir root;
+	root.prefix = _prefix;
+	root.depth = _depth;
+	_pending.push_back(root);
+	_dirStates[_prefix] = kDirPending;
+}
+
+void FSDirectory::listPending(List<PendingDir>::iterator it) const {
+	PendingDir dir = *it;
+	_pending.erase(it);
+	_dirStates[dir.prefix] = kDirListing;
+	_listing++;
+	unlock();
+
+	// Only the root has the full depth
+	const FSNode &node = (dir.depth == _depth) ? _node : dir.node;
+	FSList list;
+	listDirectory(node, list);
+
+	// Nodes to list the subdirectories with, see above
+	FSList subDirs;
+	if (dir.depth > 1) {
+		for (FSList::const_iterator i = list.begin(); i != list.end(); ++i) {
+			if (i->isDirectory()) {
+				const String name = i->getName();
+				subDirs.push_back(node.getChildWithKnownType(String(name.c_str(), name.size()), true));
+			}
+		}
+	}
+
+	lock();
+	FSList::const_iterator subDir = subDirs.begin();
+	for (FSList::const_iterator i = list.begin(); i != list.end(); ++i) {
+		String name = dir.prefix + i->getName();
+
+		// don't touch name as it might be used for warning messages
+		String lowercaseName = name;
+		lowercaseName.toLowercase();
+
+		// since the hashmap is case insensitive, we need to check for clashes when caching
+		if (i->isDirectory()) {
+			if (_subDirCache.contains(lowercaseName)) {
+				// Always warn in this case as it's when there are 2 directories at the same place with different case
+				// That means a problem in user installation as lookups are always done case insensitive
+				warning("FSDirectory::cacheDirectory: name clash when building cache, ignoring sub-directory '%s'",
+				        name.c_str());
+			} else {
+				if (subDir != subDirs.end()) {
+					PendingDir pending;
+					pending.node = *subDir;
+					pending.prefix = lowercaseName + "/";
+					pending.depth = dir.depth - 1;
+					_pending.push_back(pending);
+					_dirStates[pending.prefix] = kDirPending;
+				}
+				_subDirCache[lowercaseName] = *i;
+			}
+			if (subDir != subDirs.end())
+				++subDir;
+		} else {
+			if (_fileCache.contains(lowercaseName)) {
+				if (!_ignoreClashes) {
+					warning("FSDirectory::cacheDirectory: name clash when building cache, ignoring file '%s'",
+					        name.c_str());
+				}
+			} else {
+				_fileCache[lowercaseName] = *i;
+			}
+		}
+	}
+
+	_dirStates[dir.prefix] = kDirListed;
+	_listing--;
+	if (_pending.empty() && !_listing)
+		_cached = true;
+
+	// Drop our references while holding the lock
+	list.clear();
+	subDirs.clear();
+	dir = PendingDir();
+
+	if (_threads)
+		wakeWaiters();
+}
+
+FSDirectory::DirState FSDirectory::findDirectory(const String &key, String &found) const {
+	found = key;
+	for (;;) {
+		DirStateMap::const_iterator it = _dirStates.find(found);
+		if (it != _dirStates.end())
+			return it->_value;
+
+		// Directories below listed ones which are still unknown do not exist
+		if (found.empty())
+			return kDirListed;
+		const char *start = found.c_str();
+		const char *end = start + found.size() - 1;
+		while (end > start && end[-1] != '/')
+			--end;
+		found = String(start, end);
+	}
+}
+
+void FSDirectory::ensureListed(const String &name) const {
+	if (_flat) {
+		ensureCached();
+		return;
+	}
+
+	seedPending();
+
+	// The prefix of the members of the directory the member would be in
+	const char *start = name.c_str();
+	const char *end = start + name.size();
+	while (end > start && end[-1] != '/')
+		--end;
+	const String key(start, end);
+
+	String found;
+	while (!_cached) {
+		const DirState state = findDirectory(key, found);
+		if (state == kDirListed)
+			break;
+
+		if (state == kDirListing) {
+			waitForProgress();
+			continue;
+		}
+
+		// List the directory, or the closest parent known, ourselves
+		List<PendingDir>::iterator it = _pending.begin();
+		while (it != _pending.end() && !it->prefix.equalsIgnoreCase(found))
+			++it;
+		assert(it != _pending.end());
+		listPending(it);
+	}
+}
+
 void FSDirectory::ensureCached() const  {
 	if (_cached)
 		return;
-	cacheDirectoryRecursive(_node, _depth, _prefix);
-	_cached = true;
+
+	if (_flat) {
+		if (_scanThread) {
+			while (!_cached)
+				waitForProgress();
+		} else {
+			cacheDirectoryRecursive(_node, _depth, _prefix);
+			_cached = true;
+		}
+		return;
+	}
+
+	seedPending();
+	while (!_cached) {
+		if (!_pending.empty())
+			listPending(_pending.begin());
+		else
+			waitForProgress();
+	}
 }
 
 int FSDirectory::listMatchingMembers(ArchiveMemberList &list, const String &pattern) const {
@@ -329,6 +652,7 @@ int FSDirectory::listMatchingMembers(ArchiveMemberList &list, const String &patt
 		return 0;
 
 	// Cache dir data
+	lock();
 	ensureCached();
 
 	// need to match lowercase key, since all entries in our file cache are
@@ -344,6 +668,7 @@ int FSDirectory::listMatchingMembers(ArchiveMemberList &list, const String &patt
 			matches++;
 		}
 	}
+	unlock();
 	return matches;
 }
 
@@ -352,6 +677,7 @@ int FSDirectory::listMembers(ArchiveMemberList &list) const {
 		return 0;
 
 	// Cache dir data
+	lock();
 	ensureCached();
 
 	int files = 0;
@@ -359,9 +685,31 @@ int FSDirectory::listMembers(ArchiveMemberList &list) const {
 		list.push_back(ArchiveMemberPtr(new FSNode(it->_value)));
 		++files;
 	}
+	unlock();
 
 	return files;
 }
 
+Archive::IndexableNames FSDirectory::listIndexableNames(StringArray &names) const {
+	if (!_node.isDirectory())
+		return kIndexableNamesUnsupported;
+
+	// Don't wait for the background scan; scanProc() announces its end
+	lock();
+	if (_scanThread && !_cached) {
+		unlock();
+		return kIndexableNamesPending;
+	}
+
+	// Cache dir data
+	ensureCached();
+
+	for (NodeCache::const_iterator it = _fileCache.begin(); it != _fileCache.end(); ++it)
+		names.push_back(it->_key);
+	unlock();
+
+	return kIndexableNamesListed;
+}
+
 
 } // End of namespace Common
@@ -27,13 +27,16 @@
 #include "common/archive.h"
 #include "common/hash-str.h"
 #include "common/hashmap.h"
+#include "common/list.h"
 #include "common/ptr.h"
 #include "common/str.h"
+#include "common/thread.h"
 
 class AbstractFSNode;
 
 namespace Common {
 
+class DirectoryCache;
 class FSNode;
 class SeekableReadStream;
 class WriteStream;
@@ -129,6 +132,17 @@ public:
 	 */
 	FSNode getChild(const String &name) const;
 
+	/**
+	 * Like getChild(), but trusts the caller that the child exists and
+	 * whether it is a directory, so that the backend does not need to check.
+	 * This is meant for caches of directory contents.
+	 *
+	 * @param name			the name of a child of this directory
+	 * @param isDirectory	whether the child is a directory
+	 * @return the node referring to the child with the given name
+	 */
+	FSNode getChildWithKnownType(const String &name, bool isDirectory) const;
+
 	/**
 	 * Return a list of all child nodes of this directory node. If called on a node
 	 * that does not represent a directory, false is returned.
@@ -213,6 +227,19 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Retrieves the size and the time of the last modification of the file
+	 * referred by this node, without opening it. This is meant for caches
+	 * that need to notice when a file changed; not all backends support it.
+	 * For directories, the modification time changes whenever entries are
+	 * added, removed or renamed, while the size is backend specific.
+	 *
+	 * @param size				set to the file size in bytes
+	 * @param modificationTime	set to the modification time, in seconds since an arbitrary epoch
+	 * @return true if both values were retrieved, false otherwise.
+	 */
+	bool getFileInfo(uint32 &size, uint32 &modificationTime) const;
+
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -222,6 +249,16 @@ public:
 	 */
 	virtual SeekableReadStream *createReadStream() const;
 
+	/**
+	 * Like createReadStream(), but large files may be mapped into memory
+	 * where the backend supports it. Only use this for read-only game data:
+	 * the file must not be truncated while the stream exists, and savefiles
+	 * or files being written should be opened with createReadStream().
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	SeekableReadStream *createMappedReadStream() const;
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -280,6 +317,13 @@ public:
  * and using 'your' as prefix, the cache entry would have been 'your/data/file.ext'.
  * This is done both in non-flat and flat mode.
  *
+ * In non-flat mode, directories are listed one at a time as they are needed,
+ * so looking up 'data/file.ext' only lists c:\my and c:\my\data. Looking up
+ * files in flat mode, or listing members, needs the whole tree. The rest of
+ * the tree can be listed ahead of time on a separate thread, see
+ * scanInBackground(), and listings can be kept on disk between runs, see
+ * setDirectoryCache().
+ *
  */
 class FSDirectory : public Archive {
 	FSNode _node;
@@ -296,15 +340,61 @@ class FSDirectory : public Archive {
 	mutable NodeCache	_fileCache, _subDirCache;
 	mutable bool _cached;
 
+	// A directory of a non-flat tree which still has to be listed
+	struct PendingDir {
+		FSNode node;	// not set for the root, which is listed through _node
+		String prefix;	// prepended to the keys of its members
+		int depth;		// levels left to cache, including this one
+	};
+
+	enum DirState {
+		kDirPending,
+		kDirListing,
+		kDirListed
+	};
+
+	// State of the directories of a non-flat tree, by the prefix of their members
+	typedef HashMap<String, DirState, IgnoreCase_Hash, IgnoreCase_EqualTo> DirStateMap;
+	mutable DirStateMap _dirStates;
+	mutable List<PendingDir> _pending;
+	mutable bool _seeded;
+	mutable uint _listing;	// directories being listed right now
+
+	DirectoryCache *_dirCache;
+	bool _mapFiles;
+
+	// background scan; the lock protects all of the cache state above
+	ThreadManager *_threads;
+	ThreadManager::ThreadRef _scanThread;
+	ThreadManager::MutexRef _mutex;
+	ThreadManager::SemaphoreRef _progress;
+	mutable uint _waiters;
+	volatile bool _quit;
+
+	void lock() const;
+	void unlock() const;
+	// wait until a directory was listed, the lock must be held
+	void waitForProgress() const;
+	void wakeWaiters() const;
+
+	static void scanProc(void *param);
+
 	// look for a match
-	FSNode *lookupCache(NodeCache &cache, const String &name) const;
+	bool lookupCache(const NodeCache &cache, const String &name, FSNode &node) const;
 
 	// cache management
-	void cacheDirectoryRecursive(FSNode node, int depth, const String& prefix) const;
+	void listDirectory(const FSNode &node, FSList &list) const;
+	void cacheDirectoryRecursive(const FSNode &node, int depth, const String& prefix) const;
+	void seedPending() const;
+	void listPending(List<PendingDir>::iterator it) const;
+	DirState findDirectory(const String &key, String &found) const;
 
-	// fill cache if not already cached
+	// fill cache if not already cached, the lock must be held
 	void ensureCached() const;
 
+	// cache the directory a member would be in, the lock must be held
+	void ensureListed(const String &name) const;
+
 public:
 	/**
 	 * Create a FSDirectory representing a tree with the specified depth. Will result in an
@@ -332,6 +422,30 @@ public:
 	 */
 	FSNode getFSNode() const;
 
+	/**
+	 * Keep the listings of the directories in the given cache, and use them
+	 * instead of listing directories which did not change. Must be called
+	 * before the FSDirectory is used.
+	 */
+	void setDirectoryCache(DirectoryCache *cache) { _dirCache = cache; }
+
+	/**
+	 * Open members with FSNode::createMappedReadStream(), for a tree of
+	 * read-only game data. Off by default.
+	 */
+	void setMapFiles(bool mapFiles) { _mapFiles = mapFiles; }
+
+	/**
+	 * Start listing the whole tree on a separate thread. Lookups then only
+	 * wait for the directories they need (or for the whole tree in flat
+	 * mode), while those are listed on the calling thread if the scan did
+	 * not get to them yet. Must be called before the FSDirectory is used.
+	 *
+	 * @param threads  the thread manager to use; nullptr selects the one of
+	 *                 g_system. Without any, nothing happens.
+	 */
+	void scanInBackground(ThreadManager *threads = nullptr);
+
 	/**
 	 * Create a new FSDirectory pointing to a sub directory of the instance. See class comment
 	 * for an explanation of the prefix parameter.
@@ -369,6 +483,13 @@ public:
 	 * for success.
 	 */
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
+
+	/**
+	 * Lists the names of all the files in the cache. While a background
+	 * scan is still running, this returns kIndexableNamesPending instead of
+	 * waiting for it.
+	 */
+	virtual IndexableNames listIndexableNames(StringArray &names) const;
 };
 
 
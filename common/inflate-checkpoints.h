@@ -0,0 +1,117 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_INFLATE_CHECKPOINTS_H
+#define COMMON_INFLATE_CHECKPOINTS_H
+
+#include "common/array.h"
+#include "common/scummsys.h"
+
+#if defined(USE_ZLIB)
+
+struct z_stream_s;
+
+namespace Common {
+
+/**
+ * Points from which inflating raw deflate data can be resumed, as in zlib's
+ * zran.c example. At the boundary between two deflate blocks, an inflater
+ * only needs the bit position in the compressed data and the last 32KB of
+ * output, its dictionary. Seekable inflating streams take such checkpoints
+ * while reading forward, so that seeking backward does not need to start
+ * over from the beginning of the data.
+ *
+ * At most kMaxCheckpoints are kept, each with its own window. Once that
+ * many are taken, every second one is dropped and the distance between
+ * checkpoints doubles, so memory stays bounded for data of any size.
+ *
+ * This is used by the seekable streams in zlib.cpp and unzip.cpp, which
+ * include zlib themselves; it is implemented in zlib.cpp.
+ */
+class InflateCheckpoints {
+public:
+	enum {
+		kWindowSize = 32768,	///< 1 << MAX_WBITS, the furthest a deflate match may look back
+		kMaxCheckpoints = 64
+	};
+
+	struct Checkpoint {
+		uint32 in;		///< offset of the first compressed byte wholly in the next block
+		uint32 out;		///< uncompressed position
+		uint32 crc;		///< CRC-32 of the output up to out, for streams which check it
+		int bits;		///< number of bits of the byte before in belonging to the next block
+		uint windowSize;
+		byte *window;	///< the output right before out, as the next block's dictionary
+	};
+
+	/**
+	 * @param span	initial distance between checkpoints in uncompressed bytes
+	 */
+	explicit InflateCheckpoints(uint32 span);
+	~InflateCheckpoints();
+
+	/**
+	 * Whether a checkpoint should be taken after inflate(stream, Z_BLOCK)
+	 * returned with out bytes produced in total. This is the case at the end
+	 * of any block but the last, once far enough from the previous checkpoint.
+	 */
+	bool isDue(const z_stream_s &stream, uint32 out) const;
+
+	/**
+	 * Add a checkpoint at the position the stream stopped at.
+	 *
+	 * @param stream		the inflater, right after isDue() returned true
+	 * @param in			compressed offset of the next byte the inflater will read
+	 * @param out			uncompressed position
+	 * @param crc			CRC-32 of the output so far, if the caller needs it
+	 * @param window		the output before out, allocated with new[]; owned
+	 *						by the checkpoints from now on
+	 * @param windowSize	size of the window, at most kWindowSize
+	 */
+	void add(const z_stream_s &stream, uint32 in, uint32 out, uint32 crc, byte *window, uint windowSize);
+
+	/** The last checkpoint at or before the given position, if any. */
+	const Checkpoint *find(uint32 target) const;
+
+	/** The number of checkpoints currently held. */
+	uint size() const { return _checkpoints.size(); }
+
+	/**
+	 * Prepare an inflater, reset for raw deflate data, to continue from a
+	 * checkpoint. Its input must then start at checkpoint.in.
+	 *
+	 * @param partial	the compressed byte at checkpoint.in - 1; only used
+	 *					if checkpoint.bits is not zero
+	 * @return false if zlib reported an error
+	 */
+	static bool restore(z_stream_s &stream, const Checkpoint &checkpoint, byte partial);
+
+private:
+	Array<Checkpoint> _checkpoints;
+	uint32 _span;
+};
+
+} // End of namespace Common
+
+#endif // USE_ZLIB
+
+#endif
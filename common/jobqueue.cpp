@@ -0,0 +1,310 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/jobqueue.h"
+#include "common/atomic.h"
+#include "common/system.h"
+#include "common/textconsole.h"
+
+namespace Common {
+
+namespace {
+
+struct RangeJob {
+	JobQueue::RangeProc proc;
+	void *param;
+	uint begin;
+	uint end;
+};
+
+void runRange(void *param) {
+	const RangeJob *range = (const RangeJob *)param;
+	range->proc(range->begin, range->end, range->param);
+}
+
+} // End of anonymous namespace
+
+JobQueue::JobQueue(uint workers, ThreadManager *threads)
+	: _threads(threads), _available(nullptr), _groupMutex(nullptr), _pushMutex(nullptr), _nextQueue(0), _quit(false) {
+	if (!_threads && g_system)
+		_threads = g_system->getThreadManager();
+	if (!_threads)
+		return;
+
+	if (workers == 0)
+		workers = _threads->getCPUCount() - 1;
+	if (workers == 0) {
+		_threads = nullptr;
+		return;
+	}
+
+	_available = _threads->createSemaphore(0);
+	_groupMutex = _threads->createMutex();
+	_pushMutex = _threads->createMutex();
+
+	if (_available && _groupMutex && _pushMutex) {
+		// All queues must exist before the first worker starts stealing
+		for (uint i = 0; i < workers; ++i) {
+			WorkerQueue *queue = new WorkerQueue;
+			queue->mutex = _threads->createMutex();
+			queue->jobs.resize(16);
+			queue->head = 0;
+			queue->count = 0;
+			if (!queue->mutex) {
+				delete queue;
+				break;
+			}
+			_queues.push_back(queue);
+		}
+
+		for (uint i = 0; i < _queues.size(); ++i) {
+			Worker *worker = new Worker;
+			worker->queue = this;
+			worker->index = i;
+			worker->thread = _threads->createThread(workerProc, worker);
+			if (!worker->thread) {
+				delete worker;
+				break;
+			}
+			_workers.push_back(worker);
+		}
+	}
+
+	if (_workers.empty()) {
+		warning("JobQueue: Could not start any worker thread, running jobs synchronously");
+		shutdown();
+	}
+}
+
+JobQueue::~JobQueue() {
+	// Jobs which nobody waited for still have to run
+	Job job;
+	while (!_workers.empty() && steal(0, job))
+		run(job);
+
+	shutdown();
+}
+
+void JobQueue::shutdown() {
+	atomicStore(_quit, true);
+	for (uint i = 0; i < _workers.size(); ++i)
+		_threads->postSemaphore(_available);
+	for (uint i = 0; i < _workers.size(); ++i) {
+		_threads->joinThread(_workers[i]->thread);
+		delete _workers[i];
+	}
+	_workers.clear();
+
+	for (uint i = 0; i < _queues.size(); ++i) {
+		_threads->deleteMutex(_queues[i]->mutex);
+		delete _queues[i];
+	}
+	_queues.clear();
+
+	if (_available)
+		_threads->deleteSemaphore(_available);
+	if (_groupMutex)
+		_threads->deleteMutex(_groupMutex);
+	if (_pushMutex)
+		_threads->deleteMutex(_pushMutex);
+	_available = nullptr;
+	_groupMutex = _pushMutex = nullptr;
+	_threads = nullptr;
+}
+
+void JobQueue::workerProc(void *param) {
+	const Worker *worker = (const Worker *)param;
+	JobQueue *queue = worker->queue;
+
+	for (;;) {
+		queue->_threads->waitSemaphore(queue->_available);
+		if (atomicLoad(queue->_quit))
+			break;
+
+		// Keep going while there is work; surplus wakeups find nothing
+		Job job;
+		while (queue->popOwn(worker->index, job) || queue->steal(worker->index + 1, job))
+			queue->run(job);
+	}
+}
+
+bool JobQueue::popOwn(uint index, Job &job) {
+	WorkerQueue &queue = *_queues[index];
+	bool found = false;
+
+	_threads->lockMutex(queue.mutex);
+	if (queue.count) {
+		--queue.count;
+		job = queue.jobs[(queue.head + queue.count) % queue.jobs.size()];
+		found = true;
+	}
+	_threads->unlockMutex(queue.mutex);
+
+	return found;
+}
+
+bool JobQueue::steal(uint first, Job &job) {
+	for (uint i = 0; i < _queues.size(); ++i) {
+		WorkerQueue &queue = *_queues[(first + i) % _queues.size()];
+		bool found = false;
+
+		_threads->lockMutex(queue.mutex);
+		if (queue.count) {
+			job = queue.jobs[queue.head];
+			queue.head = (queue.head + 1) % queue.jobs.size();
+			--queue.count;
+			found = true;
+		}
+		_threads->unlockMutex(queue.mutex);
+
+		if (found)
+			return true;
+	}
+
+	return false;
+}
+
+void JobQueue::run(const Job &job) {
+	job.proc(job.param);
+
+	if (job.group) {
+		_threads->lockMutex(_groupMutex);
+		if (--job.group->_pending == 0 && job.group->_done)
+			_threads->postSemaphore(job.group->_done);
+		_threads->unlockMutex(_groupMutex);
+	}
+}
+
+bool JobQueue::isFinished(JobGroup &group) {
+	if (_workers.empty())
+		return true;
+
+	_threads->lockMutex(_groupMutex);
+	const bool finished = (group._pending == 0);
+	_threads->unlockMutex(_groupMutex);
+	return finished;
+}
+
+void JobQueue::push(JobProc proc, void *param, JobGroup *group) {
+	if (_workers.empty()) {
+		proc(param);
+		return;
+	}
+
+	if (group) {
+		_threads->lockMutex(_groupMutex);
+		++group->_pending;
+		_threads->unlockMutex(_groupMutex);
+	}
+
+	_threads->lockMutex(_pushMutex);
+	WorkerQueue &queue = *_queues[_nextQueue];
+	_nextQueue = (_nextQueue + 1) % _queues.size();
+	_threads->unlockMutex(_pushMutex);
+
+	_threads->lockMutex(queue.mutex);
+	if (queue.count == queue.jobs.size()) {
+		Array<Job> jobs;
+		jobs.resize(queue.jobs.size() * 2);
+		for (uint i = 0; i < queue.count; ++i)
+			jobs[i] = queue.jobs[(queue.head + i) % queue.jobs.size()];
+		queue.jobs = jobs;
+		queue.head = 0;
+	}
+	Job &job = queue.jobs[(queue.head + queue.count) % queue.jobs.size()];
+	job.proc = proc;
+	job.param = param;
+	job.group = group;
+	++queue.count;
+	_threads->unlockMutex(queue.mutex);
+
+	_threads->postSemaphore(_available);
+}
+
+void JobQueue::wait(JobGroup &group) {
+	if (_workers.empty())
+		return;
+
+	// Help out until there is nothing left to take
+	Job job;
+	while (!isFinished(group) && steal(0, job))
+		run(job);
+
+	// The remaining jobs of the group are running on the workers
+	ThreadManager::SemaphoreRef done = _threads->createSemaphore(0);
+	if (!done) {
+		while (!isFinished(group)) {
+			if (steal(0, job))
+				run(job);
+		}
+		return;
+	}
+
+	_threads->lockMutex(_groupMutex);
+	const bool finished = (group._pending == 0);
+	if (!finished)
+		group._done = done;
+	_threads->unlockMutex(_groupMutex);
+
+	if (!finished) {
+		_threads->waitSemaphore(done);
+		_threads->lockMutex(_groupMutex);
+		group._done = nullptr;
+		_threads->unlockMutex(_groupMutex);
+	}
+
+	_threads->deleteSemaphore(done);
+}
+
+void JobQueue::parallelFor(uint begin, uint end, uint grain, RangeProc proc, void *param) {
+	if (end <= begin)
+		return;
+
+	const uint count = end - begin;
+	if (grain == 0) {
+		const uint chunks = 4 * getConcurrency();
+		grain = MAX<uint>(1, (count + chunks - 1) / chunks);
+	}
+
+	if (_workers.empty() || count <= grain) {
+		proc(begin, end, param);
+		return;
+	}
+
+	// The jobs point into the array, so it must not grow after the pushes
+	Array<RangeJob> ranges;
+	ranges.resize((count + grain - 1) / grain);
+
+	JobGroup group;
+	for (uint i = 0; i < ranges.size(); ++i) {
+		RangeJob &range = ranges[i];
+		range.proc = proc;
+		range.param = param;
+		range.begin = begin + i * grain;
+		range.end = MIN(end, range.begin + grain);
+		push(runRange, &range, &group);
+	}
+
+	wait(group);
+}
+
+} // End of namespace Common
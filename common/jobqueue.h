@@ -0,0 +1,159 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_JOBQUEUE_H
+#define COMMON_JOBQUEUE_H
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/noncopyable.h"
+#include "common/thread.h"
+
+namespace Common {
+
+/**
+ * A pool of worker threads which run small, independent jobs.
+ *
+ * Every worker owns a queue of jobs. New jobs are spread over these queues;
+ * a worker runs the jobs from its own queue in LIFO order and steals the
+ * oldest job from another queue once its own one is empty. Threads which
+ * wait for a group of jobs help running them instead of sleeping, so jobs
+ * may themselves push and wait for more jobs.
+ *
+ * If the backend has no ThreadManager, or no workers were requested, every
+ * job runs on the calling thread as soon as it is pushed. Code using a
+ * JobQueue hence never needs a separate single threaded path, but jobs must
+ * not rely on running concurrently.
+ */
+class JobQueue : NonCopyable {
+public:
+	typedef void (*JobProc)(void *param);
+	typedef void (*RangeProc)(uint begin, uint end, void *param);
+
+	/**
+	 * A set of jobs which can be waited for as a whole. Its lifetime must
+	 * extend until wait() has returned.
+	 */
+	struct JobGroup {
+		JobGroup() : _pending(0), _done(nullptr) {}
+
+	private:
+		friend class JobQueue;
+
+		uint _pending;
+		ThreadManager::SemaphoreRef _done;
+	};
+
+	/**
+	 * @param workers  number of worker threads to start; 0 uses one worker
+	 *                 less than the number of CPU cores, since the thread
+	 *                 waiting for the results helps out
+	 * @param threads  the thread manager to use; nullptr selects the one
+	 *                 of g_system. Without any, all jobs run synchronously.
+	 */
+	explicit JobQueue(uint workers = 0, ThreadManager *threads = nullptr);
+	~JobQueue();
+
+	/** Return the number of worker threads, 0 when running synchronously. */
+	uint getWorkerCount() const { return _workers.size(); }
+
+	/**
+	 * Return the number of threads taking part in wait() and parallelFor(),
+	 * i.e. the workers plus the waiting thread.
+	 */
+	uint getConcurrency() const { return _workers.size() + 1; }
+
+	/**
+	 * Queue proc(param) for execution.
+	 *
+	 * @param group  if set, the job is added to this group
+	 */
+	void push(JobProc proc, void *param, JobGroup *group = nullptr);
+
+	/**
+	 * Return once every job of the group has finished, running queued jobs
+	 * on the calling thread in the meantime.
+	 */
+	void wait(JobGroup &group);
+
+	/**
+	 * Return whether every job of the group has finished, without waiting.
+	 * Once this returns true, everything the jobs wrote is visible to the
+	 * calling thread.
+	 */
+	bool isFinished(JobGroup &group);
+
+	/**
+	 * Split [begin, end) into chunks of at most grain elements, call
+	 * proc(chunkBegin, chunkEnd, param) for every chunk in parallel, and
+	 * wait for all of them.
+	 *
+	 * @param grain  chunk size; 0 picks one which gives every thread a few
+	 *               chunks, so uneven chunks can be balanced out
+	 */
+	void parallelFor(uint begin, uint end, uint grain, RangeProc proc, void *param);
+
+private:
+	struct Job {
+		JobProc proc;
+		void *param;
+		JobGroup *group;
+	};
+
+	/** A growable ring buffer of jobs, protected by its own mutex. */
+	struct WorkerQueue {
+		ThreadManager::MutexRef mutex;
+		Array<Job> jobs;
+		uint head;
+		uint count;
+	};
+
+	struct Worker {
+		JobQueue *queue;
+		uint index;
+		ThreadManager::ThreadRef thread;
+	};
+
+	static void workerProc(void *param);
+
+	bool popOwn(uint index, Job &job);
+	bool steal(uint first, Job &job);
+	void run(const Job &job);
+	void shutdown();
+
+	ThreadManager *_threads;
+	Array<Worker *> _workers;
+	Array<WorkerQueue *> _queues;
+
+	/** Counts the jobs pushed; workers sleep on it while idle. */
+	ThreadManager::SemaphoreRef _available;
+	/** Protects the counters of all job groups. */
+	ThreadManager::MutexRef _groupMutex;
+	/** Protects _nextQueue. */
+	ThreadManager::MutexRef _pushMutex;
+	uint _nextQueue;
+	volatile bool _quit;
+};
+
+} // End of namespace Common
+
+#endif
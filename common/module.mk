@@ -7,6 +7,7 @@ MODULE_OBJS := \
 	coroutines.o \
 	dcl.o \
 	debug.o \
+	dircache.o \
 	error.o \
 	events.o \
 	file.o \
@@ -16,6 +17,7 @@ MODULE_OBJS := \
 	iff_container.o \
 	ini-file.o \
 	installshield_cab.o \
+	jobqueue.o \
 	json.o \
 	language.o \
 	localization.o \
@@ -65,6 +67,11 @@ MODULE_OBJS += \
 	updates.o
 endif
 
+ifdef ENABLE_FRAME_STATS
+MODULE_OBJS += \
+	framestats.o
+endif
+
 ifdef USE_LUA
 MODULE_OBJS += \
 	lua/double_serialization.o \
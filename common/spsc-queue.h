@@ -0,0 +1,104 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_SPSC_QUEUE_H
+#define COMMON_SPSC_QUEUE_H
+
+#include "common/scummsys.h"
+#include "common/atomic.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+/**
+ * Fixed size, lock-free queue for passing items from exactly one producer
+ * thread to exactly one consumer thread. Neither side ever blocks: push()
+ * fails when the queue is full and pop() fails when it is empty.
+ *
+ * @tparam T     item type, copied in and out of the queue
+ * @tparam SIZE  capacity, must be a power of two
+ */
+template<class T, uint SIZE>
+class SPSCQueue : NonCopyable {
+public:
+	SPSCQueue() : _head(0), _tail(0) {}
+
+	/**
+	 * Append an item. May only be called by the producer.
+	 *
+	 * @return false if the queue is full
+	 */
+	bool push(const T &item) {
+		STATIC_ASSERT((SIZE & (SIZE - 1)) == 0, SPSCQueue_size_must_be_a_power_of_two);
+
+		const uint tail = _tail;
+		if (tail - atomicLoad(_head) == SIZE)
+			return false;
+
+		_items[tail & (SIZE - 1)] = item;
+		atomicStore(_tail, tail + 1);
+		return true;
+	}
+
+	/**
+	 * Remove the oldest item. May only be called by the consumer.
+	 *
+	 * @return false if the queue is empty
+	 */
+	bool pop(T &item) {
+		const uint head = _head;
+		if (atomicLoad(_tail) == head)
+			return false;
+
+		item = _items[head & (SIZE - 1)];
+		atomicStore(_head, head + 1);
+		return true;
+	}
+
+	/**
+	 * Number of queued items. Only a snapshot when called while the other
+	 * side is active.
+	 */
+	uint size() const {
+		return atomicLoad(_tail) - atomicLoad(_head);
+	}
+
+	bool empty() const {
+		return size() == 0;
+	}
+
+	uint capacity() const {
+		return SIZE;
+	}
+
+private:
+	T _items[SIZE];
+
+	/** Index of the next item to pop, only written by the consumer. */
+	volatile uint _head;
+	/** Index of the next free slot, only written by the producer. */
+	volatile uint _tail;
+};
+
+} // End of namespace Common
+
+#endif
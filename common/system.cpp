@@ -32,6 +32,7 @@
 #include "common/dialogs.h"
 #include "common/textconsole.h"
 #include "common/text-to-speech.h"
+#include "common/thread.h"
 
 #include "backends/audiocd/default/default-audiocd.h"
 #include "backends/fs/fs-factory.h"
@@ -43,6 +44,7 @@ OSystem::OSystem() {
 	_audiocdManager = nullptr;
 	_eventManager = nullptr;
 	_timerManager = nullptr;
+	_threadManager = nullptr;
 	_savefileManager = nullptr;
 #if defined(USE_TASKBAR)
 	_taskbarManager = nullptr;
@@ -70,6 +72,9 @@ OSystem::~OSystem() {
 	delete _timerManager;
 	_timerManager = nullptr;
 
+	delete _threadManager;
+	_threadManager = nullptr;
+
 #if defined(USE_TASKBAR)
 	delete _taskbarManager;
 	_taskbarManager = nullptr;
@@ -231,6 +236,10 @@ Common::TimerManager *OSystem::getTimerManager() {
 	return _timerManager;
 }
 
+Common::ThreadManager *OSystem::getThreadManager() {
+	return _threadManager;
+}
+
 Common::SaveFileManager *OSystem::getSavefileManager() {
 	return _savefileManager;
 }
@@ -58,6 +58,7 @@ class TextToSpeechManager;
 class DialogManager;
 #endif
 class TimerManager;
+class ThreadManager;
 class SeekableReadStream;
 class WriteStream;
 class HardwareInputSet;
@@ -164,6 +165,14 @@ protected:
 	 */
 	Common::TimerManager *_timerManager;
 
+	/**
+	 * No default value is provided for _threadManager by OSystem.
+	 * Backends which leave it unset run all jobs synchronously.
+	 *
+	 * @note _threadManager is deleted by the OSystem destructor.
+	 */
+	Common::ThreadManager *_threadManager;
+
 	/**
 	 * No default value is provided for _savefileManager by OSystem.
 	 *
@@ -429,7 +438,15 @@ public:
 		/**
 		* For platforms that should not have a Quit button
 		*/
-		kFeatureNoQuit
+		kFeatureNoQuit,
+
+		/**
+		 * The backend can store engine sprites and draw them on top of
+		 * the game screen itself, see createSprite().
+		 *
+		 * This is not a toggle-able feature.
+		 */
+		kFeatureSpriteBatching
 
 	};
 
@@ -970,6 +987,60 @@ public:
 	 */
 	virtual void clearFocusRectangle() {}
 
+	/**
+	 * Return the pixel format sprite data has to be in. Only meaningful
+	 * when kFeatureSpriteBatching is supported.
+	 */
+	virtual Graphics::PixelFormat getSpriteFormat() const { return Graphics::PixelFormat(); }
+
+	/**
+	 * Create a sprite: an image kept by the backend, usually in video
+	 * memory, which can be drawn on top of the game screen any number of
+	 * times without copying it to the screen first. Engines which build
+	 * their frames from many separate layers can use this to leave the
+	 * compositing to the backend, see kFeatureSpriteBatching.
+	 *
+	 * The contents of the sprite are transparent until set with
+	 * copyRectToSprite().
+	 *
+	 * @param width  the width of the sprite
+	 * @param height the height of the sprite
+	 * @return a handle for the sprite, or 0 if the backend cannot create it
+	 */
+	virtual uint32 createSprite(uint width, uint height) { return 0; }
+
+	/**
+	 * Free a sprite created by createSprite(). Pending draws of the sprite
+	 * are dropped.
+	 */
+	virtual void destroySprite(uint32 sprite) {}
+
+	/**
+	 * Copy image data to a sprite, see copyRectToScreen(). The data has
+	 * to be in the format returned by getSpriteFormat().
+	 */
+	virtual void copyRectToSprite(uint32 sprite, const void *buf, int pitch, int x, int y, int w, int h) {}
+
+	/**
+	 * Queue a sprite for drawing on top of the game screen. Queued sprites
+	 * are drawn in the order they were queued, with alpha blending, by
+	 * every updateScreen() call until clearSprites() is called.
+	 *
+	 * @param sprite the sprite to draw
+	 * @param x      the x coordinate of the destination, in game screen pixels
+	 * @param y      the y coordinate of the destination, in game screen pixels
+	 * @param w      the width of the destination; the sprite is stretched
+	 *               to fill it
+	 * @param h      the height of the destination
+	 * @param color  an ARGB color (0xAARRGGBB) the sprite is modulated with
+	 */
+	virtual void drawSprite(uint32 sprite, int x, int y, int w, int h, uint32 color = 0xFFFFFFFF) {}
+
+	/**
+	 * Empty the queue of sprites to draw.
+	 */
+	virtual void clearSprites() {}
+
 	//@}
 
 
@@ -1130,6 +1201,16 @@ public:
 	*/
 	virtual uint32 getMillis(bool skipRecord = false) = 0;
 
+	/**
+	 * Get a timestamp in microseconds, for measuring short durations such
+	 * as the stages of a frame. Only differences between two values are
+	 * meaningful. This may be called from any thread.
+	 *
+	 * The default implementation is based on getMillis(); backends should
+	 * override it when they have a finer clock.
+	 */
+	virtual uint64 getMicros() { return (uint64)getMillis(true) * 1000; }
+
 	/** Delay/sleep for the specified amount of milliseconds. */
 	virtual void delayMillis(uint msecs) = 0;
 
@@ -1146,6 +1227,13 @@ public:
 	 */
 	virtual Common::TimerManager *getTimerManager();
 
+	/**
+	 * Return the thread manager, or nullptr if the backend cannot run
+	 * code in parallel. For more information, refer to the ThreadManager
+	 * documentation; most code should use Common::JobQueue instead.
+	 */
+	virtual Common::ThreadManager *getThreadManager();
+
 	/**
 	 * Return the event manager singleton. For more information, refer
 	 * to the EventManager documentation.
@@ -0,0 +1,97 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_THREAD_H
+#define COMMON_THREAD_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+/**
+ * Low level threading primitives, implemented by the backend.
+ *
+ * Backends which cannot run code in parallel simply do not provide a
+ * ThreadManager; OSystem::getThreadManager() then returns nullptr.
+ * Engines should not use this directly but go through Common::JobQueue,
+ * which falls back to running everything on the calling thread.
+ *
+ * The mutexes provided here are separate from the OSystem ones, since
+ * backends without threaded timers are free to implement those as no-ops.
+ */
+class ThreadManager : NonCopyable {
+public:
+	typedef void (*ThreadProc)(void *param);
+
+	typedef struct OpaqueThread *ThreadRef;
+	typedef struct OpaqueThreadMutex *MutexRef;
+	typedef struct OpaqueSemaphore *SemaphoreRef;
+
+	virtual ~ThreadManager() {}
+
+	/**
+	 * Return the number of CPU cores available to us, at least 1.
+	 */
+	virtual uint getCPUCount() = 0;
+
+	/**
+	 * Start a new thread which runs proc(param).
+	 * @return the new thread, or 0 if it could not be created.
+	 */
+	virtual ThreadRef createThread(ThreadProc proc, void *param) = 0;
+
+	/**
+	 * Wait until the given thread has returned from its ThreadProc, and
+	 * release its resources. Every thread must be joined exactly once.
+	 */
+	virtual void joinThread(ThreadRef thread) = 0;
+
+	/**
+	 * Create a new mutex. Unlike OSystem mutexes, these need not be
+	 * recursive, so a thread must never lock one twice.
+	 * @return the newly created mutex, or 0 if an error occurred.
+	 */
+	virtual MutexRef createMutex() = 0;
+	virtual void lockMutex(MutexRef mutex) = 0;
+	virtual void unlockMutex(MutexRef mutex) = 0;
+	virtual void deleteMutex(MutexRef mutex) = 0;
+
+	/**
+	 * Create a counting semaphore with the given initial value.
+	 * @return the newly created semaphore, or 0 if an error occurred.
+	 */
+	virtual SemaphoreRef createSemaphore(uint initialValue) = 0;
+
+	/** Block until the value of the semaphore is non-zero, then decrement it. */
+	virtual void waitSemaphore(SemaphoreRef sem) = 0;
+
+	/** Increment the value of the semaphore, waking up a waiting thread. */
+	virtual void postSemaphore(SemaphoreRef sem) = 0;
+
+	/** Delete the given semaphore. No thread may be waiting on it. */
+	virtual void deleteSemaphore(SemaphoreRef sem) = 0;
+};
+
+} // End of namespace Common
+
+#endif
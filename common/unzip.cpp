@@ -106,9 +106,14 @@ typedef struct {
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/substream.h"
+#include "common/textconsole.h"
 
+#include "common/array.h"
+#include "common/inflate-checkpoints.h"
 #include "common/hashmap.h"
 #include "common/hash-str.h"
+#include "common/ptr.h"
 
 #if defined(STRICTUNZIP) || defined(STRICTZIPUNZIP)
 /* like the STRICT of WIN32, we define a pointer that cannot be converted
@@ -382,6 +387,7 @@ typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_H
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<Common::SeekableReadStream> _streamOwner;	/* owns _stream, shared with member streams */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -544,6 +550,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 	int err=UNZ_OK;
 
 	us->_stream = stream;
+	us->_streamOwner = Common::SharedPtr<Common::SeekableReadStream>(stream);
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos==0)
@@ -595,7 +602,6 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		err=UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return nullptr;
 	}
@@ -644,7 +650,6 @@ int unzClose(unzFile file) {
 	if (s->pfile_in_zip_read != nullptr)
 		unzCloseCurrentFile(file);
 
-	delete s->_stream;
 	delete s;
 	return UNZ_OK;
 }
@@ -1419,8 +1424,317 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 
 namespace Common {
 
+namespace {
+
+/**
+ * A stored member, read straight from the archive. The archive stream is
+ * shared, so the member stays readable after the ZipArchive is deleted.
+ *
+ * The CRC is verified over data read in order from the start of the member:
+ * reaching the end that way with a mismatch sets the error flag. Data read
+ * after seeking elsewhere is not checked, unless the member is read again
+ * from the start.
+ */
+class ZipStoredReadStream : public SafeSeekableSubReadStream {
+public:
+	ZipStoredReadStream(const SharedPtr<SeekableReadStream> &archive, const String &name,
+	                    uint32 begin, uint32 size, uint32 crc)
+		: SafeSeekableSubReadStream(archive.get(), begin, begin + size), _archive(archive),
+		  _name(name), _expectedCrc(crc), _crc(0), _crcPos(0), _crcErr(false) {
+	}
+
+	bool err() const { return _crcErr || SafeSeekableSubReadStream::err(); }
+	void clearErr() { _crcErr = false; SafeSeekableSubReadStream::clearErr(); }
+
+	uint32 read(void *dataPtr, uint32 dataSize);
+
+private:
+	SharedPtr<SeekableReadStream> _archive;
+	const String _name;
+	const uint32 _expectedCrc;
+	uint32 _crc;
+	uint32 _crcPos;		///< bytes covered by _crc, from the start of the member
+	bool _crcErr;
+};
+
+uint32 ZipStoredReadStream::read(void *dataPtr, uint32 dataSize) {
+	const uint32 start = pos();
+	const uint32 count = SafeSeekableSubReadStream::read(dataPtr, dataSize);
+
+#ifdef USE_ZLIB
+	if (start == 0)
+		_crc = _crcPos = 0;
+
+	if (start == _crcPos && count) {
+		_crc = crc32(_crc, (const byte *)dataPtr, count);
+		_crcPos += count;
+
+		if (_crcPos == (uint32)size() && _crc != _expectedCrc) {
+			warning("ZipStoredReadStream: CRC mismatch in '%s'", _name.c_str());
+			_crcErr = true;
+		}
+	}
+#endif // otherwise the CRC is not verified, as with the other members
+
+	return count;
+}
+
+#ifdef USE_ZLIB
+
+/**
+ * A deflated member, inflated on demand. Only the last 32KB of output is
+ * kept, so small backward seeks are free. For larger ones the inflater is
+ * restarted from the closest checkpoint: while inflating, the decoder state
+ * is saved at deflate block boundaries every kCheckpointSpan bytes of output
+ * (the approach of zlib's zran.c example).
+ *
+ * Every stream has its own inflater and only touches the shared archive
+ * stream to fetch compressed data, so several members may be read at once.
+ */
+class ZipInflateReadStream : public SeekableReadStream {
+public:
+	ZipInflateReadStream(const SharedPtr<SeekableReadStream> &archive, const String &name,
+	                     uint32 dataOffset, uint32 compressedSize, uint32 size, uint32 crc);
+	~ZipInflateReadStream();
+
+	bool err() const { return _err; }
+	void clearErr() { _err = false; _eos = false; }
+	bool eos() const { return _eos; }
+
+	uint32 read(void *dataPtr, uint32 dataSize);
+
+	int32 pos() const { return _pos; }
+	int32 size() const { return _size; }
+	bool seek(int32 offset, int whence = SEEK_SET);
+
+private:
+	enum {
+		kWindowSize = 1 << MAX_WBITS,	// the furthest a deflate match may look back
+		kInputSize = UNZ_BUFSIZE,
+		kCheckpointSpan = 1024 * 1024	// initial output distance between checkpoints
+	};
+
+	/** First position still held in the window. */
+	uint32 windowBegin() const { return MAX(_windowStart, _inflatePos > kWindowSize ? _inflatePos - kWindowSize : 0); }
+
+	bool readCompressed(uint32 offset, byte *buffer, uint32 size);
+	bool seekInflater(uint32 target);
+	void restart();
+	bool restore(const InflateCheckpoints::Checkpoint &checkpoint);
+	bool inflateMore();
+	void addCheckpoint();
+
+	SharedPtr<SeekableReadStream> _archive;
+	const String _name;
+	const uint32 _dataOffset;
+	const uint32 _compressedSize;
+	const uint32 _size;
+	const uint32 _expectedCrc;
+
+	z_stream _stream;
+	bool _streamInitialized;
+	byte _input[kInputSize];
+	uint32 _inPos;			///< compressed bytes handed to zlib so far
+
+	byte _window[kWindowSize];	///< circular buffer of the most recent output
+	uint32 _windowStart;	///< where the inflater was last (re)started
+	uint32 _inflatePos;		///< uncompressed bytes produced so far
+	uint32 _crc;
+
+	InflateCheckpoints _checkpoints;
+
+	uint32 _pos;
+	bool _eos;
+	bool _err;
+};
+
+ZipInflateReadStream::ZipInflateReadStream(const SharedPtr<SeekableReadStream> &archive, const String &name,
+                                           uint32 dataOffset, uint32 compressedSize, uint32 size, uint32 crc)
+	: _archive(archive), _name(name), _dataOffset(dataOffset), _compressedSize(compressedSize),
+	  _size(size), _expectedCrc(crc), _streamInitialized(false), _inPos(0), _windowStart(0),
+	  _inflatePos(0), _crc(0), _checkpoints(kCheckpointSpan), _pos(0), _eos(false), _err(false) {
+	memset(&_stream, 0, sizeof(_stream));
+
+	// A negative window size means raw deflate data without a zlib header
+	_streamInitialized = (inflateInit2(&_stream, -MAX_WBITS) == Z_OK);
+	if (_streamInitialized)
+		restart();
+	else
+		_err = true;
+}
+
+ZipInflateReadStream::~ZipInflateReadStream() {
+	if (_streamInitialized)
+		inflateEnd(&_stream);
+}
+
+uint32 ZipInflateReadStream::read(void *dataPtr, uint32 dataSize) {
+	byte *dst = (byte *)dataPtr;
+	uint32 done = 0;
+
+	while (done < dataSize && !_err) {
+		if (_pos >= _size) {
+			_eos = true;
+			break;
+		}
+
+		if (!seekInflater(_pos)) {
+			_err = true;
+			break;
+		}
+
+		if (_pos >= _inflatePos) {
+			if (!inflateMore())
+				_err = true;
+			continue;
+		}
+
+		const uint32 offset = _pos % kWindowSize;
+		const uint32 count = MIN(MIN(dataSize - done, _inflatePos - _pos), (uint32)kWindowSize - offset);
+		memcpy(dst + done, _window + offset, count);
+		done += count;
+		_pos += count;
+	}
+
+	return done;
+}
+
+bool ZipInflateReadStream::seek(int32 offset, int whence) {
+	int32 newPos;
+	switch (whence) {
+	case SEEK_END:
+		newPos = _size + offset;
+		break;
+	case SEEK_CUR:
+		newPos = _pos + offset;
+		break;
+	case SEEK_SET:
+	default:
+		newPos = offset;
+		break;
+	}
+
+	if (newPos < 0 || (uint32)newPos > _size)
+		return false;
+
+	// The actual work is deferred until the next read
+	_pos = newPos;
+	_eos = false;
+	return true;
+}
+
+bool ZipInflateReadStream::readCompressed(uint32 offset, byte *buffer, uint32 size) {
+	if (!_archive->seek(_dataOffset + offset, SEEK_SET))
+		return false;
+	return _archive->read(buffer, size) == size;
+}
+
+bool ZipInflateReadStream::seekInflater(uint32 target) {
+	// The latest checkpoint not past the target
+	const InflateCheckpoints::Checkpoint *best = _checkpoints.find(target);
+
+	// Continuing from the current position is no more work than restoring
+	if (target >= windowBegin() && (!best || best->out <= _inflatePos))
+		return true;
+
+	if (!best) {
+		restart();
+		return true;
+	}
+
+	return restore(*best);
+}
+
+void ZipInflateReadStream::restart() {
+	inflateReset(&_stream);
+	_stream.avail_in = 0;
+	_inPos = 0;
+	_inflatePos = _windowStart = 0;
+	_crc = crc32(0, nullptr, 0);
+}
+
+bool ZipInflateReadStream::restore(const InflateCheckpoints::Checkpoint &checkpoint) {
+	inflateReset(&_stream);
+	_stream.avail_in = 0;
+	_inPos = checkpoint.in;
+
+	byte partial = 0;
+	if (checkpoint.bits && !readCompressed(checkpoint.in - 1, &partial, 1))
+		return false;
+
+	if (!InflateCheckpoints::restore(_stream, checkpoint, partial))
+		return false;
+
+	_inflatePos = _windowStart = checkpoint.out;
+	_crc = checkpoint.crc;
+	return true;
+}
+
+bool ZipInflateReadStream::inflateMore() {
+	// Once all input is taken, zlib may still owe output, e.g. the rest of
+	// a match cut short by the end of the window
+	if (_stream.avail_in == 0 && _inPos < _compressedSize) {
+		const uint32 count = MIN<uint32>(kInputSize, _compressedSize - _inPos);
+		if (!readCompressed(_inPos, _input, count))
+			return false;
+
+		_inPos += count;
+		_stream.next_in = _input;
+		_stream.avail_in = count;
+	}
+
+	const uint32 offset = _inflatePos % kWindowSize;
+	const uint32 space = MIN((uint32)kWindowSize - offset, _size - _inflatePos);
+	_stream.next_out = _window + offset;
+	_stream.avail_out = space;
+
+	// Z_BLOCK stops at every block boundary, where checkpoints can be taken
+	const int ret = inflate(&_stream, Z_BLOCK);
+	const uint32 produced = space - _stream.avail_out;
+
+	// Z_BUF_ERROR only means that no progress was possible
+	if (ret == Z_BUF_ERROR ? produced == 0 : (ret != Z_OK && ret != Z_STREAM_END))
+		return false;
+
+	_crc = crc32(_crc, _window + offset, produced);
+	_inflatePos += produced;
+
+	if (_inflatePos == _size) {
+		if (_crc != _expectedCrc) {
+			warning("ZipInflateReadStream: CRC mismatch in '%s'", _name.c_str());
+			return false;
+		}
+	} else if (ret == Z_STREAM_END) {
+		return false;
+	}
+
+	if (_checkpoints.isDue(_stream, _inflatePos))
+		addCheckpoint();
+
+	return true;
+}
+
+void ZipInflateReadStream::addCheckpoint() {
+	// Unroll the circular window, oldest byte first
+	const uint32 offset = _inflatePos % kWindowSize;
+	byte *window = new byte[kWindowSize];
+	memcpy(window, _window + offset, kWindowSize - offset);
+	memcpy(window + kWindowSize - offset, _window, offset);
+
+	_checkpoints.add(_stream, _inPos - _stream.avail_in, _inflatePos, _crc, window, kWindowSize);
+}
+
+#endif // USE_ZLIB
+
+} // End of anonymous namespace
 
 class ZipArchive : public Archive {
+	/**
+	 * Members up to this size are read into memory when opened, larger ones
+	 * are read (and inflated) on demand.
+	 */
+	static const uint32 kMaxInflatedMemberSize = 128 * 1024;
+
 	unzFile _zipFile;
 
 public:
@@ -1433,6 +1747,7 @@ public:
 	virtual int listMembers(ArchiveMemberList &list) const;
 	virtual const ArchiveMemberPtr getMember(const String &name) const;
 	virtual SeekableReadStream *createReadStreamForMember(const String &name) const;
+	virtual IndexableNames listIndexableNames(StringArray &names) const;
 };
 
 /*
@@ -1478,6 +1793,15 @@ int ZipArchive::listMembers(ArchiveMemberList &list) const {
 	return members;
 }
 
+Archive::IndexableNames ZipArchive::listIndexableNames(StringArray &names) const {
+	const unz_s *const archive = (const unz_s *)_zipFile;
+	for (ZipHash::const_iterator i = archive->_hash.begin(), end = archive->_hash.end();
+	     i != end; ++i)
+		names.push_back(i->_key);
+
+	return kIndexableNamesListed;
+}
+
 const ArchiveMemberPtr ZipArchive::getMember(const String &name) const {
 	if (!hasFile(name))
 		return ArchiveMemberPtr();
@@ -1489,32 +1813,50 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
 		return nullptr;
 
-	unz_file_info fileInfo;
-	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
+	unz_s *s = (unz_s *)_zipFile;
+	uInt sizeVar;
+	uLong offsetLocalExtrafield;
+	uInt sizeLocalExtrafield;
+	if (unzlocal_CheckCurrentFileCoherencyHeader(s, &sizeVar, &offsetLocalExtrafield, &sizeLocalExtrafield) != UNZ_OK)
 		return nullptr;
 
-	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK)
+	const unz_file_info &fileInfo = s->cur_file_info;
+	const uint32 dataOffset = s->byte_before_the_zipfile + s->cur_file_info_internal.offset_curfile +
+	                          SIZEZIPLOCALHEADER + sizeVar;
+	if (dataOffset + fileInfo.compressed_size > (uint32)s->_stream->size())
 		return nullptr;
 
-	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
-	assert(buffer);
-
-	if (unzReadCurrentFile(_zipFile, buffer, fileInfo.uncompressed_size) != (int)fileInfo.uncompressed_size) {
-		free(buffer);
+	SeekableReadStream *stream;
+	if (fileInfo.compression_method == 0) {
+		if (fileInfo.compressed_size != fileInfo.uncompressed_size)
+			return nullptr;
+		stream = new ZipStoredReadStream(s->_streamOwner, name, dataOffset, fileInfo.uncompressed_size, fileInfo.crc);
+#ifdef USE_ZLIB
+	} else if (fileInfo.compression_method == Z_DEFLATED) {
+		stream = new ZipInflateReadStream(s->_streamOwner, name, dataOffset,
+		                                  fileInfo.compressed_size, fileInfo.uncompressed_size, fileInfo.crc);
+#endif
+	} else {
+		// Unsupported compression method, or cannot decompress the file without zlib
 		return nullptr;
 	}
 
-	if (unzCloseCurrentFile(_zipFile) != UNZ_OK) {
+	if (fileInfo.uncompressed_size > kMaxInflatedMemberSize)
+		return stream;
+
+	// Small members take less memory in a buffer than the inflater would, and
+	// reading them whole verifies their CRC before they are handed out
+	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
+	assert(buffer || !fileInfo.uncompressed_size);
+
+	const bool ok = stream->read(buffer, fileInfo.uncompressed_size) == fileInfo.uncompressed_size && !stream->err();
+	delete stream;
+	if (!ok) {
 		free(buffer);
 		return nullptr;
 	}
 
 	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
 }
 
 Archive *makeZipArchive(const String &name) {
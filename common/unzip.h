@@ -51,7 +51,10 @@ Archive *makeZipArchive(const FSNode &node);
  * This factory method creates an Archive instance corresponding to the content
  * of the given ZIP compressed datastream.
  * This takes ownership of the stream,  in particular, it is deleted when the
- * ZipArchive is deleted.
+ * ZipArchive and all member streams created from it are deleted.
+ *
+ * Member streams read their data from the archive stream as needed, so they
+ * may be used at the same time, but not from different threads.
  *
  * May return 0 in case of a failure. In this case stream will still be deleted.
  */
@@ -24,6 +24,8 @@
 #define FORBIDDEN_SYMBOL_ALLOW_ALL
 
 #include "common/zlib.h"
+#include "common/array.h"
+#include "common/inflate-checkpoints.h"
 #include "common/ptr.h"
 #include "common/util.h"
 #include "common/stream.h"
@@ -44,6 +46,11 @@
   #if ZLIB_VERNUM < 0x1204
   #error Version 1.2.0.4 or newer of zlib is required for this code
   #endif
+
+  // Seek checkpoints need inflateGetDictionary(), new in zlib 1.2.7.1
+  #if ZLIB_VERNUM >= 0x1271
+  #define GZIP_SEEK_CHECKPOINTS
+  #endif
 #endif
 
 
@@ -218,6 +225,67 @@ bool inflateZlibHeaderless(Common::WriteStream *dst, Common::SeekableReadStream
 	return (status == Z_OK);
 }
 
+InflateCheckpoints::InflateCheckpoints(uint32 span) : _span(span) {
+}
+
+InflateCheckpoints::~InflateCheckpoints() {
+	for (uint i = 0; i < _checkpoints.size(); ++i)
+		delete[] _checkpoints[i].window;
+}
+
+bool InflateCheckpoints::isDue(const z_stream &stream, uint32 out) const {
+	// Bit 7 of data_type is set at the end of a block, bit 6 if it was the last one
+	if (!(stream.data_type & 128) || (stream.data_type & 64))
+		return false;
+
+	const uint32 last = _checkpoints.empty() ? 0 : _checkpoints.back().out;
+	return out >= last + _span;
+}
+
+void InflateCheckpoints::add(const z_stream &stream, uint32 in, uint32 out, uint32 crc, byte *window, uint windowSize) {
+	if (_checkpoints.size() == kMaxCheckpoints) {
+		// Out of room: keep every second checkpoint and space the
+		// following ones twice as far apart
+		uint kept = 0;
+		for (uint i = 0; i < _checkpoints.size(); ++i) {
+			if (i & 1)
+				delete[] _checkpoints[i].window;
+			else
+				_checkpoints[kept++] = _checkpoints[i];
+		}
+		_checkpoints.resize(kept);
+		_span *= 2;
+
+		if (out < _checkpoints.back().out + _span) {
+			delete[] window;
+			return;
+		}
+	}
+
+	Checkpoint checkpoint;
+	checkpoint.in = in;
+	checkpoint.out = out;
+	checkpoint.crc = crc;
+	checkpoint.bits = stream.data_type & 7;
+	checkpoint.windowSize = windowSize;
+	checkpoint.window = window;
+	_checkpoints.push_back(checkpoint);
+}
+
+const InflateCheckpoints::Checkpoint *InflateCheckpoints::find(uint32 target) const {
+	const Checkpoint *found = nullptr;
+	for (uint i = 0; i < _checkpoints.size() && _checkpoints[i].out <= target; ++i)
+		found = &_checkpoints[i];
+	return found;
+}
+
+bool InflateCheckpoints::restore(z_stream &stream, const Checkpoint &checkpoint, byte partial) {
+	if (checkpoint.bits && inflatePrime(&stream, checkpoint.bits, partial >> (8 - checkpoint.bits)) != Z_OK)
+		return false;
+
+	return inflateSetDictionary(&stream, checkpoint.window, checkpoint.windowSize) == Z_OK;
+}
+
 #ifndef RELEASE_BUILD
 static bool _shownBackwardSeekingWarning = false;
 #endif
@@ -226,11 +294,17 @@ static bool _shownBackwardSeekingWarning = false;
  * A simple wrapper class which can be used to wrap around an arbitrary
  * other SeekableReadStream and will then provide on-the-fly decompression support.
  * Assumes the compressed data to be in gzip format.
+ *
+ * While decompressing, the state of the inflater is saved at deflate block
+ * boundaries every so often (the approach of zlib's zran.c example), so that
+ * backward seeks can resume from the closest checkpoint instead of from the
+ * start of the data.
  */
 class GZipReadStream : public SeekableReadStream {
 protected:
 	enum {
-		BUFSIZE = 16384		// 1 << MAX_WBITS
+		BUFSIZE = 16384,	// 1 << MAX_WBITS
+		CHECKPOINT_SPAN = 256 * 1024	// initial output distance between checkpoints
 	};
 
 	byte	_buf[BUFSIZE];
@@ -242,9 +316,43 @@ protected:
 	uint32 _origSize;
 	bool _eos;
 
+	InflateCheckpoints _checkpoints;
+
+#ifdef GZIP_SEEK_CHECKPOINTS
+	void addCheckpoint(uint32 out) {
+		byte *window = new byte[InflateCheckpoints::kWindowSize];
+		uint windowSize = 0;
+		if (inflateGetDictionary(&_stream, window, &windowSize) != Z_OK) {
+			delete[] window;
+			return;
+		}
+
+		_checkpoints.add(_stream, _wrapped->pos() - _stream.avail_in, out, 0, window, windowSize);
+	}
+
+	/** Continue inflating raw deflate data from the given checkpoint. */
+	bool restoreCheckpoint(const InflateCheckpoints::Checkpoint &checkpoint) {
+		_zlibErr = inflateReset2(&_stream, -MAX_WBITS);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_wrapped->seek(checkpoint.in - (checkpoint.bits ? 1 : 0), SEEK_SET);
+		const byte partial = checkpoint.bits ? _wrapped->readByte() : 0;
+		if (!InflateCheckpoints::restore(_stream, checkpoint, partial)) {
+			_zlibErr = Z_DATA_ERROR;
+			return false;
+		}
+
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+		_pos = checkpoint.out;
+		return true;
+	}
+#endif
+
 public:
 
-	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0) : _wrapped(w), _stream() {
+	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0) : _wrapped(w), _stream(), _checkpoints(CHECKPOINT_SPAN) {
 		assert(w != nullptr);
 
 		// Verify file header is correct
@@ -301,7 +409,16 @@ public:
 				_stream.next_in = _buf;
 				_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
 			}
+#ifdef GZIP_SEEK_CHECKPOINTS
+			// Stop at every block boundary, where checkpoints can be taken
+			_zlibErr = inflate(&_stream, Z_BLOCK);
+
+			const uint32 out = _pos + dataSize - _stream.avail_out;
+			if (_zlibErr == Z_OK && _checkpoints.isDue(_stream, out))
+				addCheckpoint(out);
+#else
 			_zlibErr = inflate(&_stream, Z_NO_FLUSH);
+#endif
 		}
 
 		// Update the position counter
@@ -341,10 +458,16 @@ public:
 
 		assert(newPos >= 0);
 
-		if ((uint32)newPos < _pos) {
-			// To search backward, we have to restart the whole decompression
-			// from the start of the file. A rather wasteful operation, best
-			// to avoid it. :/
+		const InflateCheckpoints::Checkpoint *checkpoint = _checkpoints.find(newPos);
+		if (checkpoint && (checkpoint->out > _pos || (uint32)newPos < _pos)) {
+#ifdef GZIP_SEEK_CHECKPOINTS
+			if (!restoreCheckpoint(*checkpoint))
+				return false; // FIXME: STREAM REWRITE
+#endif
+		} else if ((uint32)newPos < _pos) {
+			// To search backward without a checkpoint, we have to restart
+			// the whole decompression from the start of the file. A rather
+			// wasteful operation, best to avoid it. :/
 
 #ifndef RELEASE_BUILD
 			if (!_shownBackwardSeekingWarning) {
@@ -358,7 +481,12 @@ public:
 
 			_pos = 0;
 			_wrapped->seek(0, SEEK_SET);
+#ifdef GZIP_SEEK_CHECKPOINTS
+			// Resuming from a checkpoint switched to raw deflate data
+			_zlibErr = inflateReset2(&_stream, MAX_WBITS + 32);
+#else
 			_zlibErr = inflateReset(&_stream);
+#endif
 			if (_zlibErr != Z_OK)
 				return false; // FIXME: STREAM REWRITE
 			_stream.next_in = _buf;
@@ -33,6 +33,7 @@
 #include "gui/gui-manager.h"
 #include "gui/message.h"
 #include "engines/advancedDetector.h"
+#include "engines/detectioncache.h"
 #include "engines/obsolete.h"
 
 static Common::String sanitizeName(const char *name) {
@@ -360,13 +361,24 @@ bool AdvancedMetaEngine::getFileProperties(const Common::FSNode &parent, const F
 	// file and as one with resource fork.
 
 	if (game.flags & ADGF_MACRESFORK) {
-		Common::MacResManager macResMan;
+		// The resource fork may live in a separate file, so it can only be
+		// cached when the data fork file is there to check for changes.
+		const Common::FSNode *dataFork = allFiles.contains(fname) ? &allFiles[fname] : nullptr;
 
-		if (!macResMan.open(parent, fname))
-			return false;
+		if (!dataFork || !DetectionCacheMan.lookup(*dataFork, DetectionCache::kResourceFork, _md5Bytes, fileProps.size, fileProps.md5)) {
+			Common::MacResManager macResMan;
 
-		fileProps.md5 = macResMan.computeResForkMD5AsString(_md5Bytes);
-		fileProps.size = macResMan.getResForkDataSize();
+			if (!macResMan.open(parent, fname))
+				return false;
+
+			fileProps.md5 = macResMan.computeResForkMD5AsString(_md5Bytes);
+			fileProps.size = macResMan.getResForkDataSize();
+
+			if (dataFork)
+				DetectionCacheMan.store(*dataFork, DetectionCache::kResourceFork, _md5Bytes, fileProps.size, fileProps.md5);
+			else
+				DetectionCacheMan.countHashed();
+		}
 
 		if (fileProps.size != 0)
 			return true;
@@ -375,13 +387,18 @@ bool AdvancedMetaEngine::getFileProperties(const Common::FSNode &parent, const F
 	if (!allFiles.contains(fname))
 		return false;
 
+	const Common::FSNode &node = allFiles[fname];
+	if (DetectionCacheMan.lookup(node, DetectionCache::kDataFork, _md5Bytes, fileProps.size, fileProps.md5))
+		return true;
+
 	Common::File testFile;
 
-	if (!testFile.open(allFiles[fname]))
+	if (!testFile.open(node))
 		return false;
 
 	fileProps.size = (int32)testFile.size();
 	fileProps.md5 = Common::computeStreamMD5AsString(testFile, _md5Bytes);
+	DetectionCacheMan.store(node, DetectionCache::kDataFork, _md5Bytes, fileProps.size, fileProps.md5);
 	return true;
 }
 
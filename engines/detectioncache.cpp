@@ -0,0 +1,262 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/detectioncache.h"
+
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/fs.h"
+#include "common/savefile.h"
+#include "common/system.h"
+#include "common/thread.h"
+
+namespace Common {
+DECLARE_SINGLETON(DetectionCache);
+}
+
+static const char *const kCacheFileName = "scummvm-detection.cache";
+static const char *const kCacheHeader = "ScummVM detection cache 1";
+
+enum {
+	kMinFlushInterval = 10 * 1000	///< Minimum time between unforced writes, in milliseconds
+};
+
+/**
+ * The reference counts of String are not thread safe, so strings stored in
+ * or handed out of the cache are always copied into new storage.
+ */
+static Common::String unshare(const Common::String &str) {
+	return Common::String(str.c_str(), str.size());
+}
+
+DetectionCache::DetectionCache()
+	: _threads(nullptr), _mutex(nullptr), _loaded(false), _dirty(false), _enabled(true), _lastFlush(0), _hashed(0), _cached(0) {
+	if (g_system)
+		_threads = g_system->getThreadManager();
+	if (_threads)
+		_mutex = _threads->createMutex();
+}
+
+DetectionCache::~DetectionCache() {
+	if (_mutex)
+		_threads->deleteMutex(_mutex);
+}
+
+void DetectionCache::lock() {
+	if (_mutex)
+		_threads->lockMutex(_mutex);
+}
+
+void DetectionCache::unlock() {
+	if (_mutex)
+		_threads->unlockMutex(_mutex);
+}
+
+bool DetectionCache::isEnabled() const {
+	return _enabled && (!ConfMan.hasKey("detection_cache") || ConfMan.getBool("detection_cache"));
+}
+
+Common::String DetectionCache::makeKey(const Common::String &path, Fork fork, uint md5Bytes) {
+	return Common::String::format("%c%u:", fork == kResourceFork ? 'r' : 'd', md5Bytes) + path;
+}
+
+bool DetectionCache::lookup(const Common::FSNode &node, Fork fork, uint md5Bytes, int32 &size, Common::String &md5) {
+	if (!isEnabled())
+		return false;
+
+	uint32 fileSize, modificationTime;
+	if (!node.getFileInfo(fileSize, modificationTime))
+		return false;
+
+	const Common::String key = makeKey(node.getPath(), fork, md5Bytes);
+
+	lock();
+	loadLocked();
+	EntryMap::const_iterator it = _entries.find(key);
+	const bool found = it != _entries.end() && it->_value.fileSize == fileSize && it->_value.modificationTime == modificationTime;
+	if (found) {
+		size = it->_value.size;
+		md5 = unshare(it->_value.md5);
+		_cached++;
+	}
+	unlock();
+
+	return found;
+}
+
+void DetectionCache::store(const Common::FSNode &node, Fork fork, uint md5Bytes, int32 size, const Common::String &md5) {
+	if (!isEnabled()) {
+		countHashed();
+		return;
+	}
+
+	Entry entry;
+	if (!node.getFileInfo(entry.fileSize, entry.modificationTime)) {
+		countHashed();
+		return;
+	}
+
+	entry.size = size;
+	entry.md5 = unshare(md5);
+	const Common::String key = makeKey(node.getPath(), fork, md5Bytes);
+
+	lock();
+	loadLocked();
+	_entries[key] = entry;
+	_dirty = true;
+	_hashed++;
+	unlock();
+}
+
+void DetectionCache::countHashed() {
+	lock();
+	_hashed++;
+	unlock();
+}
+
+void DetectionCache::resetStats() {
+	lock();
+	_hashed = _cached = 0;
+	unlock();
+}
+
+void DetectionCache::loadLocked() {
+	// Command line detection runs before the backend is set up, and has
+	// to make do with what it hashes itself
+	Common::SaveFileManager *saveFileMan = g_system ? g_system->getSavefileManager() : nullptr;
+	if (_loaded || !saveFileMan)
+		return;
+	_loaded = true;
+
+	Common::InSaveFile *in = saveFileMan->openForLoading(kCacheFileName);
+	if (!in)
+		return;
+
+	if (!parse(*in))
+		warning("Ignoring detection cache with unknown format");
+	delete in;
+}
+
+bool DetectionCache::loadFrom(Common::SeekableReadStream &in) {
+	lock();
+	const bool result = parse(in);
+	unlock();
+	return result;
+}
+
+bool DetectionCache::parse(Common::SeekableReadStream &in) {
+	if (in.readLine() != kCacheHeader)
+		return false;
+
+	// Each line holds the file size and modification time the entry is
+	// valid for, the detection properties and the key, separated by tabs
+	while (!in.eos() && !in.err()) {
+		const Common::String line = in.readLine();
+		const char *fields[5];
+		const char *pos = line.c_str();
+		int count = 0;
+
+		for (; count < 4; count++) {
+			fields[count] = pos;
+			pos = strchr(pos, '\t');
+			if (!pos)
+				break;
+			pos++;
+		}
+
+		// The key is last, so its path may contain tabs itself
+		if (count != 4)
+			continue;
+		fields[4] = pos;
+
+		// Entries stored before the file was loaded are newer
+		if (_entries.contains(fields[4]))
+			continue;
+
+		Entry entry;
+		entry.fileSize = strtoul(fields[0], nullptr, 10);
+		entry.modificationTime = strtoul(fields[1], nullptr, 10);
+		entry.size = (int32)strtol(fields[2], nullptr, 10);
+		entry.md5 = Common::String(fields[3], fields[4] - 1);
+		_entries[fields[4]] = entry;
+	}
+
+	debug(2, "Loaded %u detection cache entries", _entries.size());
+	return true;
+}
+
+void DetectionCache::flush(bool force) {
+	Common::SaveFileManager *saveFileMan = g_system ? g_system->getSavefileManager() : nullptr;
+	if (!saveFileMan)
+		return;
+
+	lock();
+
+	const uint32 time = g_system->getMillis();
+	if (!_dirty || (!force && _lastFlush && time - _lastFlush < kMinFlushInterval)) {
+		unlock();
+		return;
+	}
+
+	// Don't lose the entries of earlier sessions which were not needed yet
+	loadLocked();
+
+	Common::OutSaveFile *out = saveFileMan->openForSaving(kCacheFileName, false);
+	if (!out) {
+		unlock();
+		warning("Could not write detection cache");
+		return;
+	}
+
+	write(*out);
+	out->finalize();
+	if (out->err())
+		warning("Could not write detection cache");
+	delete out;
+
+	_dirty = false;
+	_lastFlush = time ? time : 1;
+	unlock();
+}
+
+void DetectionCache::saveTo(Common::WriteStream &out) {
+	lock();
+	write(out);
+	unlock();
+}
+
+void DetectionCache::write(Common::WriteStream &out) const {
+	out.writeString(kCacheHeader);
+	out.writeByte('\n');
+	for (EntryMap::const_iterator it = _entries.begin(); it != _entries.end(); ++it) {
+		const Entry &entry = it->_value;
+		out.writeString(Common::String::format("%u\t%u\t%d\t%s\t%s\n", entry.fileSize, entry.modificationTime, entry.size, entry.md5.c_str(), it->_key.c_str()));
+	}
+}
+
+void DetectionCache::clear() {
+	lock();
+	_entries.clear();
+	_loaded = true;
+	_dirty = true;
+	unlock();
+}
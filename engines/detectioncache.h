@@ -0,0 +1,151 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef ENGINES_DETECTIONCACHE_H
+#define ENGINES_DETECTIONCACHE_H
+
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/singleton.h"
+#include "common/str.h"
+#include "common/thread.h"
+
+namespace Common {
+class FSNode;
+class SeekableReadStream;
+class WriteStream;
+}
+
+/**
+ * Keeps the MD5 sums computed during game detection on disk, so that
+ * scanning the same directories again only needs to hash the files which
+ * were added or changed since. Entries are keyed by the path of a file and
+ * only used while its size and modification time stay the same.
+ *
+ * Files whose size and modification time the backend cannot report (see
+ * Common::FSNode::getFileInfo) are always hashed.
+ *
+ * Detection may run on several threads at once, so all methods lock the
+ * cache. The singleton must first be used on the main thread once the
+ * backend is set up, so that it exists and gets a mutex before any worker
+ * uses it.
+ */
+class DetectionCache : public Common::Singleton<DetectionCache> {
+public:
+	enum Fork {
+		kDataFork,
+		kResourceFork
+	};
+
+	/**
+	 * Looks up the properties of a file computed by an earlier detection run.
+	 *
+	 * @param node		the file
+	 * @param fork		which fork of the file was hashed
+	 * @param md5Bytes	how many bytes were hashed
+	 * @param size		set to the size stored with the entry
+	 * @param md5		set to the MD5 stored with the entry
+	 * @return true if a valid entry was found
+	 */
+	bool lookup(const Common::FSNode &node, Fork fork, uint md5Bytes, int32 &size, Common::String &md5);
+
+	/**
+	 * Stores freshly computed properties of a file.
+	 */
+	void store(const Common::FSNode &node, Fork fork, uint md5Bytes, int32 size, const Common::String &md5);
+
+	/**
+	 * Writes the cache to disk if it changed. Unless forced, this happens
+	 * at most every few seconds, so that it can be called after every
+	 * directory during long scans.
+	 */
+	void flush(bool force = false);
+
+	/**
+	 * Drops all entries, including the ones of earlier sessions which
+	 * were not loaded yet. The file on disk is replaced at the next flush.
+	 */
+	void clear();
+
+	/**
+	 * Adds the entries written by saveTo() to the cache, keeping the ones
+	 * already present.
+	 *
+	 * @return false if the data is not in the expected format
+	 */
+	bool loadFrom(Common::SeekableReadStream &in);
+
+	/** Writes all entries to the given stream. */
+	void saveTo(Common::WriteStream &out);
+
+	/** Enables or disables the cache, regardless of the "detection_cache" setting. */
+	void setEnabled(bool enabled) { _enabled = enabled; }
+	bool isEnabled() const;
+
+	/** Number of files hashed since the statistics were last reset. */
+	uint32 getHashedCount() const { return _hashed; }
+	/** Number of files served from the cache since the statistics were last reset. */
+	uint32 getCachedCount() const { return _cached; }
+	void resetStats();
+
+	/** Counts a file which had to be hashed because it could not be cached. */
+	void countHashed();
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	DetectionCache();
+	~DetectionCache();
+
+	struct Entry {
+		uint32 fileSize;
+		uint32 modificationTime;
+		int32 size;
+		Common::String md5;
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	void lock();
+	void unlock();
+
+	/** Reads the cache file if that did not happen yet. Must be called with the lock held. */
+	void loadLocked();
+	bool parse(Common::SeekableReadStream &in);
+	void write(Common::WriteStream &out) const;
+	static Common::String makeKey(const Common::String &path, Fork fork, uint md5Bytes);
+
+	Common::ThreadManager *_threads;
+	Common::ThreadManager::MutexRef _mutex;
+
+	EntryMap _entries;
+	bool _loaded;
+	bool _dirty;
+	bool _enabled;
+	uint32 _lastFlush;
+	uint32 _hashed;
+	uint32 _cached;
+};
+
+/** Shortcut for accessing the detection cache. */
+#define DetectionCacheMan DetectionCache::instance()
+
+#endif
@@ -34,8 +34,10 @@
 #include "engines/metaengine.h"
 
 #include "common/config-manager.h"
+#include "common/dircache.h"
 #include "common/events.h"
 #include "common/file.h"
+#include "common/fs.h"
 #include "common/system.h"
 #include "common/str.h"
 #include "common/ustr.h"
@@ -192,10 +194,30 @@ Engine::~Engine() {
 	// Remove our cursors again to prevent memory leaks
 	CursorMan.popCursor();
 	CursorMan.popCursorPalette();
+
+	if (ConfMan.getBool("directory_cache"))
+		DirectoryCacheMan.flush();
 }
 
 void Engine::initializePath(const Common::FSNode &gamePath) {
-	SearchMan.addDirectory(gamePath.getPath(), gamePath, 0, 4);
+	if (!gamePath.exists() || !gamePath.isDirectory())
+		return;
+
+	// Only the directories needed by the first lookups are listed right away,
+	// the rest of the game directory is listed while the engine starts up.
+	// Like SearchMan.addDirectory(), respect an engine's request to ignore
+	// name clashes.
+	Common::FSDirectory *dir = new Common::FSDirectory(gamePath, 4, false, SearchMan.getIgnoreClashes());
+	if (ConfMan.getBool("directory_cache")) {
+		DirectoryCacheMan.load();
+		dir->setDirectoryCache(&DirectoryCacheMan);
+	}
+	// Game data is only read, so large files may be mapped into memory.
+	// Savefiles go through the savefile manager and are never mapped.
+	dir->setMapFiles(true);
+	dir->scanInBackground();
+
+	SearchMan.add(gamePath.getPath(), dir, 0);
 }
 
 void initCommonGFX() {
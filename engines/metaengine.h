@@ -39,6 +39,7 @@ class OSystem;
 namespace Common {
 class Keymap;
 class FSList;
+class JobQueue;
 class OutSaveFile;
 class String;
 
@@ -406,6 +407,21 @@ public:
 	 */
 	DetectionResults detectGames(const Common::FSList &fslist) const;
 
+	/**
+	 * Detect the games in several directories at once. Each plugin is only
+	 * loaded once for the whole batch, rather than once per directory.
+	 *
+	 * Returns one result per file list, in the same order. Each one is the
+	 * same as what detectGames() returns for that file list on its own.
+	 *
+	 * If a job queue is given, the directories are detected in parallel on
+	 * it, one job per directory and loaded plugin. Plugins are still loaded
+	 * and unloaded on the calling thread only. Every file list is only used
+	 * by a single job, since FSNode reference counts are not thread safe,
+	 * and the detection cache must be set up (see DetectionCache).
+	 */
+	Common::Array<DetectionResults> detectGames(const Common::Array<Common::FSList> &fslists, Common::JobQueue *jobs = nullptr) const;
+
 	/** Find a plugin by its engine ID */
 	const Plugin *findPlugin(const Common::String &engineId) const;
 
@@ -117,6 +117,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("resource_types",		WRAP_METHOD(Console, cmdResourceTypes));
 	registerCmd("list",				WRAP_METHOD(Console, cmdList));
 	registerCmd("alloc_list",				WRAP_METHOD(Console, cmdAllocList));
+	registerCmd("resource_cache",		WRAP_METHOD(Console, cmdResourceCache));
 	registerCmd("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
 	registerCmd("verify_scripts",		WRAP_METHOD(Console, cmdVerifyScripts));
 	registerCmd("integrity_dump",	WRAP_METHOD(Console, cmdResourceIntegrityDump));
@@ -163,6 +164,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("gc_reachable",		WRAP_METHOD(Console, cmdGCShowReachable));
 	registerCmd("gc_freeable",		WRAP_METHOD(Console, cmdGCShowFreeable));
 	registerCmd("gc_normalize",		WRAP_METHOD(Console, cmdGCNormalize));
+	registerCmd("gc_stats",			WRAP_METHOD(Console, cmdGCStats));
 	// Music/SFX
 	registerCmd("songlib",			WRAP_METHOD(Console, cmdSongLib));
 	registerCmd("songinfo",			WRAP_METHOD(Console, cmdSongInfo));
@@ -225,6 +227,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("bpe",				WRAP_METHOD(Console, cmdBreakpointFunction));		// alias
 	// VM
 	registerCmd("script_steps",		WRAP_METHOD(Console, cmdScriptSteps));
+	registerCmd("selector_cache",		WRAP_METHOD(Console, cmdSelectorCache));
 	registerCmd("script_objects",   WRAP_METHOD(Console, cmdScriptObjects));
 	registerCmd("scro",             WRAP_METHOD(Console, cmdScriptObjects));
 	registerCmd("script_strings",   WRAP_METHOD(Console, cmdScriptStrings));
@@ -347,6 +350,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" resource_types - Shows the valid resource types\n");
 	debugPrintf(" list - Lists all the resources of a given type\n");
 	debugPrintf(" alloc_list - Lists all allocated resources\n");
+	debugPrintf(" resource_cache - Shows resource cache statistics, or changes its size\n");
 	debugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
 	debugPrintf(" verify_scripts - Performs sanity checks on SCI1.1-SCI2.1 game scripts (e.g. if they're up to 64KB in total)\n");
 	debugPrintf(" integrity_dump - Dumps integrity data about resources in the current game to disk\n");
@@ -388,6 +392,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" gc_reachable - Lists all addresses directly reachable from a given memory object\n");
 	debugPrintf(" gc_freeable - Lists all addresses freeable in a given segment\n");
 	debugPrintf(" gc_normalize - Prints the \"normal\" address of a given address\n");
+	debugPrintf(" gc_stats - Shows garbage collector pause statistics\n");
 	debugPrintf("\n");
 	debugPrintf("Music/SFX:\n");
 	debugPrintf(" songlib - Shows the song library\n");
@@ -433,6 +438,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf("\n");
 	debugPrintf("VM:\n");
 	debugPrintf(" script_steps - Shows the number of executed SCI operations\n");
+	debugPrintf(" selector_cache - Shows or controls the selector lookup cache\n");
 	debugPrintf(" script_objects / scro - Shows all objects inside a specified script\n");
 	debugPrintf(" script_strings / scrs - Shows all strings inside a specified script\n");
 	debugPrintf(" script_said - Shows all said - strings inside a specified script\n");
@@ -1040,6 +1046,38 @@ bool Console::cmdAllocList(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdResourceCache(int argc, const char **argv) {
+	ResourceManager *resMan = _engine->getResMan();
+	ResourceCacheStats &stats = resMan->getCacheStats();
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		stats.reset();
+		debugPrintf("Resource cache statistics reset\n");
+		return true;
+	} else if (argc == 3 && !scumm_stricmp(argv[1], "size")) {
+		int kiloBytes;
+		if (!parseInteger(argv[2], kiloBytes))
+			return true;
+		if (!resMan->setCacheBudget(kiloBytes)) {
+			debugPrintf("The cache size must be positive\n");
+			return true;
+		}
+	} else if (argc != 1) {
+		debugPrintf("Shows resource cache statistics, resets them or changes the cache size.\n");
+		debugPrintf("Usage: %s [reset | size <KiB>]\n", argv[0]);
+		return true;
+	}
+
+	debugPrintf("Cache: %u of %u KiB in %u resources, %u KiB locked\n",
+				resMan->getCacheMemory() / 1024, resMan->getCacheBudget() / 1024,
+				resMan->getCacheEntries(), resMan->getLockedMemory() / 1024);
+	debugPrintf("Lookups: %u hits, %u misses\n", stats.hits, stats.misses);
+	debugPrintf("Read: %u KiB, evictions: %u\n", stats.bytesRead / 1024, stats.evictions);
+	debugPrintf("Prefetch: %u loaded, %u used, %u queued\n", stats.prefetches, stats.prefetchHits, resMan->getPrefetchQueueSize());
+
+	return true;
+}
+
 bool Console::cmdDissectScript(int argc, const char **argv) {
 	if (argc != 2) {
 		debugPrintf("Examines a script\n");
@@ -2839,6 +2877,29 @@ bool Console::cmdGCNormalize(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdGCStats(int argc, const char **argv) {
+	EngineState *s = _engine->_gamestate;
+	GCStatistics &stats = s->gcStats;
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		stats.reset();
+		debugPrintf("Garbage collector statistics reset\n");
+		return true;
+	} else if (argc != 1) {
+		debugPrintf("Shows how long the garbage collector paused the game.\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	debugPrintf("Collections: %u\n", stats.runs);
+	debugPrintf("Pause: last %u ms, max %u ms, average %u ms\n", stats.lastPauseTime, stats.maxPauseTime,
+				stats.runs ? stats.totalPauseTime / stats.runs : 0);
+	debugPrintf("Last collection: %u reachable, %u freed\n", stats.lastReachable, stats.lastFreed);
+	debugPrintf("Freed in total: %u\n", stats.totalFreed);
+
+	return true;
+}
+
 bool Console::cmdVMVarlist(int argc, const char **argv) {
 	EngineState *s = _engine->_gamestate;
 	const char *varnames[] = {"global", "local", "temp", "param"};
@@ -3268,6 +3329,78 @@ bool Console::cmdScriptSteps(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdSelectorCache(int argc, const char **argv) {
+	SegManager *segMan = _engine->_gamestate->_segMan;
+	SelectorLookupCache &cache = segMan->getSelectorLookupCache();
+
+	if (argc > 1) {
+		Common::String cmd = argv[1];
+
+		if (cmd == "on" || cmd == "off") {
+			cache.setEnabled(cmd == "on");
+		} else if (cmd == "reset") {
+			cache.resetStats();
+		} else if (cmd == "trace") {
+			int count = 100000;
+			if (argc > 2 && (!parseInteger(argv[2], count) || count <= 0)) {
+				debugPrintf("Invalid number of lookups: %s\n", argv[2]);
+				return true;
+			}
+
+			cache.startTrace(count);
+			debugPrintf("Recording the next %d selector lookups\n", count);
+			return true;
+		} else if (cmd == "replay") {
+			cache.stopTrace();
+
+			// Objects may have been freed since they were recorded
+			Common::Array<SelectorLookupCache::TraceEntry> trace;
+			for (uint i = 0; i < cache.getTrace().size(); ++i) {
+				if (segMan->getObject(cache.getTrace()[i].obj))
+					trace.push_back(cache.getTrace()[i]);
+			}
+
+			if (trace.empty()) {
+				debugPrintf("No recorded lookups to replay, use \"%s trace\" first\n", argv[0]);
+				return true;
+			}
+
+			const int repeats = 20;
+			const bool enabled = cache.isEnabled();
+			uint32 time[2];
+
+			for (int pass = 0; pass < 2; ++pass) {
+				cache.setEnabled(pass == 1);
+
+				const uint32 start = g_system->getMillis();
+				for (int r = 0; r < repeats; ++r) {
+					for (uint i = 0; i < trace.size(); ++i)
+						lookupSelector(segMan, trace[i].obj, trace[i].selectorId, NULL, NULL);
+				}
+				time[pass] = g_system->getMillis() - start;
+			}
+
+			cache.setEnabled(enabled);
+
+			debugPrintf("Replayed %u lookups %d times: %u ms without cache, %u ms with cache\n", trace.size(), repeats, time[0], time[1]);
+			return true;
+		} else {
+			debugPrintf("Shows or controls the selector lookup cache.\n");
+			debugPrintf("Usage: %s [on | off | reset | trace [<count>] | replay]\n", argv[0]);
+			debugPrintf("trace records the next lookups, replay times them with and without the cache.\n");
+			return true;
+		}
+	}
+
+	const uint32 hits = cache.getHits();
+	const uint32 lookups = hits + cache.getMisses();
+
+	debugPrintf("Selector lookup cache: %s\n", cache.isEnabled() ? "enabled" : "disabled");
+	debugPrintf("Hits: %u of %u lookups (%u%%), invalidations: %u\n", hits, lookups,
+	            lookups ? (uint)((uint64)hits * 100 / lookups) : 0, cache.getInvalidations());
+	return true;
+}
+
 bool Console::cmdScriptObjects(int argc, const char **argv) {
 	int curScriptNr = -1;
 
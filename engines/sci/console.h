@@ -79,6 +79,7 @@ private:
 	bool cmdList(int argc, const char **argv);
 	bool cmdResourceIntegrityDump(int argc, const char **argv);
 	bool cmdAllocList(int argc, const char **argv);
+	bool cmdResourceCache(int argc, const char **argv);
 	bool cmdHexgrep(int argc, const char **argv);
 	bool cmdVerifyScripts(int argc, const char **argv);
 	// Game
@@ -116,6 +117,7 @@ private:
 	bool cmdGCShowReachable(int argc, const char **argv);
 	bool cmdGCShowFreeable(int argc, const char **argv);
 	bool cmdGCNormalize(int argc, const char **argv);
+	bool cmdGCStats(int argc, const char **argv);
 	// Music/SFX
 	bool cmdSongLib(int argc, const char **argv);
 	bool cmdSongInfo(int argc, const char **argv);
@@ -159,6 +161,7 @@ private:
 	bool cmdBreakpointAddress(int argc, const char **argv);
 	// VM
 	bool cmdScriptSteps(int argc, const char **argv);
+	bool cmdSelectorCache(int argc, const char **argv);
 	bool cmdScriptObjects(int argc, const char **argv);
 	bool cmdScriptStrings(int argc, const char **argv);
 	bool cmdScriptSaid(int argc, const char **argv);
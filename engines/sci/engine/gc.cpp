@@ -22,6 +22,7 @@
 
 #include "sci/engine/gc.h"
 #include "common/array.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 #ifdef ENABLE_SCI32
@@ -191,8 +192,13 @@ void run_gc(EngineState *s) {
 	memset(segcount, 0, sizeof(segcount));
 #endif
 
+	const uint32 startTime = g_system->getMillis();
+	s->gcStats.runs++;
+	s->gcStats.lastFreed = 0;
+
 	// Compute the set of all segments references currently in use.
 	AddrSet *activeRefs = findAllActiveReferences(s);
+	s->gcStats.lastReachable = activeRefs->size();
 
 	// Iterate over all segments, and check for each whether it
 	// contains stuff that can be collected.
@@ -215,6 +221,8 @@ void run_gc(EngineState *s) {
 					// Not found -> we can free it
 					mobj->freeAtAddress(segMan, addr);
 					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+					s->gcStats.lastFreed++;
+					s->gcStats.totalFreed++;
 #ifdef GC_DEBUG_CODE
 					segcount[type]++;
 #endif
@@ -226,6 +234,11 @@ void run_gc(EngineState *s) {
 
 	delete activeRefs;
 
+	const uint32 pauseTime = g_system->getMillis() - startTime;
+	s->gcStats.lastPauseTime = pauseTime;
+	s->gcStats.maxPauseTime = MAX(s->gcStats.maxPauseTime, pauseTime);
+	s->gcStats.totalPauseTime += pauseTime;
+
 #ifdef GC_DEBUG_CODE
 	// Output debug summary of garbage collection
 	debugC(kDebugLevelGC, "[GC] Summary:");
@@ -337,6 +337,8 @@ void SegManager::saveLoadWithSerializer(Common::Serializer &s) {
 #endif
 			}
 		}
+
+		_selectorLookupCache.invalidate();
 	}
 }
 
@@ -164,6 +164,8 @@ void SegManager::deallocate(SegmentId seg) {
 	if (!mobj)
 		error("Attempt to deallocate an already freed segment");
 
+	_selectorLookupCache.invalidate();
+
 	if (mobj->getType() == SEG_TYPE_SCRIPT) {
 		Script *scr = (Script *)mobj;
 		_scriptSegMap.erase(scr->getScriptNumber());
@@ -1050,6 +1052,8 @@ int SegManager::instantiateScript(int scriptNum, bool applyScriptPatches) {
 	g_sci->_guestAdditions->instantiateScriptHook(*scr);
 #endif
 
+	_selectorLookupCache.invalidate();
+
 	return segmentId;
 }
 
@@ -1080,6 +1084,7 @@ void SegManager::uninstantiateScript(int script_nr) {
 	if (!scr->getLockers()) {
 		// The actual script deletion seems to be done by SCI scripts themselves
 		scr->markDeleted();
+		_selectorLookupCache.invalidate();
 		debugC(kDebugLevelScripts, "Unloaded script 0x%x.", script_nr);
 	}
 }
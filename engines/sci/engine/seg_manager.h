@@ -26,6 +26,7 @@
 #include "common/scummsys.h"
 #include "common/serializer.h"
 #include "sci/engine/script.h"
+#include "sci/engine/selector.h"
 #include "sci/engine/vm.h"
 #include "sci/engine/vm_types.h"
 #include "sci/engine/segment.h"
@@ -458,6 +459,8 @@ public:
 
 	const Common::Array<SegmentObj *> &getSegments() const { return _heap; }
 
+	SelectorLookupCache &getSelectorLookupCache() { return _selectorLookupCache; }
+
 private:
 	Common::Array<SegmentObj *> _heap;
 	Common::Array<Class> _classTable; /**< Table of all classes */
@@ -467,6 +470,8 @@ private:
 	ResourceManager *_resMan;
 	ScriptPatcher *_scriptPatcher;
 
+	SelectorLookupCache _selectorLookupCache;
+
 	SegmentId _clonesSegId; ///< ID of the (a) clones segment
 	SegmentId _listsSegId; ///< ID of the (a) list segment
 	SegmentId _nodesSegId; ///< ID of the (a) node segment
@@ -340,34 +340,116 @@ SelectorType lookupSelector(SegManager *segMan, reg_t obj_location, Selector sel
 		error("lookupSelector: Attempt to send to non-object or invalid script. Address %04x:%04x, %s", PRINT_REG(obj_location), origin.toString().c_str());
 	}
 
-	index = obj->locateVarSelector(segMan, selectorId);
+	SelectorLookupCache &cache = segMan->getSelectorLookupCache();
+	cache.recordTrace(obj_location, selectorId);
+
+	SelectorType type;
+	reg_t function = NULL_REG;
+
+	if (!cache.lookup(obj, selectorId, type, index, function)) {
+		index = obj->locateVarSelector(segMan, selectorId);
+
+		if (index >= 0) {
+			// Found it as a variable
+			type = kSelectorVariable;
+		} else {
+			// Check if it's a method, with recursive lookup in superclasses
+			const Object *cls = obj;
+			type = kSelectorNone;
+			while (cls) {
+				int funcIndex = cls->funcSelectorPosition(selectorId);
+				if (funcIndex >= 0) {
+					function = cls->getFunction(funcIndex);
+					type = kSelectorMethod;
+					break;
+				} else {
+					cls = segMan->getObject(cls->getSuperClassSelector());
+				}
+			}
+		}
+
+		cache.store(obj, selectorId, type, index, function);
+	}
 
-	if (index >= 0) {
-		// Found it as a variable
+	if (type == kSelectorVariable) {
 		if (varp) {
 			varp->obj = obj_location;
 			varp->varindex = index;
 		}
-		return kSelectorVariable;
-	} else {
-		// Check if it's a method, with recursive lookup in superclasses
-		while (obj) {
-			index = obj->funcSelectorPosition(selectorId);
-			if (index >= 0) {
-				if (fptr)
-					*fptr = obj->getFunction(index);
-
-				return kSelectorMethod;
-			} else {
-				obj = segMan->getObject(obj->getSuperClassSelector());
-			}
-		}
+	} else if (type == kSelectorMethod) {
+		if (fptr)
+			*fptr = function;
+	}
+
+	return type;
+}
+
+#pragma mark -
+
+SelectorLookupCache::SelectorLookupCache() :
+	_generation(1),
+	_enabled(true),
+	_hits(0),
+	_misses(0),
+	_invalidations(0),
+	_traceLimit(0) {
+	memset(_entries, 0, sizeof(_entries));
+}
+
+void SelectorLookupCache::invalidate() {
+	++_invalidations;
 
-		return kSelectorNone;
+	// Generation 0 marks unused entries
+	if (++_generation == 0) {
+		memset(_entries, 0, sizeof(_entries));
+		_generation = 1;
 	}
+}
+
+SelectorLookupCache::Entry &SelectorLookupCache::getEntry(const Object *obj, Selector selectorId) {
+	const reg_t pos = obj->getPos();
+	const uint32 hash = (pos.getSegment() * 0x9E3779B1) ^ (pos.getOffset() * 0x85EBCA6B) ^ (selectorId * 0xC2B2AE35);
+	return _entries[(hash >> 16) & (kCacheSize - 1)];
+}
+
+bool SelectorLookupCache::lookup(const Object *obj, Selector selectorId, SelectorType &type, int &varIndex, reg_t &function) {
+	if (!_enabled)
+		return false;
 
+	const Entry &entry = getEntry(obj, selectorId);
+	if (entry.generation != _generation || entry.selectorId != selectorId ||
+	    entry.pos != obj->getPos() || entry.species != obj->getSpeciesSelector() ||
+	    entry.superClass != obj->getSuperClassSelector()) {
+		++_misses;
+		return false;
+	}
+
+	++_hits;
+	type = entry.type;
+	varIndex = entry.varIndex;
+	function = entry.function;
+	return true;
+}
+
+void SelectorLookupCache::store(const Object *obj, Selector selectorId, SelectorType type, int varIndex, reg_t function) {
+	if (!_enabled)
+		return;
+
+	Entry &entry = getEntry(obj, selectorId);
+	entry.generation = _generation;
+	entry.pos = obj->getPos();
+	entry.species = obj->getSpeciesSelector();
+	entry.superClass = obj->getSuperClassSelector();
+	entry.selectorId = selectorId;
+	entry.type = type;
+	entry.varIndex = varIndex;
+	entry.function = function;
+}
 
-//	return _lookupSelector_function(segMan, obj, selectorId, fptr);
+void SelectorLookupCache::startTrace(uint count) {
+	_trace.clear();
+	_trace.reserve(count);
+	_traceLimit = count;
 }
 
 } // End of namespace Sci
@@ -23,6 +23,7 @@
 #ifndef SCI_ENGINE_SELECTOR_H
 #define SCI_ENGINE_SELECTOR_H
 
+#include "common/array.h"
 #include "common/scummsys.h"
 
 #include "sci/engine/vm_types.h"	// for reg_t
@@ -200,6 +201,93 @@ struct SelectorCache {
 #endif
 };
 
+class Object;
+
+/**
+ * Remembers the results of lookupSelector(), so that sends do not have to
+ * walk the selector tables of the object and its superclasses every time.
+ *
+ * What a lookup finds only depends on the selector tables of the object,
+ * which come from the script it was defined in, and on its species and
+ * superclass. Entries are therefore keyed by the object's position in its
+ * script, its species, its superclass and the selector, which lets clones
+ * of the same object share them. All entries are dropped whenever a
+ * segment is allocated or freed, or a script is instantiated.
+ */
+class SelectorLookupCache {
+public:
+	SelectorLookupCache();
+
+	/** Drop all entries. */
+	void invalidate();
+
+	/**
+	 * Look up a selector in the cache.
+	 * @return true if an entry was found, in which case type, varIndex and
+	 *         function are set like lookupSelector() would do
+	 */
+	bool lookup(const Object *obj, Selector selectorId, SelectorType &type, int &varIndex, reg_t &function);
+
+	/** Store the result of a lookup which missed the cache. */
+	void store(const Object *obj, Selector selectorId, SelectorType type, int varIndex, reg_t function);
+
+	void setEnabled(bool enabled) { _enabled = enabled; invalidate(); }
+	bool isEnabled() const { return _enabled; }
+
+	uint32 getHits() const { return _hits; }
+	uint32 getMisses() const { return _misses; }
+	uint32 getInvalidations() const { return _invalidations; }
+	void resetStats() { _hits = _misses = _invalidations = 0; }
+
+	/** An object and selector sent to, for replaying lookups later. */
+	struct TraceEntry {
+		reg_t obj;
+		Selector selectorId;
+	};
+
+	/** Record the next count lookups. */
+	void startTrace(uint count);
+	/** Stop recording, keeping what was recorded so far. */
+	void stopTrace() { _traceLimit = _trace.size(); }
+	void recordTrace(reg_t obj, Selector selectorId) {
+		if (_trace.size() < _traceLimit) {
+			TraceEntry entry = { obj, selectorId };
+			_trace.push_back(entry);
+		}
+	}
+	const Common::Array<TraceEntry> &getTrace() const { return _trace; }
+
+private:
+	enum {
+		kCacheSize = 4096 ///< Number of entries, must be a power of two
+	};
+
+	struct Entry {
+		uint32 generation;
+		reg_t pos;
+		reg_t species;
+		reg_t superClass;
+		Selector selectorId;
+		SelectorType type;
+		int varIndex;
+		reg_t function;
+	};
+
+	Entry &getEntry(const Object *obj, Selector selectorId);
+
+	Entry _entries[kCacheSize];
+	/** Entries from an older generation are invalid. */
+	uint32 _generation;
+	bool _enabled;
+
+	uint32 _hits;
+	uint32 _misses;
+	uint32 _invalidations;
+
+	Common::Array<TraceEntry> _trace;
+	uint _traceLimit;
+};
+
 /**
  * Map a selector name to a selector id. Shortcut for accessing the selector cache.
  */
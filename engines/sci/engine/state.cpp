@@ -82,6 +82,7 @@ void EngineState::reset(bool isRestoring) {
 		_memorySegmentSize = 0;
 		_fileHandles.resize(5);
 		abortScriptProcessing = kAbortNone;
+		gcStats.reset();
 	} else {
 		g_sci->_guestAdditions->reset();
 	}
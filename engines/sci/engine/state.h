@@ -83,6 +83,21 @@ enum VideoFlags {
 	kStretch         = 1 << 8
 };
 
+/**
+ * Pause statistics of the garbage collector. Times are in milliseconds.
+ */
+struct GCStatistics {
+	uint32 runs; //< Number of collections
+	uint32 lastPauseTime; //< Duration of the last collection
+	uint32 maxPauseTime; //< Longest collection
+	uint32 totalPauseTime; //< Sum of all collections
+	uint32 lastReachable; //< Number of reachable addresses found by the last mark phase
+	uint32 lastFreed; //< Number of objects freed by the last collection
+	uint32 totalFreed; //< Number of objects freed since the stats were reset
+
+	void reset() { memset(this, 0, sizeof(*this)); }
+};
+
 /**
  * Trace information about a VM function call.
  */
@@ -194,6 +209,7 @@ public:
 	void shrinkStackToBase();
 
 	int gcCountDown; /**< Number of kernel calls until next gc */
+	GCStatistics gcStats;
 
 	MessageState *_msgState;
 
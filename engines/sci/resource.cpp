@@ -22,6 +22,7 @@
 
 // Resource library
 
+#include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
@@ -211,6 +212,8 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : SciSpan<const byte>
 	_fileOffset = 0;
 	_status = kResStatusNoMalloc;
 	_lockers = 0;
+	_packedSize = 0;
+	_prefetched = false;
 	_source = nullptr;
 	_header = nullptr;
 	_headerSize = 0;
@@ -227,6 +230,14 @@ void Resource::unalloc() {
 	delete[] _data;
 	_data = nullptr;
 	_status = kResStatusNoMalloc;
+	_packedSize = 0;
+	_prefetched = false;
+}
+
+uint32 Resource::getLoadCost() const {
+	if (!_packedSize || _packedSize == _size)
+		return _size;
+	return _packedSize + _size;
 }
 
 void Resource::writeToStream(Common::WriteStream *stream) const {
@@ -427,6 +438,8 @@ void ResourceManager::loadResource(Resource *res) {
 	if (_patcher) {
 		_patcher->applyPatch(*res);
 	};
+	if (res->_data)
+		_cacheStats.bytesRead += res->_packedSize ? res->_packedSize : res->_size;
 }
 
 
@@ -984,6 +997,9 @@ void ResourceManager::init() {
 	_memoryLocked = 0;
 	_memoryLRU = 0;
 	_LRU.clear();
+	_prefetchQueue.clear();
+	_prefetchEnabled = !_detectionMode && (!ConfMan.hasKey("sci_resource_prefetch") || ConfMan.getBool("sci_resource_prefetch"));
+	_cacheStats.reset();
 	_resMap.clear();
 	_audioMapSCI1 = NULL;
 #ifdef ENABLE_SCI32
@@ -1057,6 +1073,12 @@ void ResourceManager::init() {
 		_maxMemoryLRU = 4096 * 1024; // 4MiB
 	}
 
+	// Machines with memory to spare can keep more of the game in memory,
+	// which saves reading and decompressing resources on every room change
+	if (!_detectionMode && ConfMan.hasKey("sci_resource_cache_size") &&
+	    !setCacheBudget(ConfMan.getInt("sci_resource_cache_size")))
+		warning("Ignoring invalid sci_resource_cache_size '%s'", ConfMan.get("sci_resource_cache_size").c_str());
+
 	switch (_viewType) {
 	case kViewEga:
 		debugC(1, kDebugLevelResMan, "resMan: Detected EGA graphic resources");
@@ -1143,15 +1165,96 @@ void ResourceManager::printLRU() {
 void ResourceManager::freeOldResources() {
 	while (_maxMemoryLRU < _memoryLRU) {
 		assert(!_LRU.empty());
-		Resource *goner = _LRU.back();
+
+		// Of the least recently used resources, evict the one which is
+		// cheapest to load again per byte freed. Uncompressed resources go
+		// before compressed ones of about the same age.
+		Common::List<Resource *>::iterator it = _LRU.reverse_begin();
+		Common::List<Resource *>::iterator goneIt = it;
+		for (int i = 1; i < MAX_EVICTION_CANDIDATES && it != _LRU.begin(); ++i) {
+			--it;
+			const Resource *candidate = *it;
+			const Resource *best = *goneIt;
+			if ((uint64)candidate->getLoadCost() * best->size() < (uint64)best->getLoadCost() * candidate->size())
+				goneIt = it;
+		}
+
+		Resource *goner = *goneIt;
 		removeFromLRU(goner);
 		goner->unalloc();
+		_cacheStats.evictions++;
 #ifdef SCI_VERBOSE_RESMAN
 		debug("resMan-debug: LRU: Freeing %s (%d bytes)", goner->_id.toString().c_str(), goner->size);
 #endif
 	}
 }
 
+bool ResourceManager::setCacheBudget(int kiloBytes) {
+	if (kiloBytes <= 0)
+		return false;
+
+	_maxMemoryLRU = MIN<int>(kiloBytes, MAX_CACHE_BUDGET) * 1024;
+	freeOldResources();
+	return true;
+}
+
+void ResourceManager::queuePrefetch(ResourceId id) {
+	if (!_prefetchEnabled || _prefetchQueue.size() >= MAX_PREFETCH_QUEUE)
+		return;
+
+	Resource *res = testResource(id);
+	if (!res || res->_status != kResStatusNoMalloc)
+		return;
+
+	for (Common::List<ResourceId>::const_iterator it = _prefetchQueue.begin(); it != _prefetchQueue.end(); ++it) {
+		if (*it == id)
+			return;
+	}
+
+	_prefetchQueue.push_back(id);
+}
+
+void ResourceManager::queueRelatedResources(const Resource *res) {
+	// Rooms conventionally use the picture, text and messages with the
+	// number of their script, so fetch those while the room is running
+	if (res->getType() != kResourceTypeScript)
+		return;
+
+	const uint16 number = res->getNumber();
+	queuePrefetch(ResourceId(kResourceTypePic, number));
+	queuePrefetch(ResourceId(kResourceTypeView, number));
+	queuePrefetch(ResourceId(kResourceTypeText, number));
+	queuePrefetch(ResourceId(kResourceTypeMessage, number));
+}
+
+bool ResourceManager::prefetchNext() {
+	while (!_prefetchQueue.empty()) {
+		const ResourceId id = _prefetchQueue.front();
+		_prefetchQueue.pop_front();
+
+		Resource *res = testResource(id);
+		if (!res || res->_status != kResStatusNoMalloc)
+			continue;
+
+		// Don't push anything out of the cache for resources which
+		// might not be needed after all
+		if (res->_size && _memoryLRU + (int)res->_size > _maxMemoryLRU)
+			continue;
+
+		loadResource(res);
+		if (!res->_data)
+			continue;
+
+		res->_prefetched = true;
+		addToLRU(res);
+		freeOldResources();
+		_cacheStats.prefetches++;
+		return true;
+	}
+
+	return false;
+}
+
 Common::List<ResourceId> ResourceManager::listResources(ResourceType type, int mapNumber) {
 	Common::List<ResourceId> resources;
 
@@ -1188,9 +1291,20 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return NULL;
 
-	if (retval->_status == kResStatusNoMalloc)
+	if (retval->_status == kResStatusNoMalloc) {
 		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
+		_cacheStats.misses++;
+		if (_prefetchEnabled)
+			queueRelatedResources(retval);
+	} else {
+		_cacheStats.hits++;
+		if (retval->_prefetched) {
+			retval->_prefetched = false;
+			_cacheStats.prefetchHits++;
+		}
+	}
+
+	if (retval->_status == kResStatusEnqueued)
 		// The resource is removed from its current position
 		// in the LRU list because it has been requested
 		// again. Below, it will either be locked, or it
@@ -2366,6 +2480,7 @@ int Resource::decompress(ResVersion volVersion, Common::SeekableReadStream *file
 	byte *ptr = new byte[_size];
 	_data = ptr;
 	_status = kResStatusAllocated;
+	_packedSize = szPacked;
 	errorNum = ptr ? dec->unpack(file, ptr, szPacked, _size) : SCI_ERROR_RESOURCE_TOO_BIG;
 	if (errorNum) {
 		unalloc();
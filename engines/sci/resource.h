@@ -76,7 +76,22 @@ enum ResourceErrorCodes {
 };
 
 enum {
-	MAX_OPENED_VOLUMES = 5 ///< Max number of simultaneously opened volumes
+	MAX_OPENED_VOLUMES = 5, ///< Max number of simultaneously opened volumes
+	MAX_EVICTION_CANDIDATES = 8, ///< Number of least recently used resources considered for eviction
+	MAX_PREFETCH_QUEUE = 32, ///< Max number of resources waiting to be prefetched
+	MAX_CACHE_BUDGET = 1024 * 1024 ///< Max memory in KiB which unlocked resources may use
+};
+
+/** Counters of the resource cache, shown by the "resource_cache" debugger command */
+struct ResourceCacheStats {
+	uint32 hits; ///< Lookups of resources which were already in memory
+	uint32 misses; ///< Lookups which had to load the resource
+	uint32 bytesRead; ///< Bytes read from resource files
+	uint32 evictions; ///< Resources freed to stay within the budget
+	uint32 prefetches; ///< Resources loaded ahead of time
+	uint32 prefetchHits; ///< Prefetched resources which were used before being evicted
+
+	void reset() { memset(this, 0, sizeof(*this)); }
 };
 
 enum ResourceType {
@@ -293,11 +308,19 @@ public:
 
 	uint16 getNumLockers() const { return _lockers; }
 
+	/**
+	 * Returns an estimate of the work needed to load the resource again: the
+	 * bytes read from disk, plus the bytes produced if it was compressed.
+	 */
+	uint32 getLoadCost() const;
+
 protected:
 	ResourceId _id;	// TODO: _id could almost be made const, only readResourceInfo() modifies it...
 	int32 _fileOffset; /**< Offset in file */
 	ResourceStatus _status;
 	uint16 _lockers; /**< Number of places where this resource was locked */
+	uint32 _packedSize; /**< Bytes read from the volume by the last load, 0 if not read from a volume */
+	bool _prefetched; /**< Loaded by prefetching and not requested since */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
 
@@ -369,6 +392,34 @@ public:
 	 */
 	void unlockResource(Resource *res);
 
+	/**
+	 * Queues a resource to be loaded into the cache ahead of time, if it
+	 * exists and is not in memory already.
+	 */
+	void queuePrefetch(ResourceId id);
+
+	/**
+	 * Loads the next queued prefetch resource. Meant to be called while the
+	 * game is idle.
+	 * @return true if a resource was loaded
+	 */
+	bool prefetchNext();
+
+	/**
+	 * Changes the amount of memory which unlocked resources may use.
+	 * Budgets above MAX_CACHE_BUDGET are reduced to it.
+	 * @param kiloBytes	The new budget in KiB
+	 * @return false if the budget is not positive, and was not changed
+	 */
+	bool setCacheBudget(int kiloBytes);
+	uint32 getCacheBudget() const { return _maxMemoryLRU; }
+	uint32 getCacheMemory() const { return _memoryLRU; }
+	uint32 getLockedMemory() const { return _memoryLocked; }
+	uint getCacheEntries() const { return _LRU.size(); }
+	uint getPrefetchQueueSize() const { return _prefetchQueue.size(); }
+
+	ResourceCacheStats &getCacheStats() { return _cacheStats; }
+
 	/**
 	 * Tests whether a resource exists.
 	 *
@@ -490,6 +541,9 @@ protected:
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
 	int _memoryLRU;		///< Amount of resource bytes under LRU control
 	Common::List<Resource *> _LRU; ///< Last Resource Used list
+	Common::List<ResourceId> _prefetchQueue; ///< Resources to load while the game is idle
+	bool _prefetchEnabled;
+	ResourceCacheStats _cacheStats;
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
@@ -551,6 +605,7 @@ protected:
 	void disposeVolumeFileStream(Common::SeekableReadStream *fileStream, ResourceSource *source);
 	void loadResource(Resource *res);
 	void freeOldResources();
+	void queueRelatedResources(const Resource *res);
 	bool validateResource(const ResourceId &resourceId, const Common::String &sourceMapLocation, const Common::String &sourceName, const uint32 offset, const uint32 size, const uint32 sourceSize) const;
 	Resource *addResource(ResourceId resId, ResourceSource *src, uint32 offset, uint32 size = 0, const Common::String &sourceMapLocation = Common::String("(no map location)"));
 	Resource *updateResource(ResourceId resId, ResourceSource *src, uint32 size, const Common::String &sourceMapLocation = Common::String("(no map location)"));
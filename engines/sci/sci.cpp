@@ -916,7 +916,10 @@ void SciEngine::sleep(uint32 msecs) {
 #endif
 		time = g_system->getMillis();
 		if (time + 10 < wakeUpTime) {
-			g_system->delayMillis(10);
+			// Use the idle time to load resources the game will likely
+			// need soon, and only sleep once there is nothing left to do
+			if (!_resMan->prefetchNext())
+				g_system->delayMillis(10);
 		} else {
 			if (time < wakeUpTime)
 				g_system->delayMillis(wakeUpTime - time);
@@ -0,0 +1,110 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/atlas_packer.h"
+
+namespace Graphics {
+
+AtlasPacker::AtlasPacker(uint width, uint height, uint padding)
+	: _width(MIN<uint>(width, 0xFFFF)), _height(MIN<uint>(height, 0xFFFF)), _padding(padding), _bottom(0), _count(0) {
+}
+
+bool AtlasPacker::allocate(uint w, uint h, Common::Rect &rect) {
+	if (w == 0 || h == 0 || w > _width || h > _height)
+		return false;
+
+	// Padding is only needed when something may follow, so a rectangle may
+	// touch the right and bottom edges of the page.
+	const uint paddedW = w + _padding;
+	const uint paddedH = h + _padding;
+
+	int best = -1;
+	for (uint i = 0; i < _shelves.size(); ++i) {
+		const Shelf &shelf = _shelves[i];
+		if (shelf.used + w > _width)
+			continue;
+		if (paddedH > shelf.height && !(h <= shelf.height && shelf.top + shelf.height == _height))
+			continue;
+		if (best == -1 || shelf.height < _shelves[best].height)
+			best = i;
+	}
+
+	// Rather open a new shelf than waste more than half of an existing one
+	if (best != -1 && _shelves[best].height > 2 * paddedH && _bottom + h <= _height)
+		best = -1;
+
+	if (best == -1) {
+		if (_bottom + h > _height)
+			return false;
+
+		Shelf shelf;
+		shelf.top = _bottom;
+		shelf.height = MIN<uint>(paddedH, _height - _bottom);
+		shelf.used = 0;
+		shelf.count = 0;
+		_shelves.push_back(shelf);
+		_bottom += shelf.height;
+		best = _shelves.size() - 1;
+	}
+
+	Shelf &shelf = _shelves[best];
+	rect = Common::Rect(shelf.used, shelf.top, shelf.used + w, shelf.top + h);
+	shelf.used = MIN<uint>(shelf.used + paddedW, _width);
+	++shelf.count;
+	++_count;
+	return true;
+}
+
+int AtlasPacker::findShelf(const Common::Rect &rect) const {
+	for (uint i = 0; i < _shelves.size(); ++i) {
+		if (_shelves[i].top == rect.top)
+			return i;
+	}
+	return -1;
+}
+
+void AtlasPacker::release(const Common::Rect &rect) {
+	const int i = findShelf(rect);
+	if (i == -1 || _shelves[i].count == 0)
+		return;
+
+	--_count;
+	if (--_shelves[i].count != 0)
+		return;
+
+	// The space of an empty shelf is reused as a whole; trailing empty
+	// shelves go back to the page so they can be reopened with a
+	// different height.
+	_shelves[i].used = 0;
+	while (!_shelves.empty() && _shelves.back().count == 0) {
+		_bottom = _shelves.back().top;
+		_shelves.pop_back();
+	}
+}
+
+void AtlasPacker::clear() {
+	_shelves.clear();
+	_bottom = 0;
+	_count = 0;
+}
+
+} // End of namespace Graphics
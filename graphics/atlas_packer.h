@@ -0,0 +1,95 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_ATLAS_PACKER_H
+#define GRAPHICS_ATLAS_PACKER_H
+
+#include "common/array.h"
+#include "common/rect.h"
+
+namespace Graphics {
+
+/**
+ * Hands out rectangles of a fixed size page, e.g. a texture atlas.
+ *
+ * Rectangles are placed on horizontal shelves: each request goes to the
+ * lowest shelf it fits on, preferring shelves which are barely taller than
+ * the request, and opens a new shelf at the bottom otherwise. Releasing
+ * every rectangle of a shelf makes the shelf reusable, and the space of
+ * trailing empty shelves is handed back to the page. This suits many
+ * small, similarly sized items such as sprites and glyphs; it is not meant
+ * for tight packing of arbitrary shapes.
+ */
+class AtlasPacker {
+public:
+	/**
+	 * @param width    width of the page
+	 * @param height   height of the page
+	 * @param padding  number of unused pixels kept to the right of and
+	 *                 below every rectangle, e.g. to avoid bleeding when
+	 *                 the page is sampled with linear filtering
+	 */
+	AtlasPacker(uint width, uint height, uint padding = 0);
+
+	uint getWidth() const { return _width; }
+	uint getHeight() const { return _height; }
+
+	/**
+	 * Reserve a w x h rectangle.
+	 *
+	 * @param rect  receives the position of the rectangle on success
+	 * @return false if the page has no room left for the rectangle
+	 */
+	bool allocate(uint w, uint h, Common::Rect &rect);
+
+	/** Give back a rectangle obtained from allocate(). */
+	void release(const Common::Rect &rect);
+
+	/** Release all rectangles at once. */
+	void clear();
+
+	/** Return true if no rectangle is allocated. */
+	bool isEmpty() const { return _count == 0; }
+
+	/** Return the number of allocated rectangles. */
+	uint getCount() const { return _count; }
+
+private:
+	struct Shelf {
+		uint16 top;     ///< first line of the shelf
+		uint16 height;  ///< height including padding
+		uint16 used;    ///< width in use, from the left edge
+		uint16 count;   ///< rectangles allocated on the shelf
+	};
+
+	/** Return the shelf a rectangle was allocated on, or -1. */
+	int findShelf(const Common::Rect &rect) const;
+
+	const uint _width, _height, _padding;
+	Common::Array<Shelf> _shelves;
+	uint _bottom;
+	uint _count;
+};
+
+} // End of namespace Graphics
+
+#endif
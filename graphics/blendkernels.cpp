@@ -0,0 +1,807 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/util.h"
+#include "graphics/blendkernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLENDKERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define BLENDKERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace Graphics {
+
+static const int kBModShift = 0;
+static const int kGModShift = 8;
+static const int kRModShift = 16;
+static const int kAModShift = 24;
+
+#ifdef SCUMM_LITTLE_ENDIAN
+static const int kAIndex = 0;
+static const int kBIndex = 1;
+static const int kGIndex = 2;
+static const int kRIndex = 3;
+
+#else
+static const int kAIndex = 3;
+static const int kBIndex = 2;
+static const int kGIndex = 1;
+static const int kRIndex = 0;
+#endif
+
+#pragma mark --- Scalar kernels ---
+
+static void alphaBlendScalar(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	byte *in;
+	byte *out;
+
+	if (color == 0xffffffff) {
+
+		for (uint32 i = 0; i < height; i++) {
+			out = outo;
+			in = ino;
+			for (uint32 j = 0; j < width; j++) {
+
+				if (in[kAIndex] != 0) {
+					out[kAIndex] = 255;
+					out[kRIndex] = ((in[kRIndex] * in[kAIndex]) + out[kRIndex] * (255 - in[kAIndex])) >> 8;
+					out[kGIndex] = ((in[kGIndex] * in[kAIndex]) + out[kGIndex] * (255 - in[kAIndex])) >> 8;
+					out[kBIndex] = ((in[kBIndex] * in[kAIndex]) + out[kBIndex] * (255 - in[kAIndex])) >> 8;
+				}
+
+				in += inStep;
+				out += 4;
+			}
+			outo += pitch;
+			ino += inoStep;
+		}
+	} else {
+
+		byte ca = (color >> kAModShift) & 0xFF;
+		byte cr = (color >> kRModShift) & 0xFF;
+		byte cg = (color >> kGModShift) & 0xFF;
+		byte cb = (color >> kBModShift) & 0xFF;
+
+		for (uint32 i = 0; i < height; i++) {
+			out = outo;
+			in = ino;
+			for (uint32 j = 0; j < width; j++) {
+
+				uint32 ina = in[kAIndex] * ca >> 8;
+
+				if (ina != 0) {
+					out[kAIndex] = 255;
+					out[kBIndex] = (out[kBIndex] * (255 - ina) >> 8);
+					out[kGIndex] = (out[kGIndex] * (255 - ina) >> 8);
+					out[kRIndex] = (out[kRIndex] * (255 - ina) >> 8);
+
+					out[kBIndex] = out[kBIndex] + (in[kBIndex] * ina * cb >> 16);
+					out[kGIndex] = out[kGIndex] + (in[kGIndex] * ina * cg >> 16);
+					out[kRIndex] = out[kRIndex] + (in[kRIndex] * ina * cr >> 16);
+				}
+
+				in += inStep;
+				out += 4;
+			}
+			outo += pitch;
+			ino += inoStep;
+		}
+	}
+}
+
+static void additiveBlendScalar(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	byte *in;
+	byte *out;
+
+	if (color == 0xffffffff) {
+
+		for (uint32 i = 0; i < height; i++) {
+			out = outo;
+			in = ino;
+			for (uint32 j = 0; j < width; j++) {
+
+				if (in[kAIndex] != 0) {
+					out[kRIndex] = MIN((in[kRIndex] * in[kAIndex] >> 8) + out[kRIndex], 255);
+					out[kGIndex] = MIN((in[kGIndex] * in[kAIndex] >> 8) + out[kGIndex], 255);
+					out[kBIndex] = MIN((in[kBIndex] * in[kAIndex] >> 8) + out[kBIndex], 255);
+				}
+
+				in += inStep;
+				out += 4;
+			}
+			outo += pitch;
+			ino += inoStep;
+		}
+	} else {
+
+		byte ca = (color >> kAModShift) & 0xFF;
+		byte cr = (color >> kRModShift) & 0xFF;
+		byte cg = (color >> kGModShift) & 0xFF;
+		byte cb = (color >> kBModShift) & 0xFF;
+
+		for (uint32 i = 0; i < height; i++) {
+			out = outo;
+			in = ino;
+			for (uint32 j = 0; j < width; j++) {
+
+				uint32 ina = in[kAIndex] * ca >> 8;
+
+				if (cb != 255) {
+					out[kBIndex] = MIN<uint>(out[kBIndex] + ((in[kBIndex] * cb * ina) >> 16), 255u);
+				} else {
+					out[kBIndex] = MIN<uint>(out[kBIndex] + (in[kBIndex] * ina >> 8), 255u);
+				}
+
+				if (cg != 255) {
+					out[kGIndex] = MIN<uint>(out[kGIndex] + ((in[kGIndex] * cg * ina) >> 16), 255u);
+				} else {
+					out[kGIndex] = MIN<uint>(out[kGIndex] + (in[kGIndex] * ina >> 8), 255u);
+				}
+
+				if (cr != 255) {
+					out[kRIndex] = MIN<uint>(out[kRIndex] + ((in[kRIndex] * cr * ina) >> 16), 255u);
+				} else {
+					out[kRIndex] = MIN<uint>(out[kRIndex] + (in[kRIndex] * ina >> 8), 255u);
+				}
+
+				in += inStep;
+				out += 4;
+			}
+			outo += pitch;
+			ino += inoStep;
+		}
+	}
+}
+
+static void subtractiveBlendScalar(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	byte *in;
+	byte *out;
+
+	if (color == 0xffffffff) {
+
+		for (uint32 i = 0; i < height; i++) {
+			out = outo;
+			in = ino;
+			for (uint32 j = 0; j < width; j++) {
+
+				if (in[kAIndex] != 0) {
+					out[kRIndex] = MAX(out[kRIndex] - ((in[kRIndex] * out[kRIndex]) * in[kAIndex] >> 16), 0);
+					out[kGIndex] = MAX(out[kGIndex] - ((in[kGIndex] * out[kGIndex]) * in[kAIndex] >> 16), 0);
+					out[kBIndex] = MAX(out[kBIndex] - ((in[kBIndex] * out[kBIndex]) * in[kAIndex] >> 16), 0);
+				}
+
+				in += inStep;
+				out += 4;
+			}
+			outo += pitch;
+			ino += inoStep;
+		}
+	} else {
+
+		byte cr = (color >> kRModShift) & 0xFF;
+		byte cg = (color >> kGModShift) & 0xFF;
+		byte cb = (color >> kBModShift) & 0xFF;
+
+		for (uint32 i = 0; i < height; i++) {
+			out = outo;
+			in = ino;
+			for (uint32 j = 0; j < width; j++) {
+
+				out[kAIndex] = 255;
+				if (cb != 255) {
+					out[kBIndex] = MAX(out[kBIndex] - (int)((uint32)(in[kBIndex] * cb) * (out[kBIndex] * in[kAIndex]) >> 24), 0);
+				} else {
+					out[kBIndex] = MAX(out[kBIndex] - (in[kBIndex] * (out[kBIndex]) * in[kAIndex] >> 16), 0);
+				}
+
+				if (cg != 255) {
+					out[kGIndex] = MAX(out[kGIndex] - (int)((uint32)(in[kGIndex] * cg) * (out[kGIndex] * in[kAIndex]) >> 24), 0);
+				} else {
+					out[kGIndex] = MAX(out[kGIndex] - (in[kGIndex] * (out[kGIndex]) * in[kAIndex] >> 16), 0);
+				}
+
+				if (cr != 255) {
+					out[kRIndex] = MAX(out[kRIndex] - (int)((uint32)(in[kRIndex] * cr) * (out[kRIndex] * in[kAIndex]) >> 24), 0);
+				} else {
+					out[kRIndex] = MAX(out[kRIndex] - (in[kRIndex] * (out[kRIndex]) * in[kAIndex] >> 16), 0);
+				}
+
+				in += inStep;
+				out += 4;
+			}
+			outo += pitch;
+			ino += inoStep;
+		}
+	}
+}
+
+static void multiplyBlendScalar(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	byte *in;
+	byte *out;
+
+	if (color == 0xffffffff) {
+		for (uint32 i = 0; i < height; i++) {
+			out = outo;
+			in = ino;
+			for (uint32 j = 0; j < width; j++) {
+
+				if (in[kAIndex] != 0) {
+					out[kRIndex] = MIN((in[kRIndex] * in[kAIndex] >> 8) * out[kRIndex] >> 8, 255);
+					out[kGIndex] = MIN((in[kGIndex] * in[kAIndex] >> 8) * out[kGIndex] >> 8, 255);
+					out[kBIndex] = MIN((in[kBIndex] * in[kAIndex] >> 8) * out[kBIndex] >> 8, 255);
+				}
+
+				in += inStep;
+				out += 4;
+			}
+			outo += pitch;
+			ino += inoStep;
+		}
+	} else {
+		byte ca = (color >> kAModShift) & 0xFF;
+		byte cr = (color >> kRModShift) & 0xFF;
+		byte cg = (color >> kGModShift) & 0xFF;
+		byte cb = (color >> kBModShift) & 0xFF;
+
+		for (uint32 i = 0; i < height; i++) {
+			out = outo;
+			in = ino;
+			for (uint32 j = 0; j < width; j++) {
+
+				uint32 ina = in[kAIndex] * ca >> 8;
+
+				if (cb != 255) {
+					out[kBIndex] = MIN<uint>(out[kBIndex] * ((in[kBIndex] * cb * ina) >> 16) >> 8, 255u);
+				} else {
+					out[kBIndex] = MIN<uint>(out[kBIndex] * (in[kBIndex] * ina >> 8) >> 8, 255u);
+				}
+
+				if (cg != 255) {
+					out[kGIndex] = MIN<uint>(out[kGIndex] * ((in[kGIndex] * cg * ina) >> 16) >> 8, 255u);
+				} else {
+					out[kGIndex] = MIN<uint>(out[kGIndex] * (in[kGIndex] * ina >> 8) >> 8, 255u);
+				}
+
+				if (cr != 255) {
+					out[kRIndex] = MIN<uint>(out[kRIndex] * ((in[kRIndex] * cr * ina) >> 16) >> 8, 255u);
+				} else {
+					out[kRIndex] = MIN<uint>(out[kRIndex] * (in[kRIndex] * ina >> 8) >> 8, 255u);
+				}
+
+				in += inStep;
+				out += 4;
+			}
+			outo += pitch;
+			ino += inoStep;
+		}
+	}
+}
+
+static const BlendKernels s_scalarKernels = { &alphaBlendScalar, &additiveBlendScalar, &subtractiveBlendScalar, &multiplyBlendScalar, "scalar" };
+
+#if defined(BLENDKERNELS_SSE2) || defined(BLENDKERNELS_NEON)
+
+/**
+ * Fill the 16 bit lanes of two pixels with the given values, each at the
+ * position of its channel.
+ */
+static void setChannelLanes(uint16 *lanes, uint16 a, uint16 r, uint16 g, uint16 b) {
+	for (int i = 0; i < 8; i += 4) {
+		lanes[i + kAIndex] = a;
+		lanes[i + kRIndex] = r;
+		lanes[i + kGIndex] = g;
+		lanes[i + kBIndex] = b;
+	}
+}
+
+/**
+ * The factor the vector kernels apply a color modulation component with:
+ * they take the high half of a 16 bit product, i.e. divide by 65536. The
+ * scalar code does the same for most components but skips a modulation
+ * of 255 and divides by 256 instead, which a factor of 256 reproduces.
+ */
+static uint16 modulationFactor(byte c) {
+	return c == 255 ? 256 : c;
+}
+
+/** The modulation factors of a color, 0 for the alpha lanes. */
+static void setModulationLanes(uint16 *lanes, uint32 color) {
+	setChannelLanes(lanes, 0, modulationFactor((color >> kRModShift) & 0xFF),
+	                modulationFactor((color >> kGModShift) & 0xFF), modulationFactor((color >> kBModShift) & 0xFF));
+}
+
+#endif
+
+#ifdef BLENDKERNELS_SSE2
+#pragma mark --- SSE2 kernels ---
+
+// The kernels below work on four pixels at a time, two per register once
+// widened to 16 bit lanes. Since SSE2 implies a little endian machine, the
+// alpha byte of each pixel is its lowest one.
+
+/** Broadcast the alpha of each of two widened pixels to all its lanes. */
+static inline __m128i alphaSSE2(__m128i pixels) {
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+/**
+ * The alpha of each of two widened source pixels, scaled by the alpha of
+ * the color modulation if there is one.
+ */
+template<bool tinted>
+static inline __m128i sourceAlphaSSE2(__m128i src, __m128i ca) {
+	const __m128i a = alphaSSE2(src);
+	return tinted ? _mm_srli_epi16(_mm_mullo_epi16(a, ca), 8) : a;
+}
+
+/** Take the bytes of a where mask is set, and those of b elsewhere. */
+static inline __m128i selectSSE2(__m128i mask, __m128i a, __m128i b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static inline __m128i loadSSE2(const byte *p) {
+	return _mm_loadu_si128((const __m128i *)p);
+}
+
+static inline __m128i loadLanesSSE2(const uint16 *lanes) {
+	return _mm_loadu_si128((const __m128i *)lanes);
+}
+
+template<bool tinted>
+struct AlphaBlendSSE2 {
+	AlphaBlendSSE2(uint32 color) {
+		uint16 lanes[8];
+		setChannelLanes(lanes, 0, (color >> kRModShift) & 0xFF, (color >> kGModShift) & 0xFF, (color >> kBModShift) & 0xFF);
+		_color = loadLanesSSE2(lanes);
+		_ca = _mm_set1_epi16((color >> kAModShift) & 0xFF);
+	}
+
+	__m128i operator()(__m128i src, __m128i dst) const {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i srcLo = _mm_unpacklo_epi8(src, zero), srcHi = _mm_unpackhi_epi8(src, zero);
+		const __m128i dstLo = _mm_unpacklo_epi8(dst, zero), dstHi = _mm_unpackhi_epi8(dst, zero);
+		const __m128i aLo = sourceAlphaSSE2<tinted>(srcLo, _ca), aHi = sourceAlphaSSE2<tinted>(srcHi, _ca);
+
+		const __m128i max = _mm_set1_epi16(255);
+		__m128i lo, hi;
+		if (tinted) {
+			lo = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(dstLo, _mm_sub_epi16(max, aLo)), 8),
+			                   _mm_mulhi_epu16(_mm_mullo_epi16(srcLo, aLo), _color));
+			hi = _mm_add_epi16(_mm_srli_epi16(_mm_mullo_epi16(dstHi, _mm_sub_epi16(max, aHi)), 8),
+			                   _mm_mulhi_epu16(_mm_mullo_epi16(srcHi, aHi), _color));
+		} else {
+			lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(srcLo, aLo), _mm_mullo_epi16(dstLo, _mm_sub_epi16(max, aLo))), 8);
+			hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(srcHi, aHi), _mm_mullo_epi16(dstHi, _mm_sub_epi16(max, aHi))), 8);
+		}
+
+		// Blended pixels become opaque, transparent ones leave the target alone
+		const __m128i blended = _mm_or_si128(_mm_packus_epi16(lo, hi), _mm_set1_epi32(0xFF));
+		const __m128i transparent = _mm_packs_epi16(_mm_cmpeq_epi16(aLo, zero), _mm_cmpeq_epi16(aHi, zero));
+		return selectSSE2(transparent, dst, blended);
+	}
+
+	__m128i _color, _ca;
+};
+
+template<bool tinted>
+struct AdditiveBlendSSE2 {
+	AdditiveBlendSSE2(uint32 color) {
+		uint16 lanes[8];
+		setModulationLanes(lanes, color);
+		_color = loadLanesSSE2(lanes);
+		_ca = _mm_set1_epi16((color >> kAModShift) & 0xFF);
+	}
+
+	__m128i operator()(__m128i src, __m128i dst) const {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i srcLo = _mm_unpacklo_epi8(src, zero), srcHi = _mm_unpackhi_epi8(src, zero);
+		const __m128i aLo = sourceAlphaSSE2<tinted>(srcLo, _ca), aHi = sourceAlphaSSE2<tinted>(srcHi, _ca);
+
+		// The alpha lanes of _color are 0, which keeps the target alpha
+		const __m128i lo = _mm_mulhi_epu16(_mm_mullo_epi16(srcLo, aLo), _color);
+		const __m128i hi = _mm_mulhi_epu16(_mm_mullo_epi16(srcHi, aHi), _color);
+		return _mm_adds_epu8(dst, _mm_packus_epi16(lo, hi));
+	}
+
+	__m128i _color, _ca;
+};
+
+template<bool tinted>
+struct SubtractiveBlendSSE2 {
+	SubtractiveBlendSSE2(uint32 color) {
+		uint16 lanes[8];
+		setModulationLanes(lanes, color);
+		_color = loadLanesSSE2(lanes);
+	}
+
+	__m128i operator()(__m128i src, __m128i dst) const {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i srcLo = _mm_unpacklo_epi8(src, zero), srcHi = _mm_unpackhi_epi8(src, zero);
+		const __m128i dstLo = _mm_unpacklo_epi8(dst, zero), dstHi = _mm_unpackhi_epi8(dst, zero);
+
+		// src * dst * a * modulation >> 24, with the plain source alpha
+		// even when there is a color modulation
+		const __m128i mLo = _mm_mullo_epi16(alphaSSE2(srcLo), _color);
+		const __m128i mHi = _mm_mullo_epi16(alphaSSE2(srcHi), _color);
+		const __m128i lo = _mm_sub_epi16(dstLo, _mm_srli_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(srcLo, dstLo), mLo), 8));
+		const __m128i hi = _mm_sub_epi16(dstHi, _mm_srli_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(srcHi, dstHi), mHi), 8));
+
+		const __m128i result = _mm_packus_epi16(lo, hi);
+		return tinted ? _mm_or_si128(result, _mm_set1_epi32(0xFF)) : result;
+	}
+
+	__m128i _color;
+};
+
+template<bool tinted>
+struct MultiplyBlendSSE2 {
+	MultiplyBlendSSE2(uint32 color) {
+		uint16 lanes[8];
+		setModulationLanes(lanes, color);
+		_color = loadLanesSSE2(lanes);
+		_ca = _mm_set1_epi16((color >> kAModShift) & 0xFF);
+	}
+
+	__m128i operator()(__m128i src, __m128i dst) const {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i srcLo = _mm_unpacklo_epi8(src, zero), srcHi = _mm_unpackhi_epi8(src, zero);
+		const __m128i dstLo = _mm_unpacklo_epi8(dst, zero), dstHi = _mm_unpackhi_epi8(dst, zero);
+		const __m128i aLo = sourceAlphaSSE2<tinted>(srcLo, _ca), aHi = sourceAlphaSSE2<tinted>(srcHi, _ca);
+
+		const __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(srcLo, aLo), _color), dstLo), 8);
+		const __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(srcHi, aHi), _color), dstHi), 8);
+
+		// The target alpha is kept, and without a color modulation so is
+		// the target under transparent pixels
+		__m128i keep = _mm_set1_epi32(0xFF);
+		if (!tinted)
+			keep = _mm_or_si128(keep, _mm_packs_epi16(_mm_cmpeq_epi16(aLo, zero), _mm_cmpeq_epi16(aHi, zero)));
+		return selectSSE2(keep, dst, _mm_packus_epi16(lo, hi));
+	}
+
+	__m128i _color, _ca;
+};
+
+/** Load four source pixels, in the order they are drawn in. */
+static inline __m128i loadSourceSSE2(const byte *in, int32 inStep) {
+	if (inStep > 0)
+		return loadSSE2(in);
+	return _mm_shuffle_epi32(loadSSE2(in - 12), _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+template<class Blend>
+static void blendLinesSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color, BlendKernels::BlendFunc scalar) {
+	assert(inStep == 4 || inStep == -4);
+	const Blend blend(color);
+
+	for (uint32 i = 0; i < height; i++) {
+		byte *in = ino;
+		byte *out = outo;
+		uint32 j = 0;
+		for (; j + 4 <= width; j += 4) {
+			_mm_storeu_si128((__m128i *)out, blend(loadSourceSSE2(in, inStep), loadSSE2(out)));
+			in += 4 * inStep;
+			out += 16;
+		}
+
+		scalar(in, out, width - j, 1, pitch, inStep, inoStep, color);
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+template<template<bool> class Blend>
+static void blendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color, BlendKernels::BlendFunc scalar) {
+	if (color == 0xFFFFFFFF)
+		blendLinesSSE2<Blend<false> >(ino, outo, width, height, pitch, inStep, inoStep, color, scalar);
+	else
+		blendLinesSSE2<Blend<true> >(ino, outo, width, height, pitch, inStep, inoStep, color, scalar);
+}
+
+static void alphaBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	blendSSE2<AlphaBlendSSE2>(ino, outo, width, height, pitch, inStep, inoStep, color, &alphaBlendScalar);
+}
+
+static void additiveBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	blendSSE2<AdditiveBlendSSE2>(ino, outo, width, height, pitch, inStep, inoStep, color, &additiveBlendScalar);
+}
+
+static void subtractiveBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	blendSSE2<SubtractiveBlendSSE2>(ino, outo, width, height, pitch, inStep, inoStep, color, &subtractiveBlendScalar);
+}
+
+static void multiplyBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	blendSSE2<MultiplyBlendSSE2>(ino, outo, width, height, pitch, inStep, inoStep, color, &multiplyBlendScalar);
+}
+
+static const BlendKernels s_sse2Kernels = { &alphaBlendSSE2, &additiveBlendSSE2, &subtractiveBlendSSE2, &multiplyBlendSSE2, "SSE2" };
+
+static bool hasSSE2() {
+#if defined(__GNUC__) && defined(__i386__)
+	// 32-bit builds may be told to target SSE2 while running on a
+	// CPU without it; everything 64-bit has it.
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2");
+#else
+	return true;
+#endif
+}
+#endif // BLENDKERNELS_SSE2
+
+#ifdef BLENDKERNELS_NEON
+#pragma mark --- NEON kernels ---
+
+/** NEON counterpart of alphaSSE2. */
+static inline uint16x8_t alphaNEON(uint16x8_t pixels) {
+	return vcombine_u16(vdup_lane_u16(vget_low_u16(pixels), kAIndex), vdup_lane_u16(vget_high_u16(pixels), kAIndex));
+}
+
+/** NEON counterpart of sourceAlphaSSE2. */
+template<bool tinted>
+static inline uint16x8_t sourceAlphaNEON(uint16x8_t src, uint16x8_t ca) {
+	const uint16x8_t a = alphaNEON(src);
+	return tinted ? vshrq_n_u16(vmulq_u16(a, ca), 8) : a;
+}
+
+/** The high halves of the products of eight pairs of 16 bit values. */
+static inline uint16x8_t mulhiNEON(uint16x8_t a, uint16x8_t b) {
+	return vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(a), vget_low_u16(b)), 16),
+	                    vshrn_n_u32(vmull_u16(vget_high_u16(a), vget_high_u16(b)), 16));
+}
+
+static inline uint16x8_t lowNEON(uint8x16_t pixels) {
+	return vmovl_u8(vget_low_u8(pixels));
+}
+
+static inline uint16x8_t highNEON(uint8x16_t pixels) {
+	return vmovl_u8(vget_high_u8(pixels));
+}
+
+static inline uint8x16_t packNEON(uint16x8_t lo, uint16x8_t hi) {
+	return vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi));
+}
+
+static inline uint8x16_t transparentNEON(uint16x8_t aLo, uint16x8_t aHi) {
+	return vcombine_u8(vmovn_u16(vceqq_u16(aLo, vdupq_n_u16(0))), vmovn_u16(vceqq_u16(aHi, vdupq_n_u16(0))));
+}
+
+/** A mask of the alpha bytes of four pixels. */
+static inline uint8x16_t alphaBytesNEON() {
+	byte bytes[16] = { 0 };
+	for (int i = 0; i < 16; i += 4)
+		bytes[i + kAIndex] = 0xFF;
+	return vld1q_u8(bytes);
+}
+
+/** NEON counterpart of AlphaBlendSSE2. */
+template<bool tinted>
+struct AlphaBlendNEON {
+	AlphaBlendNEON(uint32 color) {
+		uint16 lanes[8];
+		setChannelLanes(lanes, 0, (color >> kRModShift) & 0xFF, (color >> kGModShift) & 0xFF, (color >> kBModShift) & 0xFF);
+		_color = vld1q_u16(lanes);
+		_ca = vdupq_n_u16((color >> kAModShift) & 0xFF);
+		_alphaBytes = alphaBytesNEON();
+	}
+
+	uint8x16_t operator()(uint8x16_t src, uint8x16_t dst) const {
+		const uint16x8_t srcLo = lowNEON(src), srcHi = highNEON(src);
+		const uint16x8_t dstLo = lowNEON(dst), dstHi = highNEON(dst);
+		const uint16x8_t aLo = sourceAlphaNEON<tinted>(srcLo, _ca), aHi = sourceAlphaNEON<tinted>(srcHi, _ca);
+
+		const uint16x8_t max = vdupq_n_u16(255);
+		uint16x8_t lo, hi;
+		if (tinted) {
+			lo = vaddq_u16(vshrq_n_u16(vmulq_u16(dstLo, vsubq_u16(max, aLo)), 8), mulhiNEON(vmulq_u16(srcLo, aLo), _color));
+			hi = vaddq_u16(vshrq_n_u16(vmulq_u16(dstHi, vsubq_u16(max, aHi)), 8), mulhiNEON(vmulq_u16(srcHi, aHi), _color));
+		} else {
+			lo = vshrq_n_u16(vmlaq_u16(vmulq_u16(srcLo, aLo), dstLo, vsubq_u16(max, aLo)), 8);
+			hi = vshrq_n_u16(vmlaq_u16(vmulq_u16(srcHi, aHi), dstHi, vsubq_u16(max, aHi)), 8);
+		}
+
+		const uint8x16_t blended = vorrq_u8(packNEON(lo, hi), _alphaBytes);
+		return vbslq_u8(transparentNEON(aLo, aHi), dst, blended);
+	}
+
+	uint16x8_t _color, _ca;
+	uint8x16_t _alphaBytes;
+};
+
+/** NEON counterpart of AdditiveBlendSSE2. */
+template<bool tinted>
+struct AdditiveBlendNEON {
+	AdditiveBlendNEON(uint32 color) {
+		uint16 lanes[8];
+		setModulationLanes(lanes, color);
+		_color = vld1q_u16(lanes);
+		_ca = vdupq_n_u16((color >> kAModShift) & 0xFF);
+	}
+
+	uint8x16_t operator()(uint8x16_t src, uint8x16_t dst) const {
+		const uint16x8_t srcLo = lowNEON(src), srcHi = highNEON(src);
+		const uint16x8_t aLo = sourceAlphaNEON<tinted>(srcLo, _ca), aHi = sourceAlphaNEON<tinted>(srcHi, _ca);
+
+		const uint16x8_t lo = mulhiNEON(vmulq_u16(srcLo, aLo), _color);
+		const uint16x8_t hi = mulhiNEON(vmulq_u16(srcHi, aHi), _color);
+		return vqaddq_u8(dst, packNEON(lo, hi));
+	}
+
+	uint16x8_t _color, _ca;
+};
+
+/** NEON counterpart of SubtractiveBlendSSE2. */
+template<bool tinted>
+struct SubtractiveBlendNEON {
+	SubtractiveBlendNEON(uint32 color) {
+		uint16 lanes[8];
+		setModulationLanes(lanes, color);
+		_color = vld1q_u16(lanes);
+		_alphaBytes = alphaBytesNEON();
+	}
+
+	uint8x16_t operator()(uint8x16_t src, uint8x16_t dst) const {
+		const uint16x8_t srcLo = lowNEON(src), srcHi = highNEON(src);
+		const uint16x8_t dstLo = lowNEON(dst), dstHi = highNEON(dst);
+
+		const uint16x8_t mLo = vmulq_u16(alphaNEON(srcLo), _color);
+		const uint16x8_t mHi = vmulq_u16(alphaNEON(srcHi), _color);
+		const uint16x8_t lo = vsubq_u16(dstLo, vshrq_n_u16(mulhiNEON(vmulq_u16(srcLo, dstLo), mLo), 8));
+		const uint16x8_t hi = vsubq_u16(dstHi, vshrq_n_u16(mulhiNEON(vmulq_u16(srcHi, dstHi), mHi), 8));
+
+		const uint8x16_t result = packNEON(lo, hi);
+		return tinted ? vorrq_u8(result, _alphaBytes) : result;
+	}
+
+	uint16x8_t _color;
+	uint8x16_t _alphaBytes;
+};
+
+/** NEON counterpart of MultiplyBlendSSE2. */
+template<bool tinted>
+struct MultiplyBlendNEON {
+	MultiplyBlendNEON(uint32 color) {
+		uint16 lanes[8];
+		setModulationLanes(lanes, color);
+		_color = vld1q_u16(lanes);
+		_ca = vdupq_n_u16((color >> kAModShift) & 0xFF);
+		_alphaBytes = alphaBytesNEON();
+	}
+
+	uint8x16_t operator()(uint8x16_t src, uint8x16_t dst) const {
+		const uint16x8_t srcLo = lowNEON(src), srcHi = highNEON(src);
+		const uint16x8_t dstLo = lowNEON(dst), dstHi = highNEON(dst);
+		const uint16x8_t aLo = sourceAlphaNEON<tinted>(srcLo, _ca), aHi = sourceAlphaNEON<tinted>(srcHi, _ca);
+
+		const uint16x8_t lo = vshrq_n_u16(vmulq_u16(mulhiNEON(vmulq_u16(srcLo, aLo), _color), dstLo), 8);
+		const uint16x8_t hi = vshrq_n_u16(vmulq_u16(mulhiNEON(vmulq_u16(srcHi, aHi), _color), dstHi), 8);
+
+		uint8x16_t keep = _alphaBytes;
+		if (!tinted)
+			keep = vorrq_u8(keep, transparentNEON(aLo, aHi));
+		return vbslq_u8(keep, dst, packNEON(lo, hi));
+	}
+
+	uint16x8_t _color, _ca;
+	uint8x16_t _alphaBytes;
+};
+
+/** NEON counterpart of loadSourceSSE2. */
+static inline uint8x16_t loadSourceNEON(const byte *in, int32 inStep) {
+	if (inStep > 0)
+		return vld1q_u8(in);
+
+	const uint32x4_t swapped = vrev64q_u32(vreinterpretq_u32_u8(vld1q_u8(in - 12)));
+	return vreinterpretq_u8_u32(vextq_u32(swapped, swapped, 2));
+}
+
+template<class Blend>
+static void blendLinesNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color, BlendKernels::BlendFunc scalar) {
+	assert(inStep == 4 || inStep == -4);
+	const Blend blend(color);
+
+	for (uint32 i = 0; i < height; i++) {
+		byte *in = ino;
+		byte *out = outo;
+		uint32 j = 0;
+		for (; j + 4 <= width; j += 4) {
+			vst1q_u8(out, blend(loadSourceNEON(in, inStep), vld1q_u8(out)));
+			in += 4 * inStep;
+			out += 16;
+		}
+
+		scalar(in, out, width - j, 1, pitch, inStep, inoStep, color);
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+template<template<bool> class Blend>
+static void blendNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color, BlendKernels::BlendFunc scalar) {
+	if (color == 0xFFFFFFFF)
+		blendLinesNEON<Blend<false> >(ino, outo, width, height, pitch, inStep, inoStep, color, scalar);
+	else
+		blendLinesNEON<Blend<true> >(ino, outo, width, height, pitch, inStep, inoStep, color, scalar);
+}
+
+static void alphaBlendNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	blendNEON<AlphaBlendNEON>(ino, outo, width, height, pitch, inStep, inoStep, color, &alphaBlendScalar);
+}
+
+static void additiveBlendNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	blendNEON<AdditiveBlendNEON>(ino, outo, width, height, pitch, inStep, inoStep, color, &additiveBlendScalar);
+}
+
+static void subtractiveBlendNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	blendNEON<SubtractiveBlendNEON>(ino, outo, width, height, pitch, inStep, inoStep, color, &subtractiveBlendScalar);
+}
+
+static void multiplyBlendNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	blendNEON<MultiplyBlendNEON>(ino, outo, width, height, pitch, inStep, inoStep, color, &multiplyBlendScalar);
+}
+
+static const BlendKernels s_neonKernels = { &alphaBlendNEON, &additiveBlendNEON, &subtractiveBlendNEON, &multiplyBlendNEON, "NEON" };
+#endif // BLENDKERNELS_NEON
+
+#pragma mark -
+
+const BlendKernels *getBlendKernels(BlendKernelType type) {
+	switch (type) {
+	case kBlendKernelScalar:
+		return &s_scalarKernels;
+#ifdef BLENDKERNELS_SSE2
+	case kBlendKernelSSE2:
+		return hasSSE2() ? &s_sse2Kernels : 0;
+#endif
+#ifdef BLENDKERNELS_NEON
+	case kBlendKernelNEON:
+		return &s_neonKernels;
+#endif
+	default:
+		return 0;
+	}
+}
+
+const BlendKernels &getDefaultBlendKernels() {
+	static const BlendKernels *s_default = 0;
+
+	// Racing here is harmless: every caller computes the same answer.
+	if (!s_default) {
+		const BlendKernels *kernels = &s_scalarKernels;
+		for (int i = kBlendKernelCount - 1; i > kBlendKernelScalar; --i) {
+			const BlendKernels *candidate = getBlendKernels((BlendKernelType)i);
+			if (candidate) {
+				kernels = candidate;
+				break;
+			}
+		}
+		s_default = kernels;
+	}
+
+	return *s_default;
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,92 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_BLENDKERNELS_H
+#define GRAPHICS_BLENDKERNELS_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+/**
+ * The inner loops of TransparentSurface::blit and blitClip for the blend
+ * modes which mix the source with the target: blend a block of pixels in
+ * TransparentSurface's pixel format onto a target in the same format.
+ *
+ * Every implementation must produce output which is bit-identical to the
+ * scalar one.
+ */
+struct BlendKernels {
+	/**
+	 * @param ino      first source pixel
+	 * @param outo     first target pixel
+	 * @param width    number of pixels per line
+	 * @param height   number of lines
+	 * @param pitch    pitch of the target, in bytes
+	 * @param inStep   distance between two source pixels of a line, in
+	 *                 bytes: 4, or -4 for a horizontally flipped source
+	 * @param inoStep  distance between two source lines, in bytes
+	 * @param color    color modulation in 0xAARRGGBB format, 0xFFFFFFFF
+	 *                 for none
+	 */
+	typedef void (*BlendFunc)(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+
+	/** BLEND_NORMAL: alpha blending, making the target opaque. */
+	BlendFunc alphaBlend;
+
+	/** BLEND_ADDITIVE: add the source, scaled by its alpha, to the target. */
+	BlendFunc additiveBlend;
+
+	/** BLEND_SUBTRACTIVE: darken the target by the source, scaled by its alpha. */
+	BlendFunc subtractiveBlend;
+
+	/** BLEND_MULTIPLY: multiply the target by the source, scaled by its alpha. */
+	BlendFunc multiplyBlend;
+
+	/** Human readable name of the implementation, for debug output. */
+	const char *name;
+};
+
+enum BlendKernelType {
+	kBlendKernelScalar = 0,
+	kBlendKernelSSE2,
+	kBlendKernelNEON,
+
+	kBlendKernelCount
+};
+
+/**
+ * Return the kernels of the given type, or 0 if that implementation was
+ * either not compiled in or is not supported by the CPU we are running on.
+ * The scalar kernels are always available.
+ */
+const BlendKernels *getBlendKernels(BlendKernelType type);
+
+/**
+ * Return the fastest kernels usable on this machine. The choice is made
+ * once, on the first call.
+ */
+const BlendKernels &getDefaultBlendKernels();
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,139 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/dirty_region.h"
+
+namespace Graphics {
+
+static inline uint32 area(const Common::Rect &r) {
+	return (uint32)r.width() * r.height();
+}
+
+void DirtyRegion::Stats::reset() {
+	frames = 0;
+	fullFrames = 0;
+	rects = 0;
+	pixels = 0;
+	lastPixels = 0;
+	maxPixels = 0;
+}
+
+DirtyRegion::DirtyRegion(uint maxWastePercent, uint maxRects)
+	: _maxWastePercent(maxWastePercent), _maxRects(MAX<uint>(maxRects, 1)) {
+}
+
+uint32 DirtyRegion::getWaste(const Common::Rect &a, const Common::Rect &b, uint32 &unionArea) {
+	Common::Rect u(a);
+	u.extend(b);
+	unionArea = area(u);
+
+	uint32 covered = area(a) + area(b);
+	if (a.intersects(b))
+		covered -= area(a.findIntersectingRect(b));
+
+	return unionArea - covered;
+}
+
+void DirtyRegion::addRect(const Common::Rect &rect) {
+	if (!rect.isValidRect())
+		return;
+
+	Common::Rect r(rect);
+	r.clip(_bounds);
+	if (r.isEmpty())
+		return;
+
+	// Merge with every rectangle that is close enough. A merged rectangle
+	// is bigger, so it has to be checked against all others again.
+	for (uint i = 0; i < _rects.size(); ) {
+		const Common::Rect &other = _rects[i];
+		if (other.contains(r))
+			return;
+
+		uint32 unionArea;
+		const uint32 waste = getWaste(other, r, unionArea);
+		if ((uint64)waste * 100 <= (uint64)unionArea * _maxWastePercent) {
+			r.extend(other);
+			_rects.remove_at(i);
+			i = 0;
+		} else {
+			++i;
+		}
+	}
+
+	if (_rects.size() < _maxRects) {
+		_rects.push_back(r);
+		return;
+	}
+
+	// Too many rectangles: grow the one which gets the least bigger
+	uint best = 0;
+	uint32 bestGrowth = 0xFFFFFFFF;
+	for (uint i = 0; i < _rects.size(); ++i) {
+		Common::Rect u(_rects[i]);
+		u.extend(r);
+		const uint32 growth = area(u) - area(_rects[i]);
+		if (growth < bestGrowth) {
+			bestGrowth = growth;
+			best = i;
+		}
+	}
+	_rects[best].extend(r);
+}
+
+void DirtyRegion::addAll() {
+	_rects.clear();
+	if (!_bounds.isEmpty())
+		_rects.push_back(_bounds);
+}
+
+bool DirtyRegion::isFull() const {
+	for (uint i = 0; i < _rects.size(); ++i) {
+		if (_rects[i].contains(_bounds))
+			return true;
+	}
+	return false;
+}
+
+uint32 DirtyRegion::getPixelCount() const {
+	uint32 pixels = 0;
+	for (uint i = 0; i < _rects.size(); ++i)
+		pixels += area(_rects[i]);
+	return pixels;
+}
+
+void DirtyRegion::clear() {
+	if (!_rects.empty()) {
+		const uint32 pixels = getPixelCount();
+		_stats.frames++;
+		if (isFull())
+			_stats.fullFrames++;
+		_stats.rects += _rects.size();
+		_stats.pixels += pixels;
+		_stats.lastPixels = pixels;
+		_stats.maxPixels = MAX(_stats.maxPixels, pixels);
+	}
+
+	_rects.clear();
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,110 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_DIRTY_REGION_H
+#define GRAPHICS_DIRTY_REGION_H
+
+#include "common/array.h"
+#include "common/rect.h"
+
+namespace Graphics {
+
+/**
+ * Collects the modified areas of a surface as a set of rectangles.
+ *
+ * Added rectangles are merged with existing ones when their union does not
+ * contain too many unmodified pixels, so many small neighbouring changes
+ * end up as a few larger rectangles. Once maxRects rectangles are in use,
+ * new ones are merged into the existing rectangle which grows the least,
+ * so the cost of an update grows with the modified area instead of turning
+ * into a full redraw.
+ */
+class DirtyRegion {
+public:
+	enum {
+		kDefaultMaxWastePercent = 25,
+		kDefaultMaxRects = 128
+	};
+
+	/** Counters accumulated over all frames since the last resetStats(). */
+	struct Stats {
+		uint32 frames;      ///< frames with at least one dirty rectangle
+		uint32 fullFrames;  ///< frames in which the whole surface was dirty
+		uint32 rects;       ///< rectangles handed out
+		uint64 pixels;      ///< pixels covered by those rectangles
+		uint32 lastPixels;  ///< pixels of the last frame
+		uint32 maxPixels;   ///< pixels of the most expensive frame
+
+		Stats() { reset(); }
+		void reset();
+	};
+
+	/**
+	 * @param maxWastePercent  largest share of unmodified pixels, in percent,
+	 *                         a merged rectangle may consist of
+	 * @param maxRects         number of rectangles after which everything
+	 *                         new is merged regardless of the waste
+	 */
+	explicit DirtyRegion(uint maxWastePercent = kDefaultMaxWastePercent, uint maxRects = kDefaultMaxRects);
+
+	/** Set the area rectangles are clipped to. */
+	void setBounds(const Common::Rect &bounds) { _bounds = bounds; }
+	const Common::Rect &getBounds() const { return _bounds; }
+
+	/** Mark the given area as modified. */
+	void addRect(const Common::Rect &r);
+
+	/** Mark the whole bounds as modified. */
+	void addAll();
+
+	/** Return true if nothing was modified. */
+	bool isEmpty() const { return _rects.empty(); }
+
+	/** Return true if the whole bounds were modified. */
+	bool isFull() const;
+
+	/** The modified areas. They do not overlap each other as a rule, but may. */
+	const Common::Array<Common::Rect> &getRects() const { return _rects; }
+
+	/** Return the number of pixels covered by the rectangles. */
+	uint32 getPixelCount() const;
+
+	/** Finish a frame: update the statistics and forget all rectangles. */
+	void clear();
+
+	const Stats &getStats() const { return _stats; }
+	void resetStats() { _stats.reset(); }
+
+private:
+	/** Return the number of pixels in the union of a and b which lie in neither. */
+	static uint32 getWaste(const Common::Rect &a, const Common::Rect &b, uint32 &unionArea);
+
+	Common::Rect _bounds;
+	Common::Array<Common::Rect> _rects;
+	const uint _maxWastePercent;
+	const uint _maxRects;
+	Stats _stats;
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -36,6 +36,24 @@ Common::Rect Font::getBoundingBox(uint32 chr) const {
 	return Common::Rect(getCharWidth(chr), getFontHeight());
 }
 
+bool Font::drawRun(Surface *dst, const uint32 *chars, uint count, uint32 last, int &x, int y, int leftX, int rightX, uint32 color) const {
+	for (uint i = 0; i < count; ++i) {
+		const uint32 cur = chars[i];
+		x += getKerningOffset(last, cur);
+		last = cur;
+
+		Common::Rect charBox = getBoundingBox(cur);
+		if (x + charBox.right > rightX)
+			return false;
+		if (x + charBox.right >= leftX)
+			drawChar(dst, cur, x, y, color);
+
+		x += getCharWidth(cur);
+	}
+
+	return true;
+}
+
 namespace {
 
 template<class StringType>
@@ -101,28 +119,28 @@ void drawStringImpl(const Font &font, Surface *dst, const StringType &str, int x
 	assert(dst != 0);
 
 	const int leftX = x, rightX = x + w + 1;
-	int width = font.getStringWidth(str);
 
 	if (align == kTextAlignCenter)
-		x = x + (w - width)/2;
+		x = x + (w - font.getStringWidth(str))/2;
 	else if (align == kTextAlignRight)
-		x = x + w - width;
+		x = x + w - font.getStringWidth(str);
 	x += deltax;
 
-	typename StringType::unsigned_type last = 0;
+	// The characters are handed to the font in runs, see Font::drawRun
+	uint32 run[64];
+	uint length = 0;
+	uint32 last = 0;
 	for (typename StringType::const_iterator i = str.begin(), end = str.end(); i != end; ++i) {
-		const typename StringType::unsigned_type cur = *i;
-		x += font.getKerningOffset(last, cur);
-		last = cur;
-
-		Common::Rect charBox = font.getBoundingBox(cur);
-		if (x + charBox.right > rightX)
-			break;
-		if (x + charBox.right >= leftX)
-			font.drawChar(dst, cur, x, y, color);
-
-		x += font.getCharWidth(cur);
+		run[length++] = (typename StringType::unsigned_type)*i;
+		if (length == ARRAYSIZE(run)) {
+			if (!font.drawRun(dst, run, length, last, x, y, leftX, rightX, color))
+				return;
+			last = run[length - 1];
+			length = 0;
+		}
 	}
+
+	font.drawRun(dst, run, length, last, x, y, leftX, rightX, color);
 }
 
 template<class StringType>
@@ -153,6 +153,27 @@ public:
 	virtual void drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const = 0;
 	void drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color) const;
 
+	/**
+	 * Draw a run of characters on one line, the way drawString does once the
+	 * string is aligned: the kerning offset is applied before each character,
+	 * characters ending left of leftX are skipped, and the first character
+	 * ending right of rightX stops the run. drawString hands the characters
+	 * of a string over in runs, which lets fonts look up each glyph only once.
+	 *
+	 * @param dst    The surface to draw on.
+	 * @param chars  The characters to draw.
+	 * @param count  The number of characters.
+	 * @param last   The character drawn before the run, or 0.
+	 * @param x      The x coordinate of the first character, updated to the
+	 *               position following the last one drawn.
+	 * @param y      The y coordinate where to draw the characters.
+	 * @param leftX  The left edge of the area to draw in.
+	 * @param rightX The right edge of the area to draw in.
+	 * @param color  The color of the characters.
+	 * @return false if drawing stopped at rightX.
+	 */
+	virtual bool drawRun(Surface *dst, const uint32 *chars, uint count, uint32 last, int &x, int y, int leftX, int rightX, uint32 color) const;
+
 	// TODO: Add doxygen comments to this
 	void drawString(Surface *dst, const Common::String &str, int x, int y, int w, uint32 color, TextAlign align = kTextAlignLeft, int deltax = 0, bool useEllipsis = true) const;
 	void drawString(Surface *dst, const Common::U32String &str, int x, int y, int w, uint32 color, TextAlign align = kTextAlignLeft, int deltax = 0, bool useEllipsis = true) const;
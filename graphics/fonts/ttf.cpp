@@ -28,9 +28,11 @@
 #ifdef USE_FREETYPE2
 
 #include "graphics/fonts/ttf.h"
+#include "graphics/atlas_packer.h"
 #include "graphics/font.h"
 #include "graphics/surface.h"
 
+#include "common/array.h"
 #include "common/encoding.h"
 #include "common/file.h"
 #include "common/config-manager.h"
@@ -83,6 +85,20 @@ inline int divRoundToNearest(int dividend, int divisor) {
 	return (dividend + (divisor / 2)) / divisor;
 }
 
+/**
+ * A cheap fingerprint of a font file. Only its start is hashed: it holds the
+ * table directory with the checksum of every table. Files with the same
+ * fingerprint are still compared in full before they share a strike.
+ */
+uint32 hashFontFile(const uint8 *data, uint32 size) {
+	// FNV-1a
+	size = MIN<uint32>(size, 4096);
+	uint32 hash = 2166136261u;
+	for (uint32 i = 0; i < size; ++i)
+		hash = (hash ^ data[i]) * 16777619u;
+	return hash;
+}
+
 } // End of anonymous namespace
 
 class TTFLibrary : public Common::Singleton<TTFLibrary> {
@@ -102,11 +118,95 @@ private:
 	bool _initialized;
 };
 
+/**
+ * Rasterized glyphs shared by all TTF fonts.
+ *
+ * Fonts which render the same face with the same size and options share a
+ * strike, so loading a font twice does not rasterize its glyphs twice. The
+ * glyph bitmaps are stored as 8-bit coverage on atlas pages. Once the pages
+ * use up the memory budget, the page which was drawn from least recently is
+ * evicted: its glyphs keep their metrics and are rasterized again the next
+ * time they are drawn.
+ */
+class TTFGlyphCache : public Common::Singleton<TTFGlyphCache> {
+public:
+	struct Page;
+
+	struct Glyph {
+		int xOffset, yOffset;
+		int advance;
+		FT_UInt slot;
+		uint16 width, height;
+
+		/** The page holding the bitmap, nullptr if it is not rasterized. */
+		Page *page;
+		uint16 x, y;
+	};
+
+	typedef Common::HashMap<FT_UInt, Glyph> GlyphMap;
+
+	struct Strike {
+		Common::String key;
+		uint32 fileSize;
+		/** The font files of the fonts using the strike, all with the same contents */
+		Common::Array<const uint8 *> files;
+		/** Glyphs by glyph index, so fonts with different mappings share them */
+		GlyphMap glyphs;
+	};
+
+	struct Page {
+		Page(uint width, uint height);
+		~Page();
+
+		Surface surface;
+		AtlasPacker packer;
+		uint32 lastUse;
+	};
+
+	TTFGlyphCache();
+	~TTFGlyphCache();
+
+	/**
+	 * Return the strike for the given key and font file, creating it if
+	 * needed. The file has to stay valid until the matching call to
+	 * releaseStrike.
+	 */
+	Strike *acquireStrike(const Common::String &key, const uint8 *file, uint32 fileSize);
+	void releaseStrike(Strike *strike, const uint8 *file);
+
+	/**
+	 * Reserve room for the bitmap of glyph, which must have its size set,
+	 * evicting old pages if needed.
+	 *
+	 * @return where to write the bitmap, with the pitch of glyph.page
+	 */
+	uint8 *allocate(Glyph &glyph);
+
+	/** Mark a page as used by the current draw call. */
+	void touch(Page *page);
+
+private:
+	enum {
+		kPageSize = 512,
+		kMaxPixels = 16 * kPageSize * kPageSize
+	};
+
+	void evictPage(uint index);
+
+	typedef Common::HashMap<Common::String, Strike *> StrikeMap;
+	StrikeMap _strikes;
+	Common::Array<Page *> _pages;
+	uint32 _pixels;
+	uint32 _useCount;
+};
+
 void shutdownTTF() {
+	TTFGlyphCache::destroy();
 	TTFLibrary::destroy();
 }
 
 #define g_ttf ::Graphics::TTFLibrary::instance()
+#define g_ttfGlyphs ::Graphics::TTFGlyphCache::instance()
 
 TTFLibrary::TTFLibrary() : _library(), _initialized(false) {
 	if (!FT_Init_FreeType(&_library))
@@ -132,6 +232,142 @@ void TTFLibrary::closeFont(FT_Face &face) {
 	FT_Done_Face(face);
 }
 
+TTFGlyphCache::Page::Page(uint width, uint height) : packer(width, height), lastUse(0) {
+	surface.create(width, height, PixelFormat::createFormatCLUT8());
+}
+
+TTFGlyphCache::Page::~Page() {
+	surface.free();
+}
+
+TTFGlyphCache::TTFGlyphCache() : _pixels(0), _useCount(0) {
+}
+
+TTFGlyphCache::~TTFGlyphCache() {
+	for (StrikeMap::iterator i = _strikes.begin(); i != _strikes.end(); ++i)
+		delete i->_value;
+
+	for (uint i = 0; i < _pages.size(); ++i)
+		delete _pages[i];
+}
+
+TTFGlyphCache::Strike *TTFGlyphCache::acquireStrike(const Common::String &key, const uint8 *file, uint32 fileSize) {
+	// Different files whose keys collide get strikes of their own
+	for (uint n = 0; ; ++n) {
+		const Common::String strikeKey = n ? Common::String::format("%s#%u", key.c_str(), n) : key;
+		Strike *&strike = _strikes[strikeKey];
+		if (!strike) {
+			strike = new Strike();
+			strike->key = strikeKey;
+			strike->fileSize = fileSize;
+		} else if (strike->fileSize != fileSize ||
+		           (strike->files[0] != file && memcmp(strike->files[0], file, fileSize))) {
+			continue;
+		}
+
+		strike->files.push_back(file);
+		return strike;
+	}
+}
+
+void TTFGlyphCache::releaseStrike(Strike *strike, const uint8 *file) {
+	for (uint i = 0; i < strike->files.size(); ++i) {
+		if (strike->files[i] == file) {
+			strike->files.remove_at(i);
+			break;
+		}
+	}
+
+	if (!strike->files.empty())
+		return;
+
+	for (GlyphMap::const_iterator i = strike->glyphs.begin(); i != strike->glyphs.end(); ++i) {
+		const Glyph &glyph = i->_value;
+		if (glyph.page)
+			glyph.page->packer.release(Common::Rect(glyph.x, glyph.y, glyph.x + glyph.width, glyph.y + glyph.height));
+	}
+
+	for (uint i = 0; i < _pages.size();) {
+		if (_pages[i]->packer.isEmpty()) {
+			_pixels -= _pages[i]->surface.w * _pages[i]->surface.h;
+			delete _pages[i];
+			_pages.remove_at(i);
+		} else {
+			++i;
+		}
+	}
+
+	_strikes.erase(strike->key);
+	delete strike;
+}
+
+uint8 *TTFGlyphCache::allocate(Glyph &glyph) {
+	Common::Rect rect;
+	Page *page = nullptr;
+
+	for (uint i = 0; i < _pages.size() && !page; ++i) {
+		if (_pages[i]->packer.allocate(glyph.width, glyph.height, rect))
+			page = _pages[i];
+	}
+
+	if (!page) {
+		// Glyphs larger than a page get a page of their own
+		const uint width = MAX<uint>(kPageSize, glyph.width);
+		const uint height = MAX<uint>(kPageSize, glyph.height);
+
+		while (!_pages.empty() && _pixels + width * height > kMaxPixels) {
+			uint oldest = 0;
+			for (uint i = 1; i < _pages.size(); ++i) {
+				if (_pages[i]->lastUse < _pages[oldest]->lastUse)
+					oldest = i;
+			}
+			evictPage(oldest);
+		}
+
+		page = new Page(width, height);
+		_pages.push_back(page);
+		_pixels += width * height;
+
+		const bool allocated = page->packer.allocate(glyph.width, glyph.height, rect);
+		assert(allocated);
+		(void)allocated;
+	}
+
+	glyph.page = page;
+	glyph.x = rect.left;
+	glyph.y = rect.top;
+	touch(page);
+
+	return (uint8 *)page->surface.getBasePtr(glyph.x, glyph.y);
+}
+
+void TTFGlyphCache::touch(Page *page) {
+	if (++_useCount == 0) {
+		// Keep the order sane when the counter wraps
+		for (uint i = 0; i < _pages.size(); ++i)
+			_pages[i]->lastUse = 0;
+		_useCount = 1;
+	}
+
+	page->lastUse = _useCount;
+}
+
+void TTFGlyphCache::evictPage(uint index) {
+	Page *page = _pages[index];
+
+	for (StrikeMap::iterator i = _strikes.begin(); i != _strikes.end(); ++i) {
+		GlyphMap &glyphs = i->_value->glyphs;
+		for (GlyphMap::iterator j = glyphs.begin(); j != glyphs.end(); ++j) {
+			if (j->_value.page == page)
+				j->_value.page = nullptr;
+		}
+	}
+
+	_pixels -= page->surface.w * page->surface.h;
+	delete page;
+	_pages.remove_at(index);
+}
+
 class TTFFont : public Font {
 public:
 	TTFFont();
@@ -153,6 +389,8 @@ public:
 	virtual Common::Rect getBoundingBox(uint32 chr) const;
 
 	virtual void drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const;
+
+	virtual bool drawRun(Surface *dst, const uint32 *chars, uint count, uint32 last, int &x, int y, int leftX, int rightX, uint32 color) const;
 private:
 	bool _initialized;
 	FT_Face _face;
@@ -163,18 +401,18 @@ private:
 	int _width, _height;
 	int _ascent, _descent;
 
-	struct Glyph {
-		Surface image;
-		int xOffset, yOffset;
-		int advance;
-		FT_UInt slot;
-	};
+	typedef TTFGlyphCache::Glyph Glyph;
 
-	bool cacheGlyph(Glyph &glyph, uint32 chr) const;
-	typedef Common::HashMap<uint32, Glyph> GlyphCache;
+	TTFGlyphCache::Strike *_strike;
+	typedef Common::HashMap<uint32, Glyph *> GlyphCache;
 	mutable GlyphCache _glyphs;
 	bool _allowLateCaching;
-	void assureCached(uint32 chr) const;
+
+	Glyph *findGlyph(uint32 chr) const;
+	Glyph *cacheGlyph(uint32 chr) const;
+	bool rasterizeGlyph(Glyph &glyph) const;
+	int getKerning(const Glyph *left, const Glyph *right) const;
+	void drawGlyph(Surface *dst, Glyph &glyph, int x, int y, uint32 color) const;
 
 	Common::SeekableReadStream *readTTFTable(FT_ULong tag) const;
 
@@ -192,20 +430,20 @@ private:
 
 TTFFont::TTFFont()
     : _initialized(false), _face(), _ttfFile(0), _size(0), _width(0), _height(0), _ascent(0),
-      _descent(0), _glyphs(), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
+      _descent(0), _strike(nullptr), _glyphs(), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
       _hasKerning(false), _allowLateCaching(false), _fakeBold(false), _fakeItalic(false) {
 }
 
 TTFFont::~TTFFont() {
+	if (_strike)
+		g_ttfGlyphs.releaseStrike(_strike, _ttfFile);
+
 	if (_initialized) {
 		g_ttf.closeFont(_face);
 
 		delete[] _ttfFile;
 		_ttfFile = 0;
 
-		for (GlyphCache::iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i)
-			i->_value.image.free();
-
 		_initialized = false;
 	}
 }
@@ -270,7 +508,8 @@ bool TTFFont::load(uint8 *ttfFile, uint32 sizeFile, int32 faceIndex, bool bold,
 	// Check whether we have kerning support
 	_hasKerning = (FT_HAS_KERNING(_face) != 0);
 
-	if (FT_Set_Char_Size(_face, 0, computePointSize(size, sizeMode) * 64, dpi, dpi)) {
+	const int pointSize = computePointSize(size, sizeMode);
+	if (FT_Set_Char_Size(_face, 0, pointSize * 64, dpi, dpi)) {
 		g_ttf.closeFont(_face);
 
 		// Don't delete ttfFile as we return fail
@@ -334,15 +573,21 @@ bool TTFFont::load(uint8 *ttfFile, uint32 sizeFile, int32 faceIndex, bool bold,
 		_loadFlags |= FT_LOAD_NO_BITMAP;
 	}
 
+	// Everything which affects the rasterized glyphs goes into the key
+	const Common::String key = Common::String::format("%08x:%u:%d:%d:%u:%x:%d:%d:%d",
+		hashFontFile(_ttfFile, _size), _size, faceIndex, pointSize, dpi,
+		(uint)_loadFlags, (int)_renderMode, _fakeBold, _fakeItalic);
+	_strike = g_ttfGlyphs.acquireStrike(key, _ttfFile, _size);
+
 	if (!mapping) {
 		// Allow loading of all unicode characters.
 		_allowLateCaching = true;
 
 		// Load all ISO-8859-1 characters.
 		for (uint i = 0; i < 256; ++i) {
-			if (!cacheGlyph(_glyphs[i], i)) {
-				_glyphs.erase(i);
-			}
+			Glyph *glyph = cacheGlyph(i);
+			if (glyph)
+				_glyphs[i] = glyph;
 		}
 	} else {
 		// We have a fixed map of characters do not load more later.
@@ -353,22 +598,26 @@ bool TTFFont::load(uint8 *ttfFile, uint32 sizeFile, int32 faceIndex, bool bold,
 			const bool isRequired = (mapping[i] & 0x80000000) != 0;
 			// Check whether loading an important glyph fails and error out if
 			// that is the case.
-			if (!cacheGlyph(_glyphs[i], unicode)) {
-				_glyphs.erase(i);
-				if (isRequired) {
-					g_ttf.closeFont(_face);
-
-					// Don't delete ttfFile as we return fail
-					_ttfFile = 0;
-
-					return false;
-				}
+			Glyph *glyph = cacheGlyph(unicode);
+			if (glyph) {
+				_glyphs[i] = glyph;
+			} else if (isRequired) {
+				g_ttf.closeFont(_face);
+				g_ttfGlyphs.releaseStrike(_strike, _ttfFile);
+				_strike = nullptr;
+
+				// Don't delete ttfFile as we return fail
+				_ttfFile = 0;
+
+				return false;
 			}
 		}
 	}
 
 	if (_glyphs.size() == 0) {
 		g_ttf.closeFont(_face);
+		g_ttfGlyphs.releaseStrike(_strike, _ttfFile);
+		_strike = nullptr;
 
 		// Don't delete ttfFile as we return fail
 		_ttfFile = 0;
@@ -512,56 +761,42 @@ int TTFFont::getMaxCharWidth() const {
 }
 
 int TTFFont::getCharWidth(uint32 chr) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
+	const Glyph *glyph = findGlyph(chr);
+	if (!glyph)
 		return 0;
 	else
-		return glyphEntry->_value.advance;
+		return glyph->advance;
 }
 
 int TTFFont::getKerningOffset(uint32 left, uint32 right) const {
 	if (!_hasKerning)
 		return 0;
 
-	assureCached(left);
-	assureCached(right);
-
-	FT_UInt leftGlyph, rightGlyph;
-	GlyphCache::const_iterator glyphEntry;
-
-	glyphEntry = _glyphs.find(left);
-	if (glyphEntry != _glyphs.end()) {
-		leftGlyph = glyphEntry->_value.slot;
-	} else {
-		return 0;
-	}
+	const Glyph *leftGlyph = findGlyph(left);
+	const Glyph *rightGlyph = findGlyph(right);
+	return getKerning(leftGlyph, rightGlyph);
+}
 
-	glyphEntry = _glyphs.find(right);
-	if (glyphEntry != _glyphs.end()) {
-		rightGlyph = glyphEntry->_value.slot;
-	} else {
+int TTFFont::getKerning(const Glyph *left, const Glyph *right) const {
+	if (!_hasKerning || !left || !right)
 		return 0;
-	}
 
-	if (!leftGlyph || !rightGlyph)
+	if (!left->slot || !right->slot)
 		return 0;
 
 	FT_Vector kerningVector;
-	FT_Get_Kerning(_face, leftGlyph, rightGlyph, FT_KERNING_DEFAULT, &kerningVector);
+	FT_Get_Kerning(_face, left->slot, right->slot, FT_KERNING_DEFAULT, &kerningVector);
 	return (kerningVector.x / 64);
 }
 
 Common::Rect TTFFont::getBoundingBox(uint32 chr) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end()) {
+	const Glyph *glyph = findGlyph(chr);
+	if (!glyph) {
 		return Common::Rect();
 	} else {
-		const int xOffset = glyphEntry->_value.xOffset;
-		const int yOffset = glyphEntry->_value.yOffset;
-		const Graphics::Surface &image = glyphEntry->_value.image;
-		return Common::Rect(xOffset, yOffset, xOffset + image.w, yOffset + image.h);
+		const int xOffset = glyph->xOffset;
+		const int yOffset = glyph->yOffset;
+		return Common::Rect(xOffset, yOffset, xOffset + glyph->width, yOffset + glyph->height);
 	}
 }
 
@@ -604,13 +839,42 @@ static void renderGlyph(uint8 *dstPos, const int dstPitch, const uint8 *srcPos,
 } // End of anonymous namespace
 
 void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
+	Glyph *glyph = findGlyph(chr);
+	if (!glyph)
 		return;
 
-	const Glyph &glyph = glyphEntry->_value;
+	drawGlyph(dst, *glyph, x, y, color);
+}
+
+bool TTFFont::drawRun(Surface *dst, const uint32 *chars, uint count, uint32 last, int &x, int y, int leftX, int rightX, uint32 color) const {
+	// Same as Font::drawRun, but with a single glyph lookup per character
+	const Glyph *left = _hasKerning ? findGlyph(last) : nullptr;
+
+	for (uint i = 0; i < count; ++i) {
+		Glyph *glyph = findGlyph(chars[i]);
+		x += getKerning(left, glyph);
+		left = glyph;
+
+		if (!glyph) {
+			// Empty bounding box and no advance
+			if (x > rightX)
+				return false;
+			continue;
+		}
+
+		const int right = x + glyph->xOffset + glyph->width;
+		if (right > rightX)
+			return false;
+		if (right >= leftX)
+			drawGlyph(dst, *glyph, x, y, color);
+
+		x += glyph->advance;
+	}
+
+	return true;
+}
 
+void TTFFont::drawGlyph(Surface *dst, Glyph &glyph, int x, int y, uint32 color) const {
 	x += glyph.xOffset;
 	y += glyph.yOffset;
 
@@ -619,10 +883,20 @@ void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) con
 	if (y > dst->h)
 		return;
 
-	int w = glyph.image.w;
-	int h = glyph.image.h;
+	int w = glyph.width;
+	int h = glyph.height;
+
+	if (!w || !h)
+		return;
+
+	// The bitmap may have been evicted from the atlas since it was last used
+	if (!glyph.page && !rasterizeGlyph(glyph))
+		return;
+
+	g_ttfGlyphs.touch(glyph.page);
 
-	const uint8 *srcPos = (const uint8 *)glyph.image.getPixels();
+	const Surface &image = glyph.page->surface;
+	const uint8 *srcPos = (const uint8 *)image.getBasePtr(glyph.x, glyph.y);
 
 	// Make sure we are not drawing outside the screen bounds
 	if (x < 0) {
@@ -638,7 +912,7 @@ void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) con
 		return;
 
 	if (y < 0) {
-		srcPos -= y * glyph.image.pitch;
+		srcPos -= y * image.pitch;
 		h += y;
 		y = 0;
 	}
@@ -667,26 +941,55 @@ void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) con
 			}
 
 			dstPos += dst->pitch;
-			srcPos += glyph.image.pitch;
+			srcPos += image.pitch;
 		}
 	} else if (dst->format.bytesPerPixel == 2) {
-		renderGlyph<uint16>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format);
+		renderGlyph<uint16>(dstPos, dst->pitch, srcPos, image.pitch, w, h, color, dst->format);
 	} else if (dst->format.bytesPerPixel == 4) {
-		renderGlyph<uint32>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format);
+		renderGlyph<uint32>(dstPos, dst->pitch, srcPos, image.pitch, w, h, color, dst->format);
 	}
 }
 
-bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
+TTFFont::Glyph *TTFFont::findGlyph(uint32 chr) const {
+	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
+	if (glyphEntry != _glyphs.end())
+		return glyphEntry->_value;
+
+	if (!chr || !_allowLateCaching)
+		return nullptr;
+
+	Glyph *glyph = cacheGlyph(chr);
+	if (glyph)
+		_glyphs[chr] = glyph;
+	return glyph;
+}
+
+TTFFont::Glyph *TTFFont::cacheGlyph(uint32 chr) const {
 	FT_UInt slot = FT_Get_Char_Index(_face, chr);
 	if (!slot)
-		return false;
+		return nullptr;
+
+	// Another font with the same face and size may have rasterized it already
+	TTFGlyphCache::GlyphMap::iterator cached = _strike->glyphs.find(slot);
+	if (cached != _strike->glyphs.end())
+		return &cached->_value;
 
+	Glyph glyph;
 	glyph.slot = slot;
+	glyph.page = nullptr;
+	if (!rasterizeGlyph(glyph))
+		return nullptr;
+
+	Glyph &entry = _strike->glyphs[slot];
+	entry = glyph;
+	return &entry;
+}
 
+bool TTFFont::rasterizeGlyph(Glyph &glyph) const {
 	// We use the light target and render mode to improve the looks of the
 	// glyphs. It is most noticable in FreeSansBold.ttf, where otherwise the
 	// 't' glyph looks like it is cut off on the right side.
-	if (FT_Load_Glyph(_face, slot, _loadFlags))
+	if (FT_Load_Glyph(_face, glyph.slot, _loadFlags))
 		return false;
 
 	if (FT_Render_Glyph(_face->glyph, _renderMode))
@@ -740,52 +1043,50 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 		bitmap = &_face->glyph->bitmap;
 	}
 
-
-	glyph.image.create(bitmap->width, bitmap->rows, PixelFormat::createFormatCLUT8());
-
-	const uint8 *src = bitmap->buffer;
-	int srcPitch = bitmap->pitch;
-	if (srcPitch < 0) {
-		src += (bitmap->rows - 1) * srcPitch;
-		srcPitch = -srcPitch;
+	if (bitmap->pixel_mode != FT_PIXEL_MODE_MONO && bitmap->pixel_mode != FT_PIXEL_MODE_GRAY) {
+		warning("TTFFont::rasterizeGlyph: Unsupported pixel mode %d", bitmap->pixel_mode);
+		return false;
 	}
 
-	uint8 *dst = (uint8 *)glyph.image.getPixels();
-	memset(dst, 0, glyph.image.h * glyph.image.pitch);
+	glyph.width = bitmap->width;
+	glyph.height = bitmap->rows;
+	glyph.page = nullptr;
 
-	switch (bitmap->pixel_mode) {
-	case FT_PIXEL_MODE_MONO:
-		for (int y = 0; y < (int)bitmap->rows; ++y) {
-			const uint8 *curSrc = src;
-			uint8 mask = 0;
+	if (glyph.width && glyph.height) {
+		const uint8 *src = bitmap->buffer;
+		int srcPitch = bitmap->pitch;
+		if (srcPitch < 0) {
+			src += (bitmap->rows - 1) * srcPitch;
+			srcPitch = -srcPitch;
+		}
 
-			for (int x = 0; x < (int)bitmap->width; ++x) {
-				if ((x % 8) == 0)
-					mask = *curSrc++;
+		// The atlas space may hold an evicted glyph, so every pixel is written
+		uint8 *dst = g_ttfGlyphs.allocate(glyph);
+		const int dstPitch = glyph.page->surface.pitch;
 
-				if (mask & 0x80)
-					*dst = 255;
+		if (bitmap->pixel_mode == FT_PIXEL_MODE_MONO) {
+			for (int y = 0; y < (int)bitmap->rows; ++y) {
+				const uint8 *curSrc = src;
+				uint8 mask = 0;
 
-				mask <<= 1;
-				++dst;
-			}
+				for (int x = 0; x < (int)bitmap->width; ++x) {
+					if ((x % 8) == 0)
+						mask = *curSrc++;
 
-			src += srcPitch;
-		}
-		break;
+					dst[x] = (mask & 0x80) ? 255 : 0;
+					mask <<= 1;
+				}
 
-	case FT_PIXEL_MODE_GRAY:
-		for (int y = 0; y < (int)bitmap->rows; ++y) {
-			memcpy(dst, src, bitmap->width);
-			dst += glyph.image.pitch;
-			src += srcPitch;
+				dst += dstPitch;
+				src += srcPitch;
+			}
+		} else {
+			for (int y = 0; y < (int)bitmap->rows; ++y) {
+				memcpy(dst, src, bitmap->width);
+				dst += dstPitch;
+				src += srcPitch;
+			}
 		}
-		break;
-
-	default:
-		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap->pixel_mode);
-		glyph.image.free();
-		return false;
 	}
 
 #if FAKE_BOLD == 1
@@ -797,17 +1098,6 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	return true;
 }
 
-void TTFFont::assureCached(uint32 chr) const {
-	if (!chr || !_allowLateCaching || _glyphs.contains(chr)) {
-		return;
-	}
-
-	Glyph newGlyph;
-	if (cacheGlyph(newGlyph, chr)) {
-		_glyphs[chr] = newGlyph;
-	}
-}
-
 Font *loadTTFFont(Common::SeekableReadStream &stream, int size, TTFSizeMode sizeMode, uint dpi, TTFRenderMode renderMode, const uint32 *mapping) {
 	TTFFont *font = new TTFFont();
 
@@ -1013,6 +1303,7 @@ Font *findTTFace(const Common::Array<Common::String> &files, const Common::U32St
 
 namespace Common {
 DECLARE_SINGLETON(Graphics::TTFLibrary);
+DECLARE_SINGLETON(Graphics::TTFGlyphCache);
 } // End of namespace Common
 
 #endif
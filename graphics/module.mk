@@ -1,8 +1,11 @@
 MODULE := graphics
 
 MODULE_OBJS := \
+	atlas_packer.o \
+	blendkernels.o \
 	conversion.o \
 	cursorman.o \
+	dirty_region.o \
 	font.o \
 	fontman.o \
 	fonts/bdf.o \
@@ -26,6 +29,7 @@ MODULE_OBJS := \
 	macgui/macwindowmanager.o \
 	managed_surface.o \
 	nine_patch.o \
+	palette_usage.o \
 	pixelformat.o \
 	primitives.o \
 	scaler.o \
@@ -61,7 +65,8 @@ endif
 ifdef USE_HQ_SCALERS
 MODULE_OBJS += \
 	scaler/hq2x.o \
-	scaler/hq3x.o
+	scaler/hq3x.o \
+	scaler/hqkernels.o
 
 ifdef USE_NASM
 MODULE_OBJS += \
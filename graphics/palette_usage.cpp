@@ -0,0 +1,69 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/palette_usage.h"
+
+namespace Graphics {
+
+void findPaletteUsage(const byte *pixels, int pitch, int w, int h, const bool *indices,
+                      int bandHeight, Common::Array<Common::Rect> &rects) {
+	rects.clear();
+	if (bandHeight < 1)
+		bandHeight = 1;
+
+	for (int top = 0; top < h; top += bandHeight) {
+		const int bottom = MIN(top + bandHeight, h);
+		int left = w, right = 0;
+
+		for (int y = top; y < bottom; ++y) {
+			const byte *row = pixels + y * pitch;
+
+			// Only the pixels outside the extent found so far can widen it
+			int x = 0;
+			while (x < left && !indices[row[x]])
+				++x;
+			if (x == w)
+				continue;
+			left = MIN(left, x);
+
+			x = w - 1;
+			while (x >= right && !indices[row[x]])
+				--x;
+			right = MAX(right, x + 1);
+		}
+
+		if (left >= right)
+			continue;
+
+		if (!rects.empty()) {
+			Common::Rect &last = rects.back();
+			if (last.bottom == top && last.left == left && last.right == right) {
+				last.bottom = bottom;
+				continue;
+			}
+		}
+
+		rects.push_back(Common::Rect(left, top, right, bottom));
+	}
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,53 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_PALETTE_USAGE_H
+#define GRAPHICS_PALETTE_USAGE_H
+
+#include "common/array.h"
+#include "common/rect.h"
+
+namespace Graphics {
+
+/**
+ * Find the parts of a CLUT8 image which show any of the given palette
+ * indices, i.e. the parts which need to be redrawn after those palette
+ * entries changed.
+ *
+ * The image is split into bands of bandHeight rows. Every band using one
+ * of the indices yields a rectangle spanning the marked pixels of the band;
+ * vertically adjacent rectangles with the same horizontal extent are merged.
+ *
+ * @param pixels      the image
+ * @param pitch       width in bytes of one full line of the image
+ * @param w           the width of the image
+ * @param h           the height of the image
+ * @param indices     256 entries, true for every palette index to look for
+ * @param bandHeight  number of rows covered by one rectangle at most
+ * @param rects       receives the rectangles, in top to bottom order
+ */
+void findPaletteUsage(const byte *pixels, int pitch, int w, int h, const bool *indices,
+                      int bandHeight, Common::Array<Common::Rect> &rects);
+
+} // End of namespace Graphics
+
+#endif
@@ -20,8 +20,10 @@
  *
  */
 
+#include "graphics/scaler.h"
 #include "graphics/scaler/intern.h"
 #include "graphics/scaler/scalebit.h"
+#include "common/jobqueue.h"
 #include "common/util.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -178,6 +180,72 @@ void Normal1x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPit
 	}
 }
 
+namespace {
+
+enum {
+	// Smaller bands are not worth the synchronization. Band heights are
+	// kept a multiple of four lines, since the DotMatrix pattern depends
+	// on the line within the scaled area.
+	kMinBandHeight = 16
+};
+
+struct ScalerBands {
+	ScalerProc *scaler;
+	int scaleFactor;
+	const uint8 *srcPtr;
+	uint32 srcPitch;
+	uint8 *dstPtr;
+	uint32 dstPitch;
+	int width;
+	int height;
+	int bandHeight;
+};
+
+void scaleBands(uint begin, uint end, void *param) {
+	const ScalerBands &bands = *(const ScalerBands *)param;
+
+	for (uint band = begin; band < end; ++band) {
+		const int y = band * bands.bandHeight;
+		bands.scaler(bands.srcPtr + y * bands.srcPitch, bands.srcPitch,
+		             bands.dstPtr + y * bands.scaleFactor * bands.dstPitch, bands.dstPitch,
+		             bands.width, MIN(bands.bandHeight, bands.height - y));
+	}
+}
+
+} // End of anonymous namespace
+
+void ScaleInBands(Common::JobQueue &jobs, ScalerProc *scaler, int scaleFactor,
+							const uint8 *srcPtr, uint32 srcPitch,
+							uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+	// Two bands per thread even out differences in the cost of the content
+	const int count = 2 * jobs.getConcurrency();
+	const int bandHeight = MAX<int>(kMinBandHeight, ((height + count - 1) / count + 3) & ~3);
+
+	bool serial = (jobs.getWorkerCount() == 0 || bandHeight >= height);
+#if defined(USE_NASM) && defined(USE_HQ_SCALERS)
+	// The assembly versions of the HQ scalers keep their state in globals
+	serial = serial || scaler == HQ2x || scaler == HQ3x;
+#endif
+
+	if (serial) {
+		scaler(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+		return;
+	}
+
+	ScalerBands bands;
+	bands.scaler = scaler;
+	bands.scaleFactor = scaleFactor;
+	bands.srcPtr = srcPtr;
+	bands.srcPitch = srcPitch;
+	bands.dstPtr = dstPtr;
+	bands.dstPitch = dstPitch;
+	bands.width = width;
+	bands.height = height;
+	bands.bandHeight = bandHeight;
+
+	jobs.parallelFor(0, (height + bandHeight - 1) / bandHeight, 1, scaleBands, &bands);
+}
+
 #ifdef USE_SCALERS
 
 
@@ -26,12 +26,30 @@
 #include "common/scummsys.h"
 #include "graphics/surface.h"
 
+namespace Common {
+class JobQueue;
+}
+
 extern void InitScalers(uint32 BitFormat);
 extern void DestroyScalers();
 
 typedef void ScalerProc(const uint8 *srcPtr, uint32 srcPitch,
 							uint8 *dstPtr, uint32 dstPitch, int width, int height);
 
+/**
+ * Run a scaler over an area split into horizontal bands, which are scaled
+ * in parallel on the given job queue. The scalers read the lines around
+ * each band straight from the source, so the result is identical to a
+ * single call of the scaler for the whole area.
+ *
+ * @param jobs         the job queue running the bands
+ * @param scaler       the scaler to run
+ * @param scaleFactor  the vertical scale factor of the scaler
+ */
+extern void ScaleInBands(Common::JobQueue &jobs, ScalerProc *scaler, int scaleFactor,
+							const uint8 *srcPtr, uint32 srcPitch,
+							uint8 *dstPtr, uint32 dstPitch, int width, int height);
+
 #define DECLARE_SCALER(x)	\
 	extern void x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, \
 					uint32 dstPitch, int width, int height)
@@ -21,6 +21,7 @@
  */
 
 #include "graphics/scaler/intern.h"
+#include "graphics/scaler/hqkernels.h"
 
 #ifdef USE_NASM
 // Assembly version of HQ2x
@@ -122,7 +123,12 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 	//	 | w7 | w8 | w9 |
 	//	 +----+----+----+
 
+	// Computes the patterns, and scales all pixels away from edges
+	Graphics::HQLines lines(RGBtoYUV, p, nextlineSrc, width, 2);
+
 	while (height--) {
+		const uint8 *patterns = lines.next(q, nextlineDst, ColorMask::kLowBits, ColorMask::kLow2Bits);
+
 		w1 = *(p - 1 - nextlineSrc);
 		w4 = *(p - 1);
 		w7 = *(p - 1 + nextlineSrc);
@@ -139,39 +145,22 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			w6 = *(p);
 			w9 = *(p + nextlineSrc);
 
-			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			// Pixels away from edges have already been scaled by HQLines::next()
+			const int pattern = *patterns++;
+			if (!(pattern & Graphics::kHQEdgeBits)) {
+				w1 = w2;
+				w4 = w5;
+				w7 = w8;
+
+				w2 = w3;
+				w5 = w6;
+				w8 = w9;
+
+				q += 2;
+				continue;
+			}
 
 			switch (pattern) {
-			case 0:
-			case 1:
-			case 4:
-			case 32:
-			case 128:
-			case 5:
-			case 132:
-			case 160:
-			case 33:
-			case 129:
-			case 36:
-			case 133:
-			case 164:
-			case 161:
-			case 37:
-			case 165:
-				PIXEL00_20
-				PIXEL01_20
-				PIXEL10_20
-				PIXEL11_20
-				break;
 			case 2:
 			case 34:
 			case 130:
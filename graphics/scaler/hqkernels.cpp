@@ -0,0 +1,465 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/scaler/hqkernels.h"
+#include "graphics/scaler/intern.h"
+#include "common/endian.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HQKERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HQKERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace Graphics {
+
+#pragma mark --- Scalar kernels ---
+
+static void patternsScalar(const uint32 *above, const uint32 *line, const uint32 *below, uint8 *patterns, int width) {
+	for (int x = 0; x < width; ++x) {
+		const int yuv5 = line[x + 1];
+		int pattern = 0;
+
+		if (diffYUV(yuv5, above[x]))     pattern |= 0x0001;
+		if (diffYUV(yuv5, above[x + 1])) pattern |= 0x0002;
+		if (diffYUV(yuv5, above[x + 2])) pattern |= 0x0004;
+		if (diffYUV(yuv5, line[x]))      pattern |= 0x0008;
+		if (diffYUV(yuv5, line[x + 2]))  pattern |= 0x0010;
+		if (diffYUV(yuv5, below[x]))     pattern |= 0x0020;
+		if (diffYUV(yuv5, below[x + 1])) pattern |= 0x0040;
+		if (diffYUV(yuv5, below[x + 2])) pattern |= 0x0080;
+
+		patterns[x] = pattern;
+	}
+}
+
+/** interpolate16_2_1_1 with the color masks passed at run time. */
+static inline uint16 blend211(uint32 p1, uint32 p2, uint32 p3, uint32 lowBits, uint32 low2Bits) {
+	p1 <<= 1;
+	const uint32 low = ((p1 & (lowBits << 1)) + (p2 & low2Bits) + (p3 & low2Bits)) & low2Bits;
+	return ((p1 + p2 + p3) - low) >> 2;
+}
+
+/** interpolate16_3_1 with the color masks passed at run time. */
+static inline uint16 blend31(uint32 p1, uint32 p2, uint32 lowBits, uint32 low2Bits) {
+	const uint32 low = (((p1 & lowBits) << 1) + (p1 & low2Bits) + (p2 & low2Bits)) & low2Bits;
+	return ((p1 * 3 + p2) - low) >> 2;
+}
+
+static void flat2xScalar(const uint16 *src, uint32 nextlineSrc, uint16 *dst, uint32 nextlineDst, int count, uint32 lowBits, uint32 low2Bits) {
+	for (; count > 0; --count) {
+		const uint32 w2 = *(src - nextlineSrc);
+		const uint32 w4 = *(src - 1);
+		const uint32 w5 = *src;
+		const uint32 w6 = *(src + 1);
+		const uint32 w8 = *(src + nextlineSrc);
+
+		*(dst) = blend211(w5, w4, w2, lowBits, low2Bits);
+		*(dst + 1) = blend211(w5, w2, w6, lowBits, low2Bits);
+		*(dst + nextlineDst) = blend211(w5, w8, w4, lowBits, low2Bits);
+		*(dst + nextlineDst + 1) = blend211(w5, w6, w8, lowBits, low2Bits);
+
+		src++;
+		dst += 2;
+	}
+}
+
+static void flat3xScalar(const uint16 *src, uint32 nextlineSrc, uint16 *dst, uint32 nextlineDst, int count, uint32 lowBits, uint32 low2Bits) {
+	const uint32 nextlineDst2 = 2 * nextlineDst;
+
+	for (; count > 0; --count) {
+		const uint32 w2 = *(src - nextlineSrc);
+		const uint32 w4 = *(src - 1);
+		const uint32 w5 = *src;
+		const uint32 w6 = *(src + 1);
+		const uint32 w8 = *(src + nextlineSrc);
+
+		*(dst) = blend211(w5, w4, w2, lowBits, low2Bits);
+		*(dst + 1) = blend31(w5, w2, lowBits, low2Bits);
+		*(dst + 2) = blend211(w5, w2, w6, lowBits, low2Bits);
+		*(dst + nextlineDst) = blend31(w5, w4, lowBits, low2Bits);
+		*(dst + nextlineDst + 1) = w5;
+		*(dst + nextlineDst + 2) = blend31(w5, w6, lowBits, low2Bits);
+		*(dst + nextlineDst2) = blend211(w5, w8, w4, lowBits, low2Bits);
+		*(dst + nextlineDst2 + 1) = blend31(w5, w8, lowBits, low2Bits);
+		*(dst + nextlineDst2 + 2) = blend211(w5, w6, w8, lowBits, low2Bits);
+
+		src++;
+		dst += 3;
+	}
+}
+
+static const HQKernels s_scalarKernels = { &patternsScalar, &flat2xScalar, &flat3xScalar, "scalar" };
+
+#ifdef HQKERNELS_SSE2
+#pragma mark --- SSE2 kernels ---
+
+/**
+ * Return all ones in each lane where diffYUV() would return false. The Y,
+ * U and V components each take one byte, so they can be compared all at
+ * once with saturating byte arithmetic: a component differs if its
+ * absolute difference is still non-zero after subtracting the threshold.
+ */
+static inline __m128i sameYUVSSE2(__m128i yuv1, __m128i yuv2) {
+	const __m128i thresholds = _mm_set1_epi32(0xFF300706);
+	const __m128i diff = _mm_or_si128(_mm_subs_epu8(yuv1, yuv2), _mm_subs_epu8(yuv2, yuv1));
+	return _mm_cmpeq_epi32(_mm_subs_epu8(diff, thresholds), _mm_setzero_si128());
+}
+
+static inline __m128i patternBitSSE2(__m128i yuv5, const uint32 *neighbours, int bit) {
+	const __m128i n = _mm_loadu_si128((const __m128i *)neighbours);
+	return _mm_andnot_si128(sameYUVSSE2(yuv5, n), _mm_set1_epi32(bit));
+}
+
+static void patternsSSE2(const uint32 *above, const uint32 *line, const uint32 *below, uint8 *patterns, int width) {
+	int x = 0;
+
+	for (; x + 4 <= width; x += 4) {
+		const __m128i yuv5 = _mm_loadu_si128((const __m128i *)(line + x + 1));
+
+		__m128i pattern = patternBitSSE2(yuv5, above + x, 0x0001);
+		pattern = _mm_or_si128(pattern, patternBitSSE2(yuv5, above + x + 1, 0x0002));
+		pattern = _mm_or_si128(pattern, patternBitSSE2(yuv5, above + x + 2, 0x0004));
+		pattern = _mm_or_si128(pattern, patternBitSSE2(yuv5, line + x, 0x0008));
+		pattern = _mm_or_si128(pattern, patternBitSSE2(yuv5, line + x + 2, 0x0010));
+		pattern = _mm_or_si128(pattern, patternBitSSE2(yuv5, below + x, 0x0020));
+		pattern = _mm_or_si128(pattern, patternBitSSE2(yuv5, below + x + 1, 0x0040));
+		pattern = _mm_or_si128(pattern, patternBitSSE2(yuv5, below + x + 2, 0x0080));
+
+		pattern = _mm_packs_epi32(pattern, pattern);
+		pattern = _mm_packus_epi16(pattern, pattern);
+		WRITE_UINT32(patterns + x, _mm_cvtsi128_si32(pattern));
+	}
+
+	patternsScalar(above + x, line + x, below + x, patterns + x, width - x);
+}
+
+/** Load four pixels into the low halves of four 32 bit lanes. */
+static inline __m128i loadPixelsSSE2(const uint16 *src) {
+	return _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)src), _mm_setzero_si128());
+}
+
+static inline __m128i blend211SSE2(__m128i p1, __m128i p2, __m128i p3, __m128i lowBits2, __m128i low2Bits) {
+	p1 = _mm_slli_epi32(p1, 1);
+	const __m128i low = _mm_and_si128(_mm_add_epi32(_mm_add_epi32(_mm_and_si128(p1, lowBits2),
+	                                                              _mm_and_si128(p2, low2Bits)),
+	                                                _mm_and_si128(p3, low2Bits)), low2Bits);
+	return _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(_mm_add_epi32(p1, p2), p3), low), 2);
+}
+
+static inline __m128i blend31SSE2(__m128i p1, __m128i p2, __m128i lowBits, __m128i low2Bits) {
+	const __m128i low = _mm_and_si128(_mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(_mm_and_si128(p1, lowBits), 1),
+	                                                              _mm_and_si128(p1, low2Bits)),
+	                                                _mm_and_si128(p2, low2Bits)), low2Bits);
+	const __m128i sum = _mm_add_epi32(_mm_add_epi32(p1, _mm_slli_epi32(p1, 1)), p2);
+	return _mm_srli_epi32(_mm_sub_epi32(sum, low), 2);
+}
+
+static void flat2xSSE2(const uint16 *src, uint32 nextlineSrc, uint16 *dst, uint32 nextlineDst, int count, uint32 lowBits, uint32 low2Bits) {
+	const __m128i lowBits2V = _mm_set1_epi32(lowBits << 1);
+	const __m128i low2BitsV = _mm_set1_epi32(low2Bits);
+
+	for (; count >= 4; count -= 4) {
+		const __m128i w2 = loadPixelsSSE2(src - nextlineSrc);
+		const __m128i w4 = loadPixelsSSE2(src - 1);
+		const __m128i w5 = loadPixelsSSE2(src);
+		const __m128i w6 = loadPixelsSSE2(src + 1);
+		const __m128i w8 = loadPixelsSSE2(src + nextlineSrc);
+
+		// Each lane holds two horizontally adjacent output pixels
+		const __m128i top = _mm_or_si128(blend211SSE2(w5, w4, w2, lowBits2V, low2BitsV),
+		                                 _mm_slli_epi32(blend211SSE2(w5, w2, w6, lowBits2V, low2BitsV), 16));
+		const __m128i bottom = _mm_or_si128(blend211SSE2(w5, w8, w4, lowBits2V, low2BitsV),
+		                                    _mm_slli_epi32(blend211SSE2(w5, w6, w8, lowBits2V, low2BitsV), 16));
+		_mm_storeu_si128((__m128i *)dst, top);
+		_mm_storeu_si128((__m128i *)(dst + nextlineDst), bottom);
+
+		src += 4;
+		dst += 8;
+	}
+
+	flat2xScalar(src, nextlineSrc, dst, nextlineDst, count, lowBits, low2Bits);
+}
+
+static void flat3xSSE2(const uint16 *src, uint32 nextlineSrc, uint16 *dst, uint32 nextlineDst, int count, uint32 lowBits, uint32 low2Bits) {
+	const __m128i lowBitsV = _mm_set1_epi32(lowBits);
+	const __m128i lowBits2V = _mm_set1_epi32(lowBits << 1);
+	const __m128i low2BitsV = _mm_set1_epi32(low2Bits);
+
+	for (; count >= 4; count -= 4) {
+		const __m128i w2 = loadPixelsSSE2(src - nextlineSrc);
+		const __m128i w4 = loadPixelsSSE2(src - 1);
+		const __m128i w5 = loadPixelsSSE2(src);
+		const __m128i w6 = loadPixelsSSE2(src + 1);
+		const __m128i w8 = loadPixelsSSE2(src + nextlineSrc);
+
+		// SSE2 has no cheap way to interleave three vectors, so the rows
+		// are assembled from two pixel pairs and a single pixel per lane.
+		uint32 pairs[3][4], singles[3][4];
+		_mm_storeu_si128((__m128i *)pairs[0], _mm_or_si128(blend211SSE2(w5, w4, w2, lowBits2V, low2BitsV),
+		                                                   _mm_slli_epi32(blend31SSE2(w5, w2, lowBitsV, low2BitsV), 16)));
+		_mm_storeu_si128((__m128i *)singles[0], blend211SSE2(w5, w2, w6, lowBits2V, low2BitsV));
+		_mm_storeu_si128((__m128i *)pairs[1], _mm_or_si128(blend31SSE2(w5, w4, lowBitsV, low2BitsV),
+		                                                   _mm_slli_epi32(w5, 16)));
+		_mm_storeu_si128((__m128i *)singles[1], blend31SSE2(w5, w6, lowBitsV, low2BitsV));
+		_mm_storeu_si128((__m128i *)pairs[2], _mm_or_si128(blend211SSE2(w5, w8, w4, lowBits2V, low2BitsV),
+		                                                   _mm_slli_epi32(blend31SSE2(w5, w8, lowBitsV, low2BitsV), 16)));
+		_mm_storeu_si128((__m128i *)singles[2], blend211SSE2(w5, w6, w8, lowBits2V, low2BitsV));
+
+		for (int row = 0; row < 3; ++row) {
+			uint16 *q = dst + row * nextlineDst;
+			for (int i = 0; i < 4; ++i) {
+				WRITE_UINT32(q, pairs[row][i]);
+				q[2] = singles[row][i];
+				q += 3;
+			}
+		}
+
+		src += 4;
+		dst += 12;
+	}
+
+	flat3xScalar(src, nextlineSrc, dst, nextlineDst, count, lowBits, low2Bits);
+}
+
+static const HQKernels s_sse2Kernels = { &patternsSSE2, &flat2xSSE2, &flat3xSSE2, "SSE2" };
+
+static bool hasSSE2() {
+#if defined(__GNUC__) && defined(__i386__)
+	// 32-bit builds may be told to target SSE2 while running on a
+	// CPU without it; everything 64-bit has it.
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2");
+#else
+	return true;
+#endif
+}
+#endif // HQKERNELS_SSE2
+
+#ifdef HQKERNELS_NEON
+#pragma mark --- NEON kernels ---
+
+/** NEON counterpart of sameYUVSSE2, returning the opposite. */
+static inline uint32x4_t diffYUVNEON(uint8x16_t yuv1, uint8x16_t yuv2) {
+	const uint8x16_t thresholds = vreinterpretq_u8_u32(vdupq_n_u32(0xFF300706));
+	const uint32x4_t over = vreinterpretq_u32_u8(vcgtq_u8(vabdq_u8(yuv1, yuv2), thresholds));
+	return vtstq_u32(over, over);
+}
+
+static inline uint32x4_t patternBitNEON(uint8x16_t yuv5, const uint32 *neighbours, uint32 bit) {
+	const uint8x16_t n = vreinterpretq_u8_u32(vld1q_u32(neighbours));
+	return vandq_u32(diffYUVNEON(yuv5, n), vdupq_n_u32(bit));
+}
+
+static void patternsNEON(const uint32 *above, const uint32 *line, const uint32 *below, uint8 *patterns, int width) {
+	int x = 0;
+
+	for (; x + 4 <= width; x += 4) {
+		const uint8x16_t yuv5 = vreinterpretq_u8_u32(vld1q_u32(line + x + 1));
+
+		uint32x4_t pattern = patternBitNEON(yuv5, above + x, 0x0001);
+		pattern = vorrq_u32(pattern, patternBitNEON(yuv5, above + x + 1, 0x0002));
+		pattern = vorrq_u32(pattern, patternBitNEON(yuv5, above + x + 2, 0x0004));
+		pattern = vorrq_u32(pattern, patternBitNEON(yuv5, line + x, 0x0008));
+		pattern = vorrq_u32(pattern, patternBitNEON(yuv5, line + x + 2, 0x0010));
+		pattern = vorrq_u32(pattern, patternBitNEON(yuv5, below + x, 0x0020));
+		pattern = vorrq_u32(pattern, patternBitNEON(yuv5, below + x + 1, 0x0040));
+		pattern = vorrq_u32(pattern, patternBitNEON(yuv5, below + x + 2, 0x0080));
+
+		const uint16x4_t narrow = vmovn_u32(pattern);
+		uint8 bytes[8];
+		vst1_u8(bytes, vmovn_u16(vcombine_u16(narrow, narrow)));
+		memcpy(patterns + x, bytes, 4);
+	}
+
+	patternsScalar(above + x, line + x, below + x, patterns + x, width - x);
+}
+
+static inline uint32x4_t blend211NEON(uint32x4_t p1, uint32x4_t p2, uint32x4_t p3, uint32x4_t lowBits2, uint32x4_t low2Bits) {
+	p1 = vshlq_n_u32(p1, 1);
+	const uint32x4_t low = vandq_u32(vaddq_u32(vaddq_u32(vandq_u32(p1, lowBits2), vandq_u32(p2, low2Bits)),
+	                                           vandq_u32(p3, low2Bits)), low2Bits);
+	return vshrq_n_u32(vsubq_u32(vaddq_u32(vaddq_u32(p1, p2), p3), low), 2);
+}
+
+static inline uint32x4_t blend31NEON(uint32x4_t p1, uint32x4_t p2, uint32x4_t lowBits, uint32x4_t low2Bits) {
+	const uint32x4_t low = vandq_u32(vaddq_u32(vaddq_u32(vshlq_n_u32(vandq_u32(p1, lowBits), 1), vandq_u32(p1, low2Bits)),
+	                                           vandq_u32(p2, low2Bits)), low2Bits);
+	return vshrq_n_u32(vsubq_u32(vmlaq_n_u32(p2, p1, 3), low), 2);
+}
+
+static void flat2xNEON(const uint16 *src, uint32 nextlineSrc, uint16 *dst, uint32 nextlineDst, int count, uint32 lowBits, uint32 low2Bits) {
+	const uint32x4_t lowBits2V = vdupq_n_u32(lowBits << 1);
+	const uint32x4_t low2BitsV = vdupq_n_u32(low2Bits);
+
+	for (; count >= 4; count -= 4) {
+		const uint32x4_t w2 = vmovl_u16(vld1_u16(src - nextlineSrc));
+		const uint32x4_t w4 = vmovl_u16(vld1_u16(src - 1));
+		const uint32x4_t w5 = vmovl_u16(vld1_u16(src));
+		const uint32x4_t w6 = vmovl_u16(vld1_u16(src + 1));
+		const uint32x4_t w8 = vmovl_u16(vld1_u16(src + nextlineSrc));
+
+		uint16x4x2_t row;
+		row.val[0] = vmovn_u32(blend211NEON(w5, w4, w2, lowBits2V, low2BitsV));
+		row.val[1] = vmovn_u32(blend211NEON(w5, w2, w6, lowBits2V, low2BitsV));
+		vst2_u16(dst, row);
+		row.val[0] = vmovn_u32(blend211NEON(w5, w8, w4, lowBits2V, low2BitsV));
+		row.val[1] = vmovn_u32(blend211NEON(w5, w6, w8, lowBits2V, low2BitsV));
+		vst2_u16(dst + nextlineDst, row);
+
+		src += 4;
+		dst += 8;
+	}
+
+	flat2xScalar(src, nextlineSrc, dst, nextlineDst, count, lowBits, low2Bits);
+}
+
+static void flat3xNEON(const uint16 *src, uint32 nextlineSrc, uint16 *dst, uint32 nextlineDst, int count, uint32 lowBits, uint32 low2Bits) {
+	const uint32x4_t lowBitsV = vdupq_n_u32(lowBits);
+	const uint32x4_t lowBits2V = vdupq_n_u32(lowBits << 1);
+	const uint32x4_t low2BitsV = vdupq_n_u32(low2Bits);
+
+	for (; count >= 4; count -= 4) {
+		const uint32x4_t w2 = vmovl_u16(vld1_u16(src - nextlineSrc));
+		const uint32x4_t w4 = vmovl_u16(vld1_u16(src - 1));
+		const uint32x4_t w5 = vmovl_u16(vld1_u16(src));
+		const uint32x4_t w6 = vmovl_u16(vld1_u16(src + 1));
+		const uint32x4_t w8 = vmovl_u16(vld1_u16(src + nextlineSrc));
+
+		uint16x4x3_t row;
+		row.val[0] = vmovn_u32(blend211NEON(w5, w4, w2, lowBits2V, low2BitsV));
+		row.val[1] = vmovn_u32(blend31NEON(w5, w2, lowBitsV, low2BitsV));
+		row.val[2] = vmovn_u32(blend211NEON(w5, w2, w6, lowBits2V, low2BitsV));
+		vst3_u16(dst, row);
+		row.val[0] = vmovn_u32(blend31NEON(w5, w4, lowBitsV, low2BitsV));
+		row.val[1] = vmovn_u32(w5);
+		row.val[2] = vmovn_u32(blend31NEON(w5, w6, lowBitsV, low2BitsV));
+		vst3_u16(dst + nextlineDst, row);
+		row.val[0] = vmovn_u32(blend211NEON(w5, w8, w4, lowBits2V, low2BitsV));
+		row.val[1] = vmovn_u32(blend31NEON(w5, w8, lowBitsV, low2BitsV));
+		row.val[2] = vmovn_u32(blend211NEON(w5, w6, w8, lowBits2V, low2BitsV));
+		vst3_u16(dst + 2 * nextlineDst, row);
+
+		src += 4;
+		dst += 12;
+	}
+
+	flat3xScalar(src, nextlineSrc, dst, nextlineDst, count, lowBits, low2Bits);
+}
+
+static const HQKernels s_neonKernels = { &patternsNEON, &flat2xNEON, &flat3xNEON, "NEON" };
+#endif // HQKERNELS_NEON
+
+#pragma mark -
+
+const HQKernels *getHQKernels(HQKernelType type) {
+	switch (type) {
+	case kHQKernelScalar:
+		return &s_scalarKernels;
+#ifdef HQKERNELS_SSE2
+	case kHQKernelSSE2:
+		return hasSSE2() ? &s_sse2Kernels : 0;
+#endif
+#ifdef HQKERNELS_NEON
+	case kHQKernelNEON:
+		return &s_neonKernels;
+#endif
+	default:
+		return 0;
+	}
+}
+
+const HQKernels &getDefaultHQKernels() {
+	static const HQKernels *s_default = 0;
+
+	// Racing here is harmless: every caller computes the same answer.
+	if (!s_default) {
+		const HQKernels *kernels = &s_scalarKernels;
+		for (int i = kHQKernelCount - 1; i > kHQKernelScalar; --i) {
+			const HQKernels *candidate = getHQKernels((HQKernelType)i);
+			if (candidate) {
+				kernels = candidate;
+				break;
+			}
+		}
+		s_default = kernels;
+	}
+
+	return *s_default;
+}
+
+#pragma mark --- HQLines ---
+
+HQLines::HQLines(const uint32 *rgbToYuv, const uint16 *src, uint32 nextlineSrc, int width, int scale)
+	: _kernels(getDefaultHQKernels()), _rgbToYuv(rgbToYuv), _src(src), _nextlineSrc(nextlineSrc),
+	  _width(width), _scale(scale) {
+	_yuv = new uint32[3 * (width + 2)];
+	for (int i = 0; i < 3; ++i)
+		_lines[i] = _yuv + i * (width + 2);
+	_patterns = new uint8[width];
+
+	lookup(src - nextlineSrc, _lines[0]);
+	lookup(src, _lines[1]);
+}
+
+HQLines::~HQLines() {
+	delete[] _yuv;
+	delete[] _patterns;
+}
+
+void HQLines::lookup(const uint16 *src, uint32 *yuv) const {
+	// The table is large, so skip the lookup for runs of the same color
+	uint16 color = *(src - 1);
+	uint32 value = _rgbToYuv[color];
+
+	for (int x = -1; x <= _width; ++x) {
+		if (*(src + x) != color) {
+			color = *(src + x);
+			value = _rgbToYuv[color];
+		}
+		*yuv++ = value;
+	}
+}
+
+const uint8 *HQLines::next(uint16 *dst, uint32 nextlineDst, uint32 lowBits, uint32 low2Bits) {
+	lookup(_src + _nextlineSrc, _lines[2]);
+	_kernels.patterns(_lines[0], _lines[1], _lines[2], _patterns, _width);
+
+	if (_scale == 2)
+		_kernels.flat2x(_src, _nextlineSrc, dst, nextlineDst, _width, lowBits, low2Bits);
+	else
+		_kernels.flat3x(_src, _nextlineSrc, dst, nextlineDst, _width, lowBits, low2Bits);
+
+	uint32 *oldest = _lines[0];
+	_lines[0] = _lines[1];
+	_lines[1] = _lines[2];
+	_lines[2] = oldest;
+	_src += _nextlineSrc;
+
+	return _patterns;
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,151 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_SCALER_HQKERNELS_H
+#define GRAPHICS_SCALER_HQKERNELS_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+
+enum {
+	/**
+	 * The pattern bits of the four direct neighbours (w2, w4, w6 and w8).
+	 * All patterns without any of them set scale the same way, by blending
+	 * each output pixel with the two neighbours next to it.
+	 */
+	kHQEdgeBits = 0x02 | 0x08 | 0x10 | 0x40
+};
+
+/**
+ * The data parallel parts of the HQ2x and HQ3x scalers. The per pixel
+ * rules of the HQ filters stay in hq2x.cpp and hq3x.cpp; these kernels
+ * compute the neighbour patterns for a whole line, and scale all pixels
+ * of a line which take the common flat path.
+ *
+ * Every implementation must produce output which is bit-identical to the
+ * scalar one, i.e. to the diffYUV() and interpolate16_*() functions in
+ * graphics/scaler/intern.h.
+ */
+struct HQKernels {
+	/**
+	 * Compute the HQ pattern of each pixel of a line: bit n is set if the
+	 * n-th neighbour (w1 - w4, w6 - w9) differs from the pixel according
+	 * to diffYUV().
+	 *
+	 * @param above     YUV values of the line above, width + 2 entries
+	 * @param line      YUV values of the line itself, width + 2 entries
+	 * @param below     YUV values of the line below, width + 2 entries
+	 * @param patterns  output, width entries
+	 * @param width     number of pixels in the line
+	 *
+	 * All YUV lines start with the pixel left of the first one.
+	 */
+	void (*patterns)(const uint32 *above, const uint32 *line, const uint32 *below, uint8 *patterns, int width);
+
+	/**
+	 * Scale a run of pixels the way HQ2x scales those which have none of
+	 * the kHQEdgeBits set in their pattern.
+	 *
+	 * @param src          first source pixel of the run
+	 * @param nextlineSrc  source pitch, in pixels
+	 * @param dst          first destination pixel
+	 * @param nextlineDst  destination pitch, in pixels
+	 * @param count        number of source pixels in the run
+	 * @param lowBits      ColorMask::kLowBits of the pixel format
+	 * @param low2Bits     ColorMask::kLow2Bits of the pixel format
+	 */
+	void (*flat2x)(const uint16 *src, uint32 nextlineSrc, uint16 *dst, uint32 nextlineDst, int count, uint32 lowBits, uint32 low2Bits);
+
+	/** Same as flat2x, the way HQ3x does. */
+	void (*flat3x)(const uint16 *src, uint32 nextlineSrc, uint16 *dst, uint32 nextlineDst, int count, uint32 lowBits, uint32 low2Bits);
+
+	/** Human readable name of the implementation, for debug output. */
+	const char *name;
+};
+
+enum HQKernelType {
+	kHQKernelScalar = 0,
+	kHQKernelSSE2,
+	kHQKernelNEON,
+
+	kHQKernelCount
+};
+
+/**
+ * Return the kernels of the given type, or 0 if that implementation was
+ * either not compiled in or is not supported by the CPU we are running on.
+ * The scalar kernels are always available.
+ */
+const HQKernels *getHQKernels(HQKernelType type);
+
+/**
+ * Return the fastest kernels usable on this machine. The choice is made
+ * once, on the first call.
+ */
+const HQKernels &getDefaultHQKernels();
+
+/**
+ * Walks the source lines of an HQ scaler call. For every line it computes
+ * the patterns of all pixels and scales the whole line as if it was flat,
+ * leaving only the pixels next to an edge to the caller. Flat output is
+ * cheap enough that overwriting it is faster than skipping those pixels.
+ *
+ * The YUV values of each source line are looked up once, and kept for the
+ * two following lines.
+ */
+class HQLines {
+public:
+	/**
+	 * @param rgbToYuv     the RGBtoYUV table set up by InitScalers()
+	 * @param src          first pixel of the first line to be scaled
+	 * @param nextlineSrc  source pitch, in pixels
+	 * @param width        number of pixels per line
+	 * @param scale        2 for HQ2x, 3 for HQ3x
+	 */
+	HQLines(const uint32 *rgbToYuv, const uint16 *src, uint32 nextlineSrc, int width, int scale);
+	~HQLines();
+
+	/**
+	 * Compute the patterns of the next line, scale it to dst as if all of
+	 * its pixels were flat, and return the patterns.
+	 */
+	const uint8 *next(uint16 *dst, uint32 nextlineDst, uint32 lowBits, uint32 low2Bits);
+
+private:
+	void lookup(const uint16 *src, uint32 *yuv) const;
+
+	const HQKernels &_kernels;
+	const uint32 *_rgbToYuv;
+	const uint16 *_src;
+	const uint32 _nextlineSrc;
+	const int _width;
+	const int _scale;
+
+	uint32 *_yuv;
+	uint32 *_lines[3];
+	uint8 *_patterns;
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -23,6 +23,7 @@
 #include "common/system.h"
 #include "common/algorithm.h"
 #include "graphics/screen.h"
+#include "graphics/dirty_region.h"
 #include "graphics/palette.h"
 
 namespace Graphics {
@@ -76,25 +77,24 @@ void Screen::makeAllDirty() {
 }
 
 void Screen::mergeDirtyRects() {
-	Common::List<Common::Rect>::iterator rOuter, rInner;
+	if (_dirtyRects.size() < 2)
+		return;
 
-	// Process the dirty rect list to find any rects to merge
-	for (rOuter = _dirtyRects.begin(); rOuter != _dirtyRects.end(); ++rOuter) {
-		rInner = rOuter;
-		while (++rInner != _dirtyRects.end()) {
-
-			if ((*rOuter).intersects(*rInner)) {
-				// These two rectangles overlap, so merge them
-				unionRectangle(*rOuter, *rOuter, *rInner);
+	// Coalesce the rects, while keeping the share of unmodified pixels
+	// which would be copied along low
+	Common::List<Common::Rect>::iterator i;
+	Common::Rect bounds = _dirtyRects.front();
+	for (i = _dirtyRects.begin(); i != _dirtyRects.end(); ++i)
+		bounds.extend(*i);
 
-				// remove the inner rect from the list
-				_dirtyRects.erase(rInner);
+	DirtyRegion region;
+	region.setBounds(bounds);
+	for (i = _dirtyRects.begin(); i != _dirtyRects.end(); ++i)
+		region.addRect(*i);
 
-				// move back to beginning of list
-				rInner = rOuter;
-			}
-		}
-	}
+	_dirtyRects.clear();
+	for (uint j = 0; j < region.getRects().size(); ++j)
+		_dirtyRects.push_back(region.getRects()[j]);
 }
 
 bool Screen::unionRectangle(Common::Rect &destRect, const Common::Rect &src1, const Common::Rect &src2) {
@@ -47,7 +47,7 @@ protected:
 	Common::List<Common::Rect> _dirtyRects;
 protected:
 	/**
-	 * Merges together overlapping dirty areas of the screen
+	 * Merges together overlapping and nearby dirty areas of the screen
 	 */
 	void mergeDirtyRects();
 
@@ -86,6 +86,16 @@
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define YUV_TO_RGB_SSE2
+#define YUV_TO_RGB_VECTOR
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define YUV_TO_RGB_NEON
+#define YUV_TO_RGB_VECTOR
+#include <arm_neon.h>
+#endif
+
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
 }
@@ -159,6 +169,7 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 
 YUVToRGBManager::YUVToRGBManager() {
 	_lookup = 0;
+	_vectorized = true;
 
 	int16 *Cr_r_tab = &_colorTab[0 * 256];
 	int16 *Cr_g_tab = &_colorTab[1 * 256];
@@ -192,6 +203,503 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
+#pragma mark --- Vector converters ---
+
+#ifdef YUV_TO_RGB_VECTOR
+
+// The chroma coefficients of the color tables as 16 bit fixed point
+// fractions. Applied to the absolute chroma value and truncated, they
+// reproduce the (int16) casts of the tables for all 256 inputs.
+enum {
+	kCrRFraction = 26266, // 0.419 / 0.299 - 1
+	kCrGFraction = 46773, // 0.299 / 0.419
+	kCbGFraction = 22568, // 0.114 / 0.331
+	kCbBFraction = 50685  // 0.587 / 0.331 - 1
+};
+
+#ifdef YUV_TO_RGB_SSE2
+
+/**
+ * The pixel format, prepared for the shift instructions. A 32 bit pixel is
+ * put together as two 16 bit halves; 16 bit shifts by 16 or more yield 0,
+ * which drops a channel from the half it does not reach. Only formats with
+ * a channel straddling both halves need the right shifts.
+ */
+struct FormatSSE2 {
+	FormatSSE2(const Graphics::PixelFormat &format) {
+		rLoss = _mm_cvtsi32_si128(format.rLoss);
+		gLoss = _mm_cvtsi32_si128(format.gLoss);
+		bLoss = _mm_cvtsi32_si128(format.bLoss);
+		rShift = _mm_cvtsi32_si128(format.rShift);
+		gShift = _mm_cvtsi32_si128(format.gShift);
+		bShift = _mm_cvtsi32_si128(format.bShift);
+		rHighLeft = _mm_cvtsi32_si128(format.rShift >= 16 ? format.rShift - 16 : 16);
+		gHighLeft = _mm_cvtsi32_si128(format.gShift >= 16 ? format.gShift - 16 : 16);
+		bHighLeft = _mm_cvtsi32_si128(format.bShift >= 16 ? format.bShift - 16 : 16);
+		rHighRight = _mm_cvtsi32_si128(format.rShift < 16 ? 16 - format.rShift : 16);
+		gHighRight = _mm_cvtsi32_si128(format.gShift < 16 ? 16 - format.gShift : 16);
+		bHighRight = _mm_cvtsi32_si128(format.bShift < 16 ? 16 - format.bShift : 16);
+
+		straddles = straddlesHalves(format.rShift, format.rLoss) || straddlesHalves(format.gShift, format.gLoss) || straddlesHalves(format.bShift, format.bLoss);
+
+		// 32 bit formats with one byte per channel, like XRGB8888, are
+		// put together from the channels packed to bytes instead
+		bytes = format.bytesPerPixel == 4 && !format.rLoss && !format.gLoss && !format.bLoss && (format.aLoss == 0 || format.aLoss == 8)
+		        && !(format.rShift & 7) && !(format.gShift & 7) && !(format.bShift & 7)
+		        && format.rShift != format.gShift && format.gShift != format.bShift && format.bShift != format.rShift;
+		rByte = format.rShift >> 3;
+		gByte = format.gShift >> 3;
+		bByte = format.bShift >> 3;
+		aByte = 6 - rByte - gByte - bByte;
+		alphaBytes = _mm_set1_epi8((char)(0xFF >> format.aLoss));
+
+		const uint32 alpha = (0xFF >> format.aLoss) << format.aShift;
+		alphaLow = _mm_set1_epi16((short)(alpha & 0xFFFF));
+		alphaHigh = _mm_set1_epi16((short)(alpha >> 16));
+	}
+
+	__m128i rLoss, gLoss, bLoss;
+	__m128i rShift, gShift, bShift;
+	__m128i rHighLeft, gHighLeft, bHighLeft;
+	__m128i rHighRight, gHighRight, bHighRight;
+	__m128i alphaLow, alphaHigh;
+	bool straddles;
+
+	__m128i alphaBytes;
+	bool bytes;
+	int rByte, gByte, bByte, aByte;
+
+	static bool straddlesHalves(int shift, int loss) {
+		return shift < 16 && shift + 8 - loss > 16;
+	}
+};
+
+/**
+ * Multiply eight chroma values by a coefficient of whole + fraction / 65536,
+ * or its negative, truncating toward zero.
+ */
+template<int whole, int fraction, bool negative>
+static inline __m128i mulChromaSSE2(__m128i c) {
+	const __m128i sign = _mm_srai_epi16(c, 15);
+	const __m128i a = _mm_sub_epi16(_mm_xor_si128(c, sign), sign);
+
+	__m128i product = _mm_mulhi_epu16(a, _mm_set1_epi16((short)fraction));
+	if (whole)
+		product = _mm_add_epi16(product, a);
+
+	const __m128i s = negative ? _mm_xor_si128(sign, _mm_set1_epi16(-1)) : sign;
+	return _mm_sub_epi16(_mm_xor_si128(product, s), s);
+}
+
+/** Compute the red, green and blue offsets of eight pixels. */
+static inline void chromaSSE2(__m128i u, __m128i v, __m128i &r, __m128i &g, __m128i &b) {
+	const __m128i cb = _mm_sub_epi16(u, _mm_set1_epi16(128));
+	const __m128i cr = _mm_sub_epi16(v, _mm_set1_epi16(128));
+
+	r = mulChromaSSE2<1, kCrRFraction, false>(cr);
+	g = _mm_add_epi16(mulChromaSSE2<0, kCrGFraction, true>(cr), mulChromaSSE2<0, kCbGFraction, true>(cb));
+	b = mulChromaSSE2<1, kCbBFraction, false>(cb);
+}
+
+/** Clip eight channel values to 0 - 255, scaling from the ITU range if needed. */
+template<bool itu>
+static inline __m128i clipSSE2(__m128i c) {
+	// Clamp to low - high and subtract low in two saturating steps: the
+	// addition pins everything above high to 0x7FFF, the unsigned
+	// subtraction everything below low to 0.
+	const int low = itu ? 16 : 0;
+	const int high = itu ? 235 : 255;
+	c = _mm_subs_epu16(_mm_adds_epi16(c, _mm_set1_epi16(0x7FFF - high)), _mm_set1_epi16(0x7FFF - high + low));
+
+	// c * 255 / 219, exact for all values from 0 to 219
+	if (itu)
+		c = _mm_add_epi16(c, _mm_mulhi_epu16(c, _mm_set1_epi16(10776)));
+
+	return c;
+}
+
+/** Clip eight channel values and pack them to bytes, in both halves of the result. */
+template<bool itu>
+static inline __m128i packChannelSSE2(__m128i c) {
+	// Packing saturates to 0 - 255 by itself
+	if (itu)
+		c = clipSSE2<true>(c);
+	return _mm_packus_epi16(c, c);
+}
+
+/** Add the luminance to the chroma offsets and store eight pixels. */
+template<int bytesPerPixel, bool itu>
+static inline void putPixelsSSE2(byte *dst, __m128i y, __m128i r, __m128i g, __m128i b, const FormatSSE2 &format) {
+	if (bytesPerPixel == 4 && format.bytes) {
+		__m128i channels[4];
+		channels[format.rByte] = packChannelSSE2<itu>(_mm_add_epi16(y, r));
+		channels[format.gByte] = packChannelSSE2<itu>(_mm_add_epi16(y, g));
+		channels[format.bByte] = packChannelSSE2<itu>(_mm_add_epi16(y, b));
+		channels[format.aByte] = format.alphaBytes;
+
+		const __m128i low = _mm_unpacklo_epi8(channels[0], channels[1]);
+		const __m128i high = _mm_unpacklo_epi8(channels[2], channels[3]);
+		_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(low, high));
+		_mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(low, high));
+		return;
+	}
+
+	r = _mm_srl_epi16(clipSSE2<itu>(_mm_add_epi16(y, r)), format.rLoss);
+	g = _mm_srl_epi16(clipSSE2<itu>(_mm_add_epi16(y, g)), format.gLoss);
+	b = _mm_srl_epi16(clipSSE2<itu>(_mm_add_epi16(y, b)), format.bLoss);
+
+	const __m128i low = _mm_or_si128(_mm_or_si128(_mm_sll_epi16(r, format.rShift), _mm_sll_epi16(g, format.gShift)),
+	                                 _mm_or_si128(_mm_sll_epi16(b, format.bShift), format.alphaLow));
+
+	if (bytesPerPixel == 2) {
+		_mm_storeu_si128((__m128i *)dst, low);
+	} else {
+		__m128i high = _mm_or_si128(_mm_or_si128(_mm_sll_epi16(r, format.rHighLeft), _mm_sll_epi16(g, format.gHighLeft)),
+		                            _mm_or_si128(_mm_sll_epi16(b, format.bHighLeft), format.alphaHigh));
+		if (format.straddles) {
+			high = _mm_or_si128(high, _mm_or_si128(_mm_or_si128(_mm_srl_epi16(r, format.rHighRight), _mm_srl_epi16(g, format.gHighRight)),
+			                                       _mm_srl_epi16(b, format.bHighRight)));
+		}
+
+		_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(low, high));
+		_mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(low, high));
+	}
+}
+
+/** Load eight bytes into 16 bit lanes. */
+static inline __m128i loadBytesSSE2(const byte *src) {
+	return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)src), _mm_setzero_si128());
+}
+
+template<int bytesPerPixel, bool itu>
+static void convertYUV444SSE2(byte *dstPtr, int dstPitch, const FormatSSE2 &format, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	for (int h = 0; h < yHeight; h++) {
+		for (int x = 0; x < yWidth; x += 8) {
+			__m128i r, g, b;
+			chromaSSE2(loadBytesSSE2(uSrc + x), loadBytesSSE2(vSrc + x), r, g, b);
+			putPixelsSSE2<bytesPerPixel, itu>(dstPtr + x * bytesPerPixel, loadBytesSSE2(ySrc + x), r, g, b, format);
+		}
+
+		dstPtr += dstPitch;
+		ySrc += yPitch;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+}
+
+template<int bytesPerPixel, bool itu>
+static void convertYUV420SSE2(byte *dstPtr, int dstPitch, const FormatSSE2 &format, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const __m128i zero = _mm_setzero_si128();
+
+	for (int h = 0; h < yHeight; h += 2) {
+		for (int x = 0; x < yWidth; x += 16) {
+			// Eight chroma samples cover sixteen pixels on each of two lines
+			__m128i r, g, b;
+			chromaSSE2(loadBytesSSE2(uSrc + (x >> 1)), loadBytesSSE2(vSrc + (x >> 1)), r, g, b);
+			const __m128i rLo = _mm_unpacklo_epi16(r, r), rHi = _mm_unpackhi_epi16(r, r);
+			const __m128i gLo = _mm_unpacklo_epi16(g, g), gHi = _mm_unpackhi_epi16(g, g);
+			const __m128i bLo = _mm_unpacklo_epi16(b, b), bHi = _mm_unpackhi_epi16(b, b);
+
+			for (int line = 0; line < 2; line++) {
+				const __m128i y = _mm_loadu_si128((const __m128i *)(ySrc + line * yPitch + x));
+				byte *dst = dstPtr + line * dstPitch + x * bytesPerPixel;
+				putPixelsSSE2<bytesPerPixel, itu>(dst, _mm_unpacklo_epi8(y, zero), rLo, gLo, bLo, format);
+				putPixelsSSE2<bytesPerPixel, itu>(dst + 8 * bytesPerPixel, _mm_unpackhi_epi8(y, zero), rHi, gHi, bHi, format);
+			}
+		}
+
+		dstPtr += dstPitch << 1;
+		ySrc += yPitch << 1;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+}
+
+/**
+ * Interpolate the chroma of eight YUV410 pixels from the three samples
+ * starting at src and the three below them, the same way
+ * convertYUV410ToRGB does.
+ */
+static inline __m128i interpolate410SSE2(const byte *src, int uvPitch, __m128i topWeight, __m128i bottomWeight) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i top = _mm_unpacklo_epi8(_mm_cvtsi32_si128(src[0] | (src[1] << 8) | (src[2] << 16)), zero);
+	const __m128i bottom = _mm_unpacklo_epi8(_mm_cvtsi32_si128(src[uvPitch] | (src[uvPitch + 1] << 8) | (src[uvPitch + 2] << 16)), zero);
+	const __m128i column = _mm_add_epi16(_mm_mullo_epi16(top, topWeight), _mm_mullo_epi16(bottom, bottomWeight));
+
+	// Spread the first and second resp. second and third column over four pixels each
+	__m128i left = _mm_unpacklo_epi16(column, column);
+	left = _mm_unpacklo_epi32(left, left);
+	__m128i right = _mm_srli_si128(column, 2);
+	right = _mm_unpacklo_epi16(right, right);
+	right = _mm_unpacklo_epi32(right, right);
+
+	return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(left, _mm_set_epi16(1, 2, 3, 4, 1, 2, 3, 4)),
+	                                    _mm_mullo_epi16(right, _mm_set_epi16(3, 2, 1, 0, 3, 2, 1, 0))), 4);
+}
+
+template<int bytesPerPixel, bool itu>
+static void convertYUV410SSE2(byte *dstPtr, int dstPitch, const FormatSSE2 &format, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	for (int h = 0; h < yHeight; h++) {
+		const int yDiff = h & 3;
+		const __m128i topWeight = _mm_set1_epi16(4 - yDiff);
+		const __m128i bottomWeight = _mm_set1_epi16(yDiff);
+		const byte *uLine = uSrc + (h >> 2) * uvPitch;
+		const byte *vLine = vSrc + (h >> 2) * uvPitch;
+
+		for (int x = 0; x < yWidth; x += 8) {
+			__m128i r, g, b;
+			chromaSSE2(interpolate410SSE2(uLine + (x >> 2), uvPitch, topWeight, bottomWeight),
+			           interpolate410SSE2(vLine + (x >> 2), uvPitch, topWeight, bottomWeight), r, g, b);
+			putPixelsSSE2<bytesPerPixel, itu>(dstPtr + x * bytesPerPixel, loadBytesSSE2(ySrc + x), r, g, b, format);
+		}
+
+		dstPtr += dstPitch;
+		ySrc += yPitch;
+	}
+}
+
+static bool hasSSE2() {
+#if defined(__GNUC__) && defined(__i386__)
+	// 32-bit builds may be told to target SSE2 while running on a
+	// CPU without it; everything 64-bit has it.
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2");
+#else
+	return true;
+#endif
+}
+
+#define CONVERT_VECTOR(func, format, itu) \
+	if (format.bytesPerPixel == 2) { \
+		if (itu) \
+			func<2, true>(dstPtr, dstPitch, FormatSSE2(format), ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch); \
+		else \
+			func<2, false>(dstPtr, dstPitch, FormatSSE2(format), ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch); \
+	} else { \
+		if (itu) \
+			func<4, true>(dstPtr, dstPitch, FormatSSE2(format), ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch); \
+		else \
+			func<4, false>(dstPtr, dstPitch, FormatSSE2(format), ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch); \
+	}
+
+#endif // YUV_TO_RGB_SSE2
+
+#ifdef YUV_TO_RGB_NEON
+
+/** NEON counterpart of FormatSSE2. */
+struct FormatNEON {
+	FormatNEON(const Graphics::PixelFormat &format) {
+		rLoss = -format.rLoss;
+		gLoss = -format.gLoss;
+		bLoss = -format.bLoss;
+		rShift = format.rShift;
+		gShift = format.gShift;
+		bShift = format.bShift;
+		alpha = (0xFF >> format.aLoss) << format.aShift;
+	}
+
+	int rLoss, gLoss, bLoss;
+	int rShift, gShift, bShift;
+	uint32 alpha;
+};
+
+/** NEON counterpart of mulChromaSSE2. */
+template<int whole, int fraction, bool negative>
+static inline int16x8_t mulChromaNEON(int16x8_t c) {
+	const uint16x8_t a = vreinterpretq_u16_s16(vabsq_s16(c));
+
+	uint16x8_t product = vcombine_u16(vshrn_n_u32(vmull_n_u16(vget_low_u16(a), fraction), 16),
+	                                  vshrn_n_u32(vmull_n_u16(vget_high_u16(a), fraction), 16));
+	if (whole)
+		product = vaddq_u16(product, a);
+
+	const int16x8_t result = vreinterpretq_s16_u16(product);
+	const uint16x8_t flip = negative ? vcgeq_s16(c, vdupq_n_s16(0)) : vcltq_s16(c, vdupq_n_s16(0));
+	return vbslq_s16(flip, vnegq_s16(result), result);
+}
+
+/** NEON counterpart of chromaSSE2. */
+static inline void chromaNEON(uint16x8_t u, uint16x8_t v, int16x8_t &r, int16x8_t &g, int16x8_t &b) {
+	const int16x8_t cb = vsubq_s16(vreinterpretq_s16_u16(u), vdupq_n_s16(128));
+	const int16x8_t cr = vsubq_s16(vreinterpretq_s16_u16(v), vdupq_n_s16(128));
+
+	r = mulChromaNEON<1, kCrRFraction, false>(cr);
+	g = vaddq_s16(mulChromaNEON<0, kCrGFraction, true>(cr), mulChromaNEON<0, kCbGFraction, true>(cb));
+	b = mulChromaNEON<1, kCbBFraction, false>(cb);
+}
+
+/** NEON counterpart of clipSSE2. */
+template<bool itu>
+static inline uint16x8_t clipNEON(int16x8_t c) {
+	if (itu) {
+		const uint16x8_t v = vreinterpretq_u16_s16(vsubq_s16(vmaxq_s16(vminq_s16(c, vdupq_n_s16(235)), vdupq_n_s16(16)), vdupq_n_s16(16)));
+		return vaddq_u16(v, vcombine_u16(vshrn_n_u32(vmull_n_u16(vget_low_u16(v), 10776), 16),
+		                                 vshrn_n_u32(vmull_n_u16(vget_high_u16(v), 10776), 16)));
+	}
+
+	return vreinterpretq_u16_s16(vmaxq_s16(vminq_s16(c, vdupq_n_s16(255)), vdupq_n_s16(0)));
+}
+
+static inline uint32x4_t shiftChannelNEON(uint16x4_t c, int loss, int shift) {
+	return vshlq_u32(vshlq_u32(vmovl_u16(c), vdupq_n_s32(loss)), vdupq_n_s32(shift));
+}
+
+/** NEON counterpart of putPixelsSSE2. */
+template<int bytesPerPixel, bool itu>
+static inline void putPixelsNEON(byte *dst, uint16x8_t y, int16x8_t r, int16x8_t g, int16x8_t b, const FormatNEON &format) {
+	const int16x8_t luminance = vreinterpretq_s16_u16(y);
+	const uint16x8_t rc = clipNEON<itu>(vaddq_s16(luminance, r));
+	const uint16x8_t gc = clipNEON<itu>(vaddq_s16(luminance, g));
+	const uint16x8_t bc = clipNEON<itu>(vaddq_s16(luminance, b));
+	const uint32x4_t alpha = vdupq_n_u32(format.alpha);
+
+	const uint32x4_t lo = vorrq_u32(vorrq_u32(shiftChannelNEON(vget_low_u16(rc), format.rLoss, format.rShift),
+	                                          shiftChannelNEON(vget_low_u16(gc), format.gLoss, format.gShift)),
+	                                vorrq_u32(shiftChannelNEON(vget_low_u16(bc), format.bLoss, format.bShift), alpha));
+	const uint32x4_t hi = vorrq_u32(vorrq_u32(shiftChannelNEON(vget_high_u16(rc), format.rLoss, format.rShift),
+	                                          shiftChannelNEON(vget_high_u16(gc), format.gLoss, format.gShift)),
+	                                vorrq_u32(shiftChannelNEON(vget_high_u16(bc), format.bLoss, format.bShift), alpha));
+
+	if (bytesPerPixel == 2) {
+		vst1q_u16((uint16 *)dst, vcombine_u16(vmovn_u32(lo), vmovn_u32(hi)));
+	} else {
+		vst1q_u32((uint32 *)dst, lo);
+		vst1q_u32((uint32 *)(dst + 16), hi);
+	}
+}
+
+template<int bytesPerPixel, bool itu>
+static void convertYUV444NEON(byte *dstPtr, int dstPitch, const FormatNEON &format, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	for (int h = 0; h < yHeight; h++) {
+		for (int x = 0; x < yWidth; x += 8) {
+			int16x8_t r, g, b;
+			chromaNEON(vmovl_u8(vld1_u8(uSrc + x)), vmovl_u8(vld1_u8(vSrc + x)), r, g, b);
+			putPixelsNEON<bytesPerPixel, itu>(dstPtr + x * bytesPerPixel, vmovl_u8(vld1_u8(ySrc + x)), r, g, b, format);
+		}
+
+		dstPtr += dstPitch;
+		ySrc += yPitch;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+}
+
+template<int bytesPerPixel, bool itu>
+static void convertYUV420NEON(byte *dstPtr, int dstPitch, const FormatNEON &format, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	for (int h = 0; h < yHeight; h += 2) {
+		for (int x = 0; x < yWidth; x += 16) {
+			// Eight chroma samples cover sixteen pixels on each of two lines
+			int16x8_t r, g, b;
+			chromaNEON(vmovl_u8(vld1_u8(uSrc + (x >> 1))), vmovl_u8(vld1_u8(vSrc + (x >> 1))), r, g, b);
+			const int16x8x2_t rs = vzipq_s16(r, r);
+			const int16x8x2_t gs = vzipq_s16(g, g);
+			const int16x8x2_t bs = vzipq_s16(b, b);
+
+			for (int line = 0; line < 2; line++) {
+				const uint8x16_t y = vld1q_u8(ySrc + line * yPitch + x);
+				byte *dst = dstPtr + line * dstPitch + x * bytesPerPixel;
+				putPixelsNEON<bytesPerPixel, itu>(dst, vmovl_u8(vget_low_u8(y)), rs.val[0], gs.val[0], bs.val[0], format);
+				putPixelsNEON<bytesPerPixel, itu>(dst + 8 * bytesPerPixel, vmovl_u8(vget_high_u8(y)), rs.val[1], gs.val[1], bs.val[1], format);
+			}
+		}
+
+		dstPtr += dstPitch << 1;
+		ySrc += yPitch << 1;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+}
+
+/** NEON counterpart of interpolate410SSE2. */
+static inline uint16x8_t interpolate410NEON(const byte *src, int uvPitch, uint16 topWeight, uint16 bottomWeight) {
+	static const uint16 leftWeights[8] = { 4, 3, 2, 1, 4, 3, 2, 1 };
+	static const uint16 rightWeights[8] = { 0, 1, 2, 3, 0, 1, 2, 3 };
+
+	uint16 column[3];
+	for (int i = 0; i < 3; i++)
+		column[i] = src[i] * topWeight + src[uvPitch + i] * bottomWeight;
+
+	const uint16x8_t left = vcombine_u16(vdup_n_u16(column[0]), vdup_n_u16(column[1]));
+	const uint16x8_t right = vcombine_u16(vdup_n_u16(column[1]), vdup_n_u16(column[2]));
+	return vshrq_n_u16(vmlaq_u16(vmulq_u16(left, vld1q_u16(leftWeights)), right, vld1q_u16(rightWeights)), 4);
+}
+
+template<int bytesPerPixel, bool itu>
+static void convertYUV410NEON(byte *dstPtr, int dstPitch, const FormatNEON &format, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	for (int h = 0; h < yHeight; h++) {
+		const int yDiff = h & 3;
+		const byte *uLine = uSrc + (h >> 2) * uvPitch;
+		const byte *vLine = vSrc + (h >> 2) * uvPitch;
+
+		for (int x = 0; x < yWidth; x += 8) {
+			int16x8_t r, g, b;
+			chromaNEON(interpolate410NEON(uLine + (x >> 2), uvPitch, 4 - yDiff, yDiff),
+			           interpolate410NEON(vLine + (x >> 2), uvPitch, 4 - yDiff, yDiff), r, g, b);
+			putPixelsNEON<bytesPerPixel, itu>(dstPtr + x * bytesPerPixel, vmovl_u8(vld1_u8(ySrc + x)), r, g, b, format);
+		}
+
+		dstPtr += dstPitch;
+		ySrc += yPitch;
+	}
+}
+
+#define CONVERT_VECTOR(func, format, itu) \
+	if (format.bytesPerPixel == 2) { \
+		if (itu) \
+			func<2, true>(dstPtr, dstPitch, FormatNEON(format), ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch); \
+		else \
+			func<2, false>(dstPtr, dstPitch, FormatNEON(format), ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch); \
+	} else { \
+		if (itu) \
+			func<4, true>(dstPtr, dstPitch, FormatNEON(format), ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch); \
+		else \
+			func<4, false>(dstPtr, dstPitch, FormatNEON(format), ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch); \
+	}
+
+#endif // YUV_TO_RGB_NEON
+
+static bool hasVectorCode() {
+#ifdef YUV_TO_RGB_SSE2
+	static const bool s_hasSSE2 = hasSSE2();
+	return s_hasSSE2;
+#else
+	return true;
+#endif
+}
+
+// The vector converters take the width of the area they convert: a
+// multiple of 8 pixels for YUV444 and YUV410, and of 16 for YUV420.
+
+static void convertYUV444Vector(const Graphics::PixelFormat &format, bool itu, byte *dstPtr, int dstPitch, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+#ifdef YUV_TO_RGB_SSE2
+	CONVERT_VECTOR(convertYUV444SSE2, format, itu)
+#else
+	CONVERT_VECTOR(convertYUV444NEON, format, itu)
+#endif
+}
+
+static void convertYUV420Vector(const Graphics::PixelFormat &format, bool itu, byte *dstPtr, int dstPitch, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+#ifdef YUV_TO_RGB_SSE2
+	CONVERT_VECTOR(convertYUV420SSE2, format, itu)
+#else
+	CONVERT_VECTOR(convertYUV420NEON, format, itu)
+#endif
+}
+
+static void convertYUV410Vector(const Graphics::PixelFormat &format, bool itu, byte *dstPtr, int dstPitch, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+#ifdef YUV_TO_RGB_SSE2
+	CONVERT_VECTOR(convertYUV410SSE2, format, itu)
+#else
+	CONVERT_VECTOR(convertYUV410NEON, format, itu)
+#endif
+}
+
+#undef CONVERT_VECTOR
+
+#endif // YUV_TO_RGB_VECTOR
+
+#pragma mark --- Lookup table converters ---
+
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
@@ -234,12 +742,30 @@ void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert(ySrc && uSrc && vSrc);
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	byte *dstPtr = (byte *)dst->getPixels();
+
+#ifdef YUV_TO_RGB_VECTOR
+	// Convert as much as possible with the vector code, and leave the rest
+	// of each line to the lookup tables
+	if (_vectorized && hasVectorCode()) {
+		const int vectorWidth = yWidth & ~7;
+		convertYUV444Vector(dst->format, scale == kScaleITU, dstPtr, dst->pitch, ySrc, uSrc, vSrc, vectorWidth, yHeight, yPitch, uvPitch);
+
+		dstPtr += vectorWidth * dst->format.bytesPerPixel;
+		ySrc += vectorWidth;
+		uSrc += vectorWidth;
+		vSrc += vectorWidth;
+		yWidth -= vectorWidth;
+		if (yWidth == 0)
+			return;
+	}
+#endif
 
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
-		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV444ToRGB<uint16>(dstPtr, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV444ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV444ToRGB<uint32>(dstPtr, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 template<typename PixelInt>
@@ -274,7 +800,7 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 			dstPtr += sizeof(PixelInt);
 		}
 
-		dstPtr += dstPitch;
+		dstPtr += (dstPitch << 1) - yWidth * sizeof(PixelInt);
 		ySrc += (yPitch << 1) - yWidth;
 		uSrc += uvPitch - halfWidth;
 		vSrc += uvPitch - halfWidth;
@@ -290,12 +816,30 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert((yHeight & 1) == 0);
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	byte *dstPtr = (byte *)dst->getPixels();
+
+#ifdef YUV_TO_RGB_VECTOR
+	// Convert as much as possible with the vector code, and leave the rest
+	// of each line to the lookup tables
+	if (_vectorized && hasVectorCode()) {
+		const int vectorWidth = yWidth & ~15;
+		convertYUV420Vector(dst->format, scale == kScaleITU, dstPtr, dst->pitch, ySrc, uSrc, vSrc, vectorWidth, yHeight, yPitch, uvPitch);
+
+		dstPtr += vectorWidth * dst->format.bytesPerPixel;
+		ySrc += vectorWidth;
+		uSrc += vectorWidth >> 1;
+		vSrc += vectorWidth >> 1;
+		yWidth -= vectorWidth;
+		if (yWidth == 0)
+			return;
+	}
+#endif
 
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
-		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV420ToRGB<uint16>(dstPtr, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV420ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV420ToRGB<uint32>(dstPtr, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 #define READ_QUAD(ptr, prefix) \
@@ -375,12 +919,30 @@ void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert((yHeight & 3) == 0);
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	byte *dstPtr = (byte *)dst->getPixels();
+
+#ifdef YUV_TO_RGB_VECTOR
+	// Convert as much as possible with the vector code, and leave the rest
+	// of each line to the lookup tables
+	if (_vectorized && hasVectorCode()) {
+		const int vectorWidth = yWidth & ~7;
+		convertYUV410Vector(dst->format, scale == kScaleITU, dstPtr, dst->pitch, ySrc, uSrc, vSrc, vectorWidth, yHeight, yPitch, uvPitch);
+
+		dstPtr += vectorWidth * dst->format.bytesPerPixel;
+		ySrc += vectorWidth;
+		uSrc += vectorWidth >> 2;
+		vSrc += vectorWidth >> 2;
+		yWidth -= vectorWidth;
+		if (yWidth == 0)
+			return;
+	}
+#endif
 
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
-		convertYUV410ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV410ToRGB<uint16>(dstPtr, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV410ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV410ToRGB<uint32>(dstPtr, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 } // End of namespace Graphics
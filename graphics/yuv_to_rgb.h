@@ -102,6 +102,13 @@ public:
 	 */
 	void convert410(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Enable or disable the SSE2 and NEON converters, which are used by
+	 * default where available. The lookup table converters they fall back
+	 * to produce the same output; this is mainly for comparing the two.
+	 */
+	void setVectorized(bool enable) { _vectorized = enable; }
+
 private:
 	friend class Common::Singleton<SingletonBaseType>;
 	YUVToRGBManager();
@@ -111,6 +118,7 @@ private:
 
 	YUVToRGBLookup *_lookup;
 	int16 _colorTab[4 * 256]; // 2048 bytes
+	bool _vectorized;
 };
 
 } // End of namespace Graphics
@@ -20,6 +20,7 @@
  *
  */
 
+#include "engines/detectioncache.h"
 #include "engines/metaengine.h"
 #include "common/algorithm.h"
 #include "common/config-manager.h"
@@ -42,12 +43,21 @@ TODO:
 */
 
 enum {
-	// Upper bound (im milliseconds) we want to spend in handleTickle.
-	// Setting this low makes the GUI more responsive but also slows
-	// down the scanning.
-	kMaxScanTime = 50
+	// Upper bound for the number of directories listed and detected at
+	// once. Setting this low updates the progress more often but loads
+	// the engine plugins more often too.
+	kMaxScanBatch = 64
 };
 
+/**
+ * Use all cores for scanning: the GUI thread only polls for the results,
+ * and if there is no thread manager the jobs run synchronously anyway.
+ */
+static uint scanWorkerCount() {
+	Common::ThreadManager *threads = g_system->getThreadManager();
+	return threads ? MAX<uint>(threads->getCPUCount(), 1) : 1;
+}
+
 enum {
 	kOkCmd = 'OK  ',
 	kCancelCmd = 'CNCL'
@@ -60,6 +70,8 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	_dirsScanned(0),
 	_oldGamesCount(0),
 	_dirTotal(0),
+	_jobs(scanWorkerCount()),
+	_batchRunning(false),
 	_okButton(nullptr),
 	_dirProgressText(nullptr),
 	_gameProgressText(nullptr) {
@@ -68,6 +80,10 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 
 	// The dir we start our scan at
 	_scanStack.push(startDir);
+	_batch.jobs = &_jobs;
+
+	// Detection uses the cache from the workers, so create it here
+	DetectionCacheMan.resetStats();
 
 	// Removed for now... Why would you put a title on mass add dialog called "Mass Add Dialog"?
 	// new StaticTextWidget(this, "massadddialog_caption", "Mass Add Dialog");
@@ -116,6 +132,12 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	}
 }
 
+MassAddDialog::~MassAddDialog() {
+	// The worker may still be scanning if the dialog was never closed
+	if (_batchRunning)
+		_jobs.wait(_batchGroup);
+}
+
 struct GameTargetLess {
 	bool operator()(const DetectedGame &x, const DetectedGame &y) const {
 		return x.preferredTarget.compareToIgnoreCase(y.preferredTarget) < 0;
@@ -136,6 +158,14 @@ void MassAddDialog::handleCommand(CommandSender *sender, uint32 cmd, uint32 data
 	g_system->getTaskbarManager()->setCount(0);
 #endif
 
+	// The plugins and the detection cache are in use by the workers while
+	// a batch runs, and neither is thread safe, so wait for it before the
+	// dialog does anything which may touch them
+	if ((cmd == kOkCmd || cmd == kCancelCmd) && _batchRunning) {
+		_jobs.wait(_batchGroup);
+		finishBatch();
+	}
+
 	// FIXME: It's a really bad thing that we use two arbitrary constants
 	if (cmd == kOkCmd) {
 		// Sort the detected games. This is not strictly necessary, but nice for
@@ -160,7 +190,7 @@ void MassAddDialog::handleCommand(CommandSender *sender, uint32 cmd, uint32 data
 
 		close();
 	} else if (cmd == kCancelCmd) {
-		// User cancelled, so we don't do anything and just leave.
+		// User cancelled, so we don't do anything and just leave
 		_games.clear();
 		close();
 	} else {
@@ -168,98 +198,157 @@ void MassAddDialog::handleCommand(CommandSender *sender, uint32 cmd, uint32 data
 	}
 }
 
-void MassAddDialog::handleTickle() {
-	if (_scanStack.empty())
-		return;	// We have finished scanning
+void MassAddDialog::addDetectedGames(const Common::FSNode &dir, const DetectionResults &detectionResults) {
+	if (detectionResults.foundUnknownGames()) {
+		Common::U32String report = detectionResults.generateUnknownGameReport(false, 80);
+		g_system->logMessage(LogMessageType::kInfo, report.encode().c_str());
+	}
 
-	uint32 t = g_system->getMillis();
+	// Just add all detected games / game variants. If we get more than one,
+	// that either means the directory contains multiple games, or the detector
+	// could not fully determine which game variant it was seeing. In either
+	// case, let the user choose which entries he wants to keep.
+	//
+	// However, we only add games which are not already in the config file.
+	DetectedGames candidates = detectionResults.listRecognizedGames();
+	for (DetectedGames::const_iterator cand = candidates.begin(); cand != candidates.end(); ++cand) {
+		const DetectedGame &result = *cand;
 
-	// Perform a breadth-first scan of the filesystem.
-	while (!_scanStack.empty() && (g_system->getMillis() - t) < kMaxScanTime) {
-		Common::FSNode dir = _scanStack.pop();
+		Common::String path = dir.getPath();
 
-		Common::FSList files;
-		if (!dir.getChildren(files, Common::FSNode::kListAll)) {
-			continue;
+		// Remove trailing slashes
+		while (path != "/" && path.lastChar() == '/')
+			path.deleteLastChar();
+
+		// Check for existing config entries for this path/engineid/gameid/lang/platform combination
+		if (_pathToTargets.contains(path)) {
+			Common::String resultPlatformCode = Common::getPlatformCode(result.platform);
+			Common::String resultLanguageCode = Common::getLanguageCode(result.language);
+
+			bool duplicate = false;
+			const StringArray &targets = _pathToTargets[path];
+			for (StringArray::const_iterator iter = targets.begin(); iter != targets.end(); ++iter) {
+				// If the engineid, gameid, platform and language match -> skip it
+				Common::ConfigManager::Domain *dom = ConfMan.getDomain(*iter);
+				assert(dom);
+
+				if ((*dom)["engineid"] == result.engineId &&
+					(*dom)["gameid"] == result.gameId &&
+				    (*dom)["platform"] == resultPlatformCode &&
+				    (*dom)["language"] == resultLanguageCode) {
+					duplicate = true;
+					break;
+				}
+			}
+			if (duplicate) {
+				_oldGamesCount++;
+				continue;	// Skip duplicates
+			}
 		}
+		_games.push_back(result);
 
-		// Run the detector on the dir
-		DetectionResults detectionResults = EngineMan.detectGames(files);
+		_list->append(result.description);
+	}
+}
 
-		if (detectionResults.foundUnknownGames()) {
-			Common::U32String report = detectionResults.generateUnknownGameReport(false, 80);
-			g_system->logMessage(LogMessageType::kInfo, report.encode().c_str());
-		}
+void MassAddDialog::listDirectories(uint begin, uint end, void *param) {
+	ScanBatch *batch = (ScanBatch *)param;
 
-		// Just add all detected games / game variants. If we get more than one,
-		// that either means the directory contains multiple games, or the detector
-		// could not fully determine which game variant it was seeing. In either
-		// case, let the user choose which entries he wants to keep.
-		//
-		// However, we only add games which are not already in the config file.
-		DetectedGames candidates = detectionResults.listRecognizedGames();
-		for (DetectedGames::const_iterator cand = candidates.begin(); cand != candidates.end(); ++cand) {
-			const DetectedGame &result = *cand;
-
-			Common::String path = dir.getPath();
-
-			// Remove trailing slashes
-			while (path != "/" && path.lastChar() == '/')
-				path.deleteLastChar();
-
-			// Check for existing config entries for this path/engineid/gameid/lang/platform combination
-			if (_pathToTargets.contains(path)) {
-				Common::String resultPlatformCode = Common::getPlatformCode(result.platform);
-				Common::String resultLanguageCode = Common::getLanguageCode(result.language);
-
-				bool duplicate = false;
-				const StringArray &targets = _pathToTargets[path];
-				for (StringArray::const_iterator iter = targets.begin(); iter != targets.end(); ++iter) {
-					// If the engineid, gameid, platform and language match -> skip it
-					Common::ConfigManager::Domain *dom = ConfMan.getDomain(*iter);
-					assert(dom);
-
-					if ((*dom)["engineid"] == result.engineId &&
-						(*dom)["gameid"] == result.gameId &&
-					    (*dom)["platform"] == resultPlatformCode &&
-					    (*dom)["language"] == resultLanguageCode) {
-						duplicate = true;
-						break;
-					}
-				}
-				if (duplicate) {
-					_oldGamesCount++;
-					continue;	// Skip duplicates
-				}
-			}
-			_games.push_back(result);
+	for (uint i = begin; i < end; i++)
+		batch->listed[i] = batch->dirs[i].getChildren(batch->fileLists[i], Common::FSNode::kListAll);
+}
 
-			_list->append(result.description);
-		}
+void MassAddDialog::scanBatch(void *param) {
+	ScanBatch *batch = (ScanBatch *)param;
 
+	// The dialog does not touch the batch until the job is finished. Every
+	// directory and its file list is only used by one job at a time, as
+	// FSNode reference counts are not thread safe.
+	batch->fileLists.resize(batch->dirs.size());
+	batch->listed.resize(batch->dirs.size());
+	batch->jobs->parallelFor(0, batch->dirs.size(), 1, listDirectories, batch);
 
-		// Recurse into all subdirs
-		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
-			if (file->isDirectory()) {
-				_scanStack.push(*file);
+	Common::Array<Common::FSNode> dirs;
+	Common::Array<Common::FSList> fileLists;
+	for (uint i = 0; i < batch->dirs.size(); i++) {
+		if (!batch->listed[i])
+			continue;
 
-				_dirTotal++;
-			}
+		const Common::FSList &files = batch->fileLists[i];
+		for (Common::FSList::const_iterator file = files.begin(); file != files.end(); ++file) {
+			if (file->isDirectory())
+				batch->subDirs.push_back(*file);
 		}
 
+		dirs.push_back(batch->dirs[i]);
+		fileLists.push_back(files);
+	}
+
+	batch->dirs = dirs;
+	batch->fileLists.clear();
+	batch->listed.clear();
+	batch->results = EngineMan.detectGames(fileLists, batch->jobs);
+}
+
+void MassAddDialog::startBatch() {
+	while (!_scanStack.empty() && _batch.dirs.size() < kMaxScanBatch)
+		_batch.dirs.push_back(_scanStack.pop());
+
+	_batchRunning = true;
+	_jobs.push(scanBatch, &_batch, &_batchGroup);
+}
+
+void MassAddDialog::finishBatch() {
+	_batchRunning = false;
+
+	// Add the results in scan order
+	for (uint i = 0; i < _batch.dirs.size(); i++) {
+		addDetectedGames(_batch.dirs[i], _batch.results[i]);
 		_dirsScanned++;
+	}
+
+	// Continue with the subdirectories
+	for (uint i = 0; i < _batch.subDirs.size(); i++)
+		_scanStack.push(_batch.subDirs[i]);
+	_dirTotal += _batch.subDirs.size();
+
+	_batch.dirs.clear();
+	_batch.subDirs.clear();
+	_batch.results.clear();
+}
+
+void MassAddDialog::handleTickle() {
+	// Directories are listed and detected on the worker threads, one batch
+	// at a time, so that the dialog stays responsive. The directories of a
+	// batch are spread over all workers, and their results are added in
+	// scan order. Every engine plugin is only loaded once per batch instead
+	// of once per directory.
+	if (_batchRunning) {
+		if (!_jobs.isFinished(_batchGroup))
+			return;
+		finishBatch();
+	} else if (_scanStack.empty()) {
+		return;	// We have finished scanning
+	}
+
+	if (!_scanStack.empty())
+		startBatch();
+
+	const bool complete = !_batchRunning;
 
 #if defined(USE_TASKBAR)
-		g_system->getTaskbarManager()->setProgressValue(_dirsScanned, _dirTotal);
-		g_system->getTaskbarManager()->setCount(_games.size());
+	g_system->getTaskbarManager()->setProgressValue(_dirsScanned, _dirTotal);
+	g_system->getTaskbarManager()->setCount(_games.size());
 #endif
-	}
 
+	// Make sure the hashes of the whole scan end up on disk
+	if (complete)
+		DetectionCacheMan.flush(true);
 
 	// Update the dialog
 	Common::U32String buf;
 
-	if (_scanStack.empty()) {
+	if (complete) {
 		// Enable the OK button
 		_okButton->setEnabled(true);
 
@@ -27,6 +27,7 @@
 #include "gui/widgets/list.h"
 #include "common/fs.h"
 #include "common/hashmap.h"
+#include "common/jobqueue.h"
 #include "common/stack.h"
 #include "common/str.h"
 
@@ -39,6 +40,7 @@ class MassAddDialog : public Dialog {
 	typedef Common::Array<Common::U32String> U32StringArray;
 public:
 	MassAddDialog(const Common::FSNode &startDir);
+	~MassAddDialog() override;
 
 	//void open();
 	void handleCommand(CommandSender *sender, uint32 cmd, uint32 data) override;
@@ -51,9 +53,35 @@ public:
 	}
 
 private:
+	/** Add the games detected in a directory to the list, skipping those already configured */
+	void addDetectedGames(const Common::FSNode &dir, const DetectionResults &detectionResults);
+
+	/**
+	 * Directories listed and detected together by a job. The job spreads
+	 * the work for the single directories over the other workers.
+	 */
+	struct ScanBatch {
+		Common::JobQueue *jobs;
+		Common::Array<Common::FSNode> dirs;    ///< to scan; then those which could be listed
+		Common::Array<Common::FSList> fileLists; ///< the contents of dirs, while scanning
+		Common::Array<bool> listed;            ///< whether each of dirs could be listed
+		Common::Array<Common::FSNode> subDirs; ///< found in them
+		Common::Array<DetectionResults> results; ///< for each of dirs
+	};
+
+	static void scanBatch(void *param);
+	static void listDirectories(uint begin, uint end, void *param);
+	void startBatch();
+	void finishBatch();
+
 	Common::Stack<Common::FSNode>  _scanStack;
 	DetectedGames _games;
 
+	Common::JobQueue _jobs;
+	Common::JobQueue::JobGroup _batchGroup;
+	ScanBatch _batch;
+	bool _batchRunning;
+
 	/**
 	 * Map each path occuring in the config file to the target(s) using that path.
 	 * Used to detect whether a potential new target is already present in the
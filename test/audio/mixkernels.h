@@ -0,0 +1,161 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer.h"
+#include "audio/mixkernels.h"
+#include "audio/rate.h"
+
+#include "helper.h"
+
+class MixKernelsTestSuite : public CxxTest::TestSuite {
+	uint32 _seed;
+
+	int16 nextSample() {
+		_seed = _seed * 1103515245 + 12345;
+		return (int16)(_seed >> 16);
+	}
+
+	void fill(int16 *buf, uint count) {
+		for (uint i = 0; i < count; ++i)
+			buf[i] = nextSample();
+	}
+
+	// Mix random input with the given kernels and with the scalar ones, and
+	// require identical results for a range of volumes and buffer lengths.
+	void compareWithScalar(const Audio::MixKernels &kernels) {
+		const Audio::MixKernels *scalar = Audio::getMixKernels(Audio::kMixKernelScalar);
+		static const uint16 volumes[] = { 0, 1, 127, 128, 255, Audio::Mixer::kMaxMixerVolume };
+		static const uint lengths[] = { 0, 1, 3, 4, 7, 8, 15, 16, 17, 255 };
+
+		int16 src[2 * 255];
+		int16 expected[2 * 255];
+		int16 actual[2 * 255];
+
+		for (uint l = 0; l < ARRAYSIZE(lengths); ++l) {
+			for (uint v = 0; v < ARRAYSIZE(volumes) * ARRAYSIZE(volumes); ++v) {
+				const uint len = lengths[l];
+				const uint16 volL = volumes[v % ARRAYSIZE(volumes)];
+				const uint16 volR = volumes[v / ARRAYSIZE(volumes)];
+
+				// Stereo
+				fill(src, 2 * len);
+				fill(expected, 2 * len);
+				memcpy(actual, expected, sizeof(expected));
+
+				scalar->mixStereo(expected, src, len, volL, volR);
+				kernels.mixStereo(actual, src, len, volL, volR);
+				TS_ASSERT_SAME_DATA(expected, actual, 2 * len * sizeof(int16));
+
+				// Mono
+				fill(src, len);
+				fill(expected, 2 * len);
+				memcpy(actual, expected, sizeof(expected));
+
+				scalar->mixMono(expected, src, len, volL, volR);
+				kernels.mixMono(actual, src, len, volL, volR);
+				TS_ASSERT_SAME_DATA(expected, actual, 2 * len * sizeof(int16));
+			}
+
+			// Convolution, with coefficients small enough not to overflow
+			int16 coeffs[255];
+			fill(src, lengths[l]);
+			fill(coeffs, lengths[l]);
+			for (uint i = 0; i < lengths[l]; ++i)
+				coeffs[i] >>= 4;
+			TS_ASSERT_EQUALS(scalar->convolve(src, coeffs, lengths[l]), kernels.convolve(src, coeffs, lengths[l]));
+		}
+	}
+
+public:
+	void setUp() {
+		_seed = 0x5eed;
+	}
+
+	void test_scalar_reference() {
+		const Audio::MixKernels *scalar = Audio::getMixKernels(Audio::kMixKernelScalar);
+		TS_ASSERT(scalar != 0);
+
+		int16 out[4] = { 0, 100, 32000, -32000 };
+		const int16 in[4] = { -32768, 32767, -32768, 32767 };
+		scalar->mixStereo(out, in, 2, Audio::Mixer::kMaxMixerVolume, 128);
+
+		// Division truncates toward zero, additions saturate.
+		int16 ref[4] = { 0, 100, 32000, -32000 };
+		Audio::clampedAdd(ref[0], (-32768 * Audio::Mixer::kMaxMixerVolume) / Audio::Mixer::kMaxMixerVolume);
+		Audio::clampedAdd(ref[1], (32767 * 128) / Audio::Mixer::kMaxMixerVolume);
+		Audio::clampedAdd(ref[2], (-32768 * Audio::Mixer::kMaxMixerVolume) / Audio::Mixer::kMaxMixerVolume);
+		Audio::clampedAdd(ref[3], (32767 * 128) / Audio::Mixer::kMaxMixerVolume);
+		TS_ASSERT_SAME_DATA(ref, out, sizeof(out));
+	}
+
+	void test_all_kernels_match_scalar() {
+		for (int type = Audio::kMixKernelScalar; type < Audio::kMixKernelCount; ++type) {
+			const Audio::MixKernels *kernels = Audio::getMixKernels((Audio::MixKernelType)type);
+			if (kernels)
+				compareWithScalar(*kernels);
+		}
+	}
+
+	void test_default_kernels_available() {
+		const Audio::MixKernels &kernels = Audio::getDefaultMixKernels();
+		TS_ASSERT(kernels.mixMono != 0);
+		TS_ASSERT(kernels.mixStereo != 0);
+		TS_ASSERT(kernels.name != 0);
+	}
+
+	void test_polyphase_converter_dc() {
+		// A constant signal must come out unchanged once the filter has
+		// filled up, for both up- and downsampling.
+		static const int rates[][2] = { { 11025, 44100 }, { 22050, 48000 }, { 48000, 44100 } };
+
+		for (uint r = 0; r < ARRAYSIZE(rates); ++r) {
+			const int frames = 4096;
+			// The stream frees the samples with free()
+			int16 *in = (int16 *)malloc(frames * sizeof(int16));
+			for (int i = 0; i < frames; ++i)
+				in[i] = 10000;
+
+			Common::SeekableReadStream *data = new Common::MemoryReadStream((const byte *)in, frames * sizeof(int16), DisposeAfterUse::YES);
+			Audio::SeekableAudioStream *stream = Audio::makeRawStream(data, rates[r][0], Audio::FLAG_16BITS
+#ifdef SCUMM_LITTLE_ENDIAN
+			                                                          | Audio::FLAG_LITTLE_ENDIAN
+#endif
+			                                                          );
+			Audio::RateConverter *converter = Audio::makeRateConverter(rates[r][0], rates[r][1], false, false, Audio::kRateConverterPolyphase);
+
+			int16 out[2 * 1024];
+			memset(out, 0, sizeof(out));
+			TS_ASSERT_EQUALS(converter->flow(*stream, out, 1024, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), 1024);
+
+			for (int i = 512; i < 1024; ++i) {
+				TS_ASSERT_EQUALS(out[2 * i], 10000);
+				TS_ASSERT_EQUALS(out[2 * i + 1], 10000);
+			}
+
+			delete converter;
+			delete stream;
+		}
+	}
+
+	void test_copy_converter_reverse_stereo() {
+		const int sampleRate = 11025;
+		int16 *comp;
+		Audio::SeekableAudioStream *stream = createSineStream<int16>(sampleRate, 1, &comp, false, true);
+		Audio::RateConverter *converter = Audio::makeRateConverter(sampleRate, sampleRate, true, true);
+
+		const uint frames = 1000;
+		int16 *out = new int16[frames * 2];
+		memset(out, 0, frames * 2 * sizeof(int16));
+
+		TS_ASSERT_EQUALS(converter->flow(*stream, out, frames, 200, 50), (int)frames);
+
+		for (uint i = 0; i < frames; ++i) {
+			TS_ASSERT_EQUALS(out[2 * i + 1], (comp[2 * i] * 200) / Audio::Mixer::kMaxMixerVolume);
+			TS_ASSERT_EQUALS(out[2 * i], (comp[2 * i + 1] * 50) / Audio::Mixer::kMaxMixerVolume);
+		}
+
+		delete[] out;
+		delete converter;
+		delete stream;
+		delete[] comp;
+	}
+};
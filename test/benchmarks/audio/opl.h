@@ -0,0 +1,215 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/fmopl.h"
+#include "audio/softsynth/opl/dbopl.h"
+
+#include "common/func.h"
+
+#ifndef DISABLE_DOSBOX_OPL
+
+/**
+ * The DOSBox OPL core, wrapped without the mixer and config lookups of
+ * OPL::DOSBox::OPL so that it can run without an OSystem.
+ *
+ * Since the EmulatedOPL destructor stops the mixer stream, which does not
+ * exist here, there is only ever one instance and it is never deleted.
+ */
+class BenchmarkOPL : public ::OPL::EmulatedOPL {
+public:
+	static BenchmarkOPL &instance() {
+		static BenchmarkOPL *s_instance = 0;
+		if (!s_instance)
+			s_instance = new BenchmarkOPL();
+		return *s_instance;
+	}
+
+	bool init() {
+		delete _chip;
+		_chip = new ::OPL::DOSBox::DBOPL::Chip();
+		_chip->Setup(getRate());
+		_address = 0;
+		return true;
+	}
+
+	void reset() { init(); }
+	bool isStereo() const { return false; }
+	int getRate() const { return 44100; }
+
+	void setCallback(::OPL::TimerCallback *callback) {
+		_callback.reset(callback);
+	}
+
+protected:
+	BenchmarkOPL() : _chip(0), _address(0) {
+		::OPL::DOSBox::DBOPL::InitTables();
+		init();
+	}
+
+	void generateSamples(int16 *buffer, int length) {
+		int32 temp[512];
+		while (length > 0) {
+			const int count = MIN<int>(length, ARRAYSIZE(temp));
+			_chip->GenerateBlock2(count, temp);
+			for (int i = 0; i < count; ++i)
+				buffer[i] = CLIP<int32>(temp[i], -32768, 32767);
+			buffer += count;
+			length -= count;
+		}
+	}
+
+	void writeImmediate(int a, int v) {
+		if (a & 1)
+			_chip->WriteReg(_address, v);
+		else
+			_address = v;
+	}
+
+	byte readImmediate(int a) { return 0; }
+	void writeRegImmediate(int r, int v) { _chip->WriteReg(r, v); }
+
+private:
+	::OPL::DOSBox::DBOPL::Chip *_chip;
+	int _address;
+};
+
+/**
+ * Replays a register dump the way a music driver does: every timer tick
+ * sets up some instruments and starts and stops notes on all nine
+ * channels. The dump is generated from a fixed seed, so every run writes
+ * the same registers at the same ticks.
+ */
+class RegisterDumpPlayer {
+public:
+	RegisterDumpPlayer(OPL::OPL *opl, int writesPerTick) : _opl(opl), _writesPerTick(writesPerTick), _seed(0x0b1), _writes(0) {
+		static const byte initRegs[][2] = {
+			{ 0x01, 0x20 }, { 0xBD, 0x00 }, { 0x08, 0x00 }
+		};
+		for (uint i = 0; i < ARRAYSIZE(initRegs); ++i)
+			_opl->writeReg(initRegs[i][0], initRegs[i][1]);
+	}
+
+	void onTimer() {
+		for (int i = 0; i < _writesPerTick; ++i) {
+			const uint32 r = next();
+			const int channel = r % 9;
+			const int op = (channel / 3) * 8 + channel % 3;
+
+			switch ((r >> 8) & 7) {
+			case 0:
+				_opl->writeReg(0x20 + op, 0x01 + ((r >> 12) & 0x0F));
+				break;
+			case 1:
+				_opl->writeReg(0x40 + op, (r >> 12) & 0x3F);
+				break;
+			case 2:
+				_opl->writeReg(0x60 + op, 0xF0 | ((r >> 12) & 0x0F));
+				break;
+			case 3:
+				_opl->writeReg(0x80 + op, 0x70 | ((r >> 12) & 0x0F));
+				break;
+			case 4:
+				_opl->writeReg(0xC0 + channel, (r >> 12) & 0x0F);
+				break;
+			case 5:
+				_opl->writeReg(0xA0 + channel, (r >> 12) & 0xFF);
+				break;
+			default:
+				// Key on or off, with a new block and frequency
+				_opl->writeReg(0xB0 + channel, (r >> 12) & 0x3F);
+				break;
+			}
+
+			++_writes;
+		}
+	}
+
+	uint32 writes() const { return _writes; }
+
+private:
+	uint32 next() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	OPL::OPL *_opl;
+	const int _writesPerTick;
+	uint32 _seed;
+	uint32 _writes;
+};
+
+class OPLBenchmarkSuite : public CxxTest::TestSuite {
+	/** Render a minute of music and report output samples per second. */
+	void run(const char *name, bool batch, int writesPerTick, int bufferSize) {
+		BenchmarkOPL &opl = BenchmarkOPL::instance();
+		opl.reset();
+		RegisterDumpPlayer player(&opl, writesPerTick);
+
+		opl.setBatchRendering(batch);
+		opl.setCallback(new Common::Functor0Mem<void, RegisterDumpPlayer>(&player, &RegisterDumpPlayer::onTimer));
+		opl.setCallbackFrequency(::OPL::OPL::kDefaultCallbackFrequency);
+
+		int16 *buffer = new int16[bufferSize];
+		const int total = opl.getRate() * 60;
+
+		BenchmarkTimer timer;
+		for (int rendered = 0; rendered < total; rendered += bufferSize)
+			opl.readBuffer(buffer, bufferSize);
+		const double seconds = timer.elapsed();
+
+		delete[] buffer;
+		opl.setCallback(0);
+
+		char label[64];
+		snprintf(label, sizeof(label), "%s, %d writes/tick, %d samples", name, writesPerTick, bufferSize);
+		reportBenchmark(label, total, "samples", seconds);
+	}
+
+	/** Render music at a tick rate of 100 Hz in buffers of the given size. */
+	void render(int16 *buffer, int length, bool batch, int bufferSize) {
+		BenchmarkOPL &opl = BenchmarkOPL::instance();
+		opl.reset();
+		RegisterDumpPlayer player(&opl, 16);
+
+		opl.setBatchRendering(batch);
+		opl.setCallback(new Common::Functor0Mem<void, RegisterDumpPlayer>(&player, &RegisterDumpPlayer::onTimer));
+		opl.setCallbackFrequency(100);
+
+		for (int rendered = 0; rendered < length; rendered += bufferSize)
+			opl.readBuffer(buffer + rendered, MIN(bufferSize, length - rendered));
+
+		opl.setCallback(0);
+	}
+
+public:
+	void test_batched_matches_interleaved() {
+		// Both paths apply every write at the same sample, so the output
+		// has to be identical. The emulator keeps its position within the
+		// current tick across runs: render a whole number of ticks first,
+		// so that both runs start at the same position.
+		const int length = 44100 * 2;
+		int16 *expected = new int16[length];
+		int16 *actual = new int16[length];
+
+		render(expected, length, false, 1000);
+		render(expected, length, false, 1000);
+		render(actual, length, true, 1000);
+		TS_ASSERT_SAME_DATA(expected, actual, length * sizeof(int16));
+
+		delete[] expected;
+		delete[] actual;
+	}
+
+	void test_interleaved() {
+		run("OPL per tick", false, 16, 2048);
+		run("OPL per tick", false, 64, 2048);
+		run("OPL per tick", false, 16, 256);
+	}
+
+	void test_batched() {
+		run("OPL batched", true, 16, 2048);
+		run("OPL batched", true, 64, 2048);
+		run("OPL batched", true, 16, 256);
+	}
+};
+
+#endif
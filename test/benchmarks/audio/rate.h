@@ -0,0 +1,96 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#include "common/util.h"
+
+#include <math.h>
+
+/**
+ * An endless stream repeating one second of a 440 Hz tone, so that the
+ * benchmark measures the converter and not the decoder.
+ */
+class RateBenchmarkStream : public Audio::AudioStream {
+public:
+	RateBenchmarkStream(int rate, bool stereo) : _rate(rate), _stereo(stereo), _pos(0) {
+		_length = rate * (stereo ? 2 : 1);
+		_samples = new int16[_length];
+		for (int i = 0; i < _length; ++i)
+			_samples[i] = (int16)(sin(2 * M_PI * 440 * (i / (stereo ? 2 : 1)) / rate) * 16384);
+	}
+
+	~RateBenchmarkStream() {
+		delete[] _samples;
+	}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		for (int i = 0; i < numSamples; ++i) {
+			buffer[i] = _samples[_pos];
+			if (++_pos == _length)
+				_pos = 0;
+		}
+		return numSamples;
+	}
+
+	bool isStereo() const { return _stereo; }
+	int getRate() const { return _rate; }
+	bool endOfData() const { return false; }
+
+private:
+	const int _rate;
+	const bool _stereo;
+	int16 *_samples;
+	int _length;
+	int _pos;
+};
+
+class RateConverterBenchmarkSuite : public CxxTest::TestSuite {
+	/** Convert ten seconds of output and report output frames per second. */
+	void run(int inRate, int outRate, bool stereo, Audio::RateConverterQuality quality) {
+		const int frames = 1024;
+		int16 buffer[frames * 2];
+
+		RateBenchmarkStream stream(inRate, stereo);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo, false, quality);
+
+		BenchmarkTimer timer;
+		double total = 0;
+		for (int produced = 0; produced < outRate * 10; produced += frames) {
+			memset(buffer, 0, sizeof(buffer));
+			total += converter->flow(stream, buffer, frames, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+		}
+		const double seconds = timer.elapsed();
+
+		char name[64];
+		snprintf(name, sizeof(name), "%s %s %5d -> %5d Hz", quality == Audio::kRateConverterPolyphase ? "polyphase" : "linear   ",
+		         stereo ? "stereo" : "mono  ", inRate, outRate);
+		reportBenchmark(name, total, "frames", seconds);
+
+		delete converter;
+	}
+
+	void benchmark(Audio::RateConverterQuality quality) {
+		static const int inRates[] = { 8000, 11025, 16000, 22050, 32000, 44100, 48000 };
+		static const int outRates[] = { 22050, 44100, 48000 };
+
+		for (uint o = 0; o < ARRAYSIZE(outRates); ++o) {
+			for (uint i = 0; i < ARRAYSIZE(inRates); ++i) {
+				if (inRates[i] == outRates[o])
+					continue;
+				run(inRates[i], outRates[o], false, quality);
+				run(inRates[i], outRates[o], true, quality);
+			}
+		}
+	}
+
+public:
+	void test_linear() {
+		benchmark(Audio::kRateConverterLinear);
+	}
+
+	void test_polyphase() {
+		benchmark(Audio::kRateConverterPolyphase);
+	}
+};
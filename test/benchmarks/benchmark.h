@@ -0,0 +1,92 @@
+#ifndef TEST_BENCHMARKS_BENCHMARK_H
+#define TEST_BENCHMARKS_BENCHMARK_H
+
+// Benchmarks print their results and read the clock, so they may use the
+// C library directly.
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/scummsys.h"
+
+#include <stdio.h>
+#include <time.h>
+#ifdef POSIX
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Measures the processor time spent since its creation.
+ */
+class BenchmarkTimer {
+public:
+	BenchmarkTimer() : _start(clock()) {}
+
+	/** Seconds elapsed since the timer was created. */
+	double elapsed() const { return (double)(clock() - _start) / CLOCKS_PER_SEC; }
+
+private:
+	clock_t _start;
+};
+
+/**
+ * Measures the real time spent since its creation. Multithreaded code
+ * has to be timed with this, as processor time adds up over all threads.
+ */
+class BenchmarkWallTimer {
+public:
+	BenchmarkWallTimer() : _start(now()) {}
+
+	/** Seconds elapsed since the timer was created. */
+	double elapsed() const { return now() - _start; }
+
+private:
+	static double now() {
+#ifdef POSIX
+		timeval tv;
+		gettimeofday(&tv, nullptr);
+		return tv.tv_sec + tv.tv_usec / 1000000.0;
+#else
+		return (double)time(nullptr);
+#endif
+	}
+
+	double _start;
+};
+
+/**
+ * Print one line of benchmark results: the throughput of the named
+ * operation in units per second.
+ */
+static inline void reportBenchmark(const char *name, double units, const char *unitName, double seconds) {
+	printf("\n  %-56s %14.0f %s/s", name, seconds > 0 ? units / seconds : 0.0, unitName);
+	fflush(stdout);
+}
+
+/**
+ * Print one line of benchmark results which is not a rate, e.g. a size.
+ */
+static inline void reportBenchmarkValue(const char *name, double value, const char *unitName) {
+	printf("\n  %-56s %14.0f %s", name, value, unitName);
+	fflush(stdout);
+}
+
+/**
+ * The current resident set size of the process in kilobytes, or 0 where it
+ * is not known.
+ */
+static inline long residentKB() {
+#ifdef __linux__
+	long pages = 0;
+	FILE *statm = fopen("/proc/self/statm", "r");
+	if (statm) {
+		if (fscanf(statm, "%*s %ld", &pages) != 1)
+			pages = 0;
+		fclose(statm);
+	}
+	return pages * (sysconf(_SC_PAGESIZE) / 1024);
+#else
+	return 0;
+#endif
+}
+
+#endif
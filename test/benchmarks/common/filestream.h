@@ -0,0 +1,133 @@
+#include <cxxtest/TestSuite.h>
+
+#if defined(POSIX) && defined(HAS_MMAP)
+
+#include "backends/fs/posix/posix-iostream.h"
+#include "common/substream.h"
+
+#include "../../common/randomdata.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+class FileStreamBenchmarkSuite : public CxxTest::TestSuite {
+	enum {
+		kFileSize = 32 * 1024 * 1024
+	};
+
+	char _path[64];
+
+	/** Number of read system calls made so far, or -1 where unknown. */
+	static long readSyscalls() {
+		long count = -1;
+#ifdef __linux__
+		FILE *io = fopen("/proc/self/io", "r");
+		if (io) {
+			char line[64];
+			while (fgets(line, sizeof(line), io))
+				if (sscanf(line, "syscr: %ld", &count) == 1)
+					break;
+			fclose(io);
+		}
+#endif
+		return count;
+	}
+
+	/** Report the syscalls made per thousand operations since start. */
+	static void reportSyscalls(const char *name, long start, double operations) {
+		const long end = readSyscalls();
+		if (start >= 0 && end >= 0)
+			reportBenchmarkValue(name, (end - start) * 1000.0 / operations, "read syscalls per 1000 ops");
+	}
+
+	void runSequential(Common::SeekableReadStream *stream, const char *name) {
+		byte *buffer = new byte[65536];
+		const long syscalls = readSyscalls();
+		BenchmarkTimer timer;
+		stream->seek(0);
+		while (stream->read(buffer, 65536) == 65536)
+			;
+		reportBenchmark(name, kFileSize / 1048576.0, "MB", timer.elapsed());
+		reportSyscalls(name, syscalls, kFileSize / 65536);
+		delete[] buffer;
+	}
+
+	/** Small records at random offsets, as read from resource archives. */
+	void runRandom(Common::SeekableReadStream *stream, uint32 recordSize, const char *name) {
+		const int reads = 200000;
+		byte buffer[4096];
+		TestRandom random;
+		const long syscalls = readSyscalls();
+		BenchmarkTimer timer;
+		for (int i = 0; i < reads; ++i) {
+			stream->seek(random.nextBelow(kFileSize - recordSize));
+			stream->read(buffer, recordSize);
+		}
+		reportBenchmark(name, reads, "reads", timer.elapsed());
+		reportSyscalls(name, syscalls, reads);
+	}
+
+	/** Resources handed out as substreams and parsed field by field. */
+	void runSlices(Common::SeekableReadStream *stream, const char *name) {
+		const int slices = 20000;
+		TestRandom random;
+		uint32 sum = 0;
+		const long syscalls = readSyscalls();
+		BenchmarkTimer timer;
+		for (int i = 0; i < slices; ++i) {
+			const uint32 begin = random.nextBelow(kFileSize - 1024);
+			Common::SeekableSubReadStream slice(stream, begin, begin + 1024);
+			while (!slice.eos())
+				sum += slice.readUint32LE();
+		}
+		reportBenchmark(name, slices, "slices", timer.elapsed());
+		reportSyscalls(name, syscalls, slices);
+		TS_ASSERT(sum != 1);
+	}
+
+	void runAll(Common::SeekableReadStream *stream, const char *kind) {
+		char name[64];
+		snprintf(name, sizeof(name), "sequential 64KB reads, %s", kind);
+		runSequential(stream, name);
+		snprintf(name, sizeof(name), "random 16 byte records, %s", kind);
+		runRandom(stream, 16, name);
+		snprintf(name, sizeof(name), "random 4KB records, %s", kind);
+		runRandom(stream, 4096, name);
+		snprintf(name, sizeof(name), "1KB substreams read as uint32s, %s", kind);
+		runSlices(stream, name);
+	}
+
+public:
+	void setUp() {
+		strcpy(_path, "/tmp/scummvm-benchmark-XXXXXX");
+		const int fd = mkstemp(_path);
+		TS_ASSERT(fd != -1);
+
+		byte *data = new byte[kFileSize];
+		for (uint32 i = 0; i < kFileSize; ++i)
+			data[i] = i * 7 + (i >> 11);
+		TS_ASSERT_EQUALS(write(fd, data, kFileSize), kFileSize);
+		close(fd);
+		delete[] data;
+	}
+
+	void tearDown() {
+		unlink(_path);
+	}
+
+	void test_stdio_stream() {
+		Common::SeekableReadStream *stream = PosixIoStream::makeFromPath(_path, false);
+		TS_ASSERT(stream);
+		runAll(stream, "stdio");
+		delete stream;
+	}
+
+	void test_mapped_stream() {
+		Common::SeekableReadStream *stream = PosixMappedReadStream::makeFromPath(_path);
+		TS_ASSERT(stream);
+		runAll(stream, "mapped");
+		delete stream;
+	}
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/jobqueue.h"
+
+#ifdef POSIX
+#include "backends/threads/pthread/pthread-threads.h"
+#endif
+
+class JobQueueBenchmarkSuite : public CxxTest::TestSuite {
+	/** A CPU bound kernel: a few rounds of an integer hash per element. */
+	static void hashRange(uint begin, uint end, void *param) {
+		uint32 *data = (uint32 *)param;
+		for (uint i = begin; i < end; ++i) {
+			uint32 x = data[i];
+			for (int r = 0; r < 64; ++r)
+				x = (x ^ (x >> 15)) * 0x2c1b3c6d + r;
+			data[i] = x;
+		}
+	}
+
+	static void emptyJob(void *) {}
+
+	/** Hash a large array in parallel, reporting elements per second. */
+	void runScaling(Common::ThreadManager *threads, uint workers, uint grain) {
+		const uint count = 1 << 20;
+		uint32 *data = new uint32[count];
+		for (uint i = 0; i < count; ++i)
+			data[i] = i;
+
+		Common::JobQueue queue(workers, threads);
+		BenchmarkWallTimer timer;
+		for (int pass = 0; pass < 4; ++pass)
+			queue.parallelFor(0, count, grain, hashRange, data);
+		const double seconds = timer.elapsed();
+
+		char name[64];
+		snprintf(name, sizeof(name), "parallelFor hash, %u threads, grain %u", queue.getConcurrency(), grain);
+		reportBenchmark(name, 4.0 * count, "elements", seconds);
+
+		delete[] data;
+	}
+
+	/** Push and wait for empty jobs, measuring the queue overhead. */
+	void runOverhead(Common::ThreadManager *threads, uint workers) {
+		const uint jobs = 200000;
+		Common::JobQueue queue(workers, threads);
+
+		BenchmarkWallTimer timer;
+		Common::JobQueue::JobGroup group;
+		for (uint i = 0; i < jobs; ++i)
+			queue.push(emptyJob, nullptr, &group);
+		queue.wait(group);
+		const double seconds = timer.elapsed();
+
+		char name[64];
+		snprintf(name, sizeof(name), "push/wait empty jobs, %u threads", queue.getConcurrency());
+		reportBenchmark(name, jobs, "jobs", seconds);
+	}
+
+public:
+	void test_synchronous() {
+		runScaling(nullptr, 0, 0);
+		runOverhead(nullptr, 0);
+	}
+
+#ifdef POSIX
+	void test_scaling() {
+		PthreadThreadManager threads;
+		const uint cpus = threads.getCPUCount();
+
+		for (uint workers = 1; workers < 2 * cpus && workers < 32; workers *= 2) {
+			runScaling(&threads, workers, 0);
+			runScaling(&threads, workers, 256);
+		}
+		runOverhead(&threads, 1);
+		runOverhead(&threads, cpus > 1 ? cpus - 1 : 1);
+	}
+#endif
+};
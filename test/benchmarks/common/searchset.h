@@ -0,0 +1,73 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/unzip.h"
+
+#include "../../common/ziphelper.h"
+
+class SearchSetBenchmarkSuite : public CxxTest::TestSuite {
+	enum {
+		kArchives = 32,
+		kMembersPerArchive = 200,
+		kLookups = 200000
+	};
+
+	Common::SearchSet *_set;
+	Common::Archive *_archives[kArchives];
+
+	static Common::String memberName(uint32 n) {
+		return Common::String::format("room%03u/sprite%04u.bmp", n % 100, n);
+	}
+
+	// Names of which roughly half exist, spread over all archives
+	static Common::String probeName(uint32 &seed) {
+		seed = seed * 1103515245 + 12345;
+		return memberName((seed >> 8) % (2 * kArchives * kMembersPerArchive));
+	}
+
+public:
+	void setUp() {
+		_set = new Common::SearchSet();
+		const byte data = 0;
+		for (uint32 a = 0; a < kArchives; ++a) {
+			ZipBuilder builder;
+			for (uint32 m = 0; m < kMembersPerArchive; ++m)
+				builder.addMember(memberName(a * kMembersPerArchive + m).c_str(), &data, 1, false);
+			_archives[a] = Common::makeZipArchive(builder.createStream());
+			_set->add(Common::String::format("archive%u", a), _archives[a], 0);
+		}
+	}
+
+	void tearDown() {
+		delete _set;
+	}
+
+	void test_hasfile() {
+		// Every archive asked in turn, as SearchSet used to do
+		uint32 seed = 0x5eed;
+		uint found = 0;
+		BenchmarkTimer linearTimer;
+		for (int i = 0; i < kLookups; ++i) {
+			const Common::String name = probeName(seed);
+			for (uint32 a = 0; a < kArchives; ++a) {
+				if (_archives[a]->hasFile(name)) {
+					++found;
+					break;
+				}
+			}
+		}
+		reportBenchmark("hasFile, 32 archives asked in turn", kLookups, "lookups", linearTimer.elapsed());
+
+		seed = 0x5eed;
+		uint indexedFound = 0;
+		BenchmarkTimer indexTimer;
+		for (int i = 0; i < kLookups; ++i) {
+			if (_set->hasFile(probeName(seed)))
+				++indexedFound;
+		}
+		reportBenchmark("hasFile, SearchSet name index", kLookups, "lookups", indexTimer.elapsed());
+
+		TS_ASSERT_EQUALS(found, indexedFound);
+		TS_ASSERT_EQUALS(_set->getIndexStats().rebuilds, 1U);
+	}
+};
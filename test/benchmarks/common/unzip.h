@@ -0,0 +1,104 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/unzip.h"
+
+#include "../../common/randomdata.h"
+#include "../../common/ziphelper.h"
+
+class UnzipBenchmarkSuite : public CxxTest::TestSuite {
+	enum {
+		kMemberSize = 16 * 1024 * 1024
+	};
+
+	Common::Archive *_archive;
+	byte *_data;
+
+	/** Open a member many times, reading only its first byte. */
+	void runFirstByte(const char *member, const char *name) {
+		const int opens = 200;
+		BenchmarkTimer timer;
+		for (int i = 0; i < opens; ++i) {
+			Common::SeekableReadStream *stream = _archive->createReadStreamForMember(member);
+			TS_ASSERT(stream);
+			stream->readByte();
+			delete stream;
+		}
+		reportBenchmark(name, opens, "opens", timer.elapsed());
+	}
+
+	void runReads(const char *member, const char *sequentialName, const char *randomName) {
+		Common::SeekableReadStream *stream = _archive->createReadStreamForMember(member);
+		TS_ASSERT(stream);
+		byte *buffer = new byte[65536];
+
+		BenchmarkTimer timer;
+		while (stream->read(buffer, 65536) == 65536)
+			;
+		reportBenchmark(sequentialName, kMemberSize / 1048576.0, "MB", timer.elapsed());
+
+		const int reads = 200;
+		TestRandom random;
+		BenchmarkTimer randomTimer;
+		for (int i = 0; i < reads; ++i) {
+			stream->seek(random.nextBelow(kMemberSize - 4096));
+			stream->read(buffer, 4096);
+		}
+		reportBenchmark(randomName, reads, "reads", randomTimer.elapsed());
+
+		delete[] buffer;
+		delete stream;
+	}
+
+public:
+	void setUp() {
+		TestRandom random;
+		_data = random.createData(kMemberSize);
+
+		ZipBuilder builder;
+		builder.addMember("stored.bin", _data, kMemberSize, false);
+		builder.addMember("deflated.bin", _data, kMemberSize, true);
+		_archive = Common::makeZipArchive(builder.createStream());
+	}
+
+	void tearDown() {
+		delete _archive;
+		delete[] _data;
+	}
+
+	void test_first_byte() {
+		runFirstByte("stored.bin", "open + first byte, 16MB stored member");
+		if (_archive->hasFile("deflated.bin"))
+			runFirstByte("deflated.bin", "open + first byte, 16MB deflated member");
+	}
+
+	void test_reads() {
+		runReads("stored.bin", "sequential read, stored member", "random 4KB reads, stored member");
+		if (_archive->hasFile("deflated.bin"))
+			runReads("deflated.bin", "sequential read, deflated member", "random 4KB reads, deflated member");
+	}
+
+	void test_peak_memory() {
+		if (!_archive->hasFile("deflated.bin") || !residentKB())
+			return;
+
+		// Streaming through a small buffer, as ZipArchive does now
+		byte *buffer = new byte[65536];
+		long before = residentKB(), peak = before;
+		Common::SeekableReadStream *stream = _archive->createReadStreamForMember("deflated.bin");
+		while (stream->read(buffer, 65536) == 65536)
+			peak = MAX(peak, residentKB());
+		delete stream;
+		delete[] buffer;
+		reportBenchmarkValue("peak RSS growth, streaming a 16MB deflated member", peak - before, "KB");
+
+		// Inflating the whole member up front, as it used to
+		before = residentKB();
+		stream = _archive->createReadStreamForMember("deflated.bin");
+		byte *whole = (byte *)malloc(kMemberSize);
+		stream->read(whole, kMemberSize);
+		reportBenchmarkValue("peak RSS growth, inflating it into memory", residentKB() - before, "KB");
+		free(whole);
+		delete stream;
+	}
+};
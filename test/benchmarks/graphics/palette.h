@@ -0,0 +1,136 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/colormasks.h"
+#include "graphics/palette_usage.h"
+#include "graphics/pixelformat.h"
+#include "graphics/scaler.h"
+
+/**
+ * Simulates a palette cycling effect on a 320x200 CLUT8 screen and times
+ * the graphics update the SDL backend performs for every frame: either a
+ * full palette conversion and rescale, or a rescale of only those parts
+ * of the screen which show the cycled palette entries.
+ */
+class PaletteCycleBenchmarkSuite : public CxxTest::TestSuite {
+	enum {
+		kWidth = 320,
+		kHeight = 200,
+		kFrames = 200,
+		kCycleStart = 240,
+		kCycleCount = 8
+	};
+
+	byte *_screen;
+	uint16 *_tmp;
+	byte *_scaled;
+	uint16 _lut[256];
+
+	/**
+	 * Convert a rect of the screen through the palette into the temporary
+	 * surface, which has a one pixel border like the backend's, and scale it.
+	 */
+	void updateRect(const Common::Rect &r, ScalerProc *scaler, int scale) {
+		const int tmpPitch = kWidth + 4;
+		for (int y = r.top; y < r.bottom; ++y) {
+			const byte *src = _screen + y * kWidth;
+			uint16 *dst = _tmp + (y + 1) * tmpPitch + 1;
+			for (int x = r.left; x < r.right; ++x)
+				dst[x] = _lut[src[x]];
+		}
+
+		scaler((const uint8 *)(_tmp + (r.top + 1) * tmpPitch + r.left + 1), tmpPitch * 2,
+		       _scaled + (r.top * scale * kWidth * scale + r.left * scale) * 2, kWidth * scale * 2,
+		       r.width(), r.height());
+	}
+
+	void cyclePalette(const Graphics::PixelFormat &format, int frame) {
+		for (int i = 0; i < kCycleCount; ++i) {
+			const int shade = 128 + 16 * ((i + frame) % kCycleCount);
+			_lut[kCycleStart + i] = format.RGBToColor(0, shade / 2, shade);
+		}
+	}
+
+	void run(const char *name, ScalerProc *scaler, int scale) {
+		const Graphics::PixelFormat format = Graphics::createPixelFormat<565>();
+		_scaled = new byte[kWidth * scale * kHeight * scale * 2];
+
+		for (int i = 0; i < 256; ++i)
+			_lut[i] = format.RGBToColor(i, 255 - i, (i * 7) & 0xFF);
+
+		bool changed[256];
+		memset(changed, 0, sizeof(changed));
+		for (int i = 0; i < kCycleCount; ++i)
+			changed[kCycleStart + i] = true;
+
+		char label[64];
+		{
+			BenchmarkTimer timer;
+			for (int frame = 0; frame < kFrames; ++frame) {
+				cyclePalette(format, frame);
+				updateRect(Common::Rect(kWidth, kHeight), scaler, scale);
+			}
+			snprintf(label, sizeof(label), "%s full redraw", name);
+			reportBenchmark(label, kFrames, "frames", timer.elapsed());
+		}
+
+		{
+			Common::Array<Common::Rect> rects;
+			BenchmarkTimer timer;
+			for (int frame = 0; frame < kFrames; ++frame) {
+				cyclePalette(format, frame);
+				Graphics::findPaletteUsage(_screen, kWidth, kWidth, kHeight, changed, 8, rects);
+				for (uint i = 0; i < rects.size(); ++i) {
+					// Grow by a pixel for smearing scalers, like addDirtyRect
+					Common::Rect r(rects[i].left - 1, rects[i].top - 1, rects[i].right + 1, rects[i].bottom + 1);
+					r.clip(Common::Rect(kWidth, kHeight));
+					updateRect(r, scaler, scale);
+				}
+			}
+			snprintf(label, sizeof(label), "%s palette-only update", name);
+			reportBenchmark(label, kFrames, "frames", timer.elapsed());
+		}
+
+		delete[] _scaled;
+	}
+
+public:
+	void setUp() {
+		_screen = new byte[kWidth * kHeight];
+		_tmp = new uint16[(kWidth + 4) * (kHeight + 4)];
+		memset(_tmp, 0, (kWidth + 4) * (kHeight + 4) * sizeof(uint16));
+
+		// A busy background with a waterfall using the cycled entries
+		for (int y = 0; y < kHeight; ++y) {
+			for (int x = 0; x < kWidth; ++x) {
+				if (x >= 140 && x < 172 && y >= 40 && y < 160)
+					_screen[y * kWidth + x] = kCycleStart + (x + y) % kCycleCount;
+				else
+					_screen[y * kWidth + x] = (x * 3 + y * 5) % kCycleStart;
+			}
+		}
+
+		InitScalers(565);
+	}
+
+	void tearDown() {
+		DestroyScalers();
+		delete[] _screen;
+		delete[] _tmp;
+	}
+
+	void test_normal1x() {
+		run("Normal1x", Normal1x, 1);
+	}
+
+#ifdef USE_SCALERS
+	void test_advmame3x() {
+		run("AdvMame3x", AdvMame3x, 3);
+	}
+#endif
+
+#ifdef USE_HQ_SCALERS
+	void test_hq3x() {
+		run("HQ3x", HQ3x, 3);
+	}
+#endif
+};
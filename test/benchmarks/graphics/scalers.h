@@ -0,0 +1,90 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/jobqueue.h"
+#include "graphics/scaler.h"
+
+#ifdef POSIX
+#include "backends/threads/pthread/pthread-threads.h"
+#endif
+
+/**
+ * Scales a 640x360 screen, i.e. to 1920x1080 with the 3x scalers, serially
+ * and in bands on an increasing number of threads.
+ */
+class ScalerBenchmarkSuite : public CxxTest::TestSuite {
+	enum {
+		kWidth = 640,
+		kHeight = 360,
+		kSrcPitch = (kWidth + 4) * 2,
+		kFrames = 20
+	};
+
+	uint16 *_src;
+	uint8 *_dst;
+
+	const uint8 *source() const {
+		return (const uint8 *)(_src + 2 * (kWidth + 4) + 2);
+	}
+
+	void run(const char *name, ScalerProc *scaler, int scale) {
+		const uint32 dstPitch = kWidth * scale * 2;
+		char label[64];
+
+		BenchmarkWallTimer timer;
+		for (int frame = 0; frame < kFrames; ++frame)
+			scaler(source(), kSrcPitch, _dst, dstPitch, kWidth, kHeight);
+		snprintf(label, sizeof(label), "%s serial", name);
+		reportBenchmark(label, (double)kFrames * kWidth * kHeight, "pixels", timer.elapsed());
+
+#ifdef POSIX
+		PthreadThreadManager threads;
+		const uint cpus = threads.getCPUCount();
+
+		for (uint workers = 1; workers < cpus * 2 && workers < 32; workers *= 2) {
+			Common::JobQueue jobs(workers, &threads);
+			BenchmarkWallTimer bandTimer;
+			for (int frame = 0; frame < kFrames; ++frame)
+				ScaleInBands(jobs, scaler, scale, source(), kSrcPitch, _dst, dstPitch, kWidth, kHeight);
+			snprintf(label, sizeof(label), "%s in bands, %u threads", name, jobs.getConcurrency());
+			reportBenchmark(label, (double)kFrames * kWidth * kHeight, "pixels", bandTimer.elapsed());
+		}
+#endif
+	}
+
+public:
+	void setUp() {
+		_src = new uint16[(kWidth + 4) * (kHeight + 4)];
+		for (int y = 0; y < kHeight + 4; ++y)
+			for (int x = 0; x < kWidth + 4; ++x)
+				_src[y * (kWidth + 4) + x] = (uint16)(((x / 5) * 0x0841) ^ ((y / 3) * 0x1003));
+		_dst = new uint8[kWidth * 3 * kHeight * 3 * 2];
+
+		InitScalers(565);
+	}
+
+	void tearDown() {
+		DestroyScalers();
+		delete[] _src;
+		delete[] _dst;
+	}
+
+#ifdef USE_SCALERS
+	void test_advmame() {
+		run("AdvMame2x", AdvMame2x, 2);
+		run("AdvMame3x", AdvMame3x, 3);
+	}
+
+	void test_sai() {
+		run("2xSaI", _2xSaI, 2);
+		run("Super2xSaI", Super2xSaI, 2);
+		run("SuperEagle", SuperEagle, 2);
+	}
+
+#ifdef USE_HQ_SCALERS
+	void test_hq() {
+		run("HQ2x", HQ2x, 2);
+		run("HQ3x", HQ3x, 3);
+	}
+#endif
+#endif
+};
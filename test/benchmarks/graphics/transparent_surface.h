@@ -0,0 +1,101 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/blendkernels.h"
+#include "graphics/transparent_surface.h"
+
+/**
+ * Blits semi-transparent sprites of several sizes onto a 640x480 screen,
+ * the way Wintermute and Sword25 draw their scenes, with each blend mode.
+ * The normal blend mode is also run straight through each set of blend
+ * kernels, to compare them.
+ */
+class TransparentSurfaceBenchmarkSuite : public CxxTest::TestSuite {
+	enum {
+		kScreenWidth = 640,
+		kScreenHeight = 480,
+		kPixelsPerSize = 8 * 1024 * 1024
+	};
+
+	Graphics::Surface _screen;
+
+	void fillSprite(Graphics::TransparentSurface &sprite) {
+		// A soft edged disc: transparent corners, opaque center and a
+		// blended rim, like anti-aliased sprites
+		const int r = sprite.w / 2;
+		for (int y = 0; y < sprite.h; ++y) {
+			for (int x = 0; x < sprite.w; ++x) {
+				const int d = (x - r) * (x - r) + (y - r) * (y - r);
+				const int alpha = CLIP(255 - (d - r * r * 3 / 4) * 1024 / (r * r + 1), 0, 255);
+				*(uint32 *)sprite.getBasePtr(x, y) = TS_ARGB(alpha, x * 255 / sprite.w, y * 255 / sprite.h, 128);
+			}
+		}
+	}
+
+	void run(int size) {
+		static const struct {
+			const char *name;
+			uint32 color;
+			Graphics::TSpriteBlendMode blendMode;
+		} modes[] = {
+			{ "normal", TS_ARGB(255, 255, 255, 255), Graphics::BLEND_NORMAL },
+			{ "normal, tinted", TS_ARGB(192, 255, 128, 64), Graphics::BLEND_NORMAL },
+			{ "additive", TS_ARGB(255, 255, 255, 255), Graphics::BLEND_ADDITIVE },
+			{ "subtractive", TS_ARGB(255, 255, 255, 255), Graphics::BLEND_SUBTRACTIVE },
+			{ "multiply", TS_ARGB(255, 255, 255, 255), Graphics::BLEND_MULTIPLY }
+		};
+		const int blits = kPixelsPerSize / (size * size);
+		char label[64];
+
+		Graphics::TransparentSurface sprite;
+		sprite.create(size, size, Graphics::TransparentSurface::getSupportedPixelFormat());
+		fillSprite(sprite);
+
+		for (uint m = 0; m < ARRAYSIZE(modes); ++m) {
+			BenchmarkTimer timer;
+			for (int i = 0; i < blits; ++i)
+				sprite.blit(_screen, (i * 37) % (kScreenWidth - size), (i * 23) % (kScreenHeight - size), Graphics::FLIP_NONE, nullptr, modes[m].color, -1, -1, modes[m].blendMode);
+			snprintf(label, sizeof(label), "%dx%d blit, %s", size, size, modes[m].name);
+			reportBenchmark(label, blits, "blits", timer.elapsed());
+		}
+
+		for (int type = Graphics::kBlendKernelScalar; type < Graphics::kBlendKernelCount; ++type) {
+			const Graphics::BlendKernels *kernels = Graphics::getBlendKernels((Graphics::BlendKernelType)type);
+			if (!kernels)
+				continue;
+
+			BenchmarkTimer timer;
+			for (int i = 0; i < blits; ++i) {
+				byte *dst = (byte *)_screen.getBasePtr((i * 37) % (kScreenWidth - size), (i * 23) % (kScreenHeight - size));
+				kernels->alphaBlend((byte *)sprite.getPixels(), dst, size, size, _screen.pitch, 4, sprite.pitch, 0xFFFFFFFF);
+			}
+			snprintf(label, sizeof(label), "%dx%d normal, %s kernels", size, size, kernels->name);
+			reportBenchmark(label, blits, "blits", timer.elapsed());
+		}
+
+		sprite.free();
+	}
+
+public:
+	void setUp() {
+		_screen.create(kScreenWidth, kScreenHeight, Graphics::TransparentSurface::getSupportedPixelFormat());
+		for (int y = 0; y < kScreenHeight; ++y)
+			for (int x = 0; x < kScreenWidth; ++x)
+				*(uint32 *)_screen.getBasePtr(x, y) = TS_ARGB(255, x & 0xFF, y & 0xFF, (x ^ y) & 0xFF);
+	}
+
+	void tearDown() {
+		_screen.free();
+	}
+
+	void test_small_sprites() {
+		run(32);
+	}
+
+	void test_medium_sprites() {
+		run(128);
+	}
+
+	void test_large_sprites() {
+		run(320);
+	}
+};
@@ -0,0 +1,77 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/pixelformat.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+/**
+ * Converts synthetic 640x480 and 1280x720 YUV420 frames, as decoded by
+ * Theora, Bink or MPEG videos, with the lookup tables and with the vector
+ * code, to RGB565 and XRGB8888.
+ */
+class YUVToRGBBenchmarkSuite : public CxxTest::TestSuite {
+	enum {
+		kFrames = 30
+	};
+
+	void run(int width, int height, bool vectorized) {
+		const int uvWidth = width / 2;
+		const int uvHeight = height / 2;
+		byte *y = new byte[width * height];
+		byte *u = new byte[uvWidth * uvHeight];
+		byte *v = new byte[uvWidth * uvHeight];
+
+		// Smooth gradients with some noise, roughly like video content
+		uint32 seed = 1;
+		for (int i = 0; i < width * height; ++i) {
+			seed = seed * 1103515245 + 12345;
+			y[i] = (byte)((i % width) * 255 / width + ((seed >> 16) & 15));
+		}
+		for (int i = 0; i < uvWidth * uvHeight; ++i) {
+			u[i] = (byte)(64 + (i % uvWidth) * 128 / uvWidth);
+			v[i] = (byte)(192 - (i / uvWidth) * 128 / uvHeight);
+		}
+
+		static const struct {
+			const char *name;
+			Graphics::PixelFormat format;
+		} formats[] = {
+			{ "RGB565", Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0) },
+			{ "XRGB8888", Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0) }
+		};
+
+		YUVToRGBMan.setVectorized(vectorized);
+
+		for (uint f = 0; f < ARRAYSIZE(formats); ++f) {
+			Graphics::Surface dst;
+			dst.create(width, height, formats[f].format);
+
+			BenchmarkTimer timer;
+			for (int frame = 0; frame < kFrames; ++frame)
+				YUVToRGBMan.convert420(&dst, Graphics::YUVToRGBManager::kScaleITU, y, u, v, width, height, width, uvWidth);
+
+			char label[64];
+			snprintf(label, sizeof(label), "%dx%d to %s, %s", width, height, formats[f].name, vectorized ? "vector" : "lookup");
+			reportBenchmark(label, kFrames, "frames", timer.elapsed());
+
+			dst.free();
+		}
+
+		YUVToRGBMan.setVectorized(true);
+
+		delete[] y;
+		delete[] u;
+		delete[] v;
+	}
+
+public:
+	void test_yuv420_640x480() {
+		run(640, 480, false);
+		run(640, 480, true);
+	}
+
+	void test_yuv420_1280x720() {
+		run(1280, 720, false);
+		run(1280, 720, true);
+	}
+};
@@ -0,0 +1,55 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/dircache.h"
+#include "common/memstream.h"
+
+class DirectoryCacheTestSuite : public CxxTest::TestSuite {
+	static Common::String save(Common::DirectoryCache &cache) {
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+		cache.saveTo(out);
+		return Common::String((const char *)out.getData(), out.size());
+	}
+
+	static bool load(Common::DirectoryCache &cache, const char *data) {
+		Common::MemoryReadStream in((const byte *)data, strlen(data));
+		return cache.loadFrom(in);
+	}
+
+public:
+	void test_round_trip() {
+		// A single listing, so that the order of the output is known
+		const char *data =
+			"ScummVM directory cache 1\n"
+			"4096\t1600000000\t3\t/games/monkey\n"
+			"dMusic\n"
+			"fMONKEY.000\n"
+			"fname with\ttab and spaces\n";
+
+		Common::DirectoryCache cache;
+		TS_ASSERT(load(cache, data));
+		TS_ASSERT_EQUALS(save(cache), Common::String(data));
+	}
+
+	void test_unknown_format() {
+		Common::DirectoryCache cache;
+		TS_ASSERT(!load(cache, "ScummVM directory cache 0\n"));
+		TS_ASSERT(!load(cache, ""));
+		TS_ASSERT_EQUALS(save(cache), Common::String("ScummVM directory cache 1\n"));
+	}
+
+	void test_truncated_listing() {
+		const char *data =
+			"ScummVM directory cache 1\n"
+			"4096\t1600000000\t1\t/games/monkey\n"
+			"fMONKEY.000\n"
+			"4096\t1600000001\t3\t/games/indy\n"
+			"fINDY.000\n";
+
+		Common::DirectoryCache cache;
+		TS_ASSERT(load(cache, data));
+		TS_ASSERT_EQUALS(save(cache), Common::String(
+			"ScummVM directory cache 1\n"
+			"4096\t1600000000\t1\t/games/monkey\n"
+			"fMONKEY.000\n"));
+	}
+};
@@ -0,0 +1,324 @@
+#include <cxxtest/TestSuite.h>
+
+#ifdef POSIX
+
+#include "backends/fs/posix/posix-fs.h"
+#include "backends/fs/posix/posix-iostream.h"
+#include "backends/threads/pthread/pthread-threads.h"
+#include "common/algorithm.h"
+#include "common/fs.h"
+#include "common/stream.h"
+
+#include <stdlib.h>
+
+/**
+ * FSDirectory on a small tree in a temporary directory. There is no g_system
+ * in the tests, so nodes are made through the POSIX backend directly.
+ */
+class FSDirectoryTestSuite : public CxxTest::TestSuite {
+	char _path[64];
+	Common::FSNode _root;
+
+	Common::FSNode nodeFor(const char *relative) {
+		Common::FSNode node = _root;
+		Common::String path(relative);
+		for (const char *start = path.c_str(); *start; ) {
+			const char *end = strchr(start, '/');
+			if (!end)
+				end = start + strlen(start);
+			node = node.getChild(Common::String(start, end));
+			start = *end ? end + 1 : end;
+		}
+		return node;
+	}
+
+	void createDir(const char *relative) {
+		TS_ASSERT(nodeFor(relative).createDirectory());
+	}
+
+	void createFile(const char *relative) {
+		Common::WriteStream *stream = nodeFor(relative).createWriteStream();
+		TS_ASSERT(stream);
+		if (stream) {
+			stream->writeByte(relative[0]);
+			delete stream;
+		}
+	}
+
+	static void removeTree(const Common::FSNode &node) {
+		Common::FSList children;
+		if (node.isDirectory() && node.getChildren(children, Common::FSNode::kListAll)) {
+			for (Common::FSList::const_iterator i = children.begin(); i != children.end(); ++i)
+				removeTree(*i);
+		}
+		remove(node.getPath().c_str());
+	}
+
+	// The keys the recursive scan used before directories were listed lazily
+	static void fullScan(const Common::FSNode &node, int depth, bool flat, const Common::String &prefix, Common::StringArray &names) {
+		if (depth <= 0)
+			return;
+
+		Common::FSList children;
+		node.getChildren(children, Common::FSNode::kListAll);
+		for (Common::FSList::const_iterator i = children.begin(); i != children.end(); ++i) {
+			Common::String name = prefix + i->getName();
+			name.toLowercase();
+			if (i->isDirectory())
+				fullScan(*i, depth - 1, flat, flat ? prefix : name + "/", names);
+			else
+				names.push_back(name);
+		}
+	}
+
+	Common::StringArray expectedNames(int depth, bool flat, const char *prefix = "") {
+		Common::StringArray names;
+		Common::String start(prefix);
+		if (!start.empty())
+			start += "/";
+		fullScan(_root, depth, flat, start, names);
+		Common::sort(names.begin(), names.end());
+		return names;
+	}
+
+	static Common::StringArray indexedNames(const Common::FSDirectory &dir) {
+		Common::StringArray names;
+		TS_ASSERT_EQUALS(dir.listIndexableNames(names), Common::Archive::kIndexableNamesListed);
+		Common::sort(names.begin(), names.end());
+		return names;
+	}
+
+	static void checkNames(const Common::StringArray &names, const Common::StringArray &expected) {
+		TS_ASSERT_EQUALS(names.size(), expected.size());
+		for (uint i = 0; i < names.size() && i < expected.size(); ++i)
+			TS_ASSERT_EQUALS(names[i], expected[i]);
+	}
+
+	// Lookups which must give the same answers however the tree is listed
+	static void checkLookups(const Common::FSDirectory &dir, int depth, bool flat) {
+		TS_ASSERT(dir.hasFile("a.txt"));
+		TS_ASSERT(dir.hasFile("B.dat"));
+		TS_ASSERT(!dir.hasFile("missing.txt"));
+		TS_ASSERT(!dir.hasFile("nodir/missing.txt"));
+		if (flat) {
+			TS_ASSERT_EQUALS(dir.hasFile("d.txt"), depth >= 3);
+			TS_ASSERT_EQUALS(dir.hasFile("F.TXT"), depth >= 5);
+			TS_ASSERT(!dir.hasFile("sub1/c.txt"));
+		} else {
+			TS_ASSERT_EQUALS(dir.hasFile("sub1/c.txt"), depth >= 2);
+			TS_ASSERT_EQUALS(dir.hasFile("SUB2/g.txt"), depth >= 2);
+			TS_ASSERT_EQUALS(dir.hasFile("sub1/deep/d.txt"), depth >= 3);
+			TS_ASSERT_EQUALS(dir.hasFile("sub1/Deep/deeper/deepest/f.txt"), depth >= 5);
+			TS_ASSERT(!dir.hasFile("sub3/missing.txt"));
+			TS_ASSERT(!dir.hasFile("c.txt"));
+		}
+	}
+
+public:
+	void setUp() {
+		strcpy(_path, "/tmp/scummvm-fsdirectory-XXXXXX");
+		TS_ASSERT(mkdtemp(_path));
+		_root = AbstractFSNode::makeFSNode(new POSIXFilesystemNode(_path));
+
+		createFile("a.txt");
+		createFile("B.DAT");
+		createDir("sub1");
+		createFile("sub1/c.txt");
+		createDir("sub1/deep");
+		createFile("sub1/deep/d.txt");
+		createDir("sub1/deep/deeper");
+		createFile("sub1/deep/deeper/e.txt");
+		createDir("sub1/deep/deeper/deepest");
+		createFile("sub1/deep/deeper/deepest/f.txt");
+		createDir("Sub2");
+		createFile("Sub2/g.txt");
+		createFile("Sub2/h.txt");
+		createDir("sub3");
+	}
+
+	void tearDown() {
+		removeTree(_root);
+		_root = Common::FSNode();
+	}
+
+	void test_lookups() {
+		for (int depth = 1; depth <= 6; ++depth) {
+			for (int flat = 0; flat < 2; ++flat) {
+				Common::FSDirectory dir(_root, depth, flat);
+				checkLookups(dir, depth, flat);
+				checkNames(indexedNames(dir), expectedNames(depth, flat));
+			}
+		}
+	}
+
+	void test_names_without_lookups() {
+		for (int depth = 0; depth <= 6; ++depth) {
+			for (int flat = 0; flat < 2; ++flat) {
+				Common::FSDirectory dir(_root, depth, flat);
+				checkNames(indexedNames(dir), expectedNames(depth, flat));
+
+				Common::ArchiveMemberList members;
+				TS_ASSERT_EQUALS(dir.listMembers(members), (int)expectedNames(depth, flat).size());
+			}
+		}
+	}
+
+	void test_lazy_listing() {
+		Common::FSDirectory dir(_root, 4);
+		TS_ASSERT(dir.hasFile("sub1/c.txt"));
+
+		// Directories are only listed when a lookup needs them
+		createFile("Sub2/late.txt");
+		createFile("sub1/deep/late.txt");
+		TS_ASSERT(dir.hasFile("sub2/late.txt"));
+		TS_ASSERT(dir.hasFile("sub1/deep/late.txt"));
+
+		// and only once
+		createFile("Sub2/later.txt");
+		createFile("sub1/later.txt");
+		TS_ASSERT(!dir.hasFile("sub2/later.txt"));
+		TS_ASSERT(!dir.hasFile("sub1/later.txt"));
+
+		// Listing the rest of the tree keeps what was listed so far
+		Common::StringArray names = indexedNames(dir);
+		TS_ASSERT(Common::find(names.begin(), names.end(), "sub2/late.txt") != names.end());
+		TS_ASSERT(Common::find(names.begin(), names.end(), "sub2/later.txt") == names.end());
+		TS_ASSERT(Common::find(names.begin(), names.end(), "sub1/deep/deeper/e.txt") != names.end());
+	}
+
+	void test_prefix() {
+		Common::FSDirectory dir("Pre", _root, 3);
+		TS_ASSERT(dir.hasFile("pre/a.txt"));
+		TS_ASSERT(dir.hasFile("PRE/sub1/deep/d.txt"));
+		TS_ASSERT(!dir.hasFile("a.txt"));
+		TS_ASSERT(!dir.hasFile("sub1/c.txt"));
+		checkNames(indexedNames(dir), expectedNames(3, false, "Pre"));
+
+		Common::FSDirectory flat("Pre", _root, 3, true);
+		TS_ASSERT(flat.hasFile("pre/d.txt"));
+		TS_ASSERT(!flat.hasFile("d.txt"));
+		checkNames(indexedNames(flat), expectedNames(3, true, "Pre"));
+	}
+
+	void test_sub_directory() {
+		Common::FSDirectory dir(_root, 3);
+		Common::FSDirectory *sub = dir.getSubDirectory("SUB1", 2);
+		TS_ASSERT(sub);
+		if (sub) {
+			TS_ASSERT(sub->hasFile("c.txt"));
+			TS_ASSERT(sub->hasFile("deep/d.txt"));
+			TS_ASSERT(!sub->hasFile("deep/deeper/e.txt"));
+			delete sub;
+		}
+		TS_ASSERT(!dir.getSubDirectory("missing"));
+		TS_ASSERT(!dir.getSubDirectory("a.txt"));
+	}
+
+	void test_without_thread_manager() {
+		// Without g_system there is no thread manager to scan with
+		Common::FSDirectory dir(_root, 5);
+		dir.scanInBackground();
+		checkLookups(dir, 5, false);
+		checkNames(indexedNames(dir), expectedNames(5, false));
+	}
+
+	void test_background_scan() {
+		PthreadThreadManager threads;
+
+		for (int depth = 1; depth <= 6; ++depth) {
+			for (int flat = 0; flat < 2; ++flat) {
+				const uint32 generation = Common::Archive::getIndexGeneration();
+				{
+					// Lookups race with the scan, and may list directories
+					// themselves before the scan gets to them
+					Common::FSDirectory dir(_root, depth, flat);
+					dir.scanInBackground(&threads);
+					checkLookups(dir, depth, flat);
+
+					// Listing the members waits for the scan
+					Common::ArchiveMemberList members;
+					TS_ASSERT_EQUALS(dir.listMembers(members), (int)expectedNames(depth, flat).size());
+					checkNames(indexedNames(dir), expectedNames(depth, flat));
+				}
+				// The end of the scan was announced to the search sets
+				TS_ASSERT_DIFFERS(Common::Archive::getIndexGeneration(), generation);
+			}
+		}
+	}
+
+	void test_background_scan_pending() {
+		PthreadThreadManager threads;
+		Common::FSDirectory dir(_root, 5);
+		dir.scanInBackground(&threads);
+
+		// Until the scan is done, the names are not available, but asking
+		// never waits for them
+		Common::StringArray names;
+		Common::Archive::IndexableNames result;
+		do {
+			result = dir.listIndexableNames(names);
+		} while (result == Common::Archive::kIndexableNamesPending);
+		TS_ASSERT_EQUALS(result, Common::Archive::kIndexableNamesListed);
+		Common::sort(names.begin(), names.end());
+		checkNames(names, expectedNames(5, false));
+	}
+
+#ifdef HAS_MMAP
+	void test_mapped_members() {
+		// Large enough to be mapped when that is asked for
+		const uint32 size = 2 * 1024 * 1024;
+		byte *data = new byte[size];
+		for (uint32 i = 0; i < size; ++i)
+			data[i] = i * 7 + (i >> 11);
+		Common::WriteStream *out = nodeFor("big.dat").createWriteStream();
+		TS_ASSERT(out);
+		if (!out) {
+			delete[] data;
+			return;
+		}
+		TS_ASSERT_EQUALS(out->write(data, size), size);
+		delete out;
+
+		Common::FSDirectory plain(_root);
+		Common::FSDirectory mapped(_root);
+		mapped.setMapFiles(true);
+
+		for (int i = 0; i < 3; ++i) {
+			Common::SeekableReadStream *stream;
+			if (i == 0)
+				stream = nodeFor("big.dat").createReadStream();
+			else
+				stream = (i == 1 ? plain : mapped).createReadStreamForMember("big.dat");
+			TS_ASSERT(stream);
+			if (!stream)
+				continue;
+
+			// Files are only mapped on request, never for savefiles and the like
+			TS_ASSERT_EQUALS(dynamic_cast<PosixMappedReadStream *>(stream) != nullptr, i == 2);
+
+			byte buffer[4096];
+			TS_ASSERT(stream->seek(size - sizeof(buffer)));
+			TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), sizeof(buffer));
+			TS_ASSERT_EQUALS(memcmp(buffer, data + size - sizeof(buffer), sizeof(buffer)), 0);
+			delete stream;
+		}
+
+		delete[] data;
+	}
+#endif
+
+	void test_background_scan_abandoned() {
+		PthreadThreadManager threads;
+
+		// Deleting the directory stops the scan wherever it is
+		for (int i = 0; i < 20; ++i) {
+			Common::FSDirectory *dir = new Common::FSDirectory(_root, 6, i & 1);
+			dir->scanInBackground(&threads);
+			if (i & 2)
+				dir->hasFile("sub1/deep/d.txt");
+			delete dir;
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/zlib.h"
+
+#include "randomdata.h"
+
+class GZipReadStreamTestSuite : public CxxTest::TestSuite {
+	TestRandom _random;
+
+	/** Compress the data in gzip format, or return 0 without zlib. */
+	Common::SeekableReadStream *compress(const byte *data, uint32 size) {
+		Common::MemoryWriteStreamDynamic *packed = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *compressor = Common::wrapCompressedWriteStream(packed);
+		if (compressor == packed) {
+			delete packed;
+			return nullptr;
+		}
+
+		compressor->write(data, size);
+		compressor->finalize();
+		Common::SeekableReadStream *result = new Common::MemoryReadStream(packed->getData(), packed->size(), DisposeAfterUse::YES);
+		delete compressor;
+
+		return Common::wrapCompressedReadStream(result);
+	}
+
+	void checkRead(Common::SeekableReadStream *stream, const byte *data, uint32 offset, uint32 count) {
+		byte buffer[4096];
+		TS_ASSERT(stream->seek(offset));
+		TS_ASSERT_EQUALS(stream->pos(), (int32)offset);
+		TS_ASSERT_EQUALS(stream->read(buffer, count), count);
+		TS_ASSERT_SAME_DATA(buffer, data + offset, count);
+		TS_ASSERT(!stream->err());
+	}
+
+	void checkSeeks(uint32 size) {
+		byte *data = _random.createData(size);
+		Common::SeekableReadStream *stream = compress(data, size);
+		if (!stream) {
+			delete[] data;
+			return;
+		}
+		TS_ASSERT_EQUALS(stream->size(), (int32)size);
+
+		// Random seeks, before and after the whole stream has been seen
+		for (int pass = 0; pass < 2; ++pass) {
+			for (int i = 0; i < 100; ++i) {
+				const uint32 offset = _random.nextBelow(size);
+				checkRead(stream, data, offset, MIN<uint32>(_random.next() % 4096, size - offset));
+			}
+			checkRead(stream, data, size - 10, 10);
+		}
+
+		// Backward walk, as done when reading records from the end
+		for (int32 offset = size - 4096; offset >= 0; offset -= size / 20)
+			checkRead(stream, data, offset, 4096);
+
+		// Seeking relative to the current position and to the end
+		checkRead(stream, data, 100, 100);
+		TS_ASSERT(stream->seek(-150, SEEK_CUR));
+		TS_ASSERT_EQUALS(stream->readByte(), data[50]);
+		TS_ASSERT(stream->seek(-1, SEEK_END));
+		TS_ASSERT_EQUALS(stream->readByte(), data[size - 1]);
+		stream->readByte();
+		TS_ASSERT(stream->eos());
+
+		delete stream;
+		delete[] data;
+	}
+
+public:
+	void setUp() {
+		_random.reset();
+	}
+
+	void test_small_stream_seeks() {
+		checkSeeks(100000);
+	}
+
+	void test_checkpoint_seeks() {
+		checkSeeks(3 * 1024 * 1024 + 1234);
+	}
+
+	void test_thinned_checkpoint_seeks() {
+		// Past 16MB and 32MB of output, the checkpoints run out and are
+		// thinned, with the following ones spaced further apart
+		checkSeeks(40 * 1024 * 1024 + 1234);
+	}
+};
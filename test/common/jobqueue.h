@@ -0,0 +1,186 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/jobqueue.h"
+
+#ifdef POSIX
+#include "backends/threads/pthread/pthread-threads.h"
+#endif
+
+class JobQueueTestSuite : public CxxTest::TestSuite {
+	struct Ranges {
+		uint *hits;
+		uint calls;
+	};
+
+	static void markRange(uint begin, uint end, void *param) {
+		// Every index belongs to exactly one chunk, so no locking is needed
+		uint *hits = (uint *)param;
+		for (uint i = begin; i < end; ++i)
+			hits[i]++;
+	}
+
+	static void countRange(uint begin, uint end, void *param) {
+		Ranges *ranges = (Ranges *)param;
+		ranges->calls++;
+		markRange(begin, end, ranges->hits);
+	}
+
+	static void setSlot(void *param) {
+		*(uint *)param = 0xC0DE;
+	}
+
+	struct Nested {
+		Common::JobQueue *queue;
+		uint hits[64];
+	};
+
+	static void nestedJob(void *param) {
+		Nested *nested = (Nested *)param;
+		nested->queue->parallelFor(0, ARRAYSIZE(nested->hits), 1, markRange, nested->hits);
+	}
+
+	void checkQueue(Common::JobQueue &queue) {
+		// parallelFor must visit every index exactly once
+		static const uint sizes[] = { 0, 1, 7, 64, 1000, 4099 };
+		static const uint grains[] = { 0, 1, 3, 64, 5000 };
+		uint *hits = new uint[4099];
+
+		for (uint s = 0; s < ARRAYSIZE(sizes); ++s) {
+			for (uint g = 0; g < ARRAYSIZE(grains); ++g) {
+				memset(hits, 0, 4099 * sizeof(uint));
+				queue.parallelFor(0, sizes[s], grains[g], markRange, hits);
+				for (uint i = 0; i < sizes[s]; ++i)
+					TS_ASSERT_EQUALS(hits[i], 1u);
+			}
+		}
+
+		// Offset ranges stay within their bounds
+		memset(hits, 0, 4099 * sizeof(uint));
+		queue.parallelFor(100, 200, 7, markRange, hits);
+		for (uint i = 0; i < 300; ++i)
+			TS_ASSERT_EQUALS(hits[i], (i >= 100 && i < 200) ? 1u : 0u);
+
+		// Groups of plain jobs
+		Common::JobQueue::JobGroup group;
+		memset(hits, 0, 4099 * sizeof(uint));
+		for (uint i = 0; i < 500; ++i)
+			queue.push(setSlot, &hits[i], &group);
+		queue.wait(group);
+		for (uint i = 0; i < 500; ++i)
+			TS_ASSERT_EQUALS(hits[i], 0xC0DEu);
+
+		// Jobs may wait for jobs of their own
+		Nested nested[8];
+		Common::JobQueue::JobGroup outer;
+		for (uint i = 0; i < ARRAYSIZE(nested); ++i) {
+			nested[i].queue = &queue;
+			memset(nested[i].hits, 0, sizeof(nested[i].hits));
+			queue.push(nestedJob, &nested[i], &outer);
+		}
+		queue.wait(outer);
+		for (uint i = 0; i < ARRAYSIZE(nested); ++i) {
+			for (uint j = 0; j < ARRAYSIZE(nested[i].hits); ++j)
+				TS_ASSERT_EQUALS(nested[i].hits[j], 1u);
+		}
+
+		delete[] hits;
+	}
+
+public:
+	void test_synchronous() {
+		// There is no g_system in the tests, hence no thread manager
+		Common::JobQueue queue;
+		TS_ASSERT_EQUALS(queue.getWorkerCount(), 0u);
+		TS_ASSERT_EQUALS(queue.getConcurrency(), 1u);
+
+		// Jobs run right away
+		uint slot = 0;
+		queue.push(setSlot, &slot);
+		TS_ASSERT_EQUALS(slot, 0xC0DEu);
+
+		// A range which fits one chunk is handed over in one call
+		uint hits[16];
+		Ranges ranges = { hits, 0 };
+		memset(hits, 0, sizeof(hits));
+		queue.parallelFor(0, 16, 0, countRange, &ranges);
+		TS_ASSERT_EQUALS(ranges.calls, 1u);
+
+		// Groups are finished right away
+		Common::JobQueue::JobGroup group;
+		queue.push(setSlot, &slot, &group);
+		TS_ASSERT(queue.isFinished(group));
+
+		checkQueue(queue);
+	}
+
+#ifdef POSIX
+	void test_threaded() {
+		PthreadThreadManager threads;
+		static const uint workers[] = { 1, 2, 4, 7 };
+
+		for (uint w = 0; w < ARRAYSIZE(workers); ++w) {
+			Common::JobQueue queue(workers[w], &threads);
+			TS_ASSERT_EQUALS(queue.getWorkerCount(), workers[w]);
+			checkQueue(queue);
+		}
+	}
+
+	void test_destructor_runs_pending_jobs() {
+		PthreadThreadManager threads;
+		uint slots[100];
+		memset(slots, 0, sizeof(slots));
+
+		{
+			Common::JobQueue queue(3, &threads);
+			for (uint i = 0; i < ARRAYSIZE(slots); ++i)
+				queue.push(setSlot, &slots[i]);
+		}
+
+		for (uint i = 0; i < ARRAYSIZE(slots); ++i)
+			TS_ASSERT_EQUALS(slots[i], 0xC0DEu);
+	}
+
+	struct Gate {
+		PthreadThreadManager *threads;
+		Common::ThreadManager::SemaphoreRef open;
+		uint result;
+	};
+
+	static void gatedJob(void *param) {
+		Gate *gate = (Gate *)param;
+		gate->threads->waitSemaphore(gate->open);
+		gate->result = 0xC0DE;
+	}
+
+	void test_is_finished() {
+		PthreadThreadManager threads;
+		Common::JobQueue queue(1, &threads);
+		Gate gate = { &threads, threads.createSemaphore(0), 0 };
+
+		// Polling does not run the job, unlike wait()
+		Common::JobQueue::JobGroup group;
+		queue.push(gatedJob, &gate, &group);
+		TS_ASSERT(!queue.isFinished(group));
+
+		threads.postSemaphore(gate.open);
+		while (!queue.isFinished(group))
+			;
+		TS_ASSERT_EQUALS(gate.result, 0xC0DEu);
+		threads.deleteSemaphore(gate.open);
+	}
+
+	void test_semaphore() {
+		PthreadThreadManager threads;
+		Common::ThreadManager::SemaphoreRef sem = threads.createSemaphore(2);
+		TS_ASSERT(sem != nullptr);
+
+		threads.waitSemaphore(sem);
+		threads.waitSemaphore(sem);
+		threads.postSemaphore(sem);
+		threads.waitSemaphore(sem);
+		threads.deleteSemaphore(sem);
+
+		TS_ASSERT_LESS_THAN_EQUALS(1u, threads.getCPUCount());
+	}
+#endif
+};
@@ -0,0 +1,49 @@
+#ifndef TEST_COMMON_RANDOMDATA_H
+#define TEST_COMMON_RANDOMDATA_H
+
+#include "common/scummsys.h"
+
+/**
+ * Reproducible pseudo-random numbers and test data for the stream tests
+ * and benchmarks, from a plain linear congruential generator.
+ */
+class TestRandom {
+public:
+	enum {
+		kDefaultSeed = 0x5eed
+	};
+
+	explicit TestRandom(uint32 seed = kDefaultSeed) : _seed(seed) {}
+
+	void reset(uint32 seed = kDefaultSeed) {
+		_seed = seed;
+	}
+
+	/** The next number, in the range 0 to 2^24 - 1. */
+	uint32 next() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	/** The next number, in the range 0 to limit - 1, for limits above 2^24 as well. */
+	uint32 nextBelow(uint32 limit) {
+		const uint64 value = ((uint64)next() << 24) | next();
+		return (uint32)(value % limit);
+	}
+
+	/**
+	 * Data which compresses, but not so well that deflate emits few blocks.
+	 * Free it with delete[].
+	 */
+	byte *createData(uint32 size) {
+		byte *data = new byte[size];
+		for (uint32 i = 0; i < size; ++i)
+			data[i] = (next() % 3) ? 'a' + (next() & 15) : data[i / 2];
+		return data;
+	}
+
+private:
+	uint32 _seed;
+};
+
+#endif
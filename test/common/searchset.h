@@ -0,0 +1,231 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+
+/**
+ * Archive with a fixed list of names, whose members contain a single byte
+ * telling which archive they came from.
+ */
+class TaggedArchive : public Common::Archive {
+	Common::StringArray _names;
+	byte _tag;
+	bool _indexable;
+
+public:
+	mutable int probes;
+	Common::String missing; // listed, but reported as absent
+	bool pending;           // names not available yet
+
+	TaggedArchive(byte tag, const char *names, bool indexable = true)
+		: _tag(tag), _indexable(indexable), probes(0), pending(false) {
+		Common::String list(names);
+		for (const char *start = list.c_str(); *start; ) {
+			const char *end = strchr(start, ' ');
+			if (!end)
+				end = start + strlen(start);
+			_names.push_back(Common::String(start, end));
+			start = *end ? end + 1 : end;
+		}
+	}
+
+	virtual bool hasFile(const Common::String &name) const {
+		++probes;
+		if (name.equalsIgnoreCase(missing))
+			return false;
+		for (uint i = 0; i < _names.size(); ++i) {
+			if (_names[i].equalsIgnoreCase(name))
+				return true;
+		}
+		return false;
+	}
+
+	virtual int listMembers(Common::ArchiveMemberList &list) const {
+		for (uint i = 0; i < _names.size(); ++i)
+			list.push_back(Common::ArchiveMemberPtr(new Common::GenericArchiveMember(_names[i], this)));
+		return _names.size();
+	}
+
+	virtual const Common::ArchiveMemberPtr getMember(const Common::String &name) const {
+		if (!hasFile(name))
+			return Common::ArchiveMemberPtr();
+		return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(name, this));
+	}
+
+	virtual Common::SeekableReadStream *createReadStreamForMember(const Common::String &name) const {
+		if (!hasFile(name))
+			return nullptr;
+		return new Common::MemoryReadStream(&_tag, 1);
+	}
+
+	virtual IndexableNames listIndexableNames(Common::StringArray &names) const {
+		if (pending)
+			return kIndexableNamesPending;
+		if (!_indexable)
+			return kIndexableNamesUnsupported;
+		names.push_back(_names);
+		return kIndexableNamesListed;
+	}
+
+	// Stop answering kIndexableNamesPending.
+	void finishPending() {
+		pending = false;
+		bumpIndexGeneration();
+	}
+};
+
+class SearchSetTestSuite : public CxxTest::TestSuite {
+	// Which archive the set opens the given file from, 0 if none.
+	byte openedFrom(const Common::SearchSet &set, const char *name) {
+		Common::SeekableReadStream *stream = set.createReadStreamForMember(name);
+		if (!stream)
+			return 0;
+		const byte tag = stream->readByte();
+		delete stream;
+		return tag;
+	}
+
+	// Look up files until the set answers them through its name index.
+	void buildIndex(const Common::SearchSet &set) {
+		uint32 indexed;
+		for (int i = 0; i < 100; ++i) {
+			indexed = set.getIndexStats().indexedLookups;
+			set.hasFile("warmup");
+			if (set.getIndexStats().indexedLookups != indexed)
+				return;
+		}
+		TS_FAIL("name index not used");
+	}
+
+public:
+	void test_priority_order() {
+		Common::SearchSet set;
+		set.add("low", new TaggedArchive('l', "a.dat shared.dat"), -1);
+		set.add("high", new TaggedArchive('h', "b.dat SHARED.DAT"), 1);
+		set.add("mid", new TaggedArchive('m', "c.dat shared.dat"), 0);
+
+		for (int pass = 0; pass < 2; ++pass) {
+			TS_ASSERT_EQUALS(openedFrom(set, "shared.dat"), 'h');
+			TS_ASSERT_EQUALS(openedFrom(set, "Shared.Dat"), 'h');
+			TS_ASSERT_EQUALS(openedFrom(set, "a.dat"), 'l');
+			TS_ASSERT_EQUALS(openedFrom(set, "c.dat"), 'm');
+			TS_ASSERT_EQUALS(openedFrom(set, "d.dat"), 0);
+			TS_ASSERT(set.hasFile("B.dat"));
+			TS_ASSERT(!set.hasFile("d.dat"));
+			TS_ASSERT(set.getMember("c.dat"));
+			TS_ASSERT(!set.getMember("d.dat"));
+
+			buildIndex(set);
+		}
+
+		TS_ASSERT_EQUALS(set.getIndexStats().rebuilds, 1U);
+	}
+
+	void test_changes_invalidate_index() {
+		Common::SearchSet set;
+		set.add("one", new TaggedArchive('1', "shared.dat"), 1);
+		set.add("two", new TaggedArchive('2', "shared.dat two.dat"), 0);
+		buildIndex(set);
+		TS_ASSERT_EQUALS(openedFrom(set, "shared.dat"), '1');
+		TS_ASSERT_EQUALS(set.getIndexStats().rebuilds, 1U);
+
+		set.setPriority("two", 2);
+		TS_ASSERT_EQUALS(openedFrom(set, "shared.dat"), '2');
+		buildIndex(set);
+		TS_ASSERT_EQUALS(openedFrom(set, "shared.dat"), '2');
+
+		set.remove("two");
+		TS_ASSERT_EQUALS(openedFrom(set, "shared.dat"), '1');
+		buildIndex(set);
+		TS_ASSERT_EQUALS(openedFrom(set, "shared.dat"), '1');
+		TS_ASSERT(!set.hasFile("two.dat"));
+
+		set.add("three", new TaggedArchive('3', "three.dat"), 0);
+		buildIndex(set);
+		TS_ASSERT_EQUALS(openedFrom(set, "three.dat"), '3');
+		TS_ASSERT_EQUALS(set.getIndexStats().rebuilds, 4U);
+
+		set.clear();
+		TS_ASSERT(!set.hasFile("shared.dat"));
+		TS_ASSERT(!set.hasFile("three.dat"));
+	}
+
+	void test_unindexed_archives_keep_priority() {
+		Common::SearchSet set;
+		TaggedArchive *plain = new TaggedArchive('p', "first.dat");
+		set.add("indexed-high", new TaggedArchive('h', "shared.dat"), 2);
+		set.add("plain", plain, 1);
+		set.add("indexed-low", new TaggedArchive('l', "shared.dat first.dat last.dat"), 0);
+		set.add("plain-last", new TaggedArchive('q', "last.dat only.dat", false), -1);
+		buildIndex(set);
+
+		TS_ASSERT_EQUALS(openedFrom(set, "shared.dat"), 'h');
+		TS_ASSERT_EQUALS(openedFrom(set, "first.dat"), 'p');
+		TS_ASSERT_EQUALS(openedFrom(set, "last.dat"), 'l');
+		TS_ASSERT_EQUALS(openedFrom(set, "only.dat"), 'q');
+		TS_ASSERT_EQUALS(openedFrom(set, "none.dat"), 0);
+	}
+
+	void test_index_skips_archives() {
+		Common::SearchSet set;
+		TaggedArchive *archives[8];
+		for (int i = 0; i < 8; ++i) {
+			archives[i] = new TaggedArchive('0' + i, "x.dat");
+			set.add(Common::String::format("%d", i), archives[i], i);
+		}
+		buildIndex(set);
+
+		for (int i = 0; i < 8; ++i)
+			archives[i]->probes = 0;
+
+		TS_ASSERT(!set.hasFile("missing.dat"));
+		TS_ASSERT(set.hasFile("x.dat"));
+		for (int i = 0; i < 7; ++i)
+			TS_ASSERT_EQUALS(archives[i]->probes, 0);
+		TS_ASSERT_EQUALS(archives[7]->probes, 1);
+	}
+
+	void test_stale_entry() {
+		Common::SearchSet set;
+		TaggedArchive *first = new TaggedArchive('1', "gone.dat");
+		set.add("first", first, 1);
+		set.add("second", new TaggedArchive('2', "gone.dat"), 0);
+		buildIndex(set);
+
+		first->missing = "gone.dat";
+		const uint32 stale = set.getIndexStats().staleEntries;
+		TS_ASSERT_EQUALS(openedFrom(set, "gone.dat"), '2');
+		TS_ASSERT_EQUALS(set.getIndexStats().staleEntries, stale + 1);
+	}
+
+	void test_pending_archive_indexed_later() {
+		Common::SearchSet set;
+		TaggedArchive *late = new TaggedArchive('l', "late.dat");
+		TaggedArchive *other = new TaggedArchive('o', "other.dat");
+		late->pending = true;
+		set.add("late", late, 1);
+		set.add("other", other, 0);
+		buildIndex(set);
+		TS_ASSERT_EQUALS(set.getIndexStats().rebuilds, 1U);
+
+		// Still asked directly in the meantime
+		late->probes = 0;
+		TS_ASSERT_EQUALS(openedFrom(set, "late.dat"), 'l');
+		TS_ASSERT(!set.hasFile("missing.dat"));
+		TS_ASSERT_EQUALS(late->probes, 2);
+		TS_ASSERT_EQUALS(set.getIndexStats().rebuilds, 1U);
+
+		late->finishPending();
+		late->probes = 0;
+		TS_ASSERT(!set.hasFile("missing.dat"));
+		TS_ASSERT_EQUALS(late->probes, 0);
+		TS_ASSERT_EQUALS(openedFrom(set, "late.dat"), 'l');
+		TS_ASSERT_EQUALS(openedFrom(set, "other.dat"), 'o');
+		TS_ASSERT_EQUALS(set.getIndexStats().rebuilds, 2U);
+
+		// Other archives finishing don't matter once nothing is pending
+		other->finishPending();
+		TS_ASSERT(set.hasFile("other.dat"));
+		TS_ASSERT_EQUALS(set.getIndexStats().rebuilds, 2U);
+	}
+};
@@ -0,0 +1,72 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/spsc-queue.h"
+
+class SPSCQueueTestSuite : public CxxTest::TestSuite {
+public:
+	void test_empty_size() {
+		Common::SPSCQueue<int, 4> queue;
+		TS_ASSERT(queue.empty());
+		TS_ASSERT_EQUALS(queue.size(), 0u);
+		TS_ASSERT_EQUALS(queue.capacity(), 4u);
+
+		TS_ASSERT(queue.push(1));
+		TS_ASSERT(queue.push(2));
+		TS_ASSERT(!queue.empty());
+		TS_ASSERT_EQUALS(queue.size(), 2u);
+	}
+
+	void test_push_pop_order() {
+		Common::SPSCQueue<int, 8> queue;
+		int value = 0;
+
+		TS_ASSERT(!queue.pop(value));
+
+		queue.push(42);
+		queue.push(-23);
+		queue.push(7);
+
+		TS_ASSERT(queue.pop(value));
+		TS_ASSERT_EQUALS(value, 42);
+		TS_ASSERT(queue.pop(value));
+		TS_ASSERT_EQUALS(value, -23);
+		TS_ASSERT(queue.pop(value));
+		TS_ASSERT_EQUALS(value, 7);
+		TS_ASSERT(!queue.pop(value));
+		TS_ASSERT(queue.empty());
+	}
+
+	void test_full() {
+		Common::SPSCQueue<int, 4> queue;
+		for (int i = 0; i < 4; ++i)
+			TS_ASSERT(queue.push(i));
+		TS_ASSERT(!queue.push(4));
+		TS_ASSERT_EQUALS(queue.size(), 4u);
+
+		int value;
+		TS_ASSERT(queue.pop(value));
+		TS_ASSERT_EQUALS(value, 0);
+		TS_ASSERT(queue.push(4));
+		TS_ASSERT(!queue.push(5));
+	}
+
+	void test_wrap_around() {
+		Common::SPSCQueue<int, 4> queue;
+		int expected = 0;
+
+		// Go around the ring many times, with varying fill levels.
+		for (int i = 0; i < 1000; ++i) {
+			TS_ASSERT(queue.push(i));
+			if (i % 3 != 0) {
+				int value;
+				TS_ASSERT(queue.pop(value));
+				TS_ASSERT_EQUALS(value, expected++);
+			}
+			if (queue.size() == queue.capacity()) {
+				int value;
+				while (queue.pop(value))
+					TS_ASSERT_EQUALS(value, expected++);
+			}
+		}
+	}
+};
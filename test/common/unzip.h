@@ -0,0 +1,223 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/unzip.h"
+
+#include "randomdata.h"
+#include "ziphelper.h"
+
+class UnzipTestSuite : public CxxTest::TestSuite {
+	TestRandom _random;
+
+	void checkRandomReads(Common::SeekableReadStream *stream, const byte *data, uint32 size) {
+		byte buffer[5000];
+		for (int i = 0; i < 200; ++i) {
+			const uint32 offset = _random.nextBelow(size);
+			const uint32 count = MIN<uint32>(_random.next() % sizeof(buffer), size - offset);
+			TS_ASSERT(stream->seek(offset));
+			TS_ASSERT_EQUALS(stream->read(buffer, count), count);
+			TS_ASSERT_SAME_DATA(buffer, data + offset, count);
+		}
+		TS_ASSERT(!stream->err());
+	}
+
+	void checkSequentialRead(Common::SeekableReadStream *stream, const byte *data, uint32 size) {
+		byte *buffer = new byte[size + 1];
+		TS_ASSERT(stream->seek(0));
+		TS_ASSERT_EQUALS(stream->read(buffer, size + 1), size);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT(!stream->err());
+		TS_ASSERT_SAME_DATA(buffer, data, size);
+		delete[] buffer;
+	}
+
+	/**
+	 * Opens a single member zip file, after XORing a byte at the given offsets
+	 * of its local and its central header.
+	 */
+	static Common::Archive *patchArchive(Common::SeekableReadStream *zip, uint32 localOffset, uint32 centralOffset, byte mask) {
+		const int32 zipSize = zip->size();
+		byte *bytes = new byte[zipSize];
+		zip->read(bytes, zipSize);
+		delete zip;
+
+		const uint32 central = READ_LE_UINT32(bytes + zipSize - 6);
+		bytes[localOffset] ^= mask;
+		bytes[central + centralOffset] ^= mask;
+
+		return Common::makeZipArchive(new Common::MemoryReadStream(bytes, zipSize, DisposeAfterUse::YES));
+	}
+
+public:
+	void setUp() {
+		_random.reset();
+	}
+
+	void test_stored_member() {
+		const uint32 size = 100000;
+		byte *data = _random.createData(size);
+
+		ZipBuilder builder;
+		builder.addMember("stored.bin", data, size, false);
+		Common::Archive *archive = Common::makeZipArchive(builder.createStream());
+		TS_ASSERT(archive);
+
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("STORED.BIN");
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), (int32)size);
+
+		// The member outlives its archive
+		delete archive;
+		checkSequentialRead(stream, data, size);
+		checkRandomReads(stream, data, size);
+
+		delete stream;
+		delete[] data;
+	}
+
+	void test_deflated_members() {
+		// Small enough to be inflated into memory, and large enough to be
+		// inflated on demand with several checkpoints
+		const uint32 smallSize = 20000, largeSize = 3 * 1024 * 1024 + 12345;
+		byte *small = _random.createData(smallSize);
+		byte *large = _random.createData(largeSize);
+
+		ZipBuilder builder;
+		if (!builder.addMember("small.txt", small, smallSize, true)) {
+			// Built without zlib
+			delete[] small;
+			delete[] large;
+			return;
+		}
+		builder.addMember("large.txt", large, largeSize, true);
+		builder.addMember("empty.txt", large, 0, true);
+		Common::Archive *archive = Common::makeZipArchive(builder.createStream());
+		TS_ASSERT(archive);
+
+		Common::SeekableReadStream *smallStream = archive->createReadStreamForMember("small.txt");
+		Common::SeekableReadStream *largeStream = archive->createReadStreamForMember("large.txt");
+		Common::SeekableReadStream *otherStream = archive->createReadStreamForMember("large.txt");
+		Common::SeekableReadStream *emptyStream = archive->createReadStreamForMember("empty.txt");
+		TS_ASSERT(smallStream && largeStream && otherStream && emptyStream);
+		delete archive;
+
+		TS_ASSERT_EQUALS(emptyStream->size(), 0);
+		TS_ASSERT_EQUALS(emptyStream->readByte(), 0);
+		TS_ASSERT(emptyStream->eos());
+
+		checkSequentialRead(smallStream, small, smallSize);
+		checkRandomReads(smallStream, small, smallSize);
+
+		// The first pass takes the checkpoints, the second one uses them
+		checkRandomReads(largeStream, large, largeSize);
+		checkSequentialRead(largeStream, large, largeSize);
+		checkRandomReads(largeStream, large, largeSize);
+
+		// Streams of the same member do not disturb each other
+		byte a[100], b[100];
+		TS_ASSERT(largeStream->seek(largeSize - 1000));
+		TS_ASSERT(otherStream->seek(1000));
+		for (int i = 0; i < 5; ++i) {
+			TS_ASSERT_EQUALS(largeStream->read(a, sizeof(a)), sizeof(a));
+			TS_ASSERT_EQUALS(otherStream->read(b, sizeof(b)), sizeof(b));
+			TS_ASSERT_SAME_DATA(a, large + largeSize - 1000 + i * sizeof(a), sizeof(a));
+			TS_ASSERT_SAME_DATA(b, large + 1000 + i * sizeof(b), sizeof(b));
+		}
+
+		TS_ASSERT(!largeStream->seek(largeSize + 1));
+		TS_ASSERT(largeStream->seek(-10, SEEK_END));
+		TS_ASSERT_EQUALS(largeStream->pos(), (int32)largeSize - 10);
+
+		delete smallStream;
+		delete largeStream;
+		delete otherStream;
+		delete emptyStream;
+		delete[] small;
+		delete[] large;
+	}
+
+	void test_match_across_window_end() {
+		// Members padded with zeros, whose last match crosses the point where
+		// the inflater's 32KB window wraps. For some lengths, zlib has taken
+		// all input by the time the window is full.
+		ZipBuilder builder;
+		byte *data[40];
+		uint32 sizes[40];
+		for (int i = 0; i < 40; ++i) {
+			sizes[i] = 2 * 32768 + 1 + 3 * i;
+			data[i] = _random.createData(sizes[i]);
+			memset(data[i] + 100, 0, sizes[i] - 100);
+			if (!builder.addMember(Common::String::format("padded%d.bin", i).c_str(), data[i], sizes[i], true)) {
+				for (int j = 0; j <= i; ++j)
+					delete[] data[j];
+				return;
+			}
+		}
+
+		Common::Archive *archive = Common::makeZipArchive(builder.createStream());
+		TS_ASSERT(archive);
+		for (int i = 0; i < 40; ++i) {
+			Common::SeekableReadStream *stream = archive->createReadStreamForMember(Common::String::format("padded%d.bin", i));
+			TS_ASSERT(stream);
+			if (stream)
+				checkSequentialRead(stream, data[i], sizes[i]);
+			delete stream;
+			delete[] data[i];
+		}
+		delete archive;
+	}
+
+	void test_corrupt_member() {
+		const uint32 size = 300000;
+		byte *data = _random.createData(size);
+
+		// Large members are streamed, and fail once read to the end; small
+		// ones already fail to open
+		for (int deflate = 0; deflate < 2; ++deflate) {
+			for (int small = 0; small < 2; ++small) {
+				const uint32 memberSize = small ? 1000 : size;
+				ZipBuilder builder;
+				if (!builder.addMember("data.txt", data, memberSize, deflate)) {
+					delete[] data;
+					return;
+				}
+
+				// Flip a bit in the CRC, both in the local and the central header
+				Common::Archive *archive = patchArchive(builder.createStream(), 14, 16, 1);
+				TS_ASSERT(archive);
+				Common::SeekableReadStream *stream = archive->createReadStreamForMember("data.txt");
+				if (small) {
+					TS_ASSERT(!stream);
+				} else {
+					TS_ASSERT(stream);
+					byte *buffer = new byte[size];
+					stream->read(buffer, size);
+					TS_ASSERT(stream->err());
+					delete[] buffer;
+				}
+
+				delete stream;
+				delete archive;
+			}
+		}
+
+		delete[] data;
+	}
+
+	void test_unsupported_method() {
+		const uint32 size = 1000;
+		byte *data = _random.createData(size);
+
+		ZipBuilder builder;
+		builder.addMember("data.bin", data, size, false);
+
+		// Turn the stored member into an imploded one (method 6)
+		Common::Archive *archive = patchArchive(builder.createStream(), 8, 10, 6);
+		TS_ASSERT(archive);
+		TS_ASSERT(archive->hasFile("data.bin"));
+		TS_ASSERT(!archive->createReadStreamForMember("data.bin"));
+
+		delete archive;
+		delete[] data;
+	}
+};
@@ -0,0 +1,110 @@
+#ifndef TEST_COMMON_ZIPHELPER_H
+#define TEST_COMMON_ZIPHELPER_H
+
+#include "common/memstream.h"
+#include "common/zlib.h"
+
+/**
+ * Builds a ZIP archive in memory. Members are deflated with the GZip write
+ * stream, minus its header and trailer, which leaves raw deflate data.
+ */
+class ZipBuilder {
+public:
+	ZipBuilder() : _zip(DisposeAfterUse::NO), _central(DisposeAfterUse::YES), _count(0) {}
+
+	static uint32 crc32(const byte *data, uint32 size) {
+		uint32 crc = 0xFFFFFFFF;
+		for (uint32 i = 0; i < size; ++i) {
+			crc ^= data[i];
+			for (int bit = 0; bit < 8; ++bit)
+				crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+		}
+		return ~crc;
+	}
+
+	/** Add a member, returning false if it could not be compressed. */
+	bool addMember(const char *name, const byte *data, uint32 size, bool deflate) {
+		byte *packed = nullptr;
+		uint32 packedSize = size;
+
+		if (deflate) {
+			Common::MemoryWriteStreamDynamic *gzip = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+			Common::WriteStream *compressor = Common::wrapCompressedWriteStream(gzip);
+			if (compressor == gzip) {
+				// No zlib
+				delete gzip;
+				return false;
+			}
+			compressor->write(data, size);
+			compressor->finalize();
+			packed = gzip->getData();
+			packedSize = gzip->size() - kGZipHeaderSize - kGZipTrailerSize;
+			delete compressor;
+		}
+
+		const uint32 crc = crc32(data, size);
+		const uint32 nameLength = strlen(name);
+		const uint32 offset = _zip.pos();
+
+		_zip.writeUint32LE(0x04034b50);
+		writeCommonHeader(_zip, deflate, crc, packedSize, size, nameLength);
+		_zip.write(name, nameLength);
+		_zip.write(deflate ? packed + kGZipHeaderSize : data, packedSize);
+		free(packed);
+
+		_central.writeUint32LE(0x02014b50);
+		_central.writeUint16LE(20);
+		writeCommonHeader(_central, deflate, crc, packedSize, size, nameLength);
+		_central.writeUint16LE(0);	// comment length
+		_central.writeUint16LE(0);	// disk number
+		_central.writeUint16LE(0);	// internal attributes
+		_central.writeUint32LE(0);	// external attributes
+		_central.writeUint32LE(offset);
+		_central.write(name, nameLength);
+
+		++_count;
+		return true;
+	}
+
+	/** Append the central directory and return the whole archive. */
+	Common::SeekableReadStream *createStream() {
+		const uint32 centralOffset = _zip.pos();
+		_zip.write(_central.getData(), _central.size());
+
+		_zip.writeUint32LE(0x06054b50);
+		_zip.writeUint16LE(0);
+		_zip.writeUint16LE(0);
+		_zip.writeUint16LE(_count);
+		_zip.writeUint16LE(_count);
+		_zip.writeUint32LE(_central.size());
+		_zip.writeUint32LE(centralOffset);
+		_zip.writeUint16LE(0);
+
+		return new Common::MemoryReadStream(_zip.getData(), _zip.size(), DisposeAfterUse::YES);
+	}
+
+private:
+	enum {
+		kGZipHeaderSize = 10,
+		kGZipTrailerSize = 8
+	};
+
+	static void writeCommonHeader(Common::WriteStream &out, bool deflate, uint32 crc, uint32 packedSize, uint32 size, uint32 nameLength) {
+		out.writeUint16LE(20);		// version needed
+		out.writeUint16LE(0);		// flags
+		out.writeUint16LE(deflate ? 8 : 0);
+		out.writeUint16LE(0);		// time
+		out.writeUint16LE(0x21);	// date, 1980-01-01
+		out.writeUint32LE(crc);
+		out.writeUint32LE(packedSize);
+		out.writeUint32LE(size);
+		out.writeUint16LE(nameLength);
+		out.writeUint16LE(0);		// extra field length
+	}
+
+	Common::MemoryWriteStreamDynamic _zip;
+	Common::MemoryWriteStreamDynamic _central;
+	uint _count;
+};
+
+#endif
@@ -0,0 +1,69 @@
+#include <cxxtest/TestSuite.h>
+
+#include "engines/detectioncache.h"
+#include "common/memstream.h"
+
+class DetectionCacheTestSuite : public CxxTest::TestSuite {
+	static Common::String save() {
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+		DetectionCacheMan.saveTo(out);
+		return Common::String((const char *)out.getData(), out.size());
+	}
+
+	static bool load(const char *data) {
+		Common::MemoryReadStream in((const byte *)data, strlen(data));
+		return DetectionCacheMan.loadFrom(in);
+	}
+
+public:
+	void setUp() {
+		DetectionCacheMan.clear();
+	}
+
+	void test_round_trip() {
+		// A single entry, so that the order of the output is known
+		const char *data =
+			"ScummVM detection cache 1\n"
+			"123456\t1600000000\t-1\t0123456789abcdef0123456789abcdef\td5000:/games/monkey\tisland/MONKEY.000\n";
+
+		TS_ASSERT(load(data));
+		TS_ASSERT_EQUALS(save(), Common::String(data));
+
+		// Loading what was saved gives the same entries again
+		const Common::String saved = save();
+		DetectionCacheMan.clear();
+		TS_ASSERT(load(saved.c_str()));
+		TS_ASSERT_EQUALS(save(), saved);
+	}
+
+	void test_unknown_format() {
+		TS_ASSERT(!load("ScummVM detection cache 0\n"));
+		TS_ASSERT(!load(""));
+		TS_ASSERT_EQUALS(save(), Common::String("ScummVM detection cache 1\n"));
+	}
+
+	void test_malformed_lines() {
+		const char *data =
+			"ScummVM detection cache 1\n"
+			"123456\t1600000000\t5000\n"
+			"\n"
+			"123456\t1600000000\t5000\t0123456789abcdef0123456789abcdef\tr0:/games/indy/INDY\n";
+
+		TS_ASSERT(load(data));
+		TS_ASSERT_EQUALS(save(), Common::String(
+			"ScummVM detection cache 1\n"
+			"123456\t1600000000\t5000\t0123456789abcdef0123456789abcdef\tr0:/games/indy/INDY\n"));
+	}
+
+	void test_keeps_present_entries() {
+		TS_ASSERT(load(
+			"ScummVM detection cache 1\n"
+			"1\t2\t3\t0123456789abcdef0123456789abcdef\td5000:/games/monkey/MONKEY.000\n"));
+		TS_ASSERT(load(
+			"ScummVM detection cache 1\n"
+			"4\t5\t6\tfedcba9876543210fedcba9876543210\td5000:/games/monkey/MONKEY.000\n"));
+		TS_ASSERT_EQUALS(save(), Common::String(
+			"ScummVM detection cache 1\n"
+			"1\t2\t3\t0123456789abcdef0123456789abcdef\td5000:/games/monkey/MONKEY.000\n"));
+	}
+};
@@ -0,0 +1,102 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/atlas_packer.h"
+
+class AtlasPackerTestSuite : public CxxTest::TestSuite {
+	/** Return true if no two rectangles overlap and all lie inside the page. */
+	bool disjoint(const Common::Array<Common::Rect> &rects, const Graphics::AtlasPacker &packer) {
+		const Common::Rect page(packer.getWidth(), packer.getHeight());
+		for (uint i = 0; i < rects.size(); ++i) {
+			if (!page.contains(rects[i]))
+				return false;
+			for (uint j = i + 1; j < rects.size(); ++j) {
+				if (rects[i].intersects(rects[j]))
+					return false;
+			}
+		}
+		return true;
+	}
+
+public:
+	void test_rejects_invalid_sizes() {
+		Graphics::AtlasPacker packer(64, 32);
+		Common::Rect r;
+		TS_ASSERT(!packer.allocate(0, 10, r));
+		TS_ASSERT(!packer.allocate(10, 0, r));
+		TS_ASSERT(!packer.allocate(65, 10, r));
+		TS_ASSERT(!packer.allocate(10, 33, r));
+		TS_ASSERT(packer.allocate(64, 32, r));
+		TS_ASSERT_EQUALS(r, Common::Rect(64, 32));
+		TS_ASSERT(!packer.allocate(1, 1, r));
+	}
+
+	void test_fills_page_without_overlap() {
+		Graphics::AtlasPacker packer(128, 128, 1);
+		Common::Array<Common::Rect> rects;
+		uint32 seed = 0x5eed;
+
+		for (;;) {
+			seed = seed * 1103515245 + 12345;
+			const uint w = 4 + ((seed >> 8) & 15);
+			const uint h = 4 + ((seed >> 16) & 15);
+			Common::Rect r;
+			if (!packer.allocate(w, h, r))
+				break;
+			TS_ASSERT_EQUALS((uint)r.width(), w);
+			TS_ASSERT_EQUALS((uint)r.height(), h);
+			rects.push_back(r);
+		}
+
+		TS_ASSERT_EQUALS(packer.getCount(), rects.size());
+		TS_ASSERT(rects.size() > 40u);
+
+		// The padding keeps one free pixel between neighbours
+		for (uint i = 0; i < rects.size(); ++i) {
+			Common::Rect grown(rects[i].left, rects[i].top, rects[i].right + 1, rects[i].bottom + 1);
+			for (uint j = 0; j < rects.size(); ++j)
+				TS_ASSERT(i == j || !grown.intersects(rects[j]));
+		}
+		TS_ASSERT(disjoint(rects, packer));
+	}
+
+	void test_release_reuses_shelves() {
+		Graphics::AtlasPacker packer(32, 32);
+		Common::Rect a, b, c, r;
+
+		TS_ASSERT(packer.allocate(16, 16, a));
+		TS_ASSERT(packer.allocate(16, 16, b));
+		TS_ASSERT(packer.allocate(32, 16, c));
+		TS_ASSERT(!packer.allocate(8, 8, r));
+
+		// A shelf only becomes free once all of its rectangles are released
+		packer.release(a);
+		TS_ASSERT(!packer.allocate(8, 8, r));
+		packer.release(b);
+		TS_ASSERT(packer.allocate(8, 8, r));
+		TS_ASSERT_EQUALS(r, Common::Rect(0, 0, 8, 8));
+
+		// Trailing shelves go back to the page and may change their height
+		packer.release(r);
+		packer.release(c);
+		TS_ASSERT(packer.isEmpty());
+		TS_ASSERT(packer.allocate(32, 32, r));
+	}
+
+	void test_prefers_matching_shelf() {
+		Graphics::AtlasPacker packer(64, 64);
+		Common::Rect tall, small, r;
+
+		TS_ASSERT(packer.allocate(8, 32, tall));
+		TS_ASSERT(packer.allocate(8, 8, small));
+
+		// Small items do not waste the tall shelf while there is space left
+		TS_ASSERT(packer.allocate(8, 8, r));
+		TS_ASSERT_EQUALS(r.top, small.top);
+		TS_ASSERT(packer.allocate(8, 30, r));
+		TS_ASSERT_EQUALS(r.top, tall.top);
+
+		packer.clear();
+		TS_ASSERT(packer.isEmpty());
+		TS_ASSERT(packer.allocate(64, 64, r));
+	}
+};
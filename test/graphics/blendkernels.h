@@ -0,0 +1,141 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/blendkernels.h"
+#include "graphics/transparent_surface.h"
+
+class BlendKernelsTestSuite : public CxxTest::TestSuite {
+	enum {
+		kWidth = 19,
+		kHeight = 3,
+		kPitch = kWidth * 4
+	};
+
+	uint32 _seed;
+	byte _src[kHeight * kPitch];
+	byte _target[kHeight * kPitch];
+
+	uint32 next() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	// Random pixels, with plenty of fully transparent and fully opaque ones
+	void fill(byte *pixels, uint count) {
+		for (uint i = 0; i < count; ++i) {
+			const uint32 r = next();
+			switch (r & 7) {
+			case 0:
+				pixels[i] = 0;
+				break;
+			case 1:
+				pixels[i] = 255;
+				break;
+			default:
+				pixels[i] = r >> 8;
+			}
+		}
+	}
+
+	typedef Graphics::BlendKernels::BlendFunc Graphics::BlendKernels::*Mode;
+
+	// Blend the same random data with the given kernels and with the scalar
+	// ones, for every width up to kWidth, with and without flipping.
+	void compare(const Graphics::BlendKernels &kernels, Mode mode, uint32 color) {
+		const Graphics::BlendKernels *scalar = Graphics::getBlendKernels(Graphics::kBlendKernelScalar);
+
+		for (uint32 width = 0; width <= kWidth; ++width) {
+			for (int flipping = 0; flipping < 4; ++flipping) {
+				const int32 inStep = (flipping & 1) ? -4 : 4;
+				const int32 inoStep = (flipping & 2) ? -kPitch : kPitch;
+				byte *in = _src + ((flipping & 2) ? (kHeight - 1) * kPitch : 0) + ((flipping & 1) && width ? (width - 1) * 4 : 0);
+
+				fill(_src, sizeof(_src));
+				fill(_target, sizeof(_target));
+				byte expected[sizeof(_target)];
+				memcpy(expected, _target, sizeof(_target));
+
+				(scalar->*mode)(in, expected, width, kHeight, kPitch, inStep, inoStep, color);
+				(kernels.*mode)(in, _target, width, kHeight, kPitch, inStep, inoStep, color);
+				TSM_ASSERT_SAME_DATA(kernels.name, expected, _target, sizeof(_target));
+			}
+		}
+	}
+
+	void compareAll(Mode mode) {
+		static const uint32 colors[] = { 0xFFFFFFFF, 0x80FFFFFF, 0xFF000000, 0xFF10FF80, 0x40FE7F01, 0x01FFFFFF };
+
+		for (int type = Graphics::kBlendKernelScalar + 1; type < Graphics::kBlendKernelCount; ++type) {
+			const Graphics::BlendKernels *kernels = Graphics::getBlendKernels((Graphics::BlendKernelType)type);
+			if (!kernels)
+				continue;
+
+			for (uint c = 0; c < ARRAYSIZE(colors); ++c)
+				compare(*kernels, mode, colors[c]);
+		}
+	}
+
+public:
+	void setUp() {
+		_seed = 0x5eed;
+	}
+
+	void test_alpha_blend() {
+		compareAll(&Graphics::BlendKernels::alphaBlend);
+	}
+
+	void test_additive_blend() {
+		compareAll(&Graphics::BlendKernels::additiveBlend);
+	}
+
+	void test_subtractive_blend() {
+		compareAll(&Graphics::BlendKernels::subtractiveBlend);
+	}
+
+	void test_multiply_blend() {
+		compareAll(&Graphics::BlendKernels::multiplyBlend);
+	}
+
+	void test_tinted_subtractive_blend_does_not_overflow() {
+		// The product of four full bytes does not fit an int
+		uint32 src = TS_ARGB(255, 255, 255, 255);
+		uint32 target = TS_ARGB(0, 255, 255, 255);
+		Graphics::getBlendKernels(Graphics::kBlendKernelScalar)->subtractiveBlend((byte *)&src, (byte *)&target, 1, 1, 4, 4, 4, 0xFFFEFEFE);
+
+		// 255 - 255 * 254 * 255 * 255 / 2^24
+		TS_ASSERT_EQUALS(target, TS_ARGB(255, 4, 4, 4));
+	}
+
+	void test_default_kernels_available() {
+		const Graphics::BlendKernels &kernels = Graphics::getDefaultBlendKernels();
+		TS_ASSERT(kernels.alphaBlend != 0);
+		TS_ASSERT(kernels.additiveBlend != 0);
+		TS_ASSERT(kernels.subtractiveBlend != 0);
+		TS_ASSERT(kernels.multiplyBlend != 0);
+		TS_ASSERT(kernels.name != 0);
+	}
+
+	void test_blit_uses_blend_kernels() {
+		// A half transparent white sprite over black, through the whole blit
+		Graphics::TransparentSurface sprite;
+		sprite.create(5, 2, Graphics::TransparentSurface::getSupportedPixelFormat());
+		Graphics::Surface target;
+		target.create(8, 4, Graphics::TransparentSurface::getSupportedPixelFormat());
+		memset(target.getPixels(), 0, target.pitch * target.h);
+		for (int y = 0; y < sprite.h; ++y)
+			for (int x = 0; x < sprite.w; ++x)
+				*(uint32 *)sprite.getBasePtr(x, y) = TS_ARGB(128, 255, 255, 255);
+
+		Common::Rect drawn = sprite.blit(target, 2, 1);
+		TS_ASSERT_EQUALS(drawn.width(), 5);
+		TS_ASSERT_EQUALS(drawn.height(), 2);
+		for (int y = 0; y < target.h; ++y) {
+			for (int x = 0; x < target.w; ++x) {
+				const bool inside = x >= 2 && x < 7 && y >= 1 && y < 3;
+				TS_ASSERT_EQUALS(*(const uint32 *)target.getBasePtr(x, y), inside ? TS_ARGB(255, 127, 127, 127) : 0u);
+			}
+		}
+
+		sprite.free();
+		target.free();
+	}
+};
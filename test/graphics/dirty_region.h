@@ -0,0 +1,99 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/dirty_region.h"
+
+class DirtyRegionTestSuite : public CxxTest::TestSuite {
+	Graphics::DirtyRegion *_region;
+
+	/** Return true if the region covers every pixel of r. */
+	bool covers(const Common::Rect &r) {
+		const Common::Array<Common::Rect> &rects = _region->getRects();
+		for (int y = r.top; y < r.bottom; ++y) {
+			for (int x = r.left; x < r.right; ++x) {
+				bool found = false;
+				for (uint i = 0; i < rects.size() && !found; ++i)
+					found = rects[i].contains(x, y);
+				if (!found)
+					return false;
+			}
+		}
+		return true;
+	}
+
+public:
+	void setUp() {
+		_region = new Graphics::DirtyRegion();
+		_region->setBounds(Common::Rect(320, 200));
+	}
+
+	void tearDown() {
+		delete _region;
+	}
+
+	void test_clipping() {
+		_region->addRect(Common::Rect(-10, -10, 5, 5));
+		_region->addRect(Common::Rect(400, 10, 410, 20));
+		TS_ASSERT_EQUALS(_region->getRects().size(), 1u);
+		TS_ASSERT_EQUALS(_region->getRects()[0], Common::Rect(0, 0, 5, 5));
+		TS_ASSERT_EQUALS(_region->getPixelCount(), 25u);
+		TS_ASSERT(!_region->isFull());
+	}
+
+	void test_merge_adjacent() {
+		// Touching rects of the same height waste nothing when merged
+		for (int x = 0; x < 100; x += 10)
+			_region->addRect(Common::Rect(x, 50, x + 10, 60));
+		TS_ASSERT_EQUALS(_region->getRects().size(), 1u);
+		TS_ASSERT_EQUALS(_region->getRects()[0], Common::Rect(0, 50, 100, 60));
+
+		// Contained rects are dropped
+		_region->addRect(Common::Rect(20, 52, 30, 55));
+		TS_ASSERT_EQUALS(_region->getRects().size(), 1u);
+	}
+
+	void test_waste_limit() {
+		// Two distant sprites would mostly waste pixels as one rect
+		_region->addRect(Common::Rect(0, 0, 10, 10));
+		_region->addRect(Common::Rect(300, 180, 310, 190));
+		TS_ASSERT_EQUALS(_region->getRects().size(), 2u);
+		TS_ASSERT_EQUALS(_region->getPixelCount(), 200u);
+	}
+
+	void test_too_many_rects() {
+		// A scattered grid of small sprites never exceeds the cap and is
+		// never lost
+		delete _region;
+		_region = new Graphics::DirtyRegion(Graphics::DirtyRegion::kDefaultMaxWastePercent, 16);
+		_region->setBounds(Common::Rect(320, 200));
+
+		for (int y = 0; y < 200; y += 20)
+			for (int x = 0; x < 320; x += 20)
+				_region->addRect(Common::Rect(x, y, x + 4, y + 4));
+
+		TS_ASSERT_LESS_THAN_EQUALS(_region->getRects().size(), 16u);
+		for (int y = 0; y < 200; y += 20)
+			for (int x = 0; x < 320; x += 20)
+				TS_ASSERT(covers(Common::Rect(x, y, x + 4, y + 4)));
+	}
+
+	void test_full_and_stats() {
+		_region->addRect(Common::Rect(0, 0, 320, 100));
+		TS_ASSERT(!_region->isFull());
+		_region->addRect(Common::Rect(0, 100, 320, 200));
+		TS_ASSERT(_region->isFull());
+		_region->clear();
+		TS_ASSERT(_region->isEmpty());
+
+		_region->addRect(Common::Rect(10, 10, 20, 20));
+		_region->clear();
+		_region->clear();
+
+		const Graphics::DirtyRegion::Stats &stats = _region->getStats();
+		TS_ASSERT_EQUALS(stats.frames, 2u);
+		TS_ASSERT_EQUALS(stats.fullFrames, 1u);
+		TS_ASSERT_EQUALS(stats.rects, 2u);
+		TS_ASSERT_EQUALS(stats.pixels, 64100u);
+		TS_ASSERT_EQUALS(stats.lastPixels, 100u);
+		TS_ASSERT_EQUALS(stats.maxPixels, 64000u);
+	}
+};
@@ -0,0 +1,155 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/scaler/hqkernels.h"
+#include "graphics/scaler/intern.h"
+
+class HQKernelsTestSuite : public CxxTest::TestSuite {
+	enum {
+		kWidth = 37,
+		kPitch = kWidth + 2,
+		kLines = 5
+	};
+
+	uint32 _seed;
+
+	uint32 next() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 8;
+	}
+
+	// YUV values close enough to each other to hit both sides of every
+	// diffYUV() threshold
+	void fillYUV(uint32 *yuv, uint count) {
+		const uint32 base = next() & 0xFFFFFF;
+		for (uint i = 0; i < count; ++i) {
+			const uint32 r = next();
+			switch (r & 3) {
+			case 0:
+				yuv[i] = base;
+				break;
+			case 1:
+				yuv[i] = r & 0xFFFFFF;
+				break;
+			default: {
+				const int y = CLIP<int>(((base >> 16) & 0xFF) + (int)((r >> 2) & 0x7F) - 0x3F, 0, 255);
+				const int u = CLIP<int>(((base >> 8) & 0xFF) + (int)((r >> 9) & 0x0F) - 0x07, 0, 255);
+				const int v = CLIP<int>((base & 0xFF) + (int)((r >> 13) & 0x0F) - 0x07, 0, 255);
+				yuv[i] = (y << 16) | (u << 8) | v;
+				}
+			}
+		}
+	}
+
+	void fillPixels(uint16 *pixels, uint count) {
+		const uint16 base = next();
+		for (uint i = 0; i < count; ++i)
+			pixels[i] = (next() & 1) ? base : (uint16)next();
+	}
+
+	template<typename ColorMask>
+	void compareFlat(const Graphics::HQKernels &kernels) {
+		uint16 src[kLines * kPitch];
+		uint16 expected[3 * kWidth * 3];
+		uint16 actual[3 * kWidth * 3];
+		fillPixels(src, ARRAYSIZE(src));
+
+		for (int count = 0; count <= kWidth; ++count) {
+			const uint16 *p = src + 2 * kPitch + 1;
+
+			// HQ2x, against the flat case of the C implementation
+			memset(actual, 0, sizeof(actual));
+			kernels.flat2x(p, kPitch, actual, 2 * kWidth, count, ColorMask::kLowBits, ColorMask::kLow2Bits);
+			memset(expected, 0, sizeof(expected));
+			for (int x = 0; x < count; ++x) {
+				const unsigned w2 = p[x - kPitch], w4 = p[x - 1], w5 = p[x], w6 = p[x + 1], w8 = p[x + kPitch];
+				uint16 *q = expected + 2 * x;
+				q[0] = interpolate16_2_1_1<ColorMask>(w5, w4, w2);
+				q[1] = interpolate16_2_1_1<ColorMask>(w5, w2, w6);
+				q[2 * kWidth] = interpolate16_2_1_1<ColorMask>(w5, w8, w4);
+				q[2 * kWidth + 1] = interpolate16_2_1_1<ColorMask>(w5, w6, w8);
+			}
+			TSM_ASSERT_SAME_DATA(kernels.name, expected, actual, sizeof(expected));
+
+			// HQ3x
+			memset(actual, 0, sizeof(actual));
+			kernels.flat3x(p, kPitch, actual, 3 * kWidth, count, ColorMask::kLowBits, ColorMask::kLow2Bits);
+			memset(expected, 0, sizeof(expected));
+			for (int x = 0; x < count; ++x) {
+				const unsigned w2 = p[x - kPitch], w4 = p[x - 1], w5 = p[x], w6 = p[x + 1], w8 = p[x + kPitch];
+				uint16 *q = expected + 3 * x;
+				q[0] = interpolate16_2_1_1<ColorMask>(w5, w4, w2);
+				q[1] = interpolate16_3_1<ColorMask>(w5, w2);
+				q[2] = interpolate16_2_1_1<ColorMask>(w5, w2, w6);
+				q[3 * kWidth] = interpolate16_3_1<ColorMask>(w5, w4);
+				q[3 * kWidth + 1] = w5;
+				q[3 * kWidth + 2] = interpolate16_3_1<ColorMask>(w5, w6);
+				q[6 * kWidth] = interpolate16_2_1_1<ColorMask>(w5, w8, w4);
+				q[6 * kWidth + 1] = interpolate16_3_1<ColorMask>(w5, w8);
+				q[6 * kWidth + 2] = interpolate16_2_1_1<ColorMask>(w5, w6, w8);
+			}
+			TSM_ASSERT_SAME_DATA(kernels.name, expected, actual, sizeof(expected));
+		}
+	}
+
+	void comparePatterns(const Graphics::HQKernels &kernels) {
+		uint32 yuv[3 * kPitch];
+		uint8 actual[kWidth];
+
+		for (int round = 0; round < 50; ++round) {
+			fillYUV(yuv, ARRAYSIZE(yuv));
+			const uint32 *above = yuv, *line = yuv + kPitch, *below = yuv + 2 * kPitch;
+
+			for (int width = 0; width <= kWidth; ++width) {
+				memset(actual, 0xFF, sizeof(actual));
+				kernels.patterns(above, line, below, actual, width);
+
+				for (int x = 0; x < width; ++x) {
+					const int yuv5 = line[x + 1];
+					int pattern = 0;
+					if (diffYUV(yuv5, above[x]))     pattern |= 0x0001;
+					if (diffYUV(yuv5, above[x + 1])) pattern |= 0x0002;
+					if (diffYUV(yuv5, above[x + 2])) pattern |= 0x0004;
+					if (diffYUV(yuv5, line[x]))      pattern |= 0x0008;
+					if (diffYUV(yuv5, line[x + 2]))  pattern |= 0x0010;
+					if (diffYUV(yuv5, below[x]))     pattern |= 0x0020;
+					if (diffYUV(yuv5, below[x + 1])) pattern |= 0x0040;
+					if (diffYUV(yuv5, below[x + 2])) pattern |= 0x0080;
+					TSM_ASSERT_EQUALS(kernels.name, actual[x], pattern);
+				}
+
+				// Nothing past the end of the line may be touched
+				for (int x = width; x < kWidth; ++x)
+					TS_ASSERT_EQUALS(actual[x], 0xFF);
+			}
+		}
+	}
+
+public:
+	void setUp() {
+		_seed = 0x5eed;
+	}
+
+	void test_all_kernels_match_c() {
+#ifdef USE_HQ_SCALERS
+		for (int type = Graphics::kHQKernelScalar; type < Graphics::kHQKernelCount; ++type) {
+			const Graphics::HQKernels *kernels = Graphics::getHQKernels((Graphics::HQKernelType)type);
+			if (!kernels)
+				continue;
+
+			comparePatterns(*kernels);
+			compareFlat<Graphics::ColorMasks<565> >(*kernels);
+			compareFlat<Graphics::ColorMasks<555> >(*kernels);
+		}
+#endif
+	}
+
+	void test_default_kernels_available() {
+#ifdef USE_HQ_SCALERS
+		const Graphics::HQKernels &kernels = Graphics::getDefaultHQKernels();
+		TS_ASSERT(kernels.patterns != 0);
+		TS_ASSERT(kernels.flat2x != 0);
+		TS_ASSERT(kernels.flat3x != 0);
+		TS_ASSERT(kernels.name != 0);
+#endif
+	}
+};
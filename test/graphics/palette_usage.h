@@ -0,0 +1,67 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/palette_usage.h"
+
+class PaletteUsageTestSuite : public CxxTest::TestSuite {
+	enum {
+		kWidth = 64,
+		kHeight = 40
+	};
+
+	byte _pixels[kHeight][kWidth];
+	bool _indices[256];
+
+	void fillRect(int left, int top, int right, int bottom, byte color) {
+		for (int y = top; y < bottom; ++y)
+			for (int x = left; x < right; ++x)
+				_pixels[y][x] = color;
+	}
+
+public:
+	void setUp() {
+		memset(_pixels, 0, sizeof(_pixels));
+		memset(_indices, 0, sizeof(_indices));
+	}
+
+	void test_unused_indices() {
+		Common::Array<Common::Rect> rects;
+		_indices[7] = true;
+		Graphics::findPaletteUsage(&_pixels[0][0], kWidth, kWidth, kHeight, _indices, 8, rects);
+		TS_ASSERT(rects.empty());
+	}
+
+	void test_single_pixel() {
+		Common::Array<Common::Rect> rects;
+		_pixels[13][21] = 7;
+		_indices[7] = true;
+		Graphics::findPaletteUsage(&_pixels[0][0], kWidth, kWidth, kHeight, _indices, 8, rects);
+		TS_ASSERT_EQUALS(rects.size(), 1u);
+		TS_ASSERT_EQUALS(rects[0], Common::Rect(21, 8, 22, 16));
+	}
+
+	void test_bands_merge() {
+		Common::Array<Common::Rect> rects;
+
+		// A vertical strip spanning several bands, like a waterfall
+		fillRect(10, 4, 20, 30, 200);
+		_indices[200] = true;
+		Graphics::findPaletteUsage(&_pixels[0][0], kWidth, kWidth, kHeight, _indices, 8, rects);
+		TS_ASSERT_EQUALS(rects.size(), 1u);
+		TS_ASSERT_EQUALS(rects[0], Common::Rect(10, 0, 20, 32));
+	}
+
+	void test_separate_areas() {
+		Common::Array<Common::Rect> rects;
+
+		// Extents grow row by row within a band; the last band is short
+		fillRect(5, 2, 6, 3, 1);
+		fillRect(0, 5, 3, 6, 2);
+		fillRect(60, 38, 64, 40, 3);
+		fillRect(30, 20, 40, 21, 4);
+		_indices[1] = _indices[2] = _indices[3] = true;
+		Graphics::findPaletteUsage(&_pixels[0][0], kWidth, kWidth, kHeight, _indices, 16, rects);
+		TS_ASSERT_EQUALS(rects.size(), 2u);
+		TS_ASSERT_EQUALS(rects[0], Common::Rect(0, 0, 6, 16));
+		TS_ASSERT_EQUALS(rects[1], Common::Rect(60, 32, 64, 40));
+	}
+};
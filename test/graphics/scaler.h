@@ -0,0 +1,105 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/jobqueue.h"
+#include "graphics/scaler.h"
+
+#ifdef POSIX
+#include "backends/threads/pthread/pthread-threads.h"
+#endif
+
+class ScalerTestSuite : public CxxTest::TestSuite {
+	enum {
+		kWidth = 75,
+		kHeight = 131,
+		kBorder = 2,
+		kSrcPitch = (kWidth + 2 * kBorder) * 2
+	};
+
+	struct Scaler {
+		const char *name;
+		ScalerProc *proc;
+		int scale;
+	};
+
+	uint16 _src[(kWidth + 2 * kBorder) * (kHeight + 2 * kBorder)];
+
+	const uint8 *source() const {
+		return (const uint8 *)&_src[kBorder * (kWidth + 2 * kBorder) + kBorder];
+	}
+
+	/** Scale serially and in bands on the given queue and compare. */
+	void compare(Common::JobQueue &jobs, const Scaler &scaler) {
+		const uint32 dstPitch = kWidth * scaler.scale * 2;
+		const uint32 size = dstPitch * kHeight * scaler.scale;
+		uint8 *expected = new uint8[size];
+		uint8 *actual = new uint8[size];
+		memset(expected, 0, size);
+		memset(actual, 0, size);
+
+		scaler.proc(source(), kSrcPitch, expected, dstPitch, kWidth, kHeight);
+		ScaleInBands(jobs, scaler.proc, scaler.scale, source(), kSrcPitch, actual, dstPitch, kWidth, kHeight);
+		TSM_ASSERT_SAME_DATA(scaler.name, expected, actual, size);
+
+		delete[] expected;
+		delete[] actual;
+	}
+
+	void compareAll(Common::JobQueue &jobs) {
+		static const Scaler scalers[] = {
+			{ "Normal1x", Normal1x, 1 },
+#ifdef USE_SCALERS
+			{ "Normal2x", Normal2x, 2 },
+			{ "Normal3x", Normal3x, 3 },
+			{ "AdvMame2x", AdvMame2x, 2 },
+			{ "AdvMame3x", AdvMame3x, 3 },
+			{ "2xSaI", _2xSaI, 2 },
+			{ "Super2xSaI", Super2xSaI, 2 },
+			{ "SuperEagle", SuperEagle, 2 },
+			{ "TV2x", TV2x, 2 },
+			{ "DotMatrix", DotMatrix, 2 },
+#ifdef USE_HQ_SCALERS
+			{ "HQ2x", HQ2x, 2 },
+			{ "HQ3x", HQ3x, 3 },
+#endif
+#endif
+		};
+
+		for (uint i = 0; i < ARRAYSIZE(scalers); ++i)
+			compare(jobs, scalers[i]);
+	}
+
+public:
+	void setUp() {
+		// Blocks of repeated colors give the edge detecting scalers
+		// something to work with
+		uint32 seed = 1;
+		for (uint i = 0; i < ARRAYSIZE(_src); ++i) {
+			if (i % 3 == 0)
+				seed = seed * 1103515245 + 12345;
+			_src[i] = (uint16)(seed >> 16) & ((seed & 0x100000) ? 0xFFFF : 0xF81F);
+		}
+
+		InitScalers(565);
+	}
+
+	void tearDown() {
+		DestroyScalers();
+	}
+
+	void test_bands_synchronous() {
+		Common::JobQueue jobs;
+		compareAll(jobs);
+	}
+
+#ifdef POSIX
+	void test_bands_threaded() {
+		PthreadThreadManager threads;
+		static const uint workers[] = { 1, 3, 8 };
+
+		for (uint i = 0; i < ARRAYSIZE(workers); ++i) {
+			Common::JobQueue jobs(workers[i], &threads);
+			compareAll(jobs);
+		}
+	}
+#endif
+};
@@ -0,0 +1,123 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/pixelformat.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite {
+	enum {
+		kPlaneSize = 64 * 64
+	};
+
+	enum Subsampling {
+		k444,
+		k420,
+		k410
+	};
+
+	uint32 _seed;
+	byte _y[kPlaneSize], _u[kPlaneSize], _v[kPlaneSize];
+
+	byte nextByte() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	// Random values, with plenty of extremes to exercise the clipping
+	void fillPlane(byte *plane) {
+		for (uint i = 0; i < kPlaneSize; ++i) {
+			const byte b = nextByte();
+			plane[i] = (b < 32) ? 0 : (b > 224) ? 255 : nextByte();
+		}
+	}
+
+	void convert(Graphics::Surface &dst, Subsampling subsampling, Graphics::YUVToRGBManager::LuminanceScale scale, int width, int height) {
+		switch (subsampling) {
+		case k444:
+			YUVToRGBMan.convert444(&dst, scale, _y, _u, _v, width, height, 64, 64);
+			break;
+		case k420:
+			YUVToRGBMan.convert420(&dst, scale, _y, _u, _v, width, height, 64, 64);
+			break;
+		case k410:
+			YUVToRGBMan.convert410(&dst, scale, _y, _u, _v, width, height, 64, 64);
+			break;
+		}
+	}
+
+	// Convert with the vector code and with the lookup tables, and require
+	// identical results. Widths are chosen not to be multiples of the
+	// vector size.
+	void compare(const Graphics::PixelFormat &format, Subsampling subsampling, Graphics::YUVToRGBManager::LuminanceScale scale) {
+		static const int widths[3][3] = { { 1, 37, 63 }, { 2, 38, 62 }, { 4, 36, 60 } };
+
+		for (uint i = 0; i < ARRAYSIZE(widths[subsampling]); ++i) {
+			const int width = widths[subsampling][i];
+			const int height = 12;
+
+			Graphics::Surface expected, actual;
+			expected.create(width, height, format);
+			actual.create(width, height, format);
+
+			YUVToRGBMan.setVectorized(false);
+			convert(expected, subsampling, scale, width, height);
+			YUVToRGBMan.setVectorized(true);
+			convert(actual, subsampling, scale, width, height);
+
+			TS_ASSERT_SAME_DATA(expected.getPixels(), actual.getPixels(), height * expected.pitch);
+
+			expected.free();
+			actual.free();
+		}
+	}
+
+public:
+	void setUp() {
+		_seed = 0x5eed;
+		fillPlane(_y);
+		fillPlane(_u);
+		fillPlane(_v);
+	}
+
+	void tearDown() {
+		YUVToRGBMan.setVectorized(true);
+	}
+
+	void test_vector_matches_lookup() {
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),  // RGB565
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15), // ARGB1555
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0),  // XRGB8888
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0), // RGBA8888
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24), // ABGR8888
+			Graphics::PixelFormat(4, 5, 5, 5, 0, 13, 5, 0, 0)   // Red across both 16 bit halves
+		};
+
+		for (uint f = 0; f < ARRAYSIZE(formats); ++f) {
+			for (int subsampling = k444; subsampling <= k410; ++subsampling) {
+				compare(formats[f], (Subsampling)subsampling, Graphics::YUVToRGBManager::kScaleFull);
+				compare(formats[f], (Subsampling)subsampling, Graphics::YUVToRGBManager::kScaleITU);
+			}
+		}
+	}
+
+	void test_itu_black_and_white() {
+		Graphics::Surface dst;
+		dst.create(8, 2, Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0));
+
+		memset(_u, 128, sizeof(_u));
+		memset(_v, 128, sizeof(_v));
+		for (int x = 0; x < 8; ++x) {
+			_y[x] = 16;
+			_y[64 + x] = 235;
+		}
+
+		YUVToRGBMan.convert444(&dst, Graphics::YUVToRGBManager::kScaleITU, _y, _u, _v, 8, 2, 64, 64);
+		for (int x = 0; x < 8; ++x) {
+			TS_ASSERT_EQUALS(*(const uint32 *)dst.getBasePtr(x, 0), 0x000000u);
+			TS_ASSERT_EQUALS(*(const uint32 *)dst.getBasePtr(x, 1), 0xFFFFFFu);
+		}
+
+		dst.free();
+	}
+};
@@ -5,8 +5,8 @@
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h
-TEST_LIBS    := audio/libaudio.a common/libcommon.a
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/graphics/*.h $(srcdir)/test/engines/*.h
+TEST_LIBS    := engines/detectioncache.o audio/libaudio.a graphics/libgraphics.a common/libcommon.a
 
 ifeq ($(ENABLE_WINTERMUTE), STATIC_PLUGIN)
 	TESTS += $(srcdir)/test/engines/wintermute/*.h
@@ -32,6 +32,16 @@ ifdef N64
 TEST_LDFLAGS := $(filter-out -mno-crt0,$(TEST_LDFLAGS))
 endif
 
+# The thread manager and the file system nodes are part of the backends, but
+# the job queue and directory tests and the file stream benchmarks use them
+ifdef POSIX
+TEST_LIBS += backends/threads/pthread/pthread-threads.o \
+	backends/fs/abstract-fs.o \
+	backends/fs/stdiostream.o \
+	backends/fs/posix/posix-fs.o \
+	backends/fs/posix/posix-iostream.o
+endif
+
 ifdef PSP
 TEST_LIBS += backends/platform/psp/memory.o \
 	backends/platform/psp/mp3.o \
@@ -51,8 +61,56 @@ test/runner.cpp: $(TESTS)
 	@mkdir -p test
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
+
+######################################################################
+# Benchmarks, also based on CxxTest. They only report timings and are
+# not part of the 'test' target; use 'make benchmark' to run them.
+######################################################################
+
+BENCHMARKS   := $(srcdir)/test/benchmarks/audio/*.h $(srcdir)/test/benchmarks/common/*.h $(srcdir)/test/benchmarks/graphics/*.h
+BENCHMARK_FLAGS := $(TEST_FLAGS) --include=$(srcdir)/test/benchmarks/benchmark.h
+
+benchmark: test/benchmark_runner
+	./test/benchmark_runner
+test/benchmark_runner: test/benchmark_runner.cpp $(TEST_LIBS)
+	$(QUIET_CXX)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) $(TEST_CFLAGS) -o $@ $+ $(TEST_LDFLAGS)
+test/benchmark_runner.cpp: $(BENCHMARKS)
+	@mkdir -p test
+	$(srcdir)/test/cxxtest/cxxtestgen.py $(BENCHMARK_FLAGS) -o $@ $+
+
+
+######################################################################
+# OpenGL backend tests. They render into a headless EGL context (e.g.
+# Mesa llvmpipe) and are skipped when none can be created; use the
+# 'test-opengl' target to run them.
+######################################################################
+
+ifdef USE_OPENGL
+OPENGL_TESTS := $(srcdir)/test/opengl/*.h
+OPENGL_TEST_LIBS := backends/graphics/opengl/context.o \
+	backends/graphics/opengl/debug.o \
+	backends/graphics/opengl/framebuffer.o \
+	backends/graphics/opengl/shader.o \
+	backends/graphics/opengl/sprite-atlas.o \
+	backends/graphics/opengl/texture.o \
+	backends/graphics/opengl/pipelines/clut8.o \
+	backends/graphics/opengl/pipelines/fixed.o \
+	backends/graphics/opengl/pipelines/pipeline.o \
+	backends/graphics/opengl/pipelines/shader.o \
+	$(TEST_LIBS)
+
+test-opengl: test/opengl_runner
+	./test/opengl_runner
+test/opengl_runner: test/opengl_runner.cpp $(OPENGL_TEST_LIBS)
+	$(QUIET_CXX)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) $(TEST_CFLAGS) -o $@ $+ $(TEST_LDFLAGS) -lEGL
+test/opengl_runner.cpp: $(OPENGL_TESTS)
+	@mkdir -p test
+	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
+endif
+
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner
+	-$(RM) test/runner.cpp test/runner test/benchmark_runner.cpp test/benchmark_runner
+	-$(RM) test/opengl_runner.cpp test/opengl_runner
 
-.PHONY: test clean-test
+.PHONY: test benchmark test-opengl clean-test
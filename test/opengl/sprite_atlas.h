@@ -0,0 +1,386 @@
+#include <cxxtest/TestSuite.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "backends/graphics/opengl/opengl-sys.h"
+#include "backends/graphics/opengl/framebuffer.h"
+#include "backends/graphics/opengl/shader.h"
+#include "backends/graphics/opengl/sprite-atlas.h"
+#include "backends/graphics/opengl/texture.h"
+#include "backends/graphics/opengl/pipelines/fixed.h"
+#include "backends/graphics/opengl/pipelines/shader.h"
+
+/**
+ * Headless checks of the texture uploads, the sprite atlas and the pipelines.
+ *
+ * They render into an EGL pbuffer, which Mesa's llvmpipe provides without a
+ * display (e.g. with EGL_PLATFORM=surfaceless). When no context can be
+ * created every test only emits a warning and returns.
+ */
+namespace OpenGLTest {
+
+enum {
+	kWidth = 64,
+	kHeight = 48
+};
+
+static int drawCalls = 0;
+static void (GL_CALL_CONV *realDrawArrays)(GLenum, GLint, GLsizei) = nullptr;
+
+static void GL_CALL_CONV countDrawArrays(GLenum mode, GLint first, GLsizei count) {
+	++drawCalls;
+	realDrawArrays(mode, first, count);
+}
+
+static bool initContext() {
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	EGLDisplay display = EGL_NO_DISPLAY;
+	if (getPlatformDisplay)
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	if (display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	if (display == EGL_NO_DISPLAY)
+		return false;
+
+	EGLint major, minor;
+	if (!eglInitialize(display, &major, &minor) || !eglBindAPI(EGL_OPENGL_API))
+		return false;
+
+	const EGLint configAttribs[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_ALPHA_SIZE, 8,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint numConfigs = 0;
+	if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs < 1)
+		return false;
+
+	const EGLint surfaceAttribs[] = { EGL_WIDTH, kWidth, EGL_HEIGHT, kHeight, EGL_NONE };
+	EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+	if (surface == EGL_NO_SURFACE)
+		return false;
+	EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+	if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, surface, surface, context))
+		return false;
+
+	OpenGL::g_context.reset();
+	OpenGL::g_context.type = OpenGL::kContextGL;
+#define GL_FUNC_DEF(ret, name, param) { void *fn = (void *)eglGetProcAddress(#name); memcpy(&OpenGL::g_context.name, &fn, sizeof(fn)); }
+#define GL_FUNC_2_DEF(ret, name, extName, param) GL_FUNC_DEF(ret, name, param)
+#include "backends/graphics/opengl/opengl-func.h"
+#undef GL_FUNC_2_DEF
+#undef GL_FUNC_DEF
+	realDrawArrays = OpenGL::g_context.glDrawArrays;
+	OpenGL::g_context.glDrawArrays = countDrawArrays;
+
+	OpenGL::g_context.glGetIntegerv(GL_MAX_TEXTURE_SIZE, &OpenGL::g_context.maxTextureSize);
+	OpenGL::g_context.NPOTSupported = true;
+	OpenGL::g_context.shadersSupported = true;
+	OpenGL::g_context.multitextureSupported = true;
+	OpenGL::g_context.framebufferObjectSupported = true;
+	return true;
+}
+
+/** Create the context on first use; return false if there is none. */
+static bool haveContext() {
+	static const bool available = initContext();
+	return available;
+}
+
+/** RGBA bytes in memory, matching GL_RGBA/GL_UNSIGNED_BYTE on little endian. */
+static const Graphics::PixelFormat &format() {
+	static const Graphics::PixelFormat rgba(4, 8, 8, 8, 8, 0, 8, 16, 24);
+	return rgba;
+}
+
+static void fill(uint32 *buf, int count, byte r, byte g, byte b, byte a) {
+	for (int i = 0; i < count; ++i)
+		buf[i] = format().ARGBToColor(a, r, g, b);
+}
+
+/** Read back a pixel as 0xRRGGBBAA, with y counted from the top. */
+static uint32 readPixel(int x, int y) {
+	byte p[4];
+	OpenGL::g_context.glReadPixels(x, kHeight - 1 - y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, p);
+	return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+static bool near(uint32 value, uint32 expected, uint32 tolerance) {
+	return value + tolerance >= expected && value <= expected + tolerance;
+}
+
+} // End of namespace OpenGLTest
+
+class OpenGLSpriteAtlasTestSuite : public CxxTest::TestSuite {
+	typedef void (OpenGLSpriteAtlasTestSuite::*Check)(OpenGL::Pipeline &pipeline, OpenGL::Backbuffer &backbuffer, bool unpackSubImage);
+
+	/**
+	 * Run a check with the fixed function and the shader pipeline, each with
+	 * and without GL_UNPACK_ROW_LENGTH support.
+	 */
+	void runPipelines(Check check) {
+		using namespace OpenGL;
+
+		if (!OpenGLTest::haveContext()) {
+			TS_WARN("No headless OpenGL context available, test skipped");
+			return;
+		}
+
+		Backbuffer backbuffer;
+		backbuffer.setDimensions(OpenGLTest::kWidth, OpenGLTest::kHeight);
+		backbuffer.setClearColor(0, 0, 0, 0);
+
+		for (int unpack = 1; unpack >= 0; --unpack) {
+			{
+				FixedPipeline fixed;
+				runPipeline(fixed, backbuffer, unpack != 0, check);
+			}
+
+			ShaderMan.notifyCreate();
+			{
+				ShaderPipeline shader(ShaderMan.query(ShaderManager::kDefault));
+				runPipeline(shader, backbuffer, unpack != 0, check);
+			}
+			ShaderMan.notifyDestroy();
+			// Shaders stay bound after deactivation; the backend never goes
+			// back to the fixed pipeline in the same context, but we do.
+			GL_CALL(glUseProgram(0));
+		}
+	}
+
+	void runPipeline(OpenGL::Pipeline &pipeline, OpenGL::Backbuffer &backbuffer, bool unpackSubImage, Check check) {
+		OpenGL::g_context.unpackSubImageSupported = unpackSubImage;
+		OpenGL::g_context.setPipeline(&pipeline);
+		pipeline.setColor(1, 1, 1, 1);
+		pipeline.setFramebuffer(&backbuffer);
+		(this->*check)(pipeline, backbuffer, unpackSubImage);
+		OpenGL::g_context.setPipeline(nullptr);
+	}
+
+	void clear(OpenGL::Backbuffer &backbuffer, OpenGL::Framebuffer::BlendMode blend) {
+		using namespace OpenGL;
+
+		backbuffer.enableBlend(Framebuffer::kBlendModeDisabled);
+		GL_CALL(glClear(GL_COLOR_BUFFER_BIT));
+		backbuffer.enableBlend(blend);
+	}
+
+	/** Create the three sprites used by most checks: red, half transparent green and blue. */
+	void createSprites(OpenGL::SpriteAtlas &atlas, uint32 &s1, uint32 &s2, uint32 &s3) {
+		uint32 buf[20 * 20];
+		s1 = atlas.createSprite(8, 8);
+		s2 = atlas.createSprite(16, 4);
+		s3 = atlas.createSprite(20, 20);
+		TS_ASSERT(s1 && s2 && s3);
+		TS_ASSERT(s1 != s2 && s2 != s3 && s1 != s3);
+
+		OpenGLTest::fill(buf, 8 * 8, 255, 0, 0, 255);
+		atlas.copyRectToSprite(s1, buf, 8 * 4, 0, 0, 8, 8);
+		OpenGLTest::fill(buf, 16 * 4, 0, 255, 0, 128);
+		atlas.copyRectToSprite(s2, buf, 16 * 4, 0, 0, 16, 4);
+		OpenGLTest::fill(buf, 20 * 20, 0, 0, 255, 255);
+		atlas.copyRectToSprite(s3, buf, 20 * 4, 0, 0, 20, 20);
+		// A white stripe over half of s3, with a pitch wider than the update
+		OpenGLTest::fill(buf, 20 * 20, 255, 255, 255, 255);
+		atlas.copyRectToSprite(s3, buf, 20 * 4, 0, 10, 10, 2);
+	}
+
+	void checkPartialUpload(OpenGL::Pipeline &pipeline, OpenGL::Backbuffer &backbuffer, bool unpackSubImage) {
+		using namespace OpenGL;
+		const Graphics::PixelFormat &format = OpenGLTest::format();
+
+		Texture tex(GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE, format);
+		tex.allocate(32, 32);
+		tex.fill(format.ARGBToColor(255, 255, 0, 0));
+		tex.updateGLTexture();
+		// Change the pixels outside the rect without marking them dirty
+		tex.getSurface()->fillRect(Common::Rect(32, 32), format.ARGBToColor(255, 0, 0, 255));
+		uint32 green[8 * 4];
+		OpenGLTest::fill(green, 8 * 4, 0, 255, 0, 255);
+		tex.copyRectToTexture(10, 12, 8, 4, green, 8 * 4);
+		tex.updateGLTexture();
+
+		clear(backbuffer, Framebuffer::kBlendModeDisabled);
+		pipeline.drawTexture(tex.getGLTexture(), 0, 0, 32, 32);
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(12, 13), 0x00FF00FFu);
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(17, 15), 0x00FF00FFu);
+		// Left of the rect on the same line: only uploading full lines touches it
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(2, 13), unpackSubImage ? 0xFF0000FFu : 0x0000FFFFu);
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(2, 2), 0xFF0000FFu);
+	}
+
+	void checkBatching(OpenGL::Pipeline &pipeline, OpenGL::Backbuffer &backbuffer, bool) {
+		using namespace OpenGL;
+
+		SpriteAtlas atlas(GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE, OpenGLTest::format());
+		uint32 s1, s2, s3;
+		createSprites(atlas, s1, s2, s3);
+
+		TS_ASSERT(!atlas.hasQueuedSprites());
+		atlas.drawSprite(s3, 0, 0, 20, 20, 0xFFFFFFFF);
+		atlas.drawSprite(s1, 4, 4, 8, 8, 0xFFFFFFFF);
+		atlas.drawSprite(s2, 0, 5, 16, 4, 0xFFFFFFFF);
+		atlas.drawSprite(s1, 30, 30, 16, 16, 0x80FFFFFF); // scaled, half transparent
+		atlas.drawSprite(s1, 50, 0, 8, 8, 0xFF00FF00); // tinted: red * green = black
+		TS_ASSERT(atlas.isDirty());
+
+		clear(backbuffer, Framebuffer::kBlendModeTraditionalTransparency);
+		OpenGLTest::drawCalls = 0;
+		atlas.render(pipeline, Common::Rect(OpenGLTest::kWidth, OpenGLTest::kHeight), OpenGLTest::kWidth, OpenGLTest::kHeight);
+		TS_ASSERT_EQUALS(OpenGLTest::drawCalls, 1);
+		TS_ASSERT(!atlas.isDirty());
+
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(18, 18), 0x0000FFFFu);
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(2, 10), 0xFFFFFFFFu);
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(12, 10), 0x0000FFFFu);
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(6, 10), 0xFF0000FFu);
+
+		// s2 at half alpha over red and blue
+		uint32 p = OpenGLTest::readPixel(6, 6);
+		TS_ASSERT(OpenGLTest::near((p >> 24) & 0xFF, 127, 1));
+		TS_ASSERT(OpenGLTest::near((p >> 16) & 0xFF, 128, 1));
+		p = OpenGLTest::readPixel(40, 40);
+		TS_ASSERT(OpenGLTest::near((p >> 24) & 0xFF, 128, 1));
+		TS_ASSERT_EQUALS((p >> 16) & 0xFF, 0u);
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(29, 29), 0u);
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(46, 46), 0u);
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(53, 3) & 0xFFFFFF00, 0u);
+	}
+
+	void checkScaledScreen(OpenGL::Pipeline &pipeline, OpenGL::Backbuffer &backbuffer, bool) {
+		using namespace OpenGL;
+
+		SpriteAtlas atlas(GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE, OpenGLTest::format());
+		uint32 s1, s2, s3;
+		createSprites(atlas, s1, s2, s3);
+
+		// Sprites are placed in game coordinates, here half the output size
+		clear(backbuffer, Framebuffer::kBlendModeTraditionalTransparency);
+		atlas.drawSprite(s1, 2, 2, 8, 8, 0xFFFFFFFF);
+		atlas.render(pipeline, Common::Rect(OpenGLTest::kWidth, OpenGLTest::kHeight), OpenGLTest::kWidth / 2, OpenGLTest::kHeight / 2);
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(3, 3), 0u);
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(4, 4), 0xFF0000FFu);
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(19, 19), 0xFF0000FFu);
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(20, 20), 0u);
+	}
+
+	void checkDestroyedSprites(OpenGL::Pipeline &pipeline, OpenGL::Backbuffer &backbuffer, bool) {
+		using namespace OpenGL;
+
+		SpriteAtlas atlas(GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE, OpenGLTest::format());
+		uint32 s1, s2, s3;
+		createSprites(atlas, s1, s2, s3);
+		atlas.drawSprite(s1, 0, 0, 8, 8, 0xFFFFFFFF);
+		atlas.render(pipeline, Common::Rect(OpenGLTest::kWidth, OpenGLTest::kHeight), OpenGLTest::kWidth, OpenGLTest::kHeight);
+
+		// Destroyed sprites are skipped and their space comes back transparent
+		atlas.destroySprite(s1);
+		TS_ASSERT(atlas.isDirty());
+		const uint32 s4 = atlas.createSprite(8, 8);
+		TS_ASSERT(s4 != 0);
+		TS_ASSERT_DIFFERS(s4, s1);
+
+		atlas.clearSprites();
+		atlas.drawSprite(s1, 0, 0, 8, 8, 0xFFFFFFFF);
+		atlas.drawSprite(s4, 10, 0, 8, 8, 0xFFFFFFFF);
+		clear(backbuffer, Framebuffer::kBlendModeTraditionalTransparency);
+		atlas.render(pipeline, Common::Rect(OpenGLTest::kWidth, OpenGLTest::kHeight), OpenGLTest::kWidth, OpenGLTest::kHeight);
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(3, 3), 0u);
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(13, 3), 0u);
+	}
+
+	void checkLargeSprites(OpenGL::Pipeline &pipeline, OpenGL::Backbuffer &backbuffer, bool) {
+		using namespace OpenGL;
+
+		SpriteAtlas atlas(GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE, OpenGLTest::format());
+		uint32 s1, s2, s3;
+		createSprites(atlas, s1, s2, s3);
+
+		// Sprites that do not fit a shared page get their own: three batches
+		const uint32 big = atlas.createSprite(1500, 4);
+		TS_ASSERT(big != 0);
+		atlas.drawSprite(s3, 0, 0, 20, 20, 0xFFFFFFFF);
+		atlas.drawSprite(big, 0, 0, 4, 4, 0xFFFFFFFF);
+		atlas.drawSprite(s2, 0, 0, 4, 4, 0xFFFFFFFF);
+		clear(backbuffer, Framebuffer::kBlendModeTraditionalTransparency);
+		OpenGLTest::drawCalls = 0;
+		atlas.render(pipeline, Common::Rect(OpenGLTest::kWidth, OpenGLTest::kHeight), OpenGLTest::kWidth, OpenGLTest::kHeight);
+		TS_ASSERT_EQUALS(OpenGLTest::drawCalls, 3);
+		atlas.destroySprite(big);
+	}
+
+	void checkPipelineColor(OpenGL::Pipeline &pipeline, OpenGL::Backbuffer &backbuffer, bool) {
+		using namespace OpenGL;
+		const Graphics::PixelFormat &format = OpenGLTest::format();
+
+		SpriteAtlas atlas(GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE, format);
+		uint32 s1, s2, s3;
+		createSprites(atlas, s1, s2, s3);
+
+		// The batch must not clobber the color set on the pipeline
+		clear(backbuffer, Framebuffer::kBlendModeTraditionalTransparency);
+		pipeline.setColor(1, 1, 1, 0.5f);
+		atlas.drawSprite(s3, 0, 0, 4, 4, 0xFFFFFFFF);
+		atlas.render(pipeline, Common::Rect(OpenGLTest::kWidth, OpenGLTest::kHeight), OpenGLTest::kWidth, OpenGLTest::kHeight);
+
+		Texture tex(GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE, format);
+		tex.allocate(4, 4);
+		tex.fill(format.ARGBToColor(255, 255, 255, 255));
+		tex.updateGLTexture();
+		pipeline.drawTexture(tex.getGLTexture(), 10, 10, 4, 4);
+		TS_ASSERT(OpenGLTest::near((OpenGLTest::readPixel(11, 11) >> 24) & 0xFF, 128, 1));
+		pipeline.setColor(1, 1, 1, 1);
+	}
+
+	void checkContextLoss(OpenGL::Pipeline &pipeline, OpenGL::Backbuffer &backbuffer, bool) {
+		using namespace OpenGL;
+
+		SpriteAtlas atlas(GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE, OpenGLTest::format());
+		uint32 s1, s2, s3;
+		createSprites(atlas, s1, s2, s3);
+		atlas.drawSprite(s3, 0, 0, 20, 20, 0xFFFFFFFF);
+		atlas.render(pipeline, Common::Rect(OpenGLTest::kWidth, OpenGLTest::kHeight), OpenGLTest::kWidth, OpenGLTest::kHeight);
+
+		// The pixels are kept in memory and uploaded again
+		atlas.destroy();
+		atlas.recreate();
+		clear(backbuffer, Framebuffer::kBlendModeTraditionalTransparency);
+		atlas.render(pipeline, Common::Rect(OpenGLTest::kWidth, OpenGLTest::kHeight), OpenGLTest::kWidth, OpenGLTest::kHeight);
+		TS_ASSERT_EQUALS(OpenGLTest::readPixel(1, 1), 0x0000FFFFu);
+	}
+
+public:
+	void test_partial_upload() {
+		runPipelines(&OpenGLSpriteAtlasTestSuite::checkPartialUpload);
+	}
+
+	void test_batching() {
+		runPipelines(&OpenGLSpriteAtlasTestSuite::checkBatching);
+	}
+
+	void test_scaled_screen() {
+		runPipelines(&OpenGLSpriteAtlasTestSuite::checkScaledScreen);
+	}
+
+	void test_destroyed_sprites() {
+		runPipelines(&OpenGLSpriteAtlasTestSuite::checkDestroyedSprites);
+	}
+
+	void test_large_sprites() {
+		runPipelines(&OpenGLSpriteAtlasTestSuite::checkLargeSprites);
+	}
+
+	void test_pipeline_color() {
+		runPipelines(&OpenGLSpriteAtlasTestSuite::checkPipelineColor);
+	}
+
+	void test_context_loss() {
+		runPipelines(&OpenGLSpriteAtlasTestSuite::checkContextLoss);
+	}
+};